@@ -0,0 +1,135 @@
+namespace Schmix.Example;
+
+using ImGuiNET;
+
+using Schmix.Audio;
+using Schmix.Core;
+using Schmix.Extension;
+using Schmix.UI;
+
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+
+internal sealed class CaptureModule : Module
+{
+    private const float DefaultMinutes = 5f;
+
+    public CaptureModule()
+    {
+        mMinutes = DefaultMinutes;
+        mSaveSeconds = 60f;
+        mPath = "capture.wav";
+
+        mBuffer = null;
+        CreateBuffer();
+    }
+
+    protected override void Cleanup(bool disposed)
+    {
+        mBuffer?.Dispose();
+        mBuffer = null;
+    }
+
+    public override int InputCount => 1;
+    public override int OutputCount => 1;
+
+    public override string GetInputName(int index) => index > 0 ? "<unused>" : "Audio";
+    public override string GetOutputName(int index) => index > 0 ? "<unused>" : "Thru";
+
+    public override string Name => "Capture";
+
+    // the whole memory budget is committed here, never while processing
+    private void CreateBuffer()
+    {
+        mBuffer?.Dispose();
+        mBuffer = null;
+
+        try
+        {
+            mBuffer = new CaptureBuffer(Rack.Channels, Rack.SampleRate, mMinutes * 60.0);
+            Log.Info($"Capturing the last {mMinutes:0.#} minutes in {mBuffer.MemoryUsage / (1024 * 1024)} MiB");
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Failed to create capture buffer: {ex.Message}");
+        }
+    }
+
+    public override void DrawProperties()
+    {
+        const float moduleWidth = 150f;
+        ImGui.PushItemWidth(moduleWidth);
+
+        ImGui.InputFloat("Minutes", ref mMinutes);
+        if (ImGui.Button("Resize", Vector2.UnitX * moduleWidth))
+        {
+            mMinutes = Math.Max(mMinutes, 1f / 60f);
+            CreateBuffer();
+        }
+
+        ImGui.InputText("##path-input", ref mPath, 256);
+        ImGui.InputFloat("Seconds", ref mSaveSeconds);
+
+        bool saving = mBuffer?.Status == CaptureBuffer.SaveStatus.Saving;
+        ImGui.BeginDisabled(mBuffer is null || saving);
+
+        if (ImGui.Button("Save last seconds", Vector2.UnitX * moduleWidth))
+        {
+            mBuffer?.Save(mPath, mSaveSeconds);
+        }
+
+        ImGui.EndDisabled();
+
+        if (mBuffer is not null)
+        {
+            ImGui.Text($"{mBuffer.CapturedDuration:0} / {mBuffer.Duration:0} s, {mBuffer.MemoryUsage / (1024 * 1024)} MiB");
+
+            switch (mBuffer.Status)
+            {
+                case CaptureBuffer.SaveStatus.Saving:
+                    ImGui.Text("Saving...");
+                    break;
+                case CaptureBuffer.SaveStatus.Succeeded:
+                    ImGui.Text("Saved");
+                    break;
+                case CaptureBuffer.SaveStatus.Failed:
+                    ImGui.Text("Save failed!");
+                    break;
+            }
+        }
+
+        ImGui.PopItemWidth();
+    }
+
+    public override void Process(IReadOnlyList<ISignalInput?> inputs, IReadOnlyList<ISignalOutput?> outputs, int sampleRate, int samplesRequested, int channels)
+    {
+        var audio = inputs[0]?.Signal;
+        if (audio is null)
+        {
+            return;
+        }
+
+        outputs[0]?.PutSignal(audio);
+
+        // a bounce is not a take
+        if (IsRenderingOffline || mBuffer is null)
+        {
+            return;
+        }
+
+        mBuffer.Write(audio, 0, Math.Min(audio.Length, samplesRequested));
+    }
+
+    private float mMinutes;
+    private float mSaveSeconds;
+    private string mPath;
+
+    private CaptureBuffer? mBuffer;
+}
+
+[RegisteredPlugin("Capture")]
+public sealed class CapturePlugin : Plugin
+{
+    public override Module Instantiate() => new CaptureModule();
+}
@@ -41,7 +41,7 @@ internal sealed class ConstantOutputModule : Module
             return;
         }
 
-        var signal = new StereoSignal<double>(channels, samplesRequested);
+        var signal = StereoSignal<double>.Rent(channels, samplesRequested);
         for (int i = 0; i < channels; i++)
         {
             for (int j = 0; j < samplesRequested; j++)
@@ -57,5 +57,7 @@ internal sealed class ConstantOutputModule : Module
 [RegisteredPlugin("Constant output")]
 public sealed class ConstantOutputPlugin : Plugin
 {
+    public override bool CanWarmUp => true;
+
     public override Module Instantiate() => new ConstantOutputModule();
 }
@@ -78,7 +78,7 @@ internal sealed class EnvelopeModule : Module
 
     private static double Lerp(double a, double b, double t) => (1 - t) * a + t * b;
 
-    private void ProcessChannel(MonoSignal<double>? gateSignal, MonoSignal<double> cvSignal, ref EnvelopeStatus status, DateTime chunkStart, TimeSpan sampleSpan)
+    private void ProcessChannel(ReadOnlyMonoSignal<double>? gateSignal, MonoSignal<double> cvSignal, ref EnvelopeStatus status, DateTime chunkStart, TimeSpan sampleSpan)
     {
         bool isNoteActive = false;
         bool phaseChanged = true;
@@ -161,7 +161,7 @@ internal sealed class EnvelopeModule : Module
         }
 
         var gateSignal = gateInput?.Signal;
-        var cvSignal = new StereoSignal<double>(channels, samplesRequested);
+        var cvSignal = StereoSignal<double>.Rent(channels, samplesRequested);
 
         for (int i = 0; i < channels; i++)
         {
@@ -201,5 +201,7 @@ internal sealed class EnvelopeModule : Module
 [RegisteredPlugin("Envelope")]
 public sealed class EnvelopePlugin : Plugin
 {
+    public override bool CanWarmUp => true;
+
     public override Module Instantiate() => new EnvelopeModule();
 }
@@ -91,7 +91,7 @@ internal sealed class InputModule : Module
         StereoSignal<double> result;
         if (received.Length < samplesRequested)
         {
-            result = new StereoSignal<double>(channels, samplesRequested);
+            result = StereoSignal<double>.Rent(channels, samplesRequested);
 
             int offset = samplesRequested - received.Length;
             for (int i = 0; i < received.Length; i++)
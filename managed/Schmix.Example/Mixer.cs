@@ -50,7 +50,7 @@ internal sealed class MixerModule : Module
             return;
         }
 
-        var outputSignal = new StereoSignal<double>(channels, samplesRequested);
+        var outputSignal = StereoSignal<double>.Rent(channels, samplesRequested);
         for (int i = 0; i < mGains.Length; i++)
         {
             var input = inputs[i];
@@ -62,7 +62,7 @@ internal sealed class MixerModule : Module
             }
 
             double gain = mGains[i];
-            outputSignal += inputSignal * gain;
+            outputSignal.MultiplyAdd(inputSignal, gain);
         }
 
         output.PutSignal(outputSignal);
@@ -74,5 +74,7 @@ internal sealed class MixerModule : Module
 [RegisteredPlugin("Mixer")]
 public sealed class MixerPlugin : Plugin
 {
+    public override bool CanWarmUp => true;
+
     public override Module Instantiate() => new MixerModule();
 }
@@ -66,7 +66,8 @@ internal sealed class OscillatorModule : Module
         {
             // using cv as volt per octave
             // octave ratio is 2:1
-            frequencyCoefficients = cvSignal.Exp(2);
+            frequencyCoefficients = StereoSignal<double>.Rent(cvSignal.Channels, cvSignal.Length);
+            cvSignal.Exp(2, frequencyCoefficients);
         }
 
         for (int i = 0; i < outputs.Count; i++)
@@ -86,7 +87,7 @@ internal sealed class OscillatorModule : Module
                 mPhases[i] = wavePhases;
             }
 
-            var signal = new StereoSignal<double>(channels, samplesRequested);
+            var signal = StereoSignal<double>.Rent(channels, samplesRequested);
             for (int j = 0; j < channels; j++)
             {
                 double phase = wavePhases[j];
@@ -122,5 +123,7 @@ internal sealed class OscillatorModule : Module
 [RegisteredPlugin("Oscillator")]
 public sealed class OscillatorPlugin : Plugin
 {
+    public override bool CanWarmUp => true;
+
     public override Module Instantiate() => new OscillatorModule();
 }
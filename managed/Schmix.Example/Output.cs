@@ -31,7 +31,8 @@ internal sealed class OutputModule : Module
     {
         get
         {
-            if (mOutput is null)
+            // offline renders set their own pace
+            if (mOutput is null || IsRenderingOffline)
             {
                 return 0;
             }
@@ -75,8 +76,33 @@ internal sealed class OutputModule : Module
         var audioInput = inputs[0];
         var audio = audioInput?.Signal;
 
-        mDisplayedSignal = audio?.Copy();
-        if (audio is not null && !mOutput.PutAudio(audio))
+        // input signals only live for this cycle; keep our own copy for display
+        if (audio is null)
+        {
+            mDisplayedSignal?.Clear();
+        }
+        else
+        {
+            if (mDisplayedSignal is null || mDisplayedSignal.Channels != audio.Channels || mDisplayedSignal.Length != audio.Length)
+            {
+                mDisplayedSignal = new StereoSignal<double>(audio.Channels, audio.Length);
+            }
+
+            audio.CopyTo(mDisplayedSignal);
+        }
+
+        if (audio is null)
+        {
+            return;
+        }
+
+        if (IsRenderingOffline)
+        {
+            Rack.PutOfflineAudio(audio);
+            return;
+        }
+
+        if (!mOutput.PutAudio(audio))
         {
             throw new InvalidOperationException("Failed to send audio to output device!");
         }
@@ -0,0 +1,140 @@
+namespace Schmix.Example;
+
+using ImGuiNET;
+
+using Schmix.Audio;
+using Schmix.Core;
+using Schmix.Extension;
+using Schmix.UI;
+
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+
+internal sealed class RecorderModule : Module
+{
+    public RecorderModule()
+    {
+        mPath = "recording.wav";
+        mRecorder = null;
+    }
+
+    protected override void Cleanup(bool disposed)
+    {
+        StopRecording();
+    }
+
+    public override int InputCount => 1;
+    public override int OutputCount => 1;
+
+    public override string GetInputName(int index) => index > 0 ? "<unused>" : "Audio";
+    public override string GetOutputName(int index) => index > 0 ? "<unused>" : "Thru";
+
+    public override string Name => "Recorder";
+
+    private void StartRecording()
+    {
+        StopRecording();
+
+        try
+        {
+            mRecorder = new Recorder(mPath, Rack.Channels, Rack.SampleRate);
+            Log.Info($"Recording to {mPath}");
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Failed to start recording: {ex.Message}");
+        }
+    }
+
+    private void StopRecording()
+    {
+        if (mRecorder is null)
+        {
+            return;
+        }
+
+        try
+        {
+            mRecorder.Stop();
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Failed to finish recording: {ex.Message}");
+        }
+
+        mRecorder.Dispose();
+        mRecorder = null;
+    }
+
+    public override void DrawProperties()
+    {
+        const float moduleWidth = 150f;
+        ImGui.PushItemWidth(moduleWidth);
+
+        bool recording = mRecorder is not null;
+        ImGui.BeginDisabled(recording);
+        ImGui.InputText("##path-input", ref mPath, 256);
+        ImGui.EndDisabled();
+
+        if (ImGui.Button(recording ? "Stop" : "Record", Vector2.UnitX * moduleWidth))
+        {
+            if (recording)
+            {
+                StopRecording();
+            }
+            else
+            {
+                StartRecording();
+            }
+        }
+
+        if (mRecorder is not null)
+        {
+            double seconds = (double)mRecorder.RecordedSamples / Rack.SampleRate;
+            ImGui.Text($"{seconds:0.0} s recorded");
+
+            long dropped = mRecorder.DroppedSamples;
+            if (dropped > 0)
+            {
+                ImGui.Text($"{dropped} samples dropped ({mRecorder.Overflows} overflows)");
+            }
+
+            if (mRecorder.Failed)
+            {
+                ImGui.Text("Recording failed!");
+            }
+        }
+
+        ImGui.PopItemWidth();
+    }
+
+    public override void Process(IReadOnlyList<ISignalInput?> inputs, IReadOnlyList<ISignalOutput?> outputs, int sampleRate, int samplesRequested, int channels)
+    {
+        var audio = inputs[0]?.Signal;
+        if (audio is not null)
+        {
+            outputs[0]?.PutSignal(audio);
+        }
+
+        if (mRecorder is null || samplesRequested == 0)
+        {
+            return;
+        }
+
+        // keep the timeline intact while nothing is plugged in; rented signals start out silent
+        audio ??= StereoSignal<double>.Rent(channels, samplesRequested);
+
+        // a bounce outruns the writer, so it waits rather than dropping blocks
+        mRecorder.Write(audio, 0, Math.Min(audio.Length, samplesRequested), IsRenderingOffline);
+    }
+
+    private string mPath;
+    private Recorder? mRecorder;
+}
+
+[RegisteredPlugin("Recorder")]
+public sealed class RecorderPlugin : Plugin
+{
+    public override Module Instantiate() => new RecorderModule();
+}
@@ -125,9 +125,9 @@ internal sealed class SingleNoteMIDIModule : Module
         var chunkStart = DateTime.Now;
         var sampleSpan = TimeSpan.FromSeconds(1.0 / (double)sampleRate);
 
-        var pulseSignal = new StereoSignal<double>(channels, samplesRequested);
-        var gateSignal = new StereoSignal<double>(channels, samplesRequested);
-        var cvSignal = new StereoSignal<double>(channels, samplesRequested);
+        var pulseSignal = StereoSignal<double>.Rent(channels, samplesRequested);
+        var gateSignal = StereoSignal<double>.Rent(channels, samplesRequested);
+        var cvSignal = StereoSignal<double>.Rent(channels, samplesRequested);
 
         for (int i = 0; i < samplesRequested; i++)
         {
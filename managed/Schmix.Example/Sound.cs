@@ -5,14 +5,12 @@ using ImGuiNET;
 using Schmix.Audio;
 using Schmix.Core;
 using Schmix.Extension;
+using Schmix.UI;
 
 using System;
 using System.Collections.Generic;
 using System.Diagnostics.CodeAnalysis;
-using System.IO;
-using System.Linq;
 using System.Numerics;
-using System.Runtime.InteropServices;
 
 internal sealed class SoundModule : Module
 {
@@ -22,9 +20,16 @@ internal sealed class SoundModule : Module
         mSelectedPath = string.Empty;
 
         mPulseActive = false;
+        mStream = null;
+
         ResetSound();
     }
 
+    protected override void Cleanup(bool disposed)
+    {
+        CloseStream();
+    }
+
     public override int InputCount => 1;
     public override int OutputCount => 1;
 
@@ -33,59 +38,75 @@ internal sealed class SoundModule : Module
 
     public override string Name => "Sound";
 
-    public static double[] LoadSound(string path, int channels, int sampleRate)
-    {
-        const EncodingStream.StreamAction action = EncodingStream.StreamAction.Decoding;
-        const EncodingStream.SampleFormat format = EncodingStream.SampleFormat.Double;
-
-        var codecID = EncodingStream.GuessCodec(path);
-        using var encodingStream = new EncodingStream(codecID, action, channels, sampleRate, format);
-
-        using var fileStream = new FileStream(path, FileMode.Open, FileAccess.Read);
-        using var pcmStream = new MemoryStream();
-
-        fileStream.CopyTo(encodingStream);
-        encodingStream.CopyTo(pcmStream);
-
-        var data = pcmStream.GetBuffer();
-        var samples = MemoryMarshal.Cast<byte, double>(data);
-
-        return samples.ToArray();
-    }
-
     [MemberNotNull(nameof(mPath))]
-    [MemberNotNull(nameof(mData))]
-    [MemberNotNull(nameof(mCursor))]
     public void ResetSound()
     {
         Log.Debug("Resetting loaded sound");
 
         mPath = string.Empty;
+        CloseStream();
+    }
 
-        mData = Array.Empty<double>();
-        mCursor = 0;
+    private void CloseStream()
+    {
+        mStream?.Dispose();
+        mStream = null;
     }
 
-    private void LoadSoundFromSelectedPath()
+    // cheap; the file is decoded in the background
+    // opened for whatever format the rack runs at right now
+    private bool OpenStream(string path)
     {
-        Log.Debug($"Loading sound {mSelectedPath} for {mChannels} channels sampled at {mSampleRate} Hz");
+        CloseStream();
+
+        mChannels = Rack.Channels;
+        mSampleRate = Rack.SampleRate;
+
+        Log.Debug($"Streaming sound {path} for {mChannels} channels sampled at {mSampleRate} Hz");
 
         try
         {
-            mData = LoadSound(mSelectedPath, mChannels, mSampleRate);
-            mCursor = mData.Length;
-
-            mPath = mSelectedPath;
+            mStream = new SampleStream(path, mChannels, mSampleRate);
         }
         catch (Exception ex)
         {
-            Log.Error($"Failed to load sound {mSelectedPath}: {ex}");
+            Log.Error($"Failed to open sound {path}: {ex.Message}");
+            return false;
+        }
+
+        return true;
+    }
+
+    private void LoadSoundFromSelectedPath()
+    {
+        if (!OpenStream(mSelectedPath))
+        {
             mSelectedPath = mPath;
+            return;
+        }
+
+        mPath = mSelectedPath;
+    }
+
+    // the stream is reopened here rather than in Process, so that a format change never opens
+    // files or starts decoders in the middle of a rack cycle
+    private void SyncStreamFormat()
+    {
+        if (mPath.Length == 0 || (mChannels == Rack.Channels && mSampleRate == Rack.SampleRate))
+        {
+            return;
+        }
+
+        if (!OpenStream(mPath))
+        {
+            ResetSound();
         }
     }
 
     public override void DrawProperties()
     {
+        SyncStreamFormat();
+
         const float moduleWidth = 100f;
         ImGui.PushItemWidth(moduleWidth);
 
@@ -104,7 +125,7 @@ internal sealed class SoundModule : Module
         }
 
         ImGui.SameLine(buttonWidth + spacing);
-        ImGui.BeginDisabled(mData.Length > 0);
+        ImGui.BeginDisabled(mPath.Length == 0);
 
         if (ImGui.Button("Reset", Vector2.UnitX * buttonWidth))
         {
@@ -113,105 +134,94 @@ internal sealed class SoundModule : Module
 
         ImGui.EndDisabled();
 
-        if (mData.Length > 0)
+        if (mStream is not null)
         {
-            var floatData = mData.Select(sample => (float)sample).ToArray();
-            for (int i = 0; i < mChannels; i++)
+            var state = mStream.State;
+            if (state == SampleStream.StreamState.Ready && mStream.IsPlaying)
+            {
+                ImGui.Text("Playing");
+            }
+            else
             {
-                ImGui.PlotLines($"##channel-{i}", ref floatData[0], floatData.Length / mChannels, 0,
-                        string.Empty, -1f, 1f, Vector2.UnitY * 80f,
-                        sizeof(float) * mChannels);
+                ImGui.Text(state.ToString());
+            }
+
+            int underruns = mStream.Underruns;
+            if (underruns > 0)
+            {
+                ImGui.Text($"{underruns} underruns");
             }
         }
 
         ImGui.PopItemWidth();
     }
 
-    private void ReloadSound()
-    {
-        Log.Debug($"Reloading sound {mPath} for {mChannels} channels sampled at {mSampleRate} Hz");
-
-        try
-        {
-            mData = LoadSound(mPath, mChannels, mSampleRate);
-            mCursor = mData.Length;
-        }
-        catch (Exception ex)
-        {
-            Log.Error($"Failed to reload sound {mPath}: {ex}");
-            ResetSound();
-        }
-    }
-
     public bool PlaySound()
     {
-        if (mData.Length == 0)
+        if (mStream is null || mStream.State != SampleStream.StreamState.Ready)
         {
             return false;
         }
 
         Log.Trace($"Playing sound {mPath}");
-        mCursor = 0;
+        mStream.Trigger();
 
         return true;
     }
 
-    private void ProcessPulse(double pulse)
+    // returns true on a rising edge
+    private bool ProcessPulse(double pulse)
     {
         bool wasPulseActive = mPulseActive;
         mPulseActive = pulse > 0.1;
 
-        // rising edge
-        if (mPulseActive && !wasPulseActive)
-        {
-            Log.Trace("Rising edge detected from pulse input");
-            PlaySound();
-        }
+        return mPulseActive && !wasPulseActive;
     }
 
     public override void Process(IReadOnlyList<ISignalInput?> inputs, IReadOnlyList<ISignalOutput?> outputs, int sampleRate, int samplesRequested, int channels)
     {
-        if (mChannels != channels || mSampleRate != sampleRate)
-        {
-            mChannels = channels;
-            mSampleRate = sampleRate;
+        // a stream opened for another format stays silent until the properties reopen it
+        var stream = mChannels == channels && mSampleRate == sampleRate ? mStream : null;
 
-            if (mPath.Length > 0)
-            {
-                ReloadSound();
-            }
+        // a bounce outruns the decoder, so it waits on it instead of rendering gaps
+        bool wait = IsRenderingOffline;
+        if (wait)
+        {
+            stream?.WaitUntilLoaded();
         }
 
         // we only care about one channel really
         var pulseSignal = inputs[0]?.Signal?[0];
 
-        var audioSignal = new StereoSignal<double>(channels, samplesRequested);
+        var audioSignal = StereoSignal<double>.Rent(channels, samplesRequested);
+        int blockStart = 0;
+
         for (int i = 0; i < samplesRequested; i++)
         {
             double pulse = pulseSignal?[i] ?? 0;
-            ProcessPulse(pulse);
-
-            for (int j = 0; j < channels; j++)
+            if (!ProcessPulse(pulse))
             {
-                double sample = 0;
-                if (mCursor < mData.Length)
-                {
-                    sample = mData[mCursor++];
-                }
-
-                audioSignal[j][i] = sample;
+                continue;
             }
+
+            Log.Trace("Rising edge detected from pulse input");
+
+            // play out whatever came before the edge, then restart
+            stream?.Read(audioSignal, blockStart, i - blockStart, wait);
+            PlaySound();
+
+            blockStart = i;
         }
 
+        stream?.Read(audioSignal, blockStart, samplesRequested - blockStart, wait);
         outputs[0]?.PutSignal(audioSignal);
     }
 
     private string mSelectedPath;
 
     private string mPath;
-    private double[] mData;
+    private SampleStream? mStream;
     private bool mPulseActive;
-    private int mCursor;
 
     private int mChannels, mSampleRate;
 }
@@ -0,0 +1,323 @@
+namespace Schmix.Example;
+
+using ImGuiNET;
+
+using Schmix.Audio;
+using Schmix.Core;
+using Schmix.Encoding;
+using Schmix.Extension;
+using Schmix.UI;
+
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+using System.Threading;
+using System.Threading.Tasks;
+
+// plays every stem of a multitrack file in sync, one output per stem
+// the file is demuxed once and decoded into memory in the background
+internal sealed class StemsModule : Module
+{
+    private const int MaxStems = 4;
+
+    // samples per channel in each decoded block
+    private const int BlockLength = 65536;
+
+    private sealed class StemSet
+    {
+        public StemSet(int count)
+        {
+            Blocks = new List<StereoSignal<double>>[count];
+            for (int i = 0; i < count; i++)
+            {
+                Blocks[i] = new List<StereoSignal<double>>();
+            }
+
+            Length = 0;
+        }
+
+        // per stem, every block but the last one full
+        public readonly List<StereoSignal<double>>[] Blocks;
+        public long Length;
+    }
+
+    public StemsModule()
+    {
+        mChannels = mSampleRate = 0;
+        mSelectedPath = string.Empty;
+        mPath = string.Empty;
+
+        mPulseActive = false;
+        mPlaying = false;
+        mCursor = 0;
+
+        mStems = null;
+        mLoading = null;
+        mLoadTask = null;
+        mFailed = false;
+
+        mSignals = new StereoSignal<double>?[MaxStems];
+    }
+
+    protected override void Cleanup(bool disposed)
+    {
+        CancelLoad();
+    }
+
+    public override int InputCount => 1;
+    public override int OutputCount => MaxStems;
+
+    public override string GetInputName(int index) => index > 0 ? "<unused>" : "Pulse";
+    public override string GetOutputName(int index) => index < MaxStems ? $"Stem {index + 1}" : "<unused>";
+
+    public override string Name => "Stems";
+
+    private void CancelLoad()
+    {
+        mLoading?.Cancel();
+        mLoading = null;
+        mLoadTask = null;
+    }
+
+    // decoded for whatever format the rack runs at right now
+    private void Load(string path)
+    {
+        CancelLoad();
+
+        mChannels = Rack.Channels;
+        mSampleRate = Rack.SampleRate;
+
+        mStems = null;
+        mFailed = false;
+
+        var loading = new CancellationTokenSource();
+        mLoading = loading;
+
+        int channels = mChannels, sampleRate = mSampleRate;
+        mLoadTask = Task.Run(() =>
+        {
+            var stems = Decode(path, channels, sampleRate, loading.Token);
+            if (loading.IsCancellationRequested)
+            {
+                return;
+            }
+
+            if (stems is null)
+            {
+                mFailed = true;
+                return;
+            }
+
+            Volatile.Write(ref mStems, stems);
+        });
+    }
+
+    private static StemSet? Decode(string path, int channels, int sampleRate, CancellationToken token)
+    {
+        try
+        {
+            StemDecoder decoder;
+            using (var io = NativeIO.OpenFile(path, IO.Mode.Input))
+            {
+                decoder = new StemDecoder(io, channels, sampleRate);
+            }
+
+            using (decoder)
+            {
+                int count = decoder.StemCount;
+                if (count > MaxStems)
+                {
+                    Log.Warn($"{path} has {count} stems; only the first {MaxStems} are played");
+                }
+
+                var stems = new StemSet(count);
+                var blocks = new StereoSignal<double>[count];
+
+                while (!token.IsCancellationRequested)
+                {
+                    for (int i = 0; i < count; i++)
+                    {
+                        blocks[i] = new StereoSignal<double>(channels, BlockLength);
+                        stems.Blocks[i].Add(blocks[i]);
+                    }
+
+                    int samplesRead = decoder.Read(blocks, 0, BlockLength);
+                    stems.Length += samplesRead;
+
+                    if (samplesRead < BlockLength)
+                    {
+                        break;
+                    }
+                }
+
+                Log.Info($"Loaded {count} stems of {(double)stems.Length / sampleRate:0.##} s from {path}");
+                return stems;
+            }
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Failed to load stems from {path}: {ex.Message}");
+            return null;
+        }
+    }
+
+    // the stems are reloaded here rather than in Process, so that a format change never starts
+    // decoding in the middle of a rack cycle
+    private void SyncFormat()
+    {
+        if (mPath.Length == 0 || (mChannels == Rack.Channels && mSampleRate == Rack.SampleRate))
+        {
+            return;
+        }
+
+        Load(mPath);
+    }
+
+    public override void DrawProperties()
+    {
+        SyncFormat();
+
+        const float moduleWidth = 100f;
+        ImGui.PushItemWidth(moduleWidth);
+
+        bool load = ImGui.InputText("##path-input", ref mSelectedPath, 256, ImGuiInputTextFlags.EnterReturnsTrue);
+        load |= ImGui.Button("Load", Vector2.UnitX * moduleWidth);
+
+        if (load && mSelectedPath.Length > 0)
+        {
+            mPath = mSelectedPath;
+            Load(mPath);
+        }
+
+        var stems = Volatile.Read(ref mStems);
+        if (mFailed)
+        {
+            ImGui.Text("Failed");
+        }
+        else if (mPath.Length > 0)
+        {
+            ImGui.Text(stems is null ? "Loading" : mPlaying ? "Playing" : $"{stems.Blocks.Length} stems");
+        }
+
+        ImGui.PopItemWidth();
+    }
+
+    // returns true on a rising edge
+    private bool ProcessPulse(double pulse)
+    {
+        bool wasPulseActive = mPulseActive;
+        mPulseActive = pulse > 0.1;
+
+        return mPulseActive && !wasPulseActive;
+    }
+
+    private void Play(StemSet? stems, Span<StereoSignal<double>?> outputs, int offset, int length)
+    {
+        if (stems is null || !mPlaying)
+        {
+            return;
+        }
+
+        int end = offset + length;
+        while (offset < end && mCursor < stems.Length)
+        {
+            int block = (int)(mCursor / BlockLength);
+            int blockOffset = (int)(mCursor % BlockLength);
+            int count = (int)Math.Min(Math.Min(end - offset, BlockLength - blockOffset), stems.Length - mCursor);
+
+            for (int i = 0; i < outputs.Length; i++)
+            {
+                var output = outputs[i];
+                if (output is null)
+                {
+                    continue;
+                }
+
+                var source = stems.Blocks[i][block];
+                for (int j = 0; j < output.Channels; j++)
+                {
+                    source[j].AsSpan().Slice(blockOffset, count).CopyTo(output[j].AsSpan().Slice(offset, count));
+                }
+            }
+
+            mCursor += count;
+            offset += count;
+        }
+
+        mPlaying = mCursor < stems.Length;
+    }
+
+    public override void Process(IReadOnlyList<ISignalInput?> inputs, IReadOnlyList<ISignalOutput?> outputs, int sampleRate, int samplesRequested, int channels)
+    {
+        bool formatMatches = mChannels == channels && mSampleRate == sampleRate;
+
+        // a bounce would otherwise render a load that is still running as silence
+        if (formatMatches && IsRenderingOffline)
+        {
+            mLoadTask?.Wait();
+        }
+
+        // stems decoded for another format stay silent until the properties reload them
+        var stems = formatMatches ? Volatile.Read(ref mStems) : null;
+
+        int stemCount = Math.Min(stems?.Blocks.Length ?? 0, MaxStems);
+        var signals = mSignals.AsSpan(0, stemCount);
+
+        for (int i = 0; i < stemCount; i++)
+        {
+            signals[i] = outputs[i] is not null ? StereoSignal<double>.Rent(channels, samplesRequested) : null;
+        }
+
+        var pulseSignal = inputs[0]?.Signal?[0];
+        int blockStart = 0;
+
+        for (int i = 0; i < samplesRequested; i++)
+        {
+            if (!ProcessPulse(pulseSignal?[i] ?? 0))
+            {
+                continue;
+            }
+
+            // play out whatever came before the edge, then restart
+            Play(stems, signals, blockStart, i - blockStart);
+
+            mPlaying = stems is not null;
+            mCursor = 0;
+
+            blockStart = i;
+        }
+
+        Play(stems, signals, blockStart, samplesRequested - blockStart);
+
+        for (int i = 0; i < stemCount; i++)
+        {
+            var signal = signals[i];
+            if (signal is not null)
+            {
+                outputs[i]?.PutSignal(signal);
+            }
+        }
+    }
+
+    private string mSelectedPath;
+    private string mPath;
+
+    private StemSet? mStems;
+    private CancellationTokenSource? mLoading;
+    private Task? mLoadTask;
+    private volatile bool mFailed;
+
+    private bool mPulseActive, mPlaying;
+    private long mCursor;
+
+    // per output, reused every cycle
+    private readonly StereoSignal<double>?[] mSignals;
+
+    private int mChannels, mSampleRate;
+}
+
+[RegisteredPlugin("Stems")]
+public sealed class StemsPlugin : Plugin
+{
+    public override Module Instantiate() => new StemsModule();
+}
@@ -50,8 +50,6 @@ internal sealed class VCAModule : Module
         var signalInput = inputs[SignalInput];
 
         var cvSignal = cvInput?.Signal;
-        var gainSignal = cvSignal?.Exp(2); // cv is volt per amplitude
-
         var signal = signalInput?.Signal;
         var output = outputs[0];
 
@@ -60,7 +58,15 @@ internal sealed class VCAModule : Module
             return;
         }
 
-        var result = new StereoSignal<double>(channels, samplesRequested);
+        StereoSignal<double>? gainSignal = null;
+        if (cvSignal is not null)
+        {
+            // cv is volt per amplitude
+            gainSignal = StereoSignal<double>.Rent(cvSignal.Channels, cvSignal.Length);
+            cvSignal.Exp(2, gainSignal);
+        }
+
+        var result = StereoSignal<double>.Rent(channels, samplesRequested);
         for (int i = 0; i < channels; i++)
         {
             for (int j = 0; j < samplesRequested; j++)
@@ -87,5 +93,7 @@ internal sealed class VCAModule : Module
 [RegisteredPlugin("VCA")]
 public sealed class VCAPlugin : Plugin
 {
+    public override bool CanWarmUp => true;
+
     public override Module Instantiate() => new VCAModule();
 }
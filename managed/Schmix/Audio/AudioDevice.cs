@@ -64,6 +64,7 @@ public sealed class AudioDevice : RefCounted
     {
     }
 
+    // the returned signal is rented; see StereoSignal<T>.Rent
     public StereoSignal<double>? GetAudio(int samplesRequested)
     {
         int channels = Channels;
@@ -80,14 +81,16 @@ public sealed class AudioDevice : RefCounted
             return null;
         }
 
-        var data = interleaved.ToSpan().Slice(0, samplesReceived * channels);
-        return new StereoSignal<double>(channels, data);
+        var result = StereoSignal<double>.Rent(channels, samplesReceived);
+        result.Deinterleave(interleaved.ToSpan());
+
+        return result;
     }
 
-    public bool PutAudio(StereoSignal<double> signal)
+    public bool PutAudio(ReadOnlyStereoSignal<double> signal)
     {
-        double[] interleaved = signal.AsInterleaved();
-        using var nativeInterleaved = new NativeArray<double>(interleaved);
+        using var nativeInterleaved = new NativeArray<double>(signal.Length * signal.Channels);
+        signal.Interleave(nativeInterleaved.ToSpan());
 
         bool success;
         unsafe
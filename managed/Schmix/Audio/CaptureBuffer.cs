@@ -0,0 +1,90 @@
+namespace Schmix.Audio;
+
+using Coral.Managed.Interop;
+
+using Schmix.Core;
+
+using System;
+using System.IO;
+
+// always-on capture of the last stretch of a signal, kept natively as 16-bit samples
+// all memory is committed up front; saving encodes on a native background thread
+public sealed class CaptureBuffer : RefCounted
+{
+    public enum SaveStatus : int
+    {
+        Idle = 0,
+        Saving,
+        Succeeded,
+        Failed
+    }
+
+    internal static unsafe void* Create(int channels, int sampleRate, double seconds)
+    {
+        void* address = ctor_Impl(channels, sampleRate, seconds);
+        if (address is null)
+        {
+            throw new SystemException("Failed to create capture buffer!");
+        }
+
+        return address;
+    }
+
+    public unsafe CaptureBuffer(int channels, int sampleRate, double seconds) : base(Create(channels, sampleRate, seconds))
+    {
+        mChannels = channels;
+    }
+
+    // never allocates or waits
+    public unsafe void Write(ReadOnlyStereoSignal<double> source, int offset, int length)
+    {
+        if (source.Channels != mChannels)
+        {
+            throw new ArgumentException("Channel count mismatch!");
+        }
+
+        if (offset < 0 || length < 0 || offset + length > source.Length)
+        {
+            throw new ArgumentOutOfRangeException(nameof(length));
+        }
+
+        var channels = stackalloc double*[mChannels];
+        for (int i = 0; i < mChannels; i++)
+        {
+            channels[i] = source[i].Data + offset;
+        }
+
+        Write_Impl(mAddress, channels, length);
+    }
+
+    // starts encoding up to the last given number of seconds into a file; returns immediately
+    // false if a save is already running or nothing has been captured yet
+    public unsafe bool Save(string path, double seconds)
+    {
+        using NativeString nativePath = path;
+        return Save_Impl(mAddress, nativePath, seconds);
+    }
+
+    public unsafe SaveStatus Status => GetSaveState_Impl(mAddress);
+
+    // in seconds
+    public unsafe double CapturedDuration => GetCapturedDuration_Impl(mAddress);
+    public unsafe double Duration => GetDuration_Impl(mAddress);
+
+    // in bytes, fixed for the buffer's lifetime
+    public unsafe long MemoryUsage => GetMemoryUsage_Impl(mAddress);
+
+    public int Channels => mChannels;
+
+    private readonly int mChannels;
+
+    internal static unsafe delegate*<int, int, double, void*> ctor_Impl = null;
+
+    internal static unsafe delegate*<void*, double**, int, void> Write_Impl = null;
+    internal static unsafe delegate*<void*, NativeString, double, Bool32> Save_Impl = null;
+
+    internal static unsafe delegate*<void*, SaveStatus> GetSaveState_Impl = null;
+    internal static unsafe delegate*<void*, double> GetCapturedDuration_Impl = null;
+    internal static unsafe delegate*<void*, double> GetDuration_Impl = null;
+    internal static unsafe delegate*<void*, long> GetMemoryUsage_Impl = null;
+}
@@ -7,10 +7,14 @@ using System.IO;
 
 public sealed class EncodingStream : Stream
 {
+    // WAV and Raw are only ever guessed from file names; they are written natively, e.g. through
+    // TeeEncoder, and a stream cannot be created with them
     public enum Codec : int
     {
         MP3 = 0,
-        OGG
+        OGG,
+        WAV,
+        Raw
     }
 
     public enum StreamAction : int
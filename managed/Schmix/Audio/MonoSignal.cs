@@ -2,90 +2,146 @@ namespace Schmix.Audio;
 
 using System;
 using System.Numerics;
+using System.Runtime.CompilerServices;
 
-public sealed class MonoSignal<T> where T : unmanaged, INumber<T>
+public sealed unsafe class MonoSignal<T> where T : unmanaged, INumber<T>
 {
     public MonoSignal(int length)
     {
-        mData = new T[length];
-        Array.Clear(mData);
+        AllocateOwned(length);
+        AsSpan().Clear();
     }
 
     public MonoSignal(ReadOnlySpan<T> data)
     {
-        mData = new T[data.Length];
-        data.CopyTo(mData);
+        AllocateOwned(data.Length);
+        data.CopyTo(AsSpan());
     }
 
-    public T this[int index]
+    // pooled storage; owned by SignalPool<T>
+    internal MonoSignal(T* data, int length)
     {
-        get => mData[index];
-        set => mData[index] = value;
+        mArray = null;
+        mData = data;
+        mLength = length;
     }
 
-    public int Length => mData.Length;
-
-    internal T[] Data => mData;
+    // view over memory owned by someone else; the owner is kept reachable for as long as the view
+    internal MonoSignal(T* data, int length, object owner)
+    {
+        mArray = null;
+        mData = data;
+        mLength = length;
+        mOwner = owner;
+    }
 
-    public static MonoSignal<T> operator +(MonoSignal<T> lhs, MonoSignal<T> rhs)
+    private MonoSignal()
     {
-        if (lhs.Length != rhs.Length)
-        {
-            throw new ArgumentException("Signal length mismatch!");
-        }
+        mArray = null;
+        mData = null;
+        mLength = 0;
+    }
 
-        int length = lhs.Length;
-        var result = new MonoSignal<T>(length);
+    // storage is returned to the pool at the end of the current rack cycle
+    public static MonoSignal<T> Rent(int length) => SignalPool<T>.RentMono(length);
 
-        for (int i = 0; i < length; i++)
-        {
-            result[i] = lhs[i] + rhs[i];
-        }
+    // pooled storage is sized to a class, and the signal only shows as much of it as was asked for
+    internal void SetPooledLength(int length) => mLength = length;
+
+    private static MonoSignal<T> CreateUninitialized(int length)
+    {
+        var result = new MonoSignal<T>();
+        result.AllocateOwned(length);
 
         return result;
     }
 
-    public static MonoSignal<T> operator -(MonoSignal<T> signal)
+    private void AllocateOwned(int length)
     {
-        int length = signal.Length;
-        var result = new MonoSignal<T>(length);
+        // pinned so that owned and pooled signals can both be addressed through mData
+        mArray = GC.AllocateUninitializedArray<T>(length, true);
+        mData = length > 0 ? (T*)Unsafe.AsPointer(ref mArray[0]) : null;
+        mLength = length;
+    }
 
-        for (int i = 0; i < length; i++)
+    public T this[int index]
+    {
+        get
         {
-            result[i] = -signal[i];
+            if ((uint)index >= (uint)mLength)
+            {
+                throw new IndexOutOfRangeException();
+            }
+
+            return mData[index];
         }
+        set
+        {
+            if ((uint)index >= (uint)mLength)
+            {
+                throw new IndexOutOfRangeException();
+            }
 
-        return result;
+            mData[index] = value;
+        }
     }
 
-    public static MonoSignal<T> operator -(MonoSignal<T> lhs, MonoSignal<T> rhs)
+    public int Length => mLength;
+
+    public Span<T> AsSpan() => new Span<T>(mData, mLength);
+
+    // created once and kept, so that handing out views never allocates on the audio path
+    public ReadOnlyMonoSignal<T> AsReadOnly() => mReadOnly ??= new ReadOnlyMonoSignal<T>(this);
+
+    internal T* Data => mData;
+
+    public void Clear() => AsSpan().Clear();
+
+    public void CopyTo(MonoSignal<T> destination)
     {
-        if (lhs.Length != rhs.Length)
+        if (destination.mLength != mLength)
         {
             throw new ArgumentException("Signal length mismatch!");
         }
 
-        int length = lhs.Length;
-        var result = new MonoSignal<T>(length);
+        AsSpan().CopyTo(destination.AsSpan());
+    }
 
-        for (int i = 0; i < length; i++)
-        {
-            result[i] = lhs[i] - rhs[i];
-        }
+    public void AddInPlace(ReadOnlyMonoSignal<T> other) => SignalMath<T>.Add(AsSpan(), other.AsSpan(), AsSpan());
+    public void ScaleInPlace(double scalar) => SignalMath<T>.Scale(AsSpan(), scalar, AsSpan());
+
+    // this += other * scalar
+    public void MultiplyAdd(ReadOnlyMonoSignal<T> other, double scalar) => SignalMath<T>.MultiplyAdd(other.AsSpan(), scalar, AsSpan());
+
+    // operators allocate owned results; use the in-place variants on the audio path
+    public static MonoSignal<T> operator +(MonoSignal<T> lhs, MonoSignal<T> rhs)
+    {
+        var result = CreateUninitialized(lhs.Length);
+        SignalMath<T>.Add(lhs.AsSpan(), rhs.AsSpan(), result.AsSpan());
 
         return result;
     }
 
-    public static MonoSignal<T> operator *(MonoSignal<T> signal, double scalar)
+    public static MonoSignal<T> operator -(MonoSignal<T> signal)
     {
-        int length = signal.Length;
-        var result = new MonoSignal<T>(length);
+        var result = CreateUninitialized(signal.Length);
+        SignalMath<T>.Negate(signal.AsSpan(), result.AsSpan());
 
-        for (int i = 0; i < length; i++)
-        {
-            double value = Convert.ToDouble(signal[i]) * scalar;
-            result[i] = (T)Convert.ChangeType(value, typeof(T));
-        }
+        return result;
+    }
+
+    public static MonoSignal<T> operator -(MonoSignal<T> lhs, MonoSignal<T> rhs)
+    {
+        var result = CreateUninitialized(lhs.Length);
+        SignalMath<T>.Subtract(lhs.AsSpan(), rhs.AsSpan(), result.AsSpan());
+
+        return result;
+    }
+
+    public static MonoSignal<T> operator *(MonoSignal<T> signal, double scalar)
+    {
+        var result = CreateUninitialized(signal.Length);
+        SignalMath<T>.Scale(signal.AsSpan(), scalar, result.AsSpan());
 
         return result;
     }
@@ -97,33 +153,30 @@ public sealed class MonoSignal<T> where T : unmanaged, INumber<T>
 
     public static MonoSignal<T> operator /(MonoSignal<T> signal, double scalar)
     {
-        int length = signal.Length;
-        var result = new MonoSignal<T>(length);
-
-        for (int i = 0; i < length; i++)
-        {
-            double value = Convert.ToDouble(signal[i]) / scalar;
-            result[i] = (T)Convert.ChangeType(value, typeof(T));
-        }
+        var result = CreateUninitialized(signal.Length);
+        SignalMath<T>.Scale(signal.AsSpan(), 1.0 / scalar, result.AsSpan());
 
         return result;
     }
 
     public MonoSignal<T> Exp(double expBase)
     {
-        int length = mData.Length;
-        var result = new MonoSignal<T>(length);
-
-        for (int i = 0; i < length; i++)
-        {
-            double exponent = Convert.ToDouble(mData[i]);
-            double sample = Math.Pow(expBase, exponent);
-
-            result[i] = (T)Convert.ChangeType(sample, typeof(T));
-        }
+        var result = CreateUninitialized(mLength);
+        SignalMath<T>.Exp(AsSpan(), expBase, result.AsSpan());
 
         return result;
     }
 
-    private T[] mData;
+    public void Exp(double expBase, MonoSignal<T> destination) => SignalMath<T>.Exp(AsSpan(), expBase, destination.AsSpan());
+
+    // keeps owned storage alive; null for pooled signals
+    private T[]? mArray;
+
+    // keeps the source of a view alive
+    private readonly object? mOwner;
+
+    private ReadOnlyMonoSignal<T>? mReadOnly;
+
+    private T* mData;
+    private int mLength;
 }
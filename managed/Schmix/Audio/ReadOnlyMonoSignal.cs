@@ -0,0 +1,33 @@
+namespace Schmix.Audio;
+
+using System;
+using System.Diagnostics.CodeAnalysis;
+using System.Numerics;
+
+// a view of a signal that can only be read; modules get their inputs this way
+// nothing is copied, so the view is only valid for as long as the signal behind it
+public sealed unsafe class ReadOnlyMonoSignal<T> where T : unmanaged, INumber<T>
+{
+    internal ReadOnlyMonoSignal(MonoSignal<T> signal)
+    {
+        mSignal = signal;
+    }
+
+    [return: NotNullIfNotNull(nameof(signal))]
+    public static implicit operator ReadOnlyMonoSignal<T>?(MonoSignal<T>? signal) => signal?.AsReadOnly();
+
+    public T this[int index] => mSignal[index];
+
+    public int Length => mSignal.Length;
+
+    public ReadOnlySpan<T> AsSpan() => mSignal.AsSpan();
+
+    internal T* Data => mSignal.Data;
+
+    public void CopyTo(MonoSignal<T> destination) => mSignal.CopyTo(destination);
+
+    public MonoSignal<T> Exp(double expBase) => mSignal.Exp(expBase);
+    public void Exp(double expBase, MonoSignal<T> destination) => mSignal.Exp(expBase, destination);
+
+    private readonly MonoSignal<T> mSignal;
+}
@@ -0,0 +1,38 @@
+namespace Schmix.Audio;
+
+using System;
+using System.Diagnostics.CodeAnalysis;
+using System.Numerics;
+
+// see ReadOnlyMonoSignal<T>
+public sealed class ReadOnlyStereoSignal<T> where T : unmanaged, INumber<T>
+{
+    internal ReadOnlyStereoSignal(StereoSignal<T> signal)
+    {
+        mSignal = signal;
+    }
+
+    [return: NotNullIfNotNull(nameof(signal))]
+    public static implicit operator ReadOnlyStereoSignal<T>?(StereoSignal<T>? signal) => signal?.AsReadOnly();
+
+    public int Channels => mSignal.Channels;
+    public int Length => mSignal.Length;
+
+    public ReadOnlyMonoSignal<T> this[int channel] => mSignal[channel].AsReadOnly();
+
+    // the signal behind the view; only the rack's own plumbing may hand this on
+    internal StereoSignal<T> Source => mSignal;
+
+    public T[] AsInterleaved() => mSignal.AsInterleaved();
+    public void Interleave(Span<T> destination) => mSignal.Interleave(destination);
+
+    // an owned copy that outlives the cycle and can be written to
+    public StereoSignal<T> Copy() => mSignal.Copy();
+
+    public void CopyTo(StereoSignal<T> destination) => mSignal.CopyTo(destination);
+
+    public StereoSignal<T> Exp(double expBase) => mSignal.Exp(expBase);
+    public void Exp(double expBase, StereoSignal<T> destination) => mSignal.Exp(expBase, destination);
+
+    private readonly StereoSignal<T> mSignal;
+}
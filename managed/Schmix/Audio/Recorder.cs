@@ -0,0 +1,90 @@
+namespace Schmix.Audio;
+
+using Coral.Managed.Interop;
+
+using Schmix.Core;
+
+using System;
+using System.IO;
+
+// records signals into a file; encoding and disk writes happen on a native background thread
+// writes only copy into a pre-allocated ring, and blocks that don't fit are dropped and counted
+public sealed class Recorder : RefCounted
+{
+    internal static unsafe void* Open(string path, int channels, int sampleRate, int ringSamples)
+    {
+        void* address;
+        using (NativeString nativePath = path)
+        {
+            address = ctor_Impl(nativePath, channels, sampleRate, ringSamples);
+        }
+
+        if (address is null)
+        {
+            throw new IOException($"Failed to open recorder: {path}");
+        }
+
+        return address;
+    }
+
+    // a ring of 0 samples holds a few seconds
+    public unsafe Recorder(string path, int channels, int sampleRate, int ringSamples = 0) : base(Open(path, channels, sampleRate, ringSamples))
+    {
+        mChannels = channels;
+    }
+
+    // never allocates or waits; false if the block was dropped
+    // a waiting write blocks on the writer instead of dropping, for offline rendering
+    public unsafe bool Write(ReadOnlyStereoSignal<double> source, int offset, int length, bool wait = false)
+    {
+        if (source.Channels != mChannels)
+        {
+            throw new ArgumentException("Channel count mismatch!");
+        }
+
+        if (offset < 0 || length < 0 || offset + length > source.Length)
+        {
+            throw new ArgumentOutOfRangeException(nameof(length));
+        }
+
+        var channels = stackalloc double*[mChannels];
+        for (int i = 0; i < mChannels; i++)
+        {
+            channels[i] = source[i].Data + offset;
+        }
+
+        return Write_Impl(mAddress, channels, length, wait);
+    }
+
+    // waits for the writer to catch up, then finishes the file
+    public unsafe void Stop()
+    {
+        if (!Stop_Impl(mAddress))
+        {
+            throw new IOException("Failed to finish recording!");
+        }
+    }
+
+    public unsafe bool IsRecording => IsRecording_Impl(mAddress);
+    public unsafe bool Failed => HasFailed_Impl(mAddress);
+
+    public unsafe long RecordedSamples => GetRecordedFrames_Impl(mAddress);
+    public unsafe long Overflows => GetOverflows_Impl(mAddress);
+    public unsafe long DroppedSamples => GetDroppedFrames_Impl(mAddress);
+
+    public int Channels => mChannels;
+
+    private readonly int mChannels;
+
+    internal static unsafe delegate*<NativeString, int, int, int, void*> ctor_Impl = null;
+
+    internal static unsafe delegate*<void*, double**, int, Bool32, Bool32> Write_Impl = null;
+    internal static unsafe delegate*<void*, Bool32> Stop_Impl = null;
+
+    internal static unsafe delegate*<void*, Bool32> IsRecording_Impl = null;
+    internal static unsafe delegate*<void*, Bool32> HasFailed_Impl = null;
+
+    internal static unsafe delegate*<void*, long> GetRecordedFrames_Impl = null;
+    internal static unsafe delegate*<void*, long> GetOverflows_Impl = null;
+    internal static unsafe delegate*<void*, long> GetDroppedFrames_Impl = null;
+}
@@ -0,0 +1,95 @@
+namespace Schmix.Audio;
+
+using Coral.Managed.Interop;
+
+using Schmix.Core;
+
+using System;
+
+// streams a sound file from disk; decoding happens on a native background thread
+public sealed class SampleStream : RefCounted
+{
+    public enum StreamState : int
+    {
+        Loading = 0,
+        Ready,
+        Failed
+    }
+
+    internal static unsafe void* Open(string path, int channels, int sampleRate)
+    {
+        void* address;
+        using (NativeString nativePath = path)
+        {
+            address = ctor_Impl(nativePath, channels, sampleRate);
+        }
+
+        if (address is null)
+        {
+            throw new SystemException($"Failed to open sample stream: {path}");
+        }
+
+        return address;
+    }
+
+    public unsafe SampleStream(string path, int channels, int sampleRate) : base(Open(path, channels, sampleRate))
+    {
+        mChannels = channels;
+    }
+
+    // restarts playback from the beginning; ignored until the stream is ready
+    public unsafe void Trigger() => Trigger_Impl(mAddress);
+    public unsafe void Stop() => Stop_Impl(mAddress);
+
+    // blocks until the stream has loaded or failed
+    public unsafe StreamState WaitUntilLoaded() => WaitUntilLoaded_Impl(mAddress);
+
+    // fills the destination starting at the given offset, padding with silence
+    // returns the number of samples per channel that came from the file
+    // a waiting read blocks on the decoder instead of underrunning, for offline rendering
+    public unsafe int Read(StereoSignal<double> destination, int offset, int length, bool wait = false)
+    {
+        if (destination.Channels != mChannels)
+        {
+            throw new ArgumentException("Channel count mismatch!");
+        }
+
+        if (offset < 0 || length < 0 || offset + length > destination.Length)
+        {
+            throw new ArgumentOutOfRangeException(nameof(length));
+        }
+
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        // decoded straight into the destination's channels
+        var channels = stackalloc double*[mChannels];
+        for (int i = 0; i < mChannels; i++)
+        {
+            channels[i] = destination[i].Data + offset;
+        }
+
+        return Read_Impl(mAddress, channels, length, wait);
+    }
+
+    public unsafe StreamState State => GetState_Impl(mAddress);
+    public unsafe bool IsPlaying => IsPlaying_Impl(mAddress);
+    public unsafe int Underruns => GetUnderruns_Impl(mAddress);
+
+    public int Channels => mChannels;
+
+    private readonly int mChannels;
+
+    internal static unsafe delegate*<NativeString, int, int, void*> ctor_Impl = null;
+
+    internal static unsafe delegate*<void*, void> Trigger_Impl = null;
+    internal static unsafe delegate*<void*, void> Stop_Impl = null;
+    internal static unsafe delegate*<void*, double**, int, Bool32, int> Read_Impl = null;
+    internal static unsafe delegate*<void*, StreamState> WaitUntilLoaded_Impl = null;
+
+    internal static unsafe delegate*<void*, StreamState> GetState_Impl = null;
+    internal static unsafe delegate*<void*, Bool32> IsPlaying_Impl = null;
+    internal static unsafe delegate*<void*, int> GetUnderruns_Impl = null;
+}
@@ -1,11 +1,17 @@
 namespace Schmix.Audio;
 
+// signals only live for the rack cycle they are handed out in; their storage goes back to the
+// pool at the end of it, so anything kept across cycles has to be copied
+
 public interface ISignalInput
 {
-    public StereoSignal<double>? Signal { get; }
+    // shared with every other reader of the same output, hence read-only
+    public ReadOnlyStereoSignal<double>? Signal { get; }
 }
 
 public interface ISignalOutput
 {
-    public void PutSignal(StereoSignal<double> signal);
+    // the signal is borrowed rather than copied, so it must not be written to once it is put
+    // inputs can be passed straight through
+    public void PutSignal(ReadOnlyStereoSignal<double> signal);
 }
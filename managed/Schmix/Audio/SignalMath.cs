@@ -0,0 +1,203 @@
+namespace Schmix.Audio;
+
+using System;
+using System.Numerics;
+using System.Runtime.InteropServices;
+
+// span kernels shared by the signal types
+// element types Vector<T> supports take the simd path; anything else falls back to scalar loops
+internal static class SignalMath<T> where T : unmanaged, INumber<T>
+{
+    private static bool IsVectorized => Vector.IsHardwareAccelerated && Vector<T>.IsSupported;
+
+    // scalars are applied in T for these; integer samples go through double so they can be scaled
+    // by fractions
+    private static bool IsFloatingPoint => typeof(T) == typeof(float) || typeof(T) == typeof(double);
+
+    private static void VerifyLengths(int source, int destination)
+    {
+        if (source != destination)
+        {
+            throw new ArgumentException("Signal length mismatch!");
+        }
+    }
+
+    public static void Add(ReadOnlySpan<T> lhs, ReadOnlySpan<T> rhs, Span<T> destination)
+    {
+        VerifyLengths(lhs.Length, destination.Length);
+        VerifyLengths(rhs.Length, destination.Length);
+
+        int i = 0;
+        if (IsVectorized)
+        {
+            var lhsVectors = MemoryMarshal.Cast<T, Vector<T>>(lhs);
+            var rhsVectors = MemoryMarshal.Cast<T, Vector<T>>(rhs);
+            var destinationVectors = MemoryMarshal.Cast<T, Vector<T>>(destination);
+
+            for (int j = 0; j < destinationVectors.Length; j++)
+            {
+                destinationVectors[j] = lhsVectors[j] + rhsVectors[j];
+            }
+
+            i = destinationVectors.Length * Vector<T>.Count;
+        }
+
+        for (; i < destination.Length; i++)
+        {
+            destination[i] = lhs[i] + rhs[i];
+        }
+    }
+
+    public static void Subtract(ReadOnlySpan<T> lhs, ReadOnlySpan<T> rhs, Span<T> destination)
+    {
+        VerifyLengths(lhs.Length, destination.Length);
+        VerifyLengths(rhs.Length, destination.Length);
+
+        int i = 0;
+        if (IsVectorized)
+        {
+            var lhsVectors = MemoryMarshal.Cast<T, Vector<T>>(lhs);
+            var rhsVectors = MemoryMarshal.Cast<T, Vector<T>>(rhs);
+            var destinationVectors = MemoryMarshal.Cast<T, Vector<T>>(destination);
+
+            for (int j = 0; j < destinationVectors.Length; j++)
+            {
+                destinationVectors[j] = lhsVectors[j] - rhsVectors[j];
+            }
+
+            i = destinationVectors.Length * Vector<T>.Count;
+        }
+
+        for (; i < destination.Length; i++)
+        {
+            destination[i] = lhs[i] - rhs[i];
+        }
+    }
+
+    public static void Negate(ReadOnlySpan<T> source, Span<T> destination)
+    {
+        VerifyLengths(source.Length, destination.Length);
+
+        int i = 0;
+        if (IsVectorized)
+        {
+            var sourceVectors = MemoryMarshal.Cast<T, Vector<T>>(source);
+            var destinationVectors = MemoryMarshal.Cast<T, Vector<T>>(destination);
+
+            for (int j = 0; j < destinationVectors.Length; j++)
+            {
+                destinationVectors[j] = -sourceVectors[j];
+            }
+
+            i = destinationVectors.Length * Vector<T>.Count;
+        }
+
+        for (; i < destination.Length; i++)
+        {
+            destination[i] = -source[i];
+        }
+    }
+
+    public static void Scale(ReadOnlySpan<T> source, double scalar, Span<T> destination)
+    {
+        VerifyLengths(source.Length, destination.Length);
+
+        int i = 0;
+        if (IsFloatingPoint)
+        {
+            T factor = T.CreateTruncating(scalar);
+            if (IsVectorized)
+            {
+                var factorVector = new Vector<T>(factor);
+                var sourceVectors = MemoryMarshal.Cast<T, Vector<T>>(source);
+                var destinationVectors = MemoryMarshal.Cast<T, Vector<T>>(destination);
+
+                for (int j = 0; j < destinationVectors.Length; j++)
+                {
+                    destinationVectors[j] = sourceVectors[j] * factorVector;
+                }
+
+                i = destinationVectors.Length * Vector<T>.Count;
+            }
+
+            for (; i < destination.Length; i++)
+            {
+                destination[i] = source[i] * factor;
+            }
+
+            return;
+        }
+
+        for (; i < destination.Length; i++)
+        {
+            destination[i] = T.CreateSaturating(double.CreateTruncating(source[i]) * scalar);
+        }
+    }
+
+    // destination += source * scalar
+    public static void MultiplyAdd(ReadOnlySpan<T> source, double scalar, Span<T> destination)
+    {
+        VerifyLengths(source.Length, destination.Length);
+
+        int i = 0;
+        if (IsFloatingPoint)
+        {
+            T factor = T.CreateTruncating(scalar);
+            if (IsVectorized)
+            {
+                var factorVector = new Vector<T>(factor);
+                var sourceVectors = MemoryMarshal.Cast<T, Vector<T>>(source);
+                var destinationVectors = MemoryMarshal.Cast<T, Vector<T>>(destination);
+
+                for (int j = 0; j < destinationVectors.Length; j++)
+                {
+                    destinationVectors[j] += sourceVectors[j] * factorVector;
+                }
+
+                i = destinationVectors.Length * Vector<T>.Count;
+            }
+
+            for (; i < destination.Length; i++)
+            {
+                destination[i] += source[i] * factor;
+            }
+
+            return;
+        }
+
+        for (; i < destination.Length; i++)
+        {
+            double value = double.CreateTruncating(destination[i]) + double.CreateTruncating(source[i]) * scalar;
+            destination[i] = T.CreateSaturating(value);
+        }
+    }
+
+    // destination = base ^ source
+    public static void Exp(ReadOnlySpan<T> source, double expBase, Span<T> destination)
+    {
+        VerifyLengths(source.Length, destination.Length);
+
+        // b^x = e^(x ln b); one log up front instead of a pow per sample
+        double logBase = Math.Log(expBase);
+        if (typeof(T) == typeof(float))
+        {
+            float logBaseSingle = (float)logBase;
+
+            var sourceSingle = MemoryMarshal.Cast<T, float>(source);
+            var destinationSingle = MemoryMarshal.Cast<T, float>(destination);
+
+            for (int i = 0; i < destinationSingle.Length; i++)
+            {
+                destinationSingle[i] = MathF.Exp(sourceSingle[i] * logBaseSingle);
+            }
+
+            return;
+        }
+
+        for (int i = 0; i < destination.Length; i++)
+        {
+            double exponent = double.CreateTruncating(source[i]);
+            destination[i] = T.CreateSaturating(Math.Exp(exponent * logBase));
+        }
+    }
+}
@@ -0,0 +1,194 @@
+namespace Schmix.Audio;
+
+using Schmix.Core;
+
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+
+public static class SignalPool
+{
+    private static readonly List<Action> sReturnCallbacks = new List<Action>();
+    private static readonly List<Action> sFreeCallbacks = new List<Action>();
+
+    internal static void Register(Action returnAll, Action free)
+    {
+        sReturnCallbacks.Add(returnAll);
+        sFreeCallbacks.Add(free);
+    }
+
+    // every thread rents from storage of its own, and both of these only touch the calling thread's
+    // returns every signal rented since the last call
+    // called by the rack at the end of each processing cycle
+    public static void ReturnAll()
+    {
+        foreach (var callback in sReturnCallbacks)
+        {
+            callback();
+        }
+    }
+
+    // returns and frees all pooled storage
+    // threads that rent only briefly, e.g. to warm a module up, call this when they are done
+    public static void Free()
+    {
+        ReturnAll();
+        foreach (var callback in sFreeCallbacks)
+        {
+            callback();
+        }
+    }
+}
+
+// storage is bucketed by length rounded up to a power of two, so that odd or changing block sizes
+// share a handful of buckets instead of each keeping their own until shutdown
+internal static unsafe class SignalPool<T> where T : unmanaged, INumber<T>
+{
+    private sealed class Storage
+    {
+        public readonly Dictionary<int, Stack<MonoSignal<T>>> Mono = new Dictionary<int, Stack<MonoSignal<T>>>();
+        public readonly Dictionary<(int, int), Stack<StereoSignal<T>>> Stereo = new Dictionary<(int, int), Stack<StereoSignal<T>>>();
+
+        public readonly List<MonoSignal<T>> RentedMono = new List<MonoSignal<T>>();
+        public readonly List<StereoSignal<T>> RentedStereo = new List<StereoSignal<T>>();
+    }
+
+    // modules may be run off the main thread, so nothing is shared between threads
+    [ThreadStatic]
+    private static Storage? sStorage;
+
+    private static Storage Local => sStorage ??= new Storage();
+
+    static SignalPool()
+    {
+        SignalPool.Register(ReturnAll, Free);
+    }
+
+    private static int GetSizeClass(int length) => length > 0 ? (int)BitOperations.RoundUpToPowerOf2((uint)length) : 0;
+
+    private static MonoSignal<T> AllocateMono(int length)
+    {
+        var data = (T*)MemoryAllocator.Allocate(length * sizeof(T));
+        if (data is null && length > 0)
+        {
+            throw new OutOfMemoryException("Failed to allocate signal storage!");
+        }
+
+        return new MonoSignal<T>(data, length);
+    }
+
+    public static MonoSignal<T> RentMono(int length)
+    {
+        int sizeClass = GetSizeClass(length);
+        var storage = Local;
+        if (!storage.Mono.TryGetValue(sizeClass, out Stack<MonoSignal<T>>? available))
+        {
+            available = new Stack<MonoSignal<T>>();
+            storage.Mono.Add(sizeClass, available);
+        }
+
+        MonoSignal<T> signal;
+        if (!available.TryPop(out MonoSignal<T>? pooled))
+        {
+            signal = AllocateMono(sizeClass);
+        }
+        else
+        {
+            signal = pooled;
+        }
+
+        signal.SetPooledLength(length);
+        signal.Clear();
+        storage.RentedMono.Add(signal);
+
+        return signal;
+    }
+
+    public static StereoSignal<T> RentStereo(int channels, int length)
+    {
+        int sizeClass = GetSizeClass(length);
+
+        var storage = Local;
+        var key = (channels, sizeClass);
+        if (!storage.Stereo.TryGetValue(key, out Stack<StereoSignal<T>>? available))
+        {
+            available = new Stack<StereoSignal<T>>();
+            storage.Stereo.Add(key, available);
+        }
+
+        StereoSignal<T> signal;
+        if (!available.TryPop(out StereoSignal<T>? pooled))
+        {
+            // channels stay with the stereo signal for its whole lifetime
+            var channelSignals = new MonoSignal<T>[channels];
+            for (int i = 0; i < channels; i++)
+            {
+                channelSignals[i] = AllocateMono(sizeClass);
+            }
+
+            signal = new StereoSignal<T>(channelSignals, sizeClass);
+        }
+        else
+        {
+            signal = pooled;
+        }
+
+        signal.SetPooledLength(length);
+        signal.Clear();
+        storage.RentedStereo.Add(signal);
+
+        return signal;
+    }
+
+    private static void ReturnAll()
+    {
+        var storage = sStorage;
+        if (storage is null)
+        {
+            return;
+        }
+
+        foreach (var signal in storage.RentedMono)
+        {
+            storage.Mono[GetSizeClass(signal.Length)].Push(signal);
+        }
+
+        foreach (var signal in storage.RentedStereo)
+        {
+            storage.Stereo[(signal.Channels, GetSizeClass(signal.Length))].Push(signal);
+        }
+
+        storage.RentedMono.Clear();
+        storage.RentedStereo.Clear();
+    }
+
+    private static void Free()
+    {
+        var storage = sStorage;
+        if (storage is null)
+        {
+            return;
+        }
+
+        foreach (var available in storage.Mono.Values)
+        {
+            foreach (var signal in available)
+            {
+                MemoryAllocator.Free(signal.Data);
+            }
+        }
+
+        foreach (var available in storage.Stereo.Values)
+        {
+            foreach (var signal in available)
+            {
+                for (int i = 0; i < signal.Channels; i++)
+                {
+                    MemoryAllocator.Free(signal[i].Data);
+                }
+            }
+        }
+
+        sStorage = null;
+    }
+}
@@ -16,29 +16,15 @@ public sealed class StereoSignal<T> where T : unmanaged, INumber<T>
         }
     }
 
-    public StereoSignal(int channels, ReadOnlySpan<T> interleavedData)
+    public StereoSignal(int channels, ReadOnlySpan<T> interleavedData) : this(channels, interleavedData.Length / channels)
     {
-        int totalSamples = interleavedData.Length;
-        mLength = totalSamples / channels;
-
-        var sequentialData = new T[mLength * channels];
-        for (int i = 0; i < channels; i++)
-        {
-            for (int j = 0; j < mLength; j++)
-            {
-                int interleavedIndex = j * channels + i;
-                int sequentialIndex = i * mLength + j;
-
-                sequentialData[sequentialIndex] = interleavedData[interleavedIndex];
-            }
-        }
+        Deinterleave(interleavedData);
+    }
 
-        mChannels = new MonoSignal<T>[channels];
-        for (int i = 0; i < channels; i++)
-        {
-            var slice = sequentialData.AsSpan().Slice(mLength * i, mLength);
-            mChannels[i] = new MonoSignal<T>(slice);
-        }
+    internal StereoSignal(MonoSignal<T>[] channels, int length)
+    {
+        mLength = length;
+        mChannels = channels;
     }
 
     private StereoSignal()
@@ -47,28 +33,66 @@ public sealed class StereoSignal<T> where T : unmanaged, INumber<T>
         mChannels = Array.Empty<MonoSignal<T>>();
     }
 
+    // storage is returned to the pool at the end of the current rack cycle
+    public static StereoSignal<T> Rent(int channels, int length) => SignalPool<T>.RentStereo(channels, length);
+
+    internal void SetPooledLength(int length)
+    {
+        mLength = length;
+        foreach (var channel in mChannels)
+        {
+            channel.SetPooledLength(length);
+        }
+    }
+
     public int Channels => mChannels.Length;
     public int Length => mLength;
 
     public MonoSignal<T> this[int channel] => mChannels[channel];
 
+    // created once and kept, so that handing out views never allocates on the audio path
+    public ReadOnlyStereoSignal<T> AsReadOnly() => mReadOnly ??= new ReadOnlyStereoSignal<T>(this);
+
     public T[] AsInterleaved()
     {
         var interleaved = new T[mLength * mChannels.Length];
+        Interleave(interleaved);
+
+        return interleaved;
+    }
+
+    public void Deinterleave(ReadOnlySpan<T> source)
+    {
+        if (source.Length < mLength * mChannels.Length)
+        {
+            throw new ArgumentException("Source too small!");
+        }
 
-        for (int i = 0; i < mLength; i++)
+        for (int j = 0; j < mChannels.Length; j++)
         {
-            int offset = i * mChannels.Length;
-            for (int j = 0; j < mChannels.Length; j++)
+            var mono = mChannels[j].AsSpan();
+            for (int i = 0; i < mLength; i++)
             {
-                var mono = mChannels[j];
-                var interleavedIndex = offset + j;
-
-                interleaved[interleavedIndex] = mono[i];
+                mono[i] = source[i * mChannels.Length + j];
             }
         }
+    }
 
-        return interleaved;
+    public void Interleave(Span<T> destination)
+    {
+        if (destination.Length < mLength * mChannels.Length)
+        {
+            throw new ArgumentException("Destination too small!");
+        }
+
+        for (int j = 0; j < mChannels.Length; j++)
+        {
+            var mono = mChannels[j].AsSpan();
+            for (int i = 0; i < mLength; i++)
+            {
+                destination[i * mChannels.Length + j] = mono[i];
+            }
+        }
     }
 
     public StereoSignal<T> Copy()
@@ -79,100 +103,161 @@ public sealed class StereoSignal<T> where T : unmanaged, INumber<T>
         result.mChannels = new MonoSignal<T>[mChannels.Length];
         for (int i = 0; i < mChannels.Length; i++)
         {
-            result.mChannels[i] = new MonoSignal<T>(mChannels[i].Data);
+            result.mChannels[i] = new MonoSignal<T>(mChannels[i].AsSpan());
         }
 
         return result;
     }
 
-    public static StereoSignal<T> operator +(StereoSignal<T> lhs, StereoSignal<T> rhs)
+    private void VerifyShape(StereoSignal<T> other) => VerifyShape(other.Channels, other.Length);
+    private void VerifyShape(ReadOnlyStereoSignal<T> other) => VerifyShape(other.Channels, other.Length);
+
+    private void VerifyShape(int channels, int length)
     {
-        if (lhs.mChannels.Length != rhs.mChannels.Length)
+        if (channels != mChannels.Length)
         {
             throw new ArgumentException("Differing channel count!");
         }
 
-        int channels = lhs.mChannels.Length;
-        var result = new StereoSignal<T>(channels, lhs.mLength);
+        if (length != mLength)
+        {
+            throw new ArgumentException("Signal length mismatch!");
+        }
+    }
 
-        for (int i = 0; i < channels; i++)
+    public void Clear()
+    {
+        foreach (var channel in mChannels)
         {
-            result.mChannels[i] = lhs[i] + rhs[i];
+            channel.Clear();
         }
+    }
 
-        return result;
+    public void CopyTo(StereoSignal<T> destination)
+    {
+        VerifyShape(destination);
+        for (int i = 0; i < mChannels.Length; i++)
+        {
+            mChannels[i].CopyTo(destination.mChannels[i]);
+        }
     }
 
-    public static StereoSignal<T> operator -(StereoSignal<T> signal)
+    public void AddInPlace(ReadOnlyStereoSignal<T> other)
     {
-        int channels = signal.mChannels.Length;
-        var result = new StereoSignal<T>(channels, signal.mLength);
+        VerifyShape(other);
+        for (int i = 0; i < mChannels.Length; i++)
+        {
+            mChannels[i].AddInPlace(other[i]);
+        }
+    }
 
-        for (int i = 0; i < channels; i++)
+    public void ScaleInPlace(double scalar)
+    {
+        foreach (var channel in mChannels)
         {
-            result.mChannels[i] = -signal[i];
+            channel.ScaleInPlace(scalar);
         }
+    }
 
-        return result;
+    // this += other * scalar
+    public void MultiplyAdd(ReadOnlyStereoSignal<T> other, double scalar)
+    {
+        VerifyShape(other);
+        for (int i = 0; i < mChannels.Length; i++)
+        {
+            mChannels[i].MultiplyAdd(other[i], scalar);
+        }
     }
 
-    public static StereoSignal<T> operator -(StereoSignal<T> lhs, StereoSignal<T> rhs)
+    private static void VerifyChannels(StereoSignal<T> lhs, StereoSignal<T> rhs)
     {
         if (lhs.mChannels.Length != rhs.mChannels.Length)
         {
             throw new ArgumentException("Differing channel count!");
         }
+    }
 
-        int channels = lhs.mChannels.Length;
-        var result = new StereoSignal<T>(channels, lhs.mLength);
+    public static StereoSignal<T> operator +(StereoSignal<T> lhs, StereoSignal<T> rhs)
+    {
+        VerifyChannels(lhs, rhs);
 
-        for (int i = 0; i < channels; i++)
+        var channels = new MonoSignal<T>[lhs.mChannels.Length];
+        for (int i = 0; i < channels.Length; i++)
         {
-            result.mChannels[i] = lhs[i] - rhs[i];
+            channels[i] = lhs[i] + rhs[i];
         }
 
-        return result;
+        return new StereoSignal<T>(channels, lhs.mLength);
     }
 
-    public static StereoSignal<T> operator *(StereoSignal<T> signal, double scalar)
+    public static StereoSignal<T> operator -(StereoSignal<T> signal)
     {
-        int channels = signal.mChannels.Length;
-        var result = new StereoSignal<T>(channels, signal.mLength);
+        var channels = new MonoSignal<T>[signal.mChannels.Length];
+        for (int i = 0; i < channels.Length; i++)
+        {
+            channels[i] = -signal[i];
+        }
 
-        for (int i = 0; i < channels; i++)
+        return new StereoSignal<T>(channels, signal.mLength);
+    }
+
+    public static StereoSignal<T> operator -(StereoSignal<T> lhs, StereoSignal<T> rhs)
+    {
+        VerifyChannels(lhs, rhs);
+
+        var channels = new MonoSignal<T>[lhs.mChannels.Length];
+        for (int i = 0; i < channels.Length; i++)
         {
-            result.mChannels[i] = signal[i] * scalar;
+            channels[i] = lhs[i] - rhs[i];
         }
 
-        return result;
+        return new StereoSignal<T>(channels, lhs.mLength);
     }
 
-    public static StereoSignal<T> operator /(StereoSignal<T> signal, double scalar)
+    public static StereoSignal<T> operator *(StereoSignal<T> signal, double scalar)
     {
-        int channels = signal.mChannels.Length;
-        var result = new StereoSignal<T>(channels, signal.mLength);
+        var channels = new MonoSignal<T>[signal.mChannels.Length];
+        for (int i = 0; i < channels.Length; i++)
+        {
+            channels[i] = signal[i] * scalar;
+        }
 
-        for (int i = 0; i < channels; i++)
+        return new StereoSignal<T>(channels, signal.mLength);
+    }
+
+    public static StereoSignal<T> operator /(StereoSignal<T> signal, double scalar)
+    {
+        var channels = new MonoSignal<T>[signal.mChannels.Length];
+        for (int i = 0; i < channels.Length; i++)
         {
-            result.mChannels[i] = signal[i] / scalar;
+            channels[i] = signal[i] / scalar;
         }
 
-        return result;
+        return new StereoSignal<T>(channels, signal.mLength);
     }
 
     public StereoSignal<T> Exp(double expBase)
     {
-        int channels = mChannels.Length;
-        var result = new StereoSignal<T>(channels, mLength);
-
-        for (int i = 0; i < channels; i++)
+        var channels = new MonoSignal<T>[mChannels.Length];
+        for (int i = 0; i < channels.Length; i++)
         {
-            result.mChannels[i] = mChannels[i].Exp(expBase);
+            channels[i] = mChannels[i].Exp(expBase);
         }
 
-        return result;
+        return new StereoSignal<T>(channels, mLength);
+    }
+
+    public void Exp(double expBase, StereoSignal<T> destination)
+    {
+        VerifyShape(destination);
+        for (int i = 0; i < mChannels.Length; i++)
+        {
+            mChannels[i].Exp(expBase, destination.mChannels[i]);
+        }
     }
 
     private int mLength;
     private MonoSignal<T>[] mChannels;
+
+    private ReadOnlyStereoSignal<T>? mReadOnly;
 }
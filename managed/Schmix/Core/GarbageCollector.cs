@@ -0,0 +1,141 @@
+namespace Schmix.Core;
+
+using Coral.Managed.Interop;
+
+using System;
+using System.Runtime;
+
+public static class GarbageCollector
+{
+    private static long sNoGCRegionSize = 0;
+    private static bool sCycleActive = false;
+    private static bool sRegionEntered = false;
+    private static bool sCountersSampled = false;
+
+    private static int sGen0Collections, sGen1Collections, sGen2Collections;
+    private static TimeSpan sPauseDuration;
+
+    public static GCLatencyMode LatencyMode => GCSettings.LatencyMode;
+    public static long NoGCRegionSize => sNoGCRegionSize;
+
+    internal static bool Configure(int latencyMode, long noGCRegionSize)
+    {
+        var mode = (GCLatencyMode)latencyMode;
+        Log.Info($"GC: server {GCSettings.IsServerGC}, latency mode {mode}");
+
+        try
+        {
+            GCSettings.LatencyMode = mode;
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Failed to set GC latency mode: {ex}");
+            return false;
+        }
+
+        sNoGCRegionSize = noGCRegionSize;
+        return true;
+    }
+
+    private static void SampleCounters()
+    {
+        sGen0Collections = GC.CollectionCount(0);
+        sGen1Collections = GC.CollectionCount(1);
+        sGen2Collections = GC.CollectionCount(2);
+        sPauseDuration = GC.GetTotalPauseDuration();
+        sCountersSampled = true;
+    }
+
+    // false if the runtime had already left the region, after an allocation over the reserved
+    // size or an induced collection; it still has to be ended before another can start
+    private static bool EndRegion()
+    {
+        sRegionEntered = false;
+
+        try
+        {
+            GC.EndNoGCRegion();
+        }
+        catch (InvalidOperationException)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    // called by the rack right before a device cycle, whose allocations the region is reserved for
+    internal static void PrepareCycle()
+    {
+        if (sCycleActive)
+        {
+            throw new InvalidOperationException("Cannot prepare a cycle while one is active!");
+        }
+
+        // sampled first, so that a collection made to enter the region counts against the cycle
+        // it delayed
+        SampleCounters();
+
+        if (sNoGCRegionSize <= 0)
+        {
+            return;
+        }
+
+        // left over from a cycle that never ended
+        if (sRegionEntered)
+        {
+            EndRegion();
+        }
+
+        try
+        {
+            // never let the runtime block on a full collection just to make room
+            sRegionEntered = GC.TryStartNoGCRegion(sNoGCRegionSize, true);
+        }
+        catch (Exception ex)
+        {
+            Log.Warn($"Failed to enter no-GC region: {ex.Message}");
+        }
+    }
+
+    internal static void BeginCycle()
+    {
+        if (sCycleActive)
+        {
+            throw new InvalidOperationException("A processing cycle is already active!");
+        }
+
+        if (!sCountersSampled)
+        {
+            SampleCounters();
+        }
+
+        sCycleActive = true;
+    }
+
+    // ends the region right after the cycle, so that nothing outside it spends the reservation
+    internal static void EndCycle()
+    {
+        if (!sCycleActive)
+        {
+            return;
+        }
+
+        bool regionHeld = sRegionEntered && EndRegion();
+
+        int gen0 = GC.CollectionCount(0) - sGen0Collections;
+        int gen1 = GC.CollectionCount(1) - sGen1Collections;
+        int gen2 = GC.CollectionCount(2) - sGen2Collections;
+        var pause = GC.GetTotalPauseDuration() - sPauseDuration;
+
+        sCycleActive = false;
+        sCountersSampled = false;
+
+        unsafe
+        {
+            ReportCycle_Impl(gen0, gen1, gen2, pause.Ticks, regionHeld);
+        }
+    }
+
+    internal static unsafe delegate*<int, int, int, long, Bool32, void> ReportCycle_Impl = null;
+}
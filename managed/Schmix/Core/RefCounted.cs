@@ -4,12 +4,22 @@ using System;
 
 public abstract unsafe class RefCounted : IDisposable
 {
-    internal RefCounted(void* address, bool addRef = true)
+    internal RefCounted(void* address)
     {
         mAddress = address;
         mCounted = false;
 
-        if (addRef)
+        AddRef();
+    }
+
+    // takes over a reference the native side already took for us, rather than adding another
+    // the reference is still dropped on dispose or collection
+    internal RefCounted(void* address, bool adoptReference)
+    {
+        mAddress = address;
+        mCounted = adoptReference;
+
+        if (!adoptReference)
         {
             AddRef();
         }
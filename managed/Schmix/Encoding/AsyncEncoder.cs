@@ -0,0 +1,98 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using Schmix.Audio;
+
+using System;
+using System.IO;
+
+// encodes signal channels into a file on a native thread of its own
+// the container and codec are picked from the file name; writes only copy and return
+public sealed unsafe class AsyncEncoder : IDisposable
+{
+    public AsyncEncoder(string path, int channels, int sampleRate)
+    {
+        using NativeString pathNative = path;
+        mAddress = OpenFile_Impl(pathNative, channels, sampleRate);
+
+        if (mAddress is null)
+        {
+            throw new IOException($"Failed to open {path} for encoding!");
+        }
+
+        mChannels = channels;
+        mDisposed = false;
+    }
+
+    ~AsyncEncoder()
+    {
+        if (!mDisposed)
+        {
+            Delete_Impl(mAddress);
+        }
+    }
+
+    // finishes the file if Finish was not called
+    public void Dispose()
+    {
+        if (mDisposed)
+        {
+            return;
+        }
+
+        Delete_Impl(mAddress);
+        GC.SuppressFinalize(this);
+
+        mDisposed = true;
+    }
+
+    public void Write(StereoSignal<double> source, int offset, int length)
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (source.Channels != mChannels)
+        {
+            throw new ArgumentException("Channel count mismatch!");
+        }
+
+        if (offset < 0 || length < 0 || offset + length > source.Length)
+        {
+            throw new ArgumentOutOfRangeException(nameof(length));
+        }
+
+        var channels = stackalloc double*[mChannels];
+        for (int i = 0; i < mChannels; i++)
+        {
+            channels[i] = source[i].Data + offset;
+        }
+
+        if (!Write_Impl(mAddress, channels, length))
+        {
+            throw new IOException("Failed to encode audio!");
+        }
+    }
+
+    // waits for everything written so far, then drains the encoder and writes the trailer
+    public void Finish()
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (!Finish_Impl(mAddress))
+        {
+            throw new IOException("Failed to finish encoding!");
+        }
+    }
+
+    public int Channels => mChannels;
+
+    private readonly void* mAddress;
+    private readonly int mChannels;
+    private bool mDisposed;
+
+    internal static delegate*<NativeString, int, int, void*> OpenFile_Impl = null;
+    internal static delegate*<void*, void> Delete_Impl = null;
+
+    internal static delegate*<void*, double**, int, Bool32> Write_Impl = null;
+    internal static delegate*<void*, Bool32> Finish_Impl = null;
+}
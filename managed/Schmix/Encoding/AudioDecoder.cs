@@ -0,0 +1,143 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using Schmix.Audio;
+
+using System;
+using System.IO;
+
+// decodes a file straight into signal channels
+// samples are converted to the requested channel count and rate in the same pass
+public sealed unsafe class AudioDecoder : IDisposable
+{
+    public enum ResampleQuality : int
+    {
+        Fast = 0,
+        Balanced,
+        High
+    }
+
+    // a sample rate of 0 keeps the source's
+    public AudioDecoder(NativeIO io, int channels, int sampleRate = 0, ResampleQuality quality = ResampleQuality.Balanced)
+    {
+        mAddress = ctor_Impl(io.Address, channels, sampleRate, quality);
+        if (mAddress is null)
+        {
+            throw new SystemException("Failed to open audio decoder!");
+        }
+
+        mChannels = channels;
+        mDisposed = false;
+    }
+
+    ~AudioDecoder()
+    {
+        if (!mDisposed)
+        {
+            Delete_Impl(mAddress);
+        }
+    }
+
+    public void Dispose()
+    {
+        if (mDisposed)
+        {
+            return;
+        }
+
+        Delete_Impl(mAddress);
+        GC.SuppressFinalize(this);
+
+        mDisposed = true;
+    }
+
+    // fills the destination starting at the given offset
+    // returns the number of samples per channel decoded; fewer than requested means eof
+    public int Read(StereoSignal<double> destination, int offset, int length)
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (destination.Channels != mChannels)
+        {
+            throw new ArgumentException("Channel count mismatch!");
+        }
+
+        if (offset < 0 || length < 0 || offset + length > destination.Length)
+        {
+            throw new ArgumentOutOfRangeException(nameof(length));
+        }
+
+        var channels = stackalloc double*[mChannels];
+        for (int i = 0; i < mChannels; i++)
+        {
+            channels[i] = destination[i].Data + offset;
+        }
+
+        int samplesRead = Read_Impl(mAddress, channels, length);
+        if (samplesRead < 0)
+        {
+            throw new IOException("Failed to decode audio!");
+        }
+
+        return samplesRead;
+    }
+
+    public void Rewind()
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (!Rewind_Impl(mAddress))
+        {
+            throw new IOException("Failed to rewind audio decoder!");
+        }
+    }
+
+    // positions the next read at the given sample, in the output rate
+    public void Seek(long sample)
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (sample < 0)
+        {
+            throw new ArgumentOutOfRangeException(nameof(sample));
+        }
+
+        if (!Seek_Impl(mAddress, sample))
+        {
+            throw new IOException("Failed to seek audio decoder!");
+        }
+    }
+
+    // loads a seek index from the given path, or builds one there
+    // building reads through the whole file and rewinds the decoder
+    public void PrepareSeekIndex(string path)
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        using NativeString pathNative = path;
+        if (!PrepareSeekIndex_Impl(mAddress, pathNative))
+        {
+            throw new IOException("Failed to prepare seek index!");
+        }
+    }
+
+    public int Channels => mChannels;
+    public int SampleRate => GetSampleRate_Impl(mAddress);
+    public int SourceSampleRate => GetSourceSampleRate_Impl(mAddress);
+
+    private readonly void* mAddress;
+    private readonly int mChannels;
+    private bool mDisposed;
+
+    internal static delegate*<void*, int, int, ResampleQuality, void*> ctor_Impl = null;
+    internal static delegate*<void*, void> Delete_Impl = null;
+
+    internal static delegate*<void*, double**, int, int> Read_Impl = null;
+    internal static delegate*<void*, Bool32> Rewind_Impl = null;
+    internal static delegate*<void*, long, Bool32> Seek_Impl = null;
+    internal static delegate*<void*, NativeString, Bool32> PrepareSeekIndex_Impl = null;
+
+    internal static delegate*<void*, int> GetSampleRate_Impl = null;
+    internal static delegate*<void*, int> GetSourceSampleRate_Impl = null;
+}
@@ -0,0 +1,106 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using Schmix.Audio;
+using Schmix.Core;
+
+using System;
+using System.Numerics;
+
+// a decoded frame referencing the decoder's own buffers
+// they are handed back to the decoder once the frame is disposed or collected
+public sealed class AudioFrame : RefCounted
+{
+    // matches AVSampleFormat
+    public enum SampleFormat : int
+    {
+        None = -1,
+        U8 = 0,
+        S16,
+        S32,
+        Float,
+        Double,
+        U8Planar,
+        S16Planar,
+        S32Planar,
+        FloatPlanar,
+        DoublePlanar,
+        S64,
+        S64Planar
+    }
+
+    // takes over the reference the native side handed out
+    internal unsafe AudioFrame(void* address) : base(address, true)
+    {
+    }
+
+    // native frames still alive, whoever holds them; used to catch leaked frames
+    internal static unsafe int LiveCount => GetLiveCount_Impl();
+
+    public unsafe int Samples => GetSamples_Impl(mAddress);
+    public unsafe int Channels => GetChannels_Impl(mAddress);
+    public unsafe int SampleRate => GetSampleRate_Impl(mAddress);
+    public unsafe SampleFormat Format => GetSampleFormat_Impl(mAddress);
+    public unsafe bool IsPlanar => IsPlanar_Impl(mAddress);
+
+    public unsafe int PlaneCount => GetPlaneCount_Impl(mAddress);
+
+    // raw bytes of one plane; only valid until the frame is disposed
+    public unsafe ReadOnlySpan<byte> GetPlane(int index)
+    {
+        if ((uint)index >= (uint)PlaneCount)
+        {
+            throw new ArgumentOutOfRangeException(nameof(index));
+        }
+
+        return new ReadOnlySpan<byte>(GetPlane_Impl(mAddress, index), GetPlaneSize_Impl(mAddress));
+    }
+
+    // a signal viewing one channel without copying it
+    // the view keeps the frame alive, but disposing the frame still invalidates it
+    public unsafe MonoSignal<T> GetChannel<T>(int channel) where T : unmanaged, INumber<T>
+    {
+        if ((uint)channel >= (uint)Channels)
+        {
+            throw new ArgumentOutOfRangeException(nameof(channel));
+        }
+
+        var format = Format;
+        if (!IsPlanar && Channels > 1)
+        {
+            throw new InvalidOperationException("Interleaved frames cannot be viewed per channel!");
+        }
+
+        if (GetElementFormat(format) != typeof(T))
+        {
+            throw new InvalidOperationException($"Frame samples are {format}, not {typeof(T).Name}!");
+        }
+
+        var data = (T*)GetPlane_Impl(mAddress, IsPlanar ? channel : 0);
+        return new MonoSignal<T>(data, Samples, this);
+    }
+
+    private static Type? GetElementFormat(SampleFormat format) => format switch
+    {
+        SampleFormat.U8 or SampleFormat.U8Planar => typeof(byte),
+        SampleFormat.S16 or SampleFormat.S16Planar => typeof(short),
+        SampleFormat.S32 or SampleFormat.S32Planar => typeof(int),
+        SampleFormat.S64 or SampleFormat.S64Planar => typeof(long),
+        SampleFormat.Float or SampleFormat.FloatPlanar => typeof(float),
+        SampleFormat.Double or SampleFormat.DoublePlanar => typeof(double),
+        _ => null
+    };
+
+    internal static unsafe delegate*<void*, int> GetSamples_Impl = null;
+    internal static unsafe delegate*<void*, int> GetChannels_Impl = null;
+    internal static unsafe delegate*<void*, int> GetSampleRate_Impl = null;
+    internal static unsafe delegate*<void*, SampleFormat> GetSampleFormat_Impl = null;
+    internal static unsafe delegate*<void*, Bool32> IsPlanar_Impl = null;
+
+    internal static unsafe delegate*<void*, int> GetPlaneCount_Impl = null;
+    internal static unsafe delegate*<void*, int, void*> GetPlane_Impl = null;
+    internal static unsafe delegate*<void*, int> GetPlaneSize_Impl = null;
+
+    internal static unsafe delegate*<int> GetLiveCount_Impl = null;
+}
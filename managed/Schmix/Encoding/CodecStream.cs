@@ -2,6 +2,7 @@ namespace Schmix.Encoding;
 
 using Coral.Managed.Interop;
 
+using Schmix.Audio;
 using Schmix.Core;
 
 using System;
@@ -26,6 +27,23 @@ public sealed class CodecStream : Stream
         }
     }
 
+    // reads and writes go straight through the native backend
+    public CodecStream(NativeIO io, IO.Mode mode, CodecParameters parameters, int streamIndex)
+    {
+        mSource = null;
+        mSourceInterface = null;
+
+        unsafe
+        {
+            mAddress = ctorNative_Impl(io.Address, mode, parameters.Address, streamIndex);
+
+            if (mAddress is null)
+            {
+                throw new SystemException("Failed to open codec stream!");
+            }
+        }
+    }
+
     protected override void Dispose(bool disposing)
     {
         unsafe
@@ -35,11 +53,11 @@ public sealed class CodecStream : Stream
 
         if (disposing)
         {
-            mSourceInterface.Dispose();
+            mSourceInterface?.Dispose();
 
             if (mCloseSource)
             {
-                mSource.Dispose();
+                mSource?.Dispose();
             }
         }
     }
@@ -60,17 +78,30 @@ public sealed class CodecStream : Stream
     public CodecParameters Parameters => GetParameters();
     public int StreamIndex => GetStreamIndex();
 
-    private unsafe void ReadFrame()
+    // hands out the next decoded frame without copying it; null at eof
+    public unsafe AudioFrame? ReadAudioFrame()
+    {
+        void* frame = null;
+        int result = ReadAudioFrame_Impl(mAddress, &frame);
+
+        if (result < 0)
+        {
+            throw new IOException("Failed to decode frame!");
+        }
+
+        return result > 0 ? new AudioFrame(frame) : null;
+    }
+
+    private unsafe bool ReadFrame()
     {
         void* data = null;
         int samples = ReadFrame_Impl(mAddress, &data);
 
         if (samples < 0)
         {
-            mFrameBuffer = null;
-
             // assume eof
-            throw new EndOfStreamException();
+            mFrameBuffer = null;
+            return false;
         }
 
         var parameters = GetParameters();
@@ -78,21 +109,36 @@ public sealed class CodecStream : Stream
 
         var source = new Span<byte>(data, bufferSize);
         mFrameBuffer = new byte[bufferSize];
+        mCursor = 0;
         source.CopyTo(mFrameBuffer);
 
         MemoryAllocator.Free(data);
+        return true;
     }
 
     public override int Read(Span<byte> buffer)
     {
-        var cursor = buffer;
-
-        do
+        int offset = 0;
+        while (offset < buffer.Length)
         {
+            if (mFrameBuffer is null || mCursor >= mFrameBuffer.Length)
+            {
+                if (!ReadFrame())
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            int bytesCopied = int.Min(buffer.Length - offset, mFrameBuffer.Length - mCursor);
+            mFrameBuffer.AsSpan(mCursor, bytesCopied).CopyTo(buffer.Slice(offset));
+
+            offset += bytesCopied;
+            mCursor += bytesCopied;
         }
-        while (mFrameBuffer is not null && mFrameBuffer.Length > 0 && cursor.Length > 0);
 
-        return 0;
+        return offset;
     }
 
     public override int Read(byte[] buffer, int offset, int count)
@@ -101,6 +147,67 @@ public sealed class CodecStream : Stream
         return Read(span);
     }
 
+    // whole frames in the codec's sample format
+    public override void Write(ReadOnlySpan<byte> buffer)
+    {
+        int frameSize = GetParameters().CalculateFrameBufferSize(1);
+        if (frameSize <= 0 || buffer.Length % frameSize != 0)
+        {
+            throw new ArgumentException("Buffer does not hold a whole number of frames!");
+        }
+
+        unsafe
+        {
+            fixed (byte* data = buffer)
+            {
+                if (!WriteFrame_Impl(mAddress, data, buffer.Length / frameSize))
+                {
+                    throw new IOException("Failed to encode frame!");
+                }
+            }
+        }
+    }
+
+    // any length; the channels are read in place and converted to the codec's format natively
+    public unsafe void Write(StereoSignal<double> signal, int offset, int length)
+    {
+        if (offset < 0 || length < 0 || offset + length > signal.Length)
+        {
+            throw new ArgumentOutOfRangeException(nameof(length));
+        }
+
+        int channelCount = signal.Channels;
+        var channels = stackalloc double*[channelCount];
+
+        for (int i = 0; i < channelCount; i++)
+        {
+            channels[i] = signal[i].Data + offset;
+        }
+
+        if (!WriteSignal_Impl(mAddress, channels, channelCount, length))
+        {
+            throw new IOException("Failed to encode signal!");
+        }
+    }
+
+    public override void Write(byte[] buffer, int offset, int count)
+    {
+        var span = buffer.AsSpan().Slice(offset, count);
+        Write(span);
+    }
+
+    public override unsafe void Flush()
+    {
+        if (!Flush_Impl(mAddress))
+        {
+            throw new IOException("Failed to flush codec stream!");
+        }
+    }
+
+    public override bool CanRead => Mode == IO.Mode.Input;
+    public override bool CanWrite => Mode == IO.Mode.Output;
+    public override bool CanSeek => false;
+
     public override void SetLength(long value) => throw new NotSupportedException();
 
     public override long Seek(long offset, SeekOrigin origin) => throw new NotSupportedException();
@@ -108,15 +215,14 @@ public sealed class CodecStream : Stream
     private byte[]? mFrameBuffer;
     private int mCursor;
 
-    private readonly MemoryStream? mOutputBuffer;
-
-    private readonly Stream mSource;
+    private readonly Stream? mSource;
     private bool mCloseSource;
 
     private readonly unsafe void* mAddress;
-    private readonly NativeStreamInterface mSourceInterface;
+    private readonly NativeStreamInterface? mSourceInterface;
 
     internal static unsafe delegate*<NativeStreamCallbacks*, IO.Mode, void*, int, void*> ctor_Impl = null;
+    internal static unsafe delegate*<void*, IO.Mode, void*, int, void*> ctorNative_Impl = null;
     internal static unsafe delegate*<void*, void> Close_Impl = null;
 
     internal static unsafe delegate*<void*, IO.Mode> GetMode_Impl = null;
@@ -125,6 +231,8 @@ public sealed class CodecStream : Stream
     internal static unsafe delegate*<void*, int> GetFrameSize_Impl = null;
 
     internal static unsafe delegate*<void*, void**, int> ReadFrame_Impl = null;
+    internal static unsafe delegate*<void*, void**, int> ReadAudioFrame_Impl = null;
     internal static unsafe delegate*<void*, void*, int, Bool32> WriteFrame_Impl = null;
+    internal static unsafe delegate*<void*, double**, int, int, Bool32> WriteSignal_Impl = null;
     internal static unsafe delegate*<void*, Bool32> Flush_Impl = null;
 }
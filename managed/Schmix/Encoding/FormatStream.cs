@@ -0,0 +1,160 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using Schmix.Core;
+
+using System;
+using System.IO;
+
+// container-level access to an audio file
+public sealed class FormatStream : IDisposable
+{
+    private static unsafe void* GuessOutputFormat(IO.Mode mode, string? outputPath)
+    {
+        if (mode != IO.Mode.Output)
+        {
+            return null;
+        }
+
+        if (outputPath is null)
+        {
+            throw new ArgumentNullException(nameof(outputPath), "Output streams need a path to guess the container from!");
+        }
+
+        using NativeString nativePath = outputPath;
+        void* format = GuessOutputFormat_Impl(nativePath);
+
+        if (format is null)
+        {
+            throw new ArgumentException($"Failed to guess output format for {outputPath}");
+        }
+
+        return format;
+    }
+
+    // every buffer is read or written through the given stream
+    public FormatStream(Stream stream, IO.Mode mode, string? outputPath = null)
+    {
+        mStreamInterface = new NativeStreamInterface(stream);
+
+        var callbacks = mStreamInterface.GenerateCallbacks();
+        unsafe
+        {
+            mAddress = ctor_Impl(&callbacks, mode, GuessOutputFormat(mode, outputPath));
+            if (mAddress is null)
+            {
+                mStreamInterface.Dispose();
+                throw new SystemException("Failed to open format stream!");
+            }
+        }
+
+        mDisposed = false;
+    }
+
+    // demuxing and muxing stay in native code
+    public FormatStream(NativeIO io, IO.Mode mode, string? outputPath = null)
+    {
+        mStreamInterface = null;
+
+        unsafe
+        {
+            mAddress = ctorNative_Impl(io.Address, mode, GuessOutputFormat(mode, outputPath));
+            if (mAddress is null)
+            {
+                throw new SystemException("Failed to open format stream!");
+            }
+        }
+
+        mDisposed = false;
+    }
+
+    ~FormatStream()
+    {
+        if (!mDisposed)
+        {
+            Dispose(false);
+        }
+    }
+
+    public void Dispose()
+    {
+        if (mDisposed)
+        {
+            return;
+        }
+
+        Dispose(true);
+        GC.SuppressFinalize(this);
+
+        mDisposed = true;
+    }
+
+    private void Dispose(bool disposing)
+    {
+        unsafe
+        {
+            Close_Impl(mAddress);
+        }
+
+        if (disposing)
+        {
+            mStreamInterface?.Dispose();
+        }
+    }
+
+    public unsafe IO.Mode Mode => GetMode_Impl(mAddress);
+    public unsafe int StreamIndex => GetStreamIndex_Impl(mAddress);
+
+    // owned by the stream
+    public unsafe CodecParameters CodecParameters => new CodecParameters(GetCodecParameters_Impl(mAddress));
+
+    // null at eof
+    public byte[]? ReadPacket()
+    {
+        byte[] packet;
+        unsafe
+        {
+            void* data = null;
+            int size = ReadPacket_Impl(mAddress, &data);
+
+            if (size < 0)
+            {
+                return null;
+            }
+
+            packet = new ReadOnlySpan<byte>(data, size).ToArray();
+            MemoryAllocator.Free(data);
+        }
+
+        return packet;
+    }
+
+    public unsafe bool WritePacket(ReadOnlySpan<byte> data)
+    {
+        fixed (byte* dataPtr = data)
+        {
+            return WritePacket_Impl(mAddress, dataPtr, data.Length);
+        }
+    }
+
+    public unsafe bool Flush() => Flush_Impl(mAddress);
+
+    private readonly unsafe void* mAddress;
+    private readonly NativeStreamInterface? mStreamInterface;
+    private bool mDisposed;
+
+    internal static unsafe delegate*<NativeString, void*> GuessOutputFormat_Impl = null;
+
+    internal static unsafe delegate*<NativeStreamCallbacks*, IO.Mode, void*, void*> ctor_Impl = null;
+    internal static unsafe delegate*<void*, IO.Mode, void*, void*> ctorNative_Impl = null;
+    internal static unsafe delegate*<void*, void> Close_Impl = null;
+
+    internal static unsafe delegate*<void*, IO.Mode> GetMode_Impl = null;
+    internal static unsafe delegate*<void*, int> GetStreamIndex_Impl = null;
+    internal static unsafe delegate*<void*, void*> GetCodecParameters_Impl = null;
+
+    internal static unsafe delegate*<void*, void**, int> ReadPacket_Impl = null;
+    internal static unsafe delegate*<void*, void*, int, Bool32> WritePacket_Impl = null;
+    internal static unsafe delegate*<void*, Bool32> Flush_Impl = null;
+}
@@ -0,0 +1,100 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using System;
+
+// an IO backend that lives entirely in native code
+// streams opened on one never call back into managed code to read or write
+public sealed unsafe class NativeIO : IDisposable
+{
+    // 0 selects the native default
+    public static NativeIO OpenFile(string path, IO.Mode mode, int bufferSize = 0)
+    {
+        void* address;
+        using (NativeString nativePath = path)
+        {
+            address = OpenFile_Impl(nativePath, mode, bufferSize);
+        }
+
+        return new NativeIO(address, $"Failed to open file: {path}");
+    }
+
+    // read-only
+    public static NativeIO MapFile(string path)
+    {
+        void* address;
+        using (NativeString nativePath = path)
+        {
+            address = MapFile_Impl(nativePath);
+        }
+
+        return new NativeIO(address, $"Failed to map file: {path}");
+    }
+
+    // read-only; the data is copied
+    public static NativeIO FromMemory(ReadOnlySpan<byte> data)
+    {
+        void* address;
+        fixed (byte* dataPtr = data)
+        {
+            address = OpenMemory_Impl(dataPtr, data.Length);
+        }
+
+        return new NativeIO(address, "Failed to create memory stream!");
+    }
+
+    private NativeIO(void* address, string errorMessage)
+    {
+        if (address is null)
+        {
+            throw new SystemException(errorMessage);
+        }
+
+        mAddress = address;
+        mDisposed = false;
+    }
+
+    ~NativeIO()
+    {
+        if (!mDisposed)
+        {
+            Close_Impl(mAddress);
+        }
+    }
+
+    // streams keep their own reference to the backend, so this may be disposed once they are open
+    public void Dispose()
+    {
+        if (mDisposed)
+        {
+            return;
+        }
+
+        Close_Impl(mAddress);
+        GC.SuppressFinalize(this);
+
+        mDisposed = true;
+    }
+
+    internal void* Address
+    {
+        get
+        {
+            if (mDisposed)
+            {
+                throw new ObjectDisposedException(nameof(NativeIO));
+            }
+
+            return mAddress;
+        }
+    }
+
+    private readonly void* mAddress;
+    private bool mDisposed;
+
+    internal static delegate*<NativeString, IO.Mode, int, void*> OpenFile_Impl = null;
+    internal static delegate*<NativeString, void*> MapFile_Impl = null;
+    internal static delegate*<void*, int, void*> OpenMemory_Impl = null;
+    internal static delegate*<void*, void> Close_Impl = null;
+}
@@ -0,0 +1,62 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using System.Runtime.InteropServices;
+
+// stream details read from container headers alone; nothing is decoded
+// results are cached natively per path and modification time
+public static unsafe class Probe
+{
+    public enum Codec : int
+    {
+        Unknown = 0,
+        PCM,
+        MP3,
+        Vorbis,
+        Opus,
+        FLAC,
+        Other
+    }
+
+    public readonly struct Info
+    {
+        public Codec AudioCodec { get; init; }
+        public int SampleRate { get; init; }
+        public int Channels { get; init; }
+
+        // null when the headers do not say
+        public double? Duration { get; init; }
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeInfo
+    {
+        public Codec AudioCodec;
+        public int SampleRate;
+        public int Channels;
+        public double Duration;
+    }
+
+    // null if the file could not be read or is not audio
+    public static Info? File(string path)
+    {
+        NativeInfo info;
+
+        using NativeString pathNative = path;
+        if (!File_Impl(pathNative, &info))
+        {
+            return null;
+        }
+
+        return new Info
+        {
+            AudioCodec = info.AudioCodec,
+            SampleRate = info.SampleRate,
+            Channels = info.Channels,
+            Duration = info.Duration >= 0.0 ? info.Duration : null
+        };
+    }
+
+    internal static delegate*<NativeString, NativeInfo*, Bool32> File_Impl = null;
+}
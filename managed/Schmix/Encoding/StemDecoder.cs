@@ -0,0 +1,121 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using Schmix.Audio;
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+
+// decodes every audio stream of a multitrack file in a single pass, one signal per stem
+// every stem is converted to the same channel count and rate, lined up on the file's timeline
+public sealed unsafe class StemDecoder : IDisposable
+{
+    // a sample rate of 0 keeps the first stream's
+    public StemDecoder(NativeIO io, int channels, int sampleRate = 0, AudioDecoder.ResampleQuality quality = AudioDecoder.ResampleQuality.Balanced)
+    {
+        mAddress = ctor_Impl(io.Address, channels, sampleRate, quality);
+        if (mAddress is null)
+        {
+            throw new SystemException("Failed to open stem decoder!");
+        }
+
+        mChannels = channels;
+        mStemCount = GetStemCount_Impl(mAddress);
+        mDisposed = false;
+    }
+
+    ~StemDecoder()
+    {
+        if (!mDisposed)
+        {
+            Delete_Impl(mAddress);
+        }
+    }
+
+    public void Dispose()
+    {
+        if (mDisposed)
+        {
+            return;
+        }
+
+        Delete_Impl(mAddress);
+        GC.SuppressFinalize(this);
+
+        mDisposed = true;
+    }
+
+    // fills one destination per stem starting at the given offset
+    // stems that end early are padded with silence
+    // returns the number of samples per channel decoded; fewer than requested means eof
+    public int Read(IReadOnlyList<StereoSignal<double>> destinations, int offset, int length)
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (destinations.Count != mStemCount)
+        {
+            throw new ArgumentException("Stem count mismatch!");
+        }
+
+        var planes = stackalloc double*[mStemCount * mChannels];
+        var stems = stackalloc double**[mStemCount];
+
+        for (int i = 0; i < mStemCount; i++)
+        {
+            var destination = destinations[i];
+            if (destination.Channels != mChannels)
+            {
+                throw new ArgumentException("Channel count mismatch!");
+            }
+
+            if (offset < 0 || length < 0 || offset + length > destination.Length)
+            {
+                throw new ArgumentOutOfRangeException(nameof(length));
+            }
+
+            for (int j = 0; j < mChannels; j++)
+            {
+                planes[i * mChannels + j] = destination[j].Data + offset;
+            }
+
+            stems[i] = planes + i * mChannels;
+        }
+
+        int samplesRead = Read_Impl(mAddress, stems, length);
+        if (samplesRead < 0)
+        {
+            throw new IOException("Failed to decode stems!");
+        }
+
+        return samplesRead;
+    }
+
+    public void Rewind()
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (!Rewind_Impl(mAddress))
+        {
+            throw new IOException("Failed to rewind stem decoder!");
+        }
+    }
+
+    public int StemCount => mStemCount;
+    public int Channels => mChannels;
+    public int SampleRate => GetSampleRate_Impl(mAddress);
+
+    private readonly void* mAddress;
+    private readonly int mChannels, mStemCount;
+    private bool mDisposed;
+
+    internal static delegate*<void*, int, int, AudioDecoder.ResampleQuality, void*> ctor_Impl = null;
+    internal static delegate*<void*, void> Delete_Impl = null;
+
+    internal static delegate*<void*, double***, int, int> Read_Impl = null;
+    internal static delegate*<void*, Bool32> Rewind_Impl = null;
+
+    internal static delegate*<void*, int> GetStemCount_Impl = null;
+    internal static delegate*<void*, int> GetSampleRate_Impl = null;
+}
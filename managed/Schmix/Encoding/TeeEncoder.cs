@@ -0,0 +1,110 @@
+namespace Schmix.Encoding;
+
+using Coral.Managed.Interop;
+
+using Schmix.Audio;
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+
+// encodes one stream of signal channels into several files at once, each on a native thread
+// of its own; the container and codec of each are picked from its file name
+public sealed unsafe class TeeEncoder : IDisposable
+{
+    public TeeEncoder(IReadOnlyList<string> paths, int channels, int sampleRate)
+    {
+        if (paths.Count == 0)
+        {
+            throw new ArgumentException("A tee encoder needs at least one output!");
+        }
+
+        mAddress = Create_Impl(channels, sampleRate);
+        mChannels = channels;
+        mDisposed = false;
+
+        foreach (var path in paths)
+        {
+            using NativeString pathNative = path;
+            if (!AddFile_Impl(mAddress, pathNative))
+            {
+                Dispose();
+                throw new IOException($"Failed to open {path} for encoding!");
+            }
+        }
+    }
+
+    ~TeeEncoder()
+    {
+        if (!mDisposed)
+        {
+            Delete_Impl(mAddress);
+        }
+    }
+
+    // finishes every file if Finish was not called
+    public void Dispose()
+    {
+        if (mDisposed)
+        {
+            return;
+        }
+
+        Delete_Impl(mAddress);
+        GC.SuppressFinalize(this);
+
+        mDisposed = true;
+    }
+
+    // only fails once every output has
+    public void Write(StereoSignal<double> source, int offset, int length)
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (source.Channels != mChannels)
+        {
+            throw new ArgumentException("Channel count mismatch!");
+        }
+
+        if (offset < 0 || length < 0 || offset + length > source.Length)
+        {
+            throw new ArgumentOutOfRangeException(nameof(length));
+        }
+
+        var channels = stackalloc double*[mChannels];
+        for (int i = 0; i < mChannels; i++)
+        {
+            channels[i] = source[i].Data + offset;
+        }
+
+        if (!Write_Impl(mAddress, channels, length))
+        {
+            throw new IOException("Failed to encode audio!");
+        }
+    }
+
+    // waits for every output, then drains each encoder and writes its trailer
+    // throws if any output failed, though the others are still finished
+    public void Finish()
+    {
+        ObjectDisposedException.ThrowIf(mDisposed, this);
+
+        if (!Finish_Impl(mAddress))
+        {
+            throw new IOException("Failed to finish encoding!");
+        }
+    }
+
+    public int Channels => mChannels;
+
+    private readonly void* mAddress;
+    private readonly int mChannels;
+    private bool mDisposed;
+
+    internal static delegate*<int, int, void*> Create_Impl = null;
+    internal static delegate*<void*, void> Delete_Impl = null;
+    internal static delegate*<void*, NativeString, Bool32> AddFile_Impl = null;
+
+    internal static delegate*<void*, double**, int, Bool32> Write_Impl = null;
+    internal static delegate*<void*, Bool32> Finish_Impl = null;
+}
@@ -1,6 +1,7 @@
 namespace Schmix.Extension;
 
 using Schmix.Audio;
+using Schmix.UI;
 
 using System;
 using System.Collections.Generic;
@@ -24,6 +25,10 @@ public abstract class Module : IDisposable
     public virtual int InputCount => 0;
     public virtual int OutputCount => 0;
 
+    // true while the rack is bounced to a file, running as fast as it can instead of at a
+    // device's pace; output modules should hand their audio to Rack.PutOfflineAudio instead
+    public static bool IsRenderingOffline => Rack.IsOffline;
+
     protected Module()
     {
         mDisposed = false;
@@ -56,6 +61,11 @@ public abstract class Module : IDisposable
     {
     }
 
+    // inputs are read-only views of whatever the cables feeding them carry, shared with any other
+    // module reading the same output; results go out through PutSignal, usually in a signal
+    // rented for the cycle, and must not be written to once put
+    // none of these signals may be kept past the call, as their storage goes back to the pool when
+    // the cycle ends; copy anything that has to outlive it
     public abstract void Process(IReadOnlyList<ISignalInput?> inputs, IReadOnlyList<ISignalOutput?> outputs, int sampleRate, int samplesRequested, int channels);
 
     public virtual void DrawProperties()
@@ -7,54 +7,146 @@ using Schmix.Core;
 
 using System;
 using System.Collections.Generic;
+using System.IO;
 using System.Reflection;
+using System.Runtime.Loader;
+using System.Threading.Tasks;
 
 public abstract class Plugin : IDisposable
 {
-    private struct PluginInfo
+    private sealed class PluginInfo
     {
-        public Plugin Instance;
+        public Plugin? Instance;
 
-        public string Name;
-        public Assembly SourceAssembly;
-        public Type PluginType;
+        public string Name = string.Empty;
+        public Assembly? SourceAssembly;
+        public Type? PluginType;
+
+        // set for plugins registered from the native index; resolved on first use
+        public string? AssemblyPath;
+        public string? TypeName;
     }
 
     private static readonly Dictionary<string, PluginInfo> sPlugins;
+    private static readonly List<int> sQueuedAssemblies;
+    private static string? sPluginDirectory;
+    private static int sLoadContext;
+    private static bool sResolverRegistered;
+
     static Plugin()
     {
         sPlugins = new Dictionary<string, PluginInfo>();
+        sQueuedAssemblies = new List<int>();
+
+        sPluginDirectory = null;
+        sLoadContext = -1;
+        sResolverRegistered = false;
     }
 
+    public static IReadOnlyCollection<string> Names => sPlugins.Keys;
+
     public static IReadOnlyDictionary<string, Plugin> Plugins
     {
         get
         {
             var plugins = new Dictionary<string, Plugin>();
 
-            foreach ((var name, var info) in sPlugins)
+            foreach (var name in sPlugins.Keys)
             {
-                var plugin = info.Instance;
-                plugins.Add(name, plugin);
+                var plugin = Get(name);
+                if (plugin is not null)
+                {
+                    plugins.Add(name, plugin);
+                }
             }
             
             return plugins;
         }
     }
 
-    internal static int LoadPluginsFromAssembly_Native(int loadContext, int assemblyID)
+    public static Plugin? Get(string name)
+    {
+        if (!sPlugins.TryGetValue(name, out PluginInfo? info))
+        {
+            return null;
+        }
+
+        if (info.Instance is null && !ResolveIndexedPlugin(info))
+        {
+            return null;
+        }
+
+        return info.Instance;
+    }
+
+    internal static void SetPluginDirectory_Native(NativeString directory)
+    {
+        sPluginDirectory = directory.ToString();
+    }
+
+    internal static void RegisterIndexedPlugin_Native(NativeString name, NativeString typeName, NativeString assemblyPath)
+    {
+        var pluginName = name.ToString() ?? string.Empty;
+        if (sPlugins.ContainsKey(pluginName))
+        {
+            Log.Error($"Plugin already registered: {pluginName}");
+            return;
+        }
+
+        sPlugins.Add(pluginName, new PluginInfo
+        {
+            Instance = null,
+
+            Name = pluginName,
+            SourceAssembly = null,
+            PluginType = null,
+
+            AssemblyPath = assemblyPath.ToString(),
+            TypeName = typeName.ToString()
+        });
+
+        Log.Debug($"Registered indexed plugin: {pluginName}");
+    }
+
+    internal static void QueueAssembly_Native(int assemblyID)
+    {
+        sQueuedAssemblies.Add(assemblyID);
+    }
+
+    internal static int LoadQueuedAssemblies_Native(int loadContext)
     {
+        sLoadContext = loadContext;
+
+        var ids = sQueuedAssemblies.ToArray();
+        sQueuedAssemblies.Clear();
+
         // see managed/Coral.Managed.csproj
-        Assembly? assembly;
-        if (!AssemblyLoader.TryGetAssembly(loadContext, assemblyID, out assembly) || assembly is null)
+        var assemblies = new Assembly[ids.Length];
+        for (int i = 0; i < ids.Length; i++)
         {
-            Log.Error("Failed to retrieve assembly from Coral!");
-            return -1;
+            Assembly? assembly;
+            if (!AssemblyLoader.TryGetAssembly(loadContext, ids[i], out assembly) || assembly is null)
+            {
+                Log.Error("Failed to retrieve assembly from Coral!");
+                return -1;
+            }
+
+            assemblies[i] = assembly;
         }
 
         try
         {
-            return LoadPluginsFromAssembly(assembly);
+            // reflection is safe to run concurrently; registration and instantiation are not
+            var scans = new List<(Type, RegisteredPluginAttribute)>[assemblies.Length];
+            Parallel.For(0, assemblies.Length, i => scans[i] = ScanAssembly(assemblies[i]));
+
+            int pluginCount = 0;
+            for (int i = 0; i < assemblies.Length; i++)
+            {
+                pluginCount += RegisterPlugins(ids[i], assemblies[i], scans[i]);
+            }
+
+            return pluginCount;
         }
         catch (Exception ex)
         {
@@ -63,9 +155,9 @@ public abstract class Plugin : IDisposable
         }
     }
 
-    internal static int LoadPluginsFromAssembly(Assembly assembly)
+    private static List<(Type, RegisteredPluginAttribute)> ScanAssembly(Assembly assembly)
     {
-        int pluginCount = 0;
+        var result = new List<(Type, RegisteredPluginAttribute)>();
 
         var types = assembly.GetTypes();
         foreach (var type in types)
@@ -75,13 +167,24 @@ public abstract class Plugin : IDisposable
                 continue;
             }
 
+            // runs on worker threads; don't log per type here
             var attribute = type.GetCustomAttribute<RegisteredPluginAttribute>();
             if (attribute is null)
             {
-                Log.Debug($"Skipping type: {type.Namespace ?? "<global>"}.{type.Name}");
                 continue;
             }
 
+            result.Add((type, attribute));
+        }
+
+        return result;
+    }
+
+    private static int RegisterPlugins(int assemblyID, Assembly assembly, IEnumerable<(Type, RegisteredPluginAttribute)> scan)
+    {
+        int pluginCount = 0;
+        foreach ((var type, var attribute) in scan)
+        {
             var pluginName = attribute.Name;
             if (sPlugins.ContainsKey(pluginName))
             {
@@ -89,16 +192,9 @@ public abstract class Plugin : IDisposable
                 continue;
             }
 
-            if (!type.IsDerivedFrom(typeof(Plugin)))
-            {
-                Log.Error($"Plugin \"{pluginName}\" is not derived from Plugin!");
-                continue;
-            }
-
-            var result = (Plugin?)Activator.CreateInstance(type, attribute.Parameters);
+            var result = Instantiate(type, attribute);
             if (result is null)
             {
-                Log.Error($"Failed to initialize plugin \"{pluginName}\"");
                 continue;
             }
 
@@ -111,6 +207,14 @@ public abstract class Plugin : IDisposable
                 PluginType = type
             });
 
+            using NativeString nameNative = pluginName;
+            using NativeString typeNameNative = type.FullName ?? type.Name;
+
+            unsafe
+            {
+                RecordPlugin_Impl(assemblyID, nameNative, typeNameNative);
+            }
+
             Log.Info($"Loaded plugin: {pluginName}");
             pluginCount++;
         }
@@ -118,6 +222,114 @@ public abstract class Plugin : IDisposable
         return pluginCount;
     }
 
+    private static Plugin? Instantiate(Type type, RegisteredPluginAttribute attribute)
+    {
+        var pluginName = attribute.Name;
+        if (!type.IsDerivedFrom(typeof(Plugin)))
+        {
+            Log.Error($"Plugin \"{pluginName}\" is not derived from Plugin!");
+            return null;
+        }
+
+        var result = (Plugin?)Activator.CreateInstance(type, attribute.Parameters);
+        if (result is null)
+        {
+            Log.Error($"Failed to initialize plugin \"{pluginName}\"");
+        }
+
+        return result;
+    }
+
+    private static Assembly? LoadAssembly(string path)
+    {
+        int assemblyID;
+        unsafe
+        {
+            using NativeString pathNative = path;
+            assemblyID = LoadAssembly_Impl(pathNative);
+        }
+
+        Assembly? assembly;
+        if (assemblyID < 0 || !AssemblyLoader.TryGetAssembly(sLoadContext, assemblyID, out assembly))
+        {
+            return null;
+        }
+
+        return assembly;
+    }
+
+    private static Assembly? ResolveDependency(AssemblyLoadContext context, AssemblyName name)
+    {
+        // dependencies of deferred assemblies may not have been loaded yet
+        if (sPluginDirectory is null || name.Name is null)
+        {
+            return null;
+        }
+
+        var fileName = $"{name.Name}.dll";
+        foreach (var path in Directory.EnumerateFiles(sPluginDirectory, fileName, SearchOption.AllDirectories))
+        {
+            return LoadAssembly(Path.GetFullPath(path));
+        }
+
+        return null;
+    }
+
+    private static bool ResolveIndexedPlugin(PluginInfo info)
+    {
+        if (info.AssemblyPath is null || info.TypeName is null)
+        {
+            return false;
+        }
+
+        var assembly = LoadAssembly(info.AssemblyPath);
+        if (assembly is null)
+        {
+            Log.Error($"Failed to load assembly {info.AssemblyPath} for plugin \"{info.Name}\"");
+            return false;
+        }
+
+        if (!sResolverRegistered)
+        {
+            var context = AssemblyLoadContext.GetLoadContext(assembly);
+            if (context is not null)
+            {
+                context.Resolving += ResolveDependency;
+                sResolverRegistered = true;
+            }
+        }
+
+        var type = assembly.GetType(info.TypeName);
+        var attribute = type?.GetCustomAttribute<RegisteredPluginAttribute>();
+
+        if (type is null || attribute is null || attribute.Name != info.Name)
+        {
+            Log.Error($"Indexed plugin \"{info.Name}\" no longer exists in {info.AssemblyPath}");
+            return false;
+        }
+
+        try
+        {
+            info.Instance = Instantiate(type, attribute);
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Failed to initialize plugin \"{info.Name}\": {ex}");
+            return false;
+        }
+
+        if (info.Instance is null)
+        {
+            return false;
+        }
+
+        info.SourceAssembly = assembly;
+        info.PluginType = type;
+
+        Log.Info($"Loaded plugin: {info.Name}");
+        return true;
+    }
+
     internal static void UnloadPlugins()
     {
         foreach (var name in sPlugins.Keys)
@@ -125,10 +337,11 @@ public abstract class Plugin : IDisposable
             var info = sPlugins[name];
             var plugin = info.Instance;
 
-            plugin.Dispose();
+            plugin?.Dispose();
         }
 
         sPlugins.Clear();
+        sQueuedAssemblies.Clear();
     }
 
     protected Plugin()
@@ -149,6 +362,12 @@ public abstract class Plugin : IDisposable
 
     public abstract Module Instantiate();
 
+    // whether a throwaway module may be instantiated and run on silent scratch buffers, on a
+    // background thread, before the real one joins the rack
+    // off by default, since modules that open devices or files, or hook into anything shared,
+    // would do so twice; plugins whose modules only process their inputs can opt in
+    public virtual bool CanWarmUp => false;
+
     protected virtual void Unload(bool disposing)
     {
         // unload plugin-specific data here
@@ -168,4 +387,7 @@ public abstract class Plugin : IDisposable
     }
 
     private bool mDisposed;
+
+    internal static unsafe delegate*<NativeString, int> LoadAssembly_Impl = null;
+    internal static unsafe delegate*<int, NativeString, NativeString, void> RecordPlugin_Impl = null;
 }
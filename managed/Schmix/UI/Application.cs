@@ -4,8 +4,11 @@ using Coral.Managed.Interop;
 
 using ImGuiNET;
 
+using Schmix.Audio;
 using Schmix.Core;
+using Schmix.Encoding;
 
+using System;
 using System.Numerics;
 
 public static class Application
@@ -14,12 +17,13 @@ public static class Application
     private static bool sShowDockspace = true;
     private static bool sShowRack = true;
 
-    internal static bool Init()
+    internal static bool Init(Bool32 warmUpModules)
     {
         Log.Info("Initializing rack...");
 
         Rack.Channels = 2;
         Rack.SampleRate = 40960;
+        Rack.WarmUpModules = warmUpModules;
 
         return true;
     }
@@ -29,6 +33,22 @@ public static class Application
         Log.Debug("Managed application shutting down");
 
         Rack.Clear();
+        SignalPool.Free();
+
+        CheckFrameLeaks();
+    }
+
+    // every frame handed to managed code must have dropped its native reference by now
+    private static void CheckFrameLeaks()
+    {
+        GC.Collect();
+        GC.WaitForPendingFinalizers();
+
+        int liveFrames = AudioFrame.LiveCount;
+        if (liveFrames > 0)
+        {
+            Log.Warn($"{liveFrames} decoded audio frames were never released");
+        }
     }
 
     internal static void Update()
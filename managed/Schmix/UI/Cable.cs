@@ -42,27 +42,40 @@ public sealed class Cable : ISignalInput, ISignalOutput
     public Endpoint Source => mSource;
     public Endpoint Destination => mDestination;
 
-    public StereoSignal<double>? Signal => mSignal;
+    public ReadOnlyStereoSignal<double>? Signal => mSignal?.AsReadOnly();
 
     public void ResetSignal()
     {
         mSignal = null;
+        mSignalBorrowed = false;
     }
     
-    public void PutSignal(StereoSignal<double> signal)
+    public void PutSignal(ReadOnlyStereoSignal<double> signal)
     {
         if (mSignal is null)
         {
-            mSignal = signal.Copy();
+            // signals are read-only once put; no need to copy unless we have to mix
+            mSignal = signal.Source;
+            mSignalBorrowed = true;
+
+            return;
         }
-        else
+
+        if (mSignalBorrowed)
         {
-            mSignal += signal;
+            var mixed = StereoSignal<double>.Rent(mSignal.Channels, mSignal.Length);
+            mSignal.CopyTo(mixed);
+
+            mSignal = mixed;
+            mSignalBorrowed = false;
         }
+
+        mSignal.AddInPlace(signal);
     }
 
     private int mID;
     private readonly Endpoint mSource, mDestination;
 
     private StereoSignal<double>? mSignal;
+    private bool mSignalBorrowed;
 }
@@ -4,17 +4,63 @@ using ImGuiNET;
 using imnodesNET;
 
 using Schmix.Algorithm;
+using Schmix.Audio;
 using Schmix.Core;
+using Schmix.Encoding;
 using Schmix.Extension;
 
 using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Diagnostics.CodeAnalysis;
 using System.Linq;
 using System.Numerics;
+using System.Threading.Tasks;
 
 public static class Rack
 {
+    private sealed class ScratchEndpoint : ISignalInput, ISignalOutput
+    {
+        public ScratchEndpoint(int channels, int samples)
+        {
+            mSignal = StereoSignal<double>.Rent(channels, samples);
+        }
+
+        public ReadOnlyStereoSignal<double>? Signal => mSignal;
+
+        public void PutSignal(ReadOnlyStereoSignal<double> signal)
+        {
+        }
+
+        private readonly StereoSignal<double> mSignal;
+    }
+
+    private sealed class BounceState : IDisposable
+    {
+        public BounceState(IReadOnlyList<string> paths, long totalFrames, long silenceFrames)
+        {
+            Paths = string.Join(", ", paths);
+            TotalFrames = totalFrames;
+            SilenceFrames = silenceFrames;
+
+            // every file is encoded from the same render, on a thread of its own
+            Encoder = new TeeEncoder(paths, sChannels, sSampleRate);
+            Stopwatch = Stopwatch.StartNew();
+        }
+
+        public void Dispose() => Encoder.Dispose();
+
+        public bool IsDone => Rendered >= TotalFrames || SilentFor >= SilenceFrames;
+
+        public readonly string Paths;
+        public readonly long TotalFrames, SilenceFrames;
+        public readonly TeeEncoder Encoder;
+        public readonly Stopwatch Stopwatch;
+
+        public long Rendered = 0;
+        public long SilentFor = 0;
+    }
+
     private struct EndpointMeta
     {
         public Cable? Cable;
@@ -72,6 +118,9 @@ public static class Rack
 
         public Node Instance;
         public Dictionary<int, EndpointMeta> Inputs, Outputs;
+
+        // what Update hands the node each cycle; rebuilt only when the node is added or rewired
+        public Cable?[] InputCables, OutputCables;
     }
 
     private static readonly Dictionary<int, NodeMeta> sNodes = new Dictionary<int, NodeMeta>();
@@ -81,6 +130,11 @@ public static class Rack
     private static IEnumerable<int>? sNodeUpdateOrder = null;
     private static Dictionary<int, Vector2> sNodeSizes = new Dictionary<int, Vector2>();
 
+    // the first call pays for JIT compilation, static constructors and pool growth
+    // tiered compilation only queues a method for optimization after 30 calls and compiles it in
+    // the background, so this gets that started rather than waiting for it to finish
+    private const int WarmUpIterations = 32;
+
     private static int sChannels = -1;
     private static int sSampleRate = -1;
     private static int sSamplesRequested = -1;
@@ -113,6 +167,27 @@ public static class Rack
         }
     }
 
+    public static bool WarmUpModules { get; set; } = true;
+
+    // frames rendered per cycle while bouncing
+    private const int OfflineBlockSize = 4096;
+
+    // peak level under which a bounce considers the output silent
+    public const double SilenceThreshold = 1e-5;
+
+    // mixed output of the current offline cycle; null while rendering for a device
+    private static StereoSignal<double>? sOfflineOutput = null;
+
+    // true while the rack renders into a file as fast as it can instead of at a device's pace
+    public static bool IsOffline => sOfflineOutput is not null;
+
+    // how long each update may spend on a bounce before handing the frame back to the UI
+    private static readonly TimeSpan BounceSlice = TimeSpan.FromMilliseconds(12);
+
+    private static BounceState? sBounce = null;
+
+    public static bool IsBouncing => sBounce is not null;
+
     public static int SamplesRequested
     {
         get
@@ -144,7 +219,10 @@ public static class Rack
             Instance = node,
 
             Inputs = new Dictionary<int, EndpointMeta>(),
-            Outputs = new Dictionary<int, EndpointMeta>()
+            Outputs = new Dictionary<int, EndpointMeta>(),
+
+            InputCables = new Cable?[node.Inputs.Count],
+            OutputCables = new Cable?[node.Outputs.Count]
         };
 
         sNodes.Add(node.ID, meta);
@@ -152,6 +230,98 @@ public static class Rack
         RegenerateUpdateOrder();
     }
 
+    // runs a throwaway instance, so that the module joining the rack starts from a clean state
+    // and nothing it records or captures holds warm-up audio
+    // called off the main thread, so it only ever sees the format it was started with
+    private static void WarmUp(Plugin plugin, int channels, int sampleRate)
+    {
+        var stopwatch = Stopwatch.StartNew();
+        string name = plugin.GetType().Name;
+
+        try
+        {
+            using var module = plugin.Instantiate();
+            name = module.Name;
+
+            int samples = Math.Max(module.SamplesRequested, sampleRate / 30);
+            var inputs = new ISignalInput?[module.InputCount];
+            var outputs = new ISignalOutput?[module.OutputCount];
+
+            // alternate between connected and disconnected endpoints so both paths get compiled
+            for (int i = 0; i < WarmUpIterations; i++)
+            {
+                bool connected = i % 2 == 0;
+                for (int j = 0; j < inputs.Length; j++)
+                {
+                    inputs[j] = connected ? new ScratchEndpoint(channels, samples) : null;
+                }
+
+                for (int j = 0; j < outputs.Length; j++)
+                {
+                    outputs[j] = connected ? new ScratchEndpoint(channels, samples) : null;
+                }
+
+                module.Process(inputs, outputs, sampleRate, samples, channels);
+                SignalPool.ReturnAll();
+            }
+        }
+        catch (Exception ex)
+        {
+            Log.Warn($"Failed to warm up module {name}: {ex.Message}");
+            return;
+        }
+        finally
+        {
+            // the thread goes back to the task pool, so its signals go too
+            SignalPool.Free();
+        }
+
+        Log.Debug($"Warmed up module {name} in {stopwatch.Elapsed.TotalMilliseconds:0.###} ms");
+    }
+
+    // modules still warming up, in the order they were added
+    private static readonly List<(Plugin Plugin, Task WarmUp, TaskCompletionSource<int> Added)> sWarmingUp = new();
+
+    // warms the plugin's code up on a background task first, if enabled, so that the audio never
+    // waits on it; the module joins the rack on the first update after that finishes
+    public static Task<int> AddModuleAsync(Plugin plugin)
+    {
+        if (!WarmUpModules || !plugin.CanWarmUp || sChannels < 0 || sSampleRate < 0)
+        {
+            return Task.FromResult(AddModule(plugin.Instantiate()));
+        }
+
+        int channels = sChannels, sampleRate = sSampleRate;
+        var added = new TaskCompletionSource<int>();
+
+        sWarmingUp.Add((plugin, Task.Run(() => WarmUp(plugin, channels, sampleRate)), added));
+        return added.Task;
+    }
+
+    private static void AddWarmedUpModules()
+    {
+        for (int i = 0; i < sWarmingUp.Count;)
+        {
+            var (plugin, warmUp, added) = sWarmingUp[i];
+            if (!warmUp.IsCompleted)
+            {
+                i++;
+                continue;
+            }
+
+            sWarmingUp.RemoveAt(i);
+
+            try
+            {
+                added.SetResult(AddModule(plugin.Instantiate()));
+            }
+            catch (Exception ex)
+            {
+                added.SetException(ex);
+            }
+        }
+    }
+
     public static int AddModule(Module module)
     {
         var node = new ModuleNode(module);
@@ -174,6 +344,31 @@ public static class Rack
         });
     }
 
+    private static Cable?[] GetEndpointCables(IReadOnlyDictionary<int, EndpointMeta> list, int count)
+    {
+        var cables = new Cable?[count];
+        for (int i = 0; i < count; i++)
+        {
+            if (list.TryGetValue(i, out EndpointMeta endpoint))
+            {
+                cables[i] = endpoint.Cable;
+            }
+        }
+
+        return cables;
+    }
+
+    private static void CacheNodeCables(int id)
+    {
+        var meta = sNodes[id];
+        var node = meta.Instance;
+
+        meta.InputCables = GetEndpointCables(meta.Inputs, node.Inputs.Count);
+        meta.OutputCables = GetEndpointCables(meta.Outputs, node.Outputs.Count);
+
+        sNodes[id] = meta;
+    }
+
     private static void AddCableToEndpointList(IDictionary<int, EndpointMeta> list, int index, Cable cable)
     {
         VerifyEndpointListContainsIndex(list, index);
@@ -213,6 +408,9 @@ public static class Rack
         AddCableToEndpointList(sourceMeta.Outputs, source.Index, cable);
         AddCableToEndpointList(destinationMeta.Inputs, destination.Index, cable);
 
+        CacheNodeCables(sourceNode.ID);
+        CacheNodeCables(destinationNode.ID);
+
         RegenerateUpdateOrder();
 
         return id;
@@ -251,6 +449,9 @@ public static class Rack
         RemoveCableFromEndpointList(sNodes[sourceID].Outputs, source.Index);
         RemoveCableFromEndpointList(sNodes[destinationID].Inputs, destination.Index);
 
+        CacheNodeCables(sourceID);
+        CacheNodeCables(destinationID);
+
         sCables.Remove(id);
     }
 
@@ -327,6 +528,13 @@ public static class Rack
 
     private static void GetSampleRequest()
     {
+        // nothing paces an offline render, so it goes a whole block at a time
+        if (sOfflineOutput is not null)
+        {
+            sSamplesRequested = sOfflineOutput.Length;
+            return;
+        }
+
         sSamplesRequested = 0;
         foreach (var meta in sNodes.Values)
         {
@@ -346,9 +554,26 @@ public static class Rack
         }
     }
 
+    // while a bounce is running, each update renders a slice of it instead of a device cycle
     public static void Update()
+    {
+        AddWarmedUpModules();
+
+        if (sBounce is not null)
+        {
+            StepBounce(BounceSlice);
+            return;
+        }
+
+        // offline cycles have no deadline, so only device cycles get a no-GC region
+        GarbageCollector.PrepareCycle();
+        ProcessCycle();
+    }
+
+    private static void ProcessCycle()
     {
         UpdateSanityChecks();
+        GarbageCollector.BeginCycle();
 
         try
         {
@@ -362,46 +587,260 @@ public static class Rack
             foreach (int id in sNodeUpdateOrder)
             {
                 var meta = sNodes[id];
-                var node = meta.Instance;
+                foreach (var cable in meta.OutputCables)
+                {
+                    cable?.ResetSignal();
+                }
 
-                var inputNames = node.Inputs;
-                var outputNames = node.Outputs;
+                meta.Instance.Update(meta.InputCables, meta.OutputCables);
+            }
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Error processing audio: {ex}");
+        }
+        finally
+        {
+            // rented signals are only valid for the cycle they were rented in
+            foreach (var cable in sCables.Values)
+            {
+                cable.ResetSignal();
+            }
 
-                var inputs = new Cable?[inputNames.Count];
-                var outputs = new Cable?[outputNames.Count];
+            // an offline cycle's output is rented too; the bounce returns it once it is encoded
+            if (sOfflineOutput is null)
+            {
+                SignalPool.ReturnAll();
+            }
 
-                for (int i = 0; i < inputs.Length; i++)
-                {
-                    Cable? cable = null;
-                    if (meta.Inputs.TryGetValue(i, out EndpointMeta endpoint))
-                    {
-                        cable = endpoint.Cable;
-                    }
+            GarbageCollector.EndCycle();
+        }
 
-                    inputs[i] = cable;
-                }
+        sSamplesRequested = -1;
+    }
 
-                for (int i = 0; i < outputs.Length; i++)
-                {
-                    Cable? cable = null;
-                    if (meta.Outputs.TryGetValue(i, out EndpointMeta endpoint))
-                    {
-                        cable = endpoint.Cable;
-                    }
+    // output modules hand their audio here instead of to a device while the rack is offline
+    // everything put during a cycle is mixed together
+    public static void PutOfflineAudio(ReadOnlyStereoSignal<double> signal)
+    {
+        if (sOfflineOutput is null)
+        {
+            throw new InvalidOperationException("Rack is not rendering offline!");
+        }
 
-                    cable?.ResetSignal();
-                    outputs[i] = cable;
+        int channels = Math.Min(signal.Channels, sOfflineOutput.Channels);
+        int length = Math.Min(signal.Length, sOfflineOutput.Length);
+
+        for (int i = 0; i < channels; i++)
+        {
+            var destination = sOfflineOutput[i].AsSpan().Slice(0, length);
+            SignalMath<double>.Add(destination, signal[i].AsSpan().Slice(0, length), destination);
+        }
+    }
+
+    private static double GetPeak(StereoSignal<double> signal, int length)
+    {
+        double peak = 0;
+        for (int i = 0; i < signal.Channels; i++)
+        {
+            foreach (double sample in signal[i].AsSpan().Slice(0, length))
+            {
+                peak = Math.Max(peak, Math.Abs(sample));
+            }
+        }
+
+        return peak;
+    }
+
+    // starts rendering the rack into one or more files as fast as the graph allows, without
+    // waiting on any device; the render then advances a slice at a time from Update
+    // stops after the given length, or once the output has stayed silent for the given time
+    public static bool BeginBounce(IReadOnlyList<string> paths, TimeSpan? length, TimeSpan? silence)
+    {
+        if (length is null && silence is null)
+        {
+            throw new ArgumentException("A bounce needs a length, a silence timeout or both!");
+        }
+
+        UpdateSanityChecks();
+        if (sBounce is not null || sOfflineOutput is not null)
+        {
+            throw new InvalidOperationException("Rack is already rendering offline!");
+        }
+
+        long totalFrames = length is null ? long.MaxValue : (long)(length.Value.TotalSeconds * sSampleRate);
+        long silenceFrames = silence is null ? long.MaxValue : (long)(silence.Value.TotalSeconds * sSampleRate);
+
+        Log.Info($"Bouncing rack to {string.Join(", ", paths)}...");
+
+        try
+        {
+            sBounce = new BounceState(paths, totalFrames, silenceFrames);
+        }
+        catch (Exception ex)
+        {
+            Log.Error($"Failed to bounce rack: {ex.Message}");
+            return false;
+        }
+
+        return true;
+    }
+
+    public static bool BeginBounce(string path, TimeSpan? length, TimeSpan? silence)
+    {
+        return BeginBounce(new[] { path }, length, silence);
+    }
+
+    // renders a whole bounce before returning
+    public static bool Bounce(IReadOnlyList<string> paths, TimeSpan? length, TimeSpan? silence)
+    {
+        if (!BeginBounce(paths, length, silence))
+        {
+            return false;
+        }
+
+        bool succeeded = true;
+        while (sBounce is not null)
+        {
+            succeeded = StepBounce(TimeSpan.MaxValue);
+        }
+
+        return succeeded;
+    }
+
+    public static bool Bounce(string path, TimeSpan? length, TimeSpan? silence)
+    {
+        return Bounce(new[] { path }, length, silence);
+    }
+
+    // stops a running bounce, keeping what has been rendered so far
+    public static void CancelBounce()
+    {
+        if (sBounce is null)
+        {
+            return;
+        }
+
+        double seconds = (double)sBounce.Rendered / sSampleRate;
+        Log.Info($"Bounce cancelled after {seconds:0.##} s of audio");
+
+        sBounce.Dispose();
+        sBounce = null;
+    }
+
+    // fraction of a fixed-length bounce rendered so far; null if it runs until silence
+    public static float? BounceProgress
+    {
+        get
+        {
+            if (sBounce is null || sBounce.TotalFrames == long.MaxValue)
+            {
+                return null;
+            }
+
+            return (float)((double)sBounce.Rendered / sBounce.TotalFrames);
+        }
+    }
+
+    // renders blocks until the bounce is done or the budget is spent
+    // returns false if the bounce failed, in which case it is stopped
+    private static bool StepBounce(TimeSpan budget)
+    {
+        var bounce = sBounce!;
+        var slice = Stopwatch.StartNew();
+
+        try
+        {
+            while (!bounce.IsDone && slice.Elapsed < budget)
+            {
+                long remaining = bounce.TotalFrames - bounce.Rendered;
+                int blockSize = (int)Math.Min(OfflineBlockSize, remaining);
+
+                // rented cleared, and kept past the cycle until it has been encoded
+                sOfflineOutput = StereoSignal<double>.Rent(sChannels, blockSize);
+                ProcessCycle();
+
+                bounce.Encoder.Write(sOfflineOutput, 0, blockSize);
+                bounce.Rendered += blockSize;
+
+                if (GetPeak(sOfflineOutput, blockSize) < SilenceThreshold)
+                {
+                    bounce.SilentFor += blockSize;
+                }
+                else
+                {
+                    bounce.SilentFor = 0;
                 }
 
-                node.Update(inputs, outputs);
+                SignalPool.ReturnAll();
+            }
+
+            if (bounce.IsDone)
+            {
+                bounce.Encoder.Finish();
             }
         }
         catch (Exception ex)
         {
-            Log.Error($"Error processing audio: {ex}");
+            Log.Error($"Failed to bounce rack: {ex.Message}");
+
+            bounce.Dispose();
+            sBounce = null;
+
+            return false;
+        }
+        finally
+        {
+            sOfflineOutput = null;
+            SignalPool.ReturnAll();
         }
 
-        sSamplesRequested = -1;
+        if (!bounce.IsDone)
+        {
+            return true;
+        }
+
+        double seconds = (double)bounce.Rendered / sSampleRate;
+        double elapsed = bounce.Stopwatch.Elapsed.TotalSeconds;
+
+        Log.Info($"Bounced {seconds:0.##} s of audio to {bounce.Paths} in {elapsed:0.##} s ({seconds / Math.Max(elapsed, 1e-3):0.#}x realtime)");
+
+        bounce.Dispose();
+        sBounce = null;
+
+        return true;
+    }
+
+    private static void RenderBounceProgress()
+    {
+        if (sBounce is null)
+        {
+            return;
+        }
+
+        ImGui.SetNextWindowSize(new Vector2(320f, 0f), ImGuiCond.Appearing);
+        if (ImGui.Begin("Bouncing", ImGuiWindowFlags.NoCollapse | ImGuiWindowFlags.NoSavedSettings))
+        {
+            double seconds = (double)sBounce.Rendered / sSampleRate;
+            ImGui.TextUnformatted(sBounce.Paths);
+
+            var progress = BounceProgress;
+            if (progress is not null)
+            {
+                ImGui.ProgressBar(progress.Value, Vector2.UnitX * -1f, $"{seconds:0.#} s");
+            }
+            else
+            {
+                ImGui.Text($"{seconds:0.#} s rendered, waiting for silence");
+            }
+
+            if (ImGui.Button("Cancel"))
+            {
+                CancelBounce();
+            }
+        }
+
+        ImGui.End();
     }
 
     private static int GetNodeInputID(NodeMeta meta, int index)
@@ -461,8 +900,20 @@ public static class Rack
     }
 
     private static int sContextNode = -1;
+
+    // how long a bounce that stops at silence waits before it does
+    private static readonly TimeSpan BounceSilence = TimeSpan.FromSeconds(2);
+
+    private static string sBouncePaths = "bounce.wav";
+    private static bool sBounceHasLength = true;
+    private static float sBounceSeconds = 60f;
+    private static bool sBounceStopsAtSilence = true;
+
     public static void Render(ref bool show)
     {
+        // shown even while the rack itself is hidden, so that a bounce can always be cancelled
+        RenderBounceProgress();
+
         if (!show)
         {
             return;
@@ -508,10 +959,11 @@ public static class Rack
             {
                 if (ImGui.BeginMenu("Add"))
                 {
-                    var plugins = Plugin.Plugins;
+                    // plugins from the index are only loaded once they're picked
+                    var names = Plugin.Names;
                     int pluginIndex = 0;
 
-                    foreach ((var name, var plugin) in plugins)
+                    foreach (var name in names)
                     {
                         ImGui.PushID($"plugin-{pluginIndex}");
 
@@ -519,8 +971,11 @@ public static class Rack
                         {
                             Log.Info($"Adding module from plugin {name}");
 
-                            var module = plugin.Instantiate();
-                            Rack.AddModule(module);
+                            var plugin = Plugin.Get(name);
+                            if (plugin is not null)
+                            {
+                                _ = Rack.AddModuleAsync(plugin);
+                            }
                         }
 
                         ImGui.PopID();
@@ -529,6 +984,38 @@ public static class Rack
                     ImGui.EndMenu();
                 }
 
+                if (ImGui.BeginMenu("Bounce", sBounce is null))
+                {
+                    // several files, separated by semicolons, are encoded from a single render
+                    ImGui.InputText("Files", ref sBouncePaths, 512);
+                    ImGui.Checkbox("Fixed length", ref sBounceHasLength);
+
+                    ImGui.BeginDisabled(!sBounceHasLength);
+                    ImGui.InputFloat("Seconds", ref sBounceSeconds);
+                    ImGui.EndDisabled();
+
+                    ImGui.Checkbox("Stop at silence", ref sBounceStopsAtSilence);
+
+                    bool hasLength = sBounceHasLength && sBounceSeconds > 0f;
+                    bool hasPaths = !string.IsNullOrWhiteSpace(sBouncePaths.Replace(';', ' '));
+                    ImGui.BeginDisabled(!hasPaths || (!hasLength && !sBounceStopsAtSilence));
+
+                    if (ImGui.Button("Render"))
+                    {
+                        TimeSpan? length = hasLength ? TimeSpan.FromSeconds(sBounceSeconds) : null;
+                        TimeSpan? silence = sBounceStopsAtSilence ? BounceSilence : null;
+                        var paths = sBouncePaths.Split(';', StringSplitOptions.TrimEntries |
+                                                           StringSplitOptions.RemoveEmptyEntries);
+
+                        BeginBounce(paths, length, silence);
+
+                        ImGui.CloseCurrentPopup();
+                    }
+
+                    ImGui.EndDisabled();
+                    ImGui.EndMenu();
+                }
+
                 ImGui.EndPopup();
             }
 
@@ -0,0 +1,190 @@
+#include "schmixpch.h"
+#include "schmix/audio/CaptureBuffer.h"
+
+#include "schmix/encoding/FileEncoder.h"
+
+namespace schmix {
+    // extra ring past the requested duration, in seconds
+    // a save reads from the oldest end while the writer keeps going, so it needs a head start
+    static constexpr double s_GuardDuration = 1.0;
+
+    // frames per channel converted and encoded at a time while saving
+    static constexpr std::size_t s_BlockFrames = 4096;
+
+    static constexpr double s_SampleScale = 32767.0;
+
+    static std::int16_t ToStored(double sample) {
+        return (std::int16_t)std::lrint(std::clamp(sample, -1.0, 1.0) * s_SampleScale);
+    }
+
+    CaptureBuffer::CaptureBuffer(std::size_t channels, std::size_t sampleRate, double duration) {
+        m_Initialized = false;
+
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+
+        m_Claimed.store(0);
+        m_Published.store(0);
+        m_SaveState.store(SaveState::Idle);
+
+        m_DurationFrames = (std::size_t)(std::max(duration, 0.0) * (double)sampleRate);
+        m_CapacityFrames = m_DurationFrames + (std::size_t)(s_GuardDuration * (double)sampleRate);
+
+        if (m_Channels == 0 || m_DurationFrames == 0) {
+            SCHMIX_ERROR("Capture buffer cannot be empty!");
+            return;
+        }
+
+        // the whole budget is committed here rather than on first use
+        m_Samples.assign(m_CapacityFrames * m_Channels, 0);
+
+        SCHMIX_DEBUG("Capturing {:.1f} s of {} channels in {} bytes", duration, m_Channels,
+                     GetMemoryUsage());
+
+        m_Initialized = true;
+    }
+
+    CaptureBuffer::~CaptureBuffer() {
+        if (m_SaveThread.joinable()) {
+            m_SaveThread.join();
+        }
+    }
+
+    void CaptureBuffer::Write(const double* const* channels, std::size_t frames) {
+        if (!m_Initialized || frames == 0) {
+            return;
+        }
+
+        std::uint64_t position = m_Published.load(std::memory_order_relaxed);
+
+        // claimed before touching the ring, so that a save reading the same frames notices
+        m_Claimed.store(position + frames, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::size_t index = (std::size_t)(position % m_CapacityFrames);
+        for (std::size_t i = 0; i < frames; i++) {
+            std::int16_t* frame = m_Samples.data() + index * m_Channels;
+            for (std::size_t j = 0; j < m_Channels; j++) {
+                frame[j] = ToStored(channels[j][i]);
+            }
+
+            if (++index == m_CapacityFrames) {
+                index = 0;
+            }
+        }
+
+        m_Published.store(position + frames, std::memory_order_release);
+    }
+
+    double CaptureBuffer::GetCapturedDuration() const {
+        std::uint64_t published = m_Published.load(std::memory_order_acquire);
+        auto frames = std::min<std::uint64_t>(published, m_DurationFrames);
+
+        return (double)frames / (double)m_SampleRate;
+    }
+
+    double CaptureBuffer::GetDuration() const {
+        return (double)m_DurationFrames / (double)m_SampleRate;
+    }
+
+    bool CaptureBuffer::Save(const std::filesystem::path& path, double seconds) {
+        if (!m_Initialized) {
+            SCHMIX_ERROR("Capture buffer is not initialized!");
+            return false;
+        }
+
+        if (GetSaveState() == SaveState::Saving) {
+            SCHMIX_WARN("A capture is already being saved");
+            return false;
+        }
+
+        if (m_SaveThread.joinable()) {
+            m_SaveThread.join();
+        }
+
+        std::uint64_t end = m_Published.load(std::memory_order_acquire);
+        auto requested = (std::uint64_t)(std::max(seconds, 0.0) * (double)m_SampleRate);
+        auto frames = std::min({ requested, end, (std::uint64_t)m_DurationFrames });
+
+        if (frames == 0) {
+            SCHMIX_WARN("Nothing has been captured to save");
+            return false;
+        }
+
+        m_SaveState.store(SaveState::Saving, std::memory_order_release);
+        std::uint64_t begin = end - frames;
+        m_SaveThread = std::thread([this, path, begin, end]() { Encode(path, begin, end); });
+
+        return true;
+    }
+
+    bool CaptureBuffer::ReadFrames(std::uint64_t begin, std::size_t frames,
+                                   double* const* planes) const {
+        std::size_t index = (std::size_t)(begin % m_CapacityFrames);
+        for (std::size_t i = 0; i < frames; i++) {
+            const std::int16_t* frame = m_Samples.data() + index * m_Channels;
+            for (std::size_t j = 0; j < m_Channels; j++) {
+                planes[j][i] = (double)frame[j] / s_SampleScale;
+            }
+
+            if (++index == m_CapacityFrames) {
+                index = 0;
+            }
+        }
+
+        // checked after the copy; any write that overlapped it has claimed past our frames
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::uint64_t claimed = m_Claimed.load(std::memory_order_relaxed);
+
+        return claimed <= begin + m_CapacityFrames;
+    }
+
+    void CaptureBuffer::Encode(std::filesystem::path path, std::uint64_t begin,
+                               std::uint64_t end) {
+        auto streams = FileEncoder::Open(path, m_Channels, m_SampleRate, 1);
+        bool success = streams.has_value() &&
+                       FileEncoder::Connect(*streams->Codec, streams->Format.get(), m_Channels,
+                                            m_SampleRate, Resampler::Quality::Balanced);
+
+        if (success) {
+            std::vector<double> block(s_BlockFrames * m_Channels);
+            std::vector<double*> planes(m_Channels);
+
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                planes[i] = block.data() + i * s_BlockFrames;
+            }
+
+            for (std::uint64_t position = begin; success && position < end;) {
+                auto frames = (std::size_t)std::min<std::uint64_t>(s_BlockFrames, end - position);
+
+                if (!ReadFrames(position, frames, planes.data())) {
+                    SCHMIX_ERROR("Capture was overwritten while being saved");
+                    success = false;
+                    break;
+                }
+
+                success = streams->Codec->WriteSignal(planes.data(), m_Channels, frames);
+                position += frames;
+            }
+
+            success = success && streams->Codec->Flush() && streams->Format->Finish();
+
+            // the codec writes into the muxer
+            streams->Codec.reset();
+            streams->Format.reset();
+        }
+
+        if (!success) {
+            SCHMIX_ERROR("Failed to save capture to {}", path.string().c_str());
+
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        } else {
+            double seconds = (double)(end - begin) / (double)m_SampleRate;
+            SCHMIX_INFO("Saved {:.1f} s of capture to {}", seconds, path.string().c_str());
+        }
+
+        m_SaveState.store(success ? SaveState::Succeeded : SaveState::Failed,
+                          std::memory_order_release);
+    }
+} // namespace schmix
@@ -0,0 +1,64 @@
+#pragma once
+#include "schmix/core/Ref.h"
+
+#include <thread>
+
+namespace schmix {
+    // keeps the last stretch of audio written to it, ready to be saved after the fact
+    // samples are stored as 16-bit integers in a ring sized once up front, so memory use never
+    // changes while capturing; saving encodes straight out of the ring on a thread of its own
+    class CaptureBuffer : public RefCounted {
+    public:
+        enum class SaveState : std::int32_t { Idle = 0, Saving, Succeeded, Failed };
+
+        CaptureBuffer(std::size_t channels, std::size_t sampleRate, double duration);
+        virtual ~CaptureBuffer() override;
+
+        CaptureBuffer(const CaptureBuffer&) = delete;
+        CaptureBuffer& operator=(const CaptureBuffer&) = delete;
+
+        // processing thread only; never allocates, locks or waits
+        void Write(const double* const* channels, std::size_t frames);
+
+        // encodes up to the given number of seconds leading up to now into a file, in the
+        // background; the container and codec are picked from the file name
+        // false if a save is already running or nothing has been captured
+        bool Save(const std::filesystem::path& path, double seconds);
+
+        SaveState GetSaveState() const { return m_SaveState.load(std::memory_order_acquire); }
+
+        // in seconds; what a save can reach back, growing up to the duration asked for
+        double GetCapturedDuration() const;
+        double GetDuration() const;
+
+        // the ring itself, fixed at construction
+        // it holds a little more than the duration so that a full-length save never races the
+        // writer; a save only adds one small conversion block on top
+        std::size_t GetMemoryUsage() const { return m_Samples.size() * sizeof(std::int16_t); }
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+
+        bool IsInitialized() const { return m_Initialized; }
+
+    private:
+        void Encode(std::filesystem::path path, std::uint64_t begin, std::uint64_t end);
+
+        // converts one run of frames out of the ring; false if the writer got there first
+        bool ReadFrames(std::uint64_t begin, std::size_t frames, double* const* planes) const;
+
+        std::size_t m_Channels, m_SampleRate;
+
+        // interleaved frames, indexed by position modulo the capacity
+        std::vector<std::int16_t> m_Samples;
+        std::size_t m_CapacityFrames, m_DurationFrames;
+
+        // frames ever written; a write first claims its frames, then publishes them
+        std::atomic<std::uint64_t> m_Claimed, m_Published;
+
+        std::thread m_SaveThread;
+        std::atomic<SaveState> m_SaveState;
+
+        bool m_Initialized;
+    };
+} // namespace schmix
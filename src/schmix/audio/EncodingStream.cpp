@@ -1,11 +1,8 @@
 #include "schmixpch.h"
 #include "schmix/audio/EncodingStream.h"
 
-extern "C" {
-#include <libavcodec/avcodec.h>
-#include <libavutil/avutil.h>
-#include <libavformat/avformat.h>
-}
+#include "schmix/encoding/FFmpeg.h"
+#include "schmix/encoding/PCM.h"
 
 namespace schmix {
     static AVCodecID ConvertCodecID(EncodingStream::Codec codec) {
@@ -19,8 +16,35 @@ namespace schmix {
         }
     }
 
+    static AVSampleFormat ConvertSampleFormat(EncodingStream::SampleFormat format) {
+        switch (format) {
+        case EncodingStream::SampleFormat::U8:
+            return AV_SAMPLE_FMT_U8;
+        case EncodingStream::SampleFormat::S16:
+            return AV_SAMPLE_FMT_S16;
+        case EncodingStream::SampleFormat::S32:
+            return AV_SAMPLE_FMT_S32;
+        case EncodingStream::SampleFormat::Float:
+            return AV_SAMPLE_FMT_FLT;
+        case EncodingStream::SampleFormat::Double:
+            return AV_SAMPLE_FMT_DBL;
+        default:
+            throw std::runtime_error("Invalid sample format!");
+        }
+    }
+
     std::optional<EncodingStream::Codec> EncodingStream::GuessCodec(
         const std::filesystem::path& filename) {
+        auto container = PCM::GuessContainer(filename);
+        if (container.has_value()) {
+            switch (container.value()) {
+            case PCM::Container::WAV:
+                return Codec::WAV;
+            case PCM::Container::Raw:
+                return Codec::Raw;
+            }
+        }
+
         static std::unordered_map<AVCodecID, Codec> codecMap;
         if (codecMap.empty()) {
             for (std::int32_t i = 0; i < (std::int32_t)Codec::MAX; i++) {
@@ -50,7 +74,8 @@ namespace schmix {
     }
 
     EncodingStream::EncodingStream(Codec codec, Action action, std::size_t channels,
-                                   std::size_t sampleRate, SampleFormat sampleFormat) {
+                                   std::size_t sampleRate, SampleFormat sampleFormat,
+                                   Resampler::Quality quality) {
         m_Initialized = false;
 
         m_CodecID = codec;
@@ -59,17 +84,69 @@ namespace schmix {
         m_Channels = channels;
         m_SampleRate = sampleRate;
         m_SampleFormat = sampleFormat;
+        m_Quality = quality;
 
         m_Codec = nullptr;
         m_Context = nullptr;
 
-        auto id = ConvertCodecID(codec);
+        m_Frame = nullptr;
+        m_ConvertedFrame = nullptr;
+        m_Packet = nullptr;
+
+        m_PacketsQueued = 0;
+        m_PacketsRead = 0;
+        m_NextPTS = 0;
+
+        // a header sized on close needs a seekable file, which a packet stream never has
+        if (codec == Codec::WAV || codec == Codec::Raw) {
+            SCHMIX_ERROR("WAV and raw PCM have no packet codec - write them with PCM::Writer");
+            return;
+        }
+
+        if (!OpenCodec()) {
+            return;
+        }
+
+        m_Frame = av_frame_alloc();
+        m_ConvertedFrame = av_frame_alloc();
+        m_Packet = av_packet_alloc();
+
+        if (m_Frame == nullptr || m_ConvertedFrame == nullptr || m_Packet == nullptr) {
+            SCHMIX_ERROR("Failed to allocate frame or packet!");
+            return;
+        }
+
+        // decoders only report their output format once frames come out
+        if (action == Action::Encoding && GetRequestedFormat() != GetCodecFormat()) {
+            m_Resampler = std::make_unique<Resampler>(GetRequestedFormat(), GetCodecFormat(),
+                                                      m_Quality);
+            if (!m_Resampler->IsInitialized()) {
+                return;
+            }
+        }
+
+        if (action == Action::Encoding) {
+            // codecs that take any frame size get every write as it comes
+            std::size_t frameSize = (std::size_t)m_Context->frame_size;
+            if ((m_Codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) != 0) {
+                frameSize = 0;
+            }
+
+            m_FIFO = std::make_unique<AudioFIFO>((std::size_t)m_Context->ch_layout.nb_channels,
+                                                 m_Context->sample_fmt, frameSize);
+        }
+
+        m_Initialized = true;
+    }
+
+    bool EncodingStream::OpenCodec() {
+        auto id = ConvertCodecID(m_CodecID);
         if (id == AV_CODEC_ID_NONE) {
             SCHMIX_ERROR("Unsupported codec!");
-            return;
+            return false;
         }
 
-        switch (action) {
+        switch (m_Action) {
         case Action::Encoding:
             m_Codec = avcodec_find_encoder(id);
             break;
@@ -78,33 +155,46 @@ namespace schmix {
             break;
         default:
             SCHMIX_ERROR("Invalid action!");
-            return;
+            return false;
         }
 
         if (m_Codec == nullptr) {
             SCHMIX_ERROR("Failed to find codec!");
-            return;
+            return false;
         }
 
         m_Context = avcodec_alloc_context3(m_Codec);
         if (m_Context == nullptr) {
             SCHMIX_ERROR("Failed to allocate context!");
-            return;
+            return false;
         }
 
         SelectChannels();
         SelectSampleRate();
         SelectSampleFormat();
 
+        // timestamps count samples
+        if (m_Action == Action::Encoding) {
+            m_Context->time_base = { 1, m_Context->sample_rate };
+        }
+
         if (avcodec_open2(m_Context, m_Codec, nullptr) < 0) {
             SCHMIX_ERROR("Failed to open codec!");
-            return;
+            return false;
         }
 
-        m_Initialized = true;
+        return true;
     }
 
     EncodingStream::~EncodingStream() {
+        for (auto packet : m_Packets) {
+            av_packet_free(&packet);
+        }
+
+        av_frame_free(&m_Frame);
+        av_frame_free(&m_ConvertedFrame);
+        av_packet_free(&m_Packet);
+
         if (m_Context != nullptr) {
             avcodec_free_context(&m_Context);
         }
@@ -121,46 +211,127 @@ namespace schmix {
             return false;
         }
 
-        auto avFrame = av_frame_alloc();
-        if (avFrame == nullptr) {
-            SCHMIX_ERROR("Failed to allocate AV frame!");
+        auto input = (const std::uint8_t*)pcm;
+        auto sink = [this](const std::uint8_t* const* planes, std::size_t frames) {
+            return SendFrame(planes, frames);
+        };
+
+        // the requested format is packed, so without conversion it goes in as a single plane
+        if (!m_Resampler) {
+            return m_FIFO->Write(&input, length, sink);
+        }
+
+        if (!m_Resampler->ConvertFrame(&input, length, m_ConvertedFrame, m_BufferPool)) {
             return false;
         }
 
-        avFrame->nb_samples = length;
-        avFrame->sample_rate = m_Context->sample_rate;
-        avFrame->ch_layout = m_Context->ch_layout;
+        bool written = m_FIFO->Write(m_ConvertedFrame->extended_data,
+                                     (std::size_t)m_ConvertedFrame->nb_samples, sink);
 
-        std::size_t bufferSize =
-            av_samples_get_buffer_size(nullptr, m_Channels, length, m_Context->sample_fmt, 0);
+        av_frame_unref(m_ConvertedFrame);
+        return written;
+    }
 
-        void* frameData = Memory::Allocate(bufferSize + AV_INPUT_BUFFER_PADDING_SIZE);
-        Memory::Copy(pcm, frameData, bufferSize);
+    bool EncodingStream::Finish() {
+        if (!m_Initialized) {
+            SCHMIX_ERROR("Encoding stream not fully initialized!");
+            return false;
+        }
 
-        int ret = avcodec_fill_audio_frame(avFrame, m_Context->ch_layout.nb_channels,
-                                           m_Context->sample_fmt, (const uint8_t*)frameData,
-                                           (int)bufferSize, 0);
+        if (m_Action != Action::Encoding) {
+            SCHMIX_ERROR("Attempted to finish a non-encoding stream!");
+            return false;
+        }
 
-        if (ret < 0) {
-            SCHMIX_ERROR("Failed to set up AV frame pointers!");
+        auto sink = [this](const std::uint8_t* const* planes, std::size_t frames) {
+            return SendFrame(planes, frames);
+        };
+
+        // the resampler's tail, then the last short frame, then whatever the encoder holds
+        if (m_Resampler) {
+            if (!m_Resampler->ConvertFrame(nullptr, 0, m_ConvertedFrame, m_BufferPool)) {
+                return false;
+            }
 
-            Memory::Free(frameData);
-            av_frame_free(&avFrame);
+            bool written = m_FIFO->Write(m_ConvertedFrame->extended_data,
+                                         (std::size_t)m_ConvertedFrame->nb_samples, sink);
 
+            av_frame_unref(m_ConvertedFrame);
+            if (!written) {
+                return false;
+            }
+        }
+
+        if (!m_FIFO->Flush(sink)) {
             return false;
         }
 
-        ret = avcodec_send_frame(m_Context, avFrame);
+        if (avcodec_send_frame(m_Context, nullptr) < 0) {
+            SCHMIX_ERROR("Failed to drain encoder!");
+            return false;
+        }
+
+        return ReceivePackets();
+    }
+
+    bool EncodingStream::SendFrame(const std::uint8_t* const* planes, std::size_t length) {
+        std::size_t channels = (std::size_t)m_Context->ch_layout.nb_channels;
+        auto sampleFormat = m_Context->sample_fmt;
+
+        m_Frame->nb_samples = (int)length;
+        m_Frame->format = (int)sampleFormat;
+        m_Frame->sample_rate = m_Context->sample_rate;
+        m_Frame->pts = m_NextPTS;
+        av_channel_layout_copy(&m_Frame->ch_layout, &m_Context->ch_layout);
+
+        // copied once into a pooled buffer; the encoder keeps a reference to that rather than
+        // making its own copy, and the buffer goes back to the pool once it lets go
+        if (!m_BufferPool.GetFrame(m_Frame)) {
+            av_frame_unref(m_Frame);
+            return false;
+        }
 
-        Memory::Free(frameData);
-        av_frame_free(&avFrame);
+        av_samples_copy(m_Frame->extended_data, (std::uint8_t* const*)planes, 0, 0, (int)length,
+                        (int)channels, sampleFormat);
+
+        int ret = avcodec_send_frame(m_Context, m_Frame);
+        av_frame_unref(m_Frame);
 
         if (ret < 0) {
             SCHMIX_ERROR("Failed to send AV frame!");
             return false;
         }
 
-        return true;
+        m_NextPTS += (std::int64_t)length;
+
+        // taken out right away, so one write can span any number of frames
+        return ReceivePackets();
+    }
+
+    bool EncodingStream::ReceivePackets() {
+        while (true) {
+            if (m_PacketsQueued == m_Packets.size()) {
+                auto packet = av_packet_alloc();
+                if (packet == nullptr) {
+                    SCHMIX_ERROR("Failed to allocate packet!");
+                    return false;
+                }
+
+                m_Packets.push_back(packet);
+            }
+
+            int ret = avcodec_receive_packet(m_Context, m_Packets[m_PacketsQueued]);
+            if (ret < 0) {
+                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                    return true;
+                }
+
+                SCHMIX_ERROR("Error retrieving encoded packet!");
+                return false;
+            }
+
+            m_PacketsQueued++;
+        }
     }
 
     bool EncodingStream::DecodePacket(const void* data, std::size_t dataSize) {
@@ -174,23 +345,19 @@ namespace schmix {
             return false;
         }
 
-        void* packetData = av_malloc(dataSize + AV_INPUT_BUFFER_PADDING_SIZE);
-        Memory::Copy(data, packetData, dataSize);
-
-        auto avPacket = av_packet_alloc();
-        int ret = av_packet_from_data(avPacket, (uint8_t*)packetData, dataSize);
-
-        if (ret < 0) {
-            SCHMIX_ERROR("Failed to attach memory chunk to packet!");
-
-            av_freep(&packetData);
-            av_packet_free(&avPacket);
-
+        auto buffer = m_BufferPool.Get(dataSize);
+        if (buffer == nullptr) {
             return false;
         }
 
-        ret = avcodec_send_packet(m_Context, avPacket);
-        av_packet_unref(avPacket);
+        Memory::Copy(data, buffer->data, dataSize);
+
+        m_Packet->buf = buffer;
+        m_Packet->data = buffer->data;
+        m_Packet->size = (int)dataSize;
+
+        int ret = avcodec_send_packet(m_Context, m_Packet);
+        av_packet_unref(m_Packet);
 
         if (ret < 0) {
             SCHMIX_ERROR("Failed to send packet to decoding context!");
@@ -200,7 +367,7 @@ namespace schmix {
         return true;
     }
 
-    std::optional<void*> EncodingStream::GetEncodedPacket(std::size_t* dataSize) {
+    std::optional<const void*> EncodingStream::GetEncodedPacket(std::size_t* dataSize) {
         if (!m_Initialized) {
             SCHMIX_ERROR("Encoding stream not fully initialized!");
             return {};
@@ -211,36 +378,64 @@ namespace schmix {
             return {};
         }
 
-        auto outputPacket = av_packet_alloc();
-        if (outputPacket == nullptr) {
-            SCHMIX_ERROR("Failed to allocate output packet!");
+        // releases the previously returned packet
+        av_packet_unref(m_Packet);
+
+        if (m_PacketsRead == m_PacketsQueued) {
+            m_PacketsQueued = 0;
+            m_PacketsRead = 0;
+
+            return nullptr;
+        }
+
+        av_packet_move_ref(m_Packet, m_Packets[m_PacketsRead++]);
+
+        if (dataSize != nullptr) {
+            *dataSize = (std::size_t)m_Packet->size;
+        }
+
+        return m_Packet->data;
+    }
+
+    std::optional<const void*> EncodingStream::GetDecodedFrame(std::size_t* length,
+                                                               std::size_t* dataSize) {
+        auto received = ReceiveDecodedFrame();
+        if (!received.has_value()) {
             return {};
         }
 
-        int ret = avcodec_receive_packet(m_Context, outputPacket);
+        if (!received.value()) {
+            return nullptr;
+        }
 
-        std::optional<void*> allocatedPacket;
-        if (ret >= 0) {
-            std::size_t packetSize = outputPacket->size;
+        std::size_t frames = (std::size_t)m_Frame->nb_samples;
+        if (length != nullptr) {
+            *length = frames;
+        }
 
-            allocatedPacket = Memory::Allocate(packetSize);
-            Memory::Copy(outputPacket->data, allocatedPacket.value(), packetSize);
+        // the requested format is always packed
+        if (dataSize != nullptr) {
+            auto format = (AVSampleFormat)m_Frame->format;
+            *dataSize = frames * m_Channels * (std::size_t)av_get_bytes_per_sample(format);
+        }
 
-            if (dataSize != nullptr) {
-                *dataSize = packetSize;
-            }
-        } else if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            allocatedPacket = nullptr;
-        } else {
-            SCHMIX_ERROR("Error retrieving encoded packet!");
+        return m_Frame->extended_data[0];
+    }
+
+    std::optional<Ref<AudioFrame>> EncodingStream::GetDecodedAudioFrame() {
+        auto received = ReceiveDecodedFrame();
+        if (!received.has_value()) {
+            return {};
         }
 
-        av_packet_free(&outputPacket);
-        return allocatedPacket;
+        if (!received.value()) {
+            return Ref<AudioFrame>();
+        }
+
+        return Ref<AudioFrame>::Create(m_Frame);
     }
 
-    std::optional<void*> EncodingStream::GetDecodedFrame(std::size_t* length,
-                                                         std::size_t* dataSize) {
+    std::optional<bool> EncodingStream::ReceiveDecodedFrame() {
         if (!m_Initialized) {
             SCHMIX_ERROR("Encoding stream not fully initialized!");
             return {};
@@ -251,38 +446,96 @@ namespace schmix {
             return {};
         }
 
-        auto outputFrame = av_frame_alloc();
-        if (outputFrame == nullptr) {
-            SCHMIX_ERROR("Failed to allocate output frame!");
-            return {};
-        }
+        while (true) {
+            // releases the previously returned frame
+            av_frame_unref(m_Frame);
+
+            int ret = avcodec_receive_frame(m_Context, m_Frame);
 
-        int ret = avcodec_receive_frame(m_Context, outputFrame);
+            const std::uint8_t* const* input = nullptr;
+            std::size_t inputFrames = 0;
 
-        std::optional<void*> allocatedFrame;
-        if (ret >= 0) {
-            std::size_t sampleCount = outputFrame->nb_samples;
-            std::size_t bufferSize = av_samples_get_buffer_size(nullptr, m_Channels, sampleCount,
-                                                                m_Context->sample_fmt, 0);
+            if (ret >= 0) {
+                if (!PrepareDecodeConversion(m_Frame)) {
+                    return {};
+                }
 
-            allocatedFrame = Memory::Allocate(bufferSize);
-            Memory::Copy(outputFrame->data, allocatedFrame.value(), bufferSize);
+                // already in the requested format; hand out the decoder's own buffer
+                if (!m_Resampler) {
+                    return true;
+                }
 
-            if (length != nullptr) {
-                *length = sampleCount;
+                input = m_Frame->extended_data;
+                inputFrames = (std::size_t)m_Frame->nb_samples;
+            } else if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                // drain whatever the resampler is holding once the decoder is done
+                if (ret == AVERROR(EAGAIN) || !m_Resampler) {
+                    return false;
+                }
+            } else {
+                SCHMIX_ERROR("Error retrieving decoded frame!");
+                return {};
             }
 
-            if (dataSize != nullptr) {
-                *dataSize = bufferSize;
+            bool converted =
+                m_Resampler->ConvertFrame(input, inputFrames, m_ConvertedFrame, m_BufferPool);
+
+            av_frame_unref(m_Frame);
+            if (!converted) {
+                return {};
+            }
+
+            if (m_ConvertedFrame->nb_samples > 0) {
+                av_frame_move_ref(m_Frame, m_ConvertedFrame);
+                return true;
+            }
+
+            av_frame_unref(m_ConvertedFrame);
+            if (ret < 0) {
+                return false;
             }
-        } else if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            allocatedFrame = nullptr;
-        } else {
-            SCHMIX_ERROR("Error retrieving decoded frame!");
         }
+    }
+
+    Resampler::Format EncodingStream::GetRequestedFormat() const {
+        Resampler::Format format;
+        format.Channels = m_Channels;
+        format.SampleRate = m_SampleRate;
+        format.SampleFormat = ConvertSampleFormat(m_SampleFormat);
 
-        av_frame_free(&outputFrame);
-        return allocatedFrame;
+        return format;
+    }
+
+    Resampler::Format EncodingStream::GetCodecFormat() const {
+        Resampler::Format format;
+        format.Channels = (std::size_t)m_Context->ch_layout.nb_channels;
+        format.SampleRate = (std::size_t)m_Context->sample_rate;
+        format.SampleFormat = m_Context->sample_fmt;
+
+        return format;
+    }
+
+    bool EncodingStream::PrepareDecodeConversion(const AVFrame* frame) {
+        Resampler::Format input;
+        input.Channels = (std::size_t)frame->ch_layout.nb_channels;
+        input.SampleRate = (std::size_t)frame->sample_rate;
+        input.SampleFormat = frame->format;
+
+        if (m_Resampler) {
+            if (m_Resampler->GetInputFormat() == input) {
+                return true;
+            }
+        } else if (input == GetRequestedFormat()) {
+            return true;
+        }
+
+        m_Resampler = std::make_unique<Resampler>(input, GetRequestedFormat(), m_Quality);
+        if (!m_Resampler->IsInitialized()) {
+            m_Resampler.reset();
+            return false;
+        }
+
+        return true;
     }
 
     template <typename _Ty>
@@ -317,11 +570,8 @@ namespace schmix {
 
         m_Context->ch_layout = layouts[0];
 
-        std::size_t requested = m_Channels;
-        m_Channels = (std::size_t)m_Context->ch_layout.nb_channels;
-
-        SCHMIX_WARN("No support found for {} channels - using first supported ({} channels)",
-                    requested, m_Channels);
+        SCHMIX_WARN("No support found for {} channels - converting to {} channels", m_Channels,
+                    m_Context->ch_layout.nb_channels);
     }
 
     void EncodingStream::SelectSampleRate() {
@@ -349,28 +599,8 @@ namespace schmix {
         } else {
             m_Context->sample_rate = rates[0];
 
-            std::size_t requested = m_SampleRate;
-            m_SampleRate = (std::size_t)m_Context->sample_rate;
-
-            SCHMIX_WARN("No support found for sample rate of {} Hz - using first supported ({} Hz)",
-                        requested, m_SampleRate);
-        }
-    }
-
-    static AVSampleFormat ConvertSampleFormat(EncodingStream::SampleFormat format) {
-        switch (format) {
-        case EncodingStream::SampleFormat::U8:
-            return AV_SAMPLE_FMT_U8;
-        case EncodingStream::SampleFormat::S16:
-            return AV_SAMPLE_FMT_S16;
-        case EncodingStream::SampleFormat::S32:
-            return AV_SAMPLE_FMT_S32;
-        case EncodingStream::SampleFormat::Float:
-            return AV_SAMPLE_FMT_FLT;
-        case EncodingStream::SampleFormat::Double:
-            return AV_SAMPLE_FMT_DBL;
-        default:
-            throw std::runtime_error("Invalid sample format!");
+            SCHMIX_WARN("No support found for sample rate of {} Hz - resampling to {} Hz",
+                        m_SampleRate, m_Context->sample_rate);
         }
     }
 
@@ -401,7 +631,8 @@ namespace schmix {
             selectedFormat = requestedFormat;
         } else {
             selectedFormat = formats[0];
-            SCHMIX_WARN("No support found for requested sample format - using default");
+            SCHMIX_WARN("No support found for requested sample format - converting to {}",
+                        av_get_sample_fmt_name(selectedFormat));
         }
 
         switch (m_Action) {
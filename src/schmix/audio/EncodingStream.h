@@ -1,12 +1,22 @@
 #pragma once
+#include "schmix/encoding/Resampler.h"
+#include "schmix/encoding/BufferPool.h"
+#include "schmix/encoding/AudioFrame.h"
+#include "schmix/encoding/AudioFIFO.h"
 
 typedef struct AVCodec AVCodec;
 typedef struct AVCodecContext AVCodecContext;
+typedef struct AVFrame AVFrame;
+typedef struct AVPacket AVPacket;
 
 namespace schmix {
+    // pcm passed in or handed out is always in the requested format
+    // formats the codec does not support are converted on the way through
     class EncodingStream {
     public:
-        enum class Codec : std::int32_t { MP3 = 0, OGG, MAX };
+        // wav and raw are guessed so that callers can route them to PCM::Writer; they have no
+        // packet codec, and a stream cannot be opened with them
+        enum class Codec : std::int32_t { MP3 = 0, OGG, WAV, Raw, MAX };
         enum class Action : std::int32_t { Encoding = 0, Decoding };
         enum class SampleFormat : std::int32_t { U8 = 0, S16, S32, Float, Double };
 
@@ -15,21 +25,31 @@ namespace schmix {
         static std::optional<Codec> GuessCodec(const std::filesystem::path& filename);
 
         EncodingStream(Codec codec, Action action, std::size_t channels, std::size_t sampleRate,
-                       SampleFormat sampleFormat);
+                       SampleFormat sampleFormat,
+                       Resampler::Quality quality = Resampler::Quality::Balanced);
 
         ~EncodingStream();
 
         EncodingStream(const EncodingStream&) = delete;
         EncodingStream& operator=(const EncodingStream&) = delete;
 
+        // any length may be passed; samples are re-chunked to the encoder's frame size
         bool EncodeFrame(const void* pcm, std::size_t length);
+
+        // encodes the last short frame and drains the encoder; nothing may be encoded afterwards
+        bool Finish();
+
         bool DecodePacket(const void* data, std::size_t dataSize);
 
-        // free return chunk with Memory::Free
+        // returned chunks are owned by the stream and stay valid until the next call
         // empty optional means error
         // null chunk means no chunks left
-        std::optional<void*> GetEncodedPacket(std::size_t* dataSize);
-        std::optional<void*> GetDecodedFrame(std::size_t* length, std::size_t* dataSize);
+        std::optional<const void*> GetEncodedPacket(std::size_t* dataSize);
+        std::optional<const void*> GetDecodedFrame(std::size_t* length, std::size_t* dataSize);
+
+        // same as above, but the frame stays valid for as long as it is referenced
+        // empty optional means error; a null frame means no frames left
+        std::optional<Ref<AudioFrame>> GetDecodedAudioFrame();
 
         Codec GetCodecID() const { return m_CodecID; }
         Action GetAction() const { return m_Action; }
@@ -41,19 +61,50 @@ namespace schmix {
         bool IsInitialized() const { return m_Initialized; }
 
     private:
+        bool OpenCodec();
+
         void SelectChannels();
         void SelectSampleRate();
         void SelectSampleFormat();
 
+        Resampler::Format GetRequestedFormat() const;
+        Resampler::Format GetCodecFormat() const;
+        bool PrepareDecodeConversion(const AVFrame* frame);
+
+        // leaves the next frame in m_Frame, converted to the requested format
+        std::optional<bool> ReceiveDecodedFrame();
+
+        // sends one frame in the codec's format and queues up the packets it produces
+        bool SendFrame(const std::uint8_t* const* planes, std::size_t length);
+        bool ReceivePackets();
+
         Codec m_CodecID;
         Action m_Action;
 
         std::size_t m_Channels, m_SampleRate;
         SampleFormat m_SampleFormat;
+        Resampler::Quality m_Quality;
 
         const AVCodec* m_Codec;
         AVCodecContext* m_Context;
 
+        // only present when the codec and requested formats differ
+        std::unique_ptr<Resampler> m_Resampler;
+
+        // reused across calls; the frame doubles as encoder input and decoder output, and the
+        // packet as decoder input and encoder output
+        AVFrame* m_Frame;
+        AVFrame* m_ConvertedFrame;
+        AVPacket* m_Packet;
+        BufferPool m_BufferPool;
+
+        // encoding only; samples short of a whole frame, and packets not handed out yet
+        // the packets are allocated once and reused; the queue starts over once it is drained
+        std::unique_ptr<AudioFIFO> m_FIFO;
+        std::vector<AVPacket*> m_Packets;
+        std::size_t m_PacketsQueued, m_PacketsRead;
+        std::int64_t m_NextPTS;
+
         bool m_Initialized;
     };
 } // namespace schmix
@@ -0,0 +1,230 @@
+#include "schmixpch.h"
+#include "schmix/audio/Recorder.h"
+
+#include "schmix/encoding/FileEncoder.h"
+
+namespace schmix {
+    // ring length when none is given, in seconds
+    static constexpr double s_DefaultRingDuration = 4.0;
+
+    // frames per channel encoded at a time
+    static constexpr std::size_t s_BlockFrames = 4096;
+
+    // how long the writer sleeps between looks at the rings
+    // the processing thread never wakes it, since that could mean a system call
+    static constexpr auto s_PollInterval = std::chrono::milliseconds(10);
+
+    Recorder::Recorder(const std::filesystem::path& path, std::size_t channels,
+                       std::size_t sampleRate, std::size_t ringFrames) {
+        m_Initialized = false;
+        m_Stopped = false;
+
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+
+        m_RecordedFrames.store(0);
+        m_Overflows.store(0);
+        m_DroppedFrames.store(0);
+        m_Failed.store(false);
+        m_Stopping.store(false);
+        m_WriteWaiting.store(false);
+
+        if (channels == 0) {
+            SCHMIX_ERROR("Cannot record zero channels!");
+            return;
+        }
+
+        auto streams = FileEncoder::Open(path, channels, sampleRate, 1);
+        if (!streams.has_value()) {
+            return;
+        }
+
+        m_Codec = std::move(streams->Codec);
+        m_Format = std::move(streams->Format);
+
+        if (!FileEncoder::Connect(*m_Codec, m_Format.get(), m_Channels, m_SampleRate,
+                                  Resampler::Quality::Balanced)) {
+            return;
+        }
+
+        if (ringFrames == 0) {
+            ringFrames = (std::size_t)(s_DefaultRingDuration * (double)sampleRate);
+        }
+
+        // everything the processing thread will ever touch is allocated here
+        for (std::size_t i = 0; i < m_Channels; i++) {
+            m_Rings.push_back(std::make_unique<RingBuffer<double>>(ringFrames));
+        }
+
+        m_Block.resize(s_BlockFrames * m_Channels);
+        m_Planes.resize(m_Channels);
+
+        for (std::size_t i = 0; i < m_Channels; i++) {
+            m_Planes[i] = m_Block.data() + i * s_BlockFrames;
+        }
+
+        m_Thread = std::thread([this]() { Work(); });
+        m_Initialized = true;
+    }
+
+    Recorder::~Recorder() {
+        if (m_Initialized) {
+            Stop();
+        }
+
+        // the codec writes into the muxer
+        m_Codec.reset();
+        m_Format.reset();
+    }
+
+    bool Recorder::Write(const double* const* channels, std::size_t frames, bool wait) {
+        if (!m_Initialized || m_Stopping.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        // the writer only ever frees space, so checking every ring up front keeps them in step
+        if (!wait) {
+            if (GetFree() < frames || m_Failed.load(std::memory_order_relaxed)) {
+                m_Overflows.fetch_add(1, std::memory_order_relaxed);
+                m_DroppedFrames.fetch_add(frames, std::memory_order_relaxed);
+
+                return false;
+            }
+
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                m_Rings[i]->Write(channels[i], frames);
+            }
+
+            return true;
+        }
+
+        // blocks larger than the rings go in as the writer makes room
+        std::size_t written = 0;
+        while (written < frames) {
+            if (m_Failed.load(std::memory_order_relaxed)) {
+                m_DroppedFrames.fetch_add(frames - written, std::memory_order_relaxed);
+                return false;
+            }
+
+            std::size_t toWrite = std::min(GetFree(), frames - written);
+            if (toWrite == 0) {
+                std::unique_lock lock(m_Mutex);
+                m_WriteWaiting.store(true, std::memory_order_release);
+                m_Condition.notify_one();
+
+                m_DrainCondition.wait_for(lock, s_PollInterval, [this]() {
+                    return GetFree() > 0 || m_Failed.load(std::memory_order_relaxed);
+                });
+
+                m_WriteWaiting.store(false, std::memory_order_release);
+                continue;
+            }
+
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                m_Rings[i]->Write(channels[i] + written, toWrite);
+            }
+
+            written += toWrite;
+        }
+
+        return true;
+    }
+
+    std::size_t Recorder::GetFree() const {
+        std::size_t free = std::numeric_limits<std::size_t>::max();
+        for (const auto& ring : m_Rings) {
+            free = std::min(free, ring->GetFree());
+        }
+
+        return free;
+    }
+
+    bool Recorder::Stop() {
+        if (!m_Initialized) {
+            return false;
+        }
+
+        if (m_Stopped) {
+            return !HasFailed();
+        }
+
+        m_Stopped = true;
+
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping.store(true, std::memory_order_release);
+        }
+
+        m_Condition.notify_one();
+        m_Thread.join();
+
+        if (HasFailed()) {
+            return false;
+        }
+
+        // nothing else touches the streams now
+        bool success = m_Codec->Flush() && m_Format->Finish();
+        if (!success) {
+            m_Failed.store(true, std::memory_order_relaxed);
+        }
+
+        std::size_t dropped = GetDroppedFrames();
+        if (dropped > 0) {
+            SCHMIX_WARN("Recorder dropped {} frames across {} overflows", dropped, GetOverflows());
+        }
+
+        return success;
+    }
+
+    void Recorder::Work() {
+        while (true) {
+            // checked before draining, so that nothing written before the stop is left behind
+            bool stopping = m_Stopping.load(std::memory_order_acquire);
+
+            if (!Drain() && !HasFailed()) {
+                SCHMIX_ERROR("Recording failed - dropping the rest of the stream");
+                m_Failed.store(true, std::memory_order_relaxed);
+            }
+
+            m_DrainCondition.notify_all();
+
+            if (stopping) {
+                break;
+            }
+
+            std::unique_lock lock(m_Mutex);
+            m_Condition.wait_for(lock, s_PollInterval, [this]() {
+                return m_Stopping.load(std::memory_order_acquire) ||
+                       m_WriteWaiting.load(std::memory_order_acquire);
+            });
+        }
+    }
+
+    bool Recorder::Drain() {
+        while (true) {
+            std::size_t available = s_BlockFrames;
+            for (const auto& ring : m_Rings) {
+                available = std::min(available, ring->GetAvailable());
+            }
+
+            if (available == 0) {
+                return true;
+            }
+
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                m_Rings[i]->Read(m_Planes[i], available);
+            }
+
+            // keep emptying the rings after a failure so that the counters stay meaningful
+            if (HasFailed()) {
+                continue;
+            }
+
+            if (!m_Codec->WriteSignal(m_Planes.data(), m_Channels, available)) {
+                return false;
+            }
+
+            m_RecordedFrames.fetch_add(available, std::memory_order_relaxed);
+        }
+    }
+} // namespace schmix
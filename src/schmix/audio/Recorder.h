@@ -0,0 +1,95 @@
+#pragma once
+#include "schmix/core/Ref.h"
+#include "schmix/core/RingBuffer.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace schmix {
+    class CodecStream;
+    class FormatStream;
+
+    // records planar audio from the processing thread into a file
+    // writes only copy into a pre-allocated ring per channel; a writer thread drains the rings
+    // on its own schedule, converting, encoding and muxing what it finds
+    // if the writer falls behind, whole blocks are dropped and counted rather than waited on
+    class Recorder : public RefCounted {
+    public:
+        // the container and codec are picked from the file name
+        // a ring of 0 frames holds a few seconds at the given rate
+        Recorder(const std::filesystem::path& path, std::size_t channels, std::size_t sampleRate,
+                 std::size_t ringFrames = 0);
+
+        virtual ~Recorder() override;
+
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        // processing thread only; never allocates, locks or waits
+        // false if the block was dropped
+        // a waiting write blocks on the writer instead of dropping; for offline rendering, which
+        // runs faster than the writer drains the rings
+        bool Write(const double* const* channels, std::size_t frames, bool wait = false);
+
+        // lets the writer drain what is left, then finishes the file; done on destruction
+        // must not overlap a write
+        bool Stop();
+
+        bool IsRecording() const { return m_Initialized && !m_Stopped; }
+        bool HasFailed() const { return m_Failed.load(std::memory_order_relaxed); }
+
+        // frames handed to the encoder
+        std::size_t GetRecordedFrames() const {
+            return m_RecordedFrames.load(std::memory_order_relaxed);
+        }
+
+        // blocks that found the ring full, and the frames they held
+        std::size_t GetOverflows() const { return m_Overflows.load(std::memory_order_relaxed); }
+        std::size_t GetDroppedFrames() const {
+            return m_DroppedFrames.load(std::memory_order_relaxed);
+        }
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+
+        bool IsInitialized() const { return m_Initialized; }
+
+    private:
+        void Work();
+
+        // encodes everything the rings hold right now
+        bool Drain();
+
+        // frames every ring has room for
+        std::size_t GetFree() const;
+
+        std::unique_ptr<CodecStream> m_Codec;
+        std::unique_ptr<FormatStream> m_Format;
+
+        std::size_t m_Channels, m_SampleRate;
+
+        // one per channel, so blocks go in without interleaving
+        std::vector<std::unique_ptr<RingBuffer<double>>> m_Rings;
+
+        // writer thread only
+        std::vector<double> m_Block;
+        std::vector<double*> m_Planes;
+
+        std::atomic<std::size_t> m_RecordedFrames;
+        std::atomic<std::size_t> m_Overflows, m_DroppedFrames;
+        std::atomic<bool> m_Failed;
+
+        std::thread m_Thread;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::atomic<bool> m_Stopping;
+
+        // signalled by the writer after each drain, for waiting writes
+        std::condition_variable m_DrainCondition;
+        std::atomic<bool> m_WriteWaiting;
+
+        bool m_Stopped;
+        bool m_Initialized;
+    };
+} // namespace schmix
@@ -0,0 +1,397 @@
+#include "schmixpch.h"
+#include "schmix/audio/SampleCache.h"
+
+#include "schmix/core/MappedFile.h"
+#include "schmix/core/ThreadPool.h"
+
+#include "schmix/encoding/FormatStream.h"
+#include "schmix/encoding/ParallelDecoder.h"
+
+#include <fstream>
+#include <list>
+#include <mutex>
+
+namespace schmix {
+    struct SampleCacheHeader {
+        char Magic[8];
+        std::uint32_t Version;
+        std::uint32_t Channels;
+        std::uint64_t SampleRate;
+        std::uint64_t Frames;
+        std::uint64_t DataOffset;
+    };
+
+    static constexpr char s_Magic[8] = { 'S', 'C', 'H', 'M', 'I', 'X', 'P', 'C' };
+
+    // bump whenever decoded output would change for the same source
+    // 2: entries are resampled to the key rate rather than stored at the source rate
+    static constexpr std::uint32_t s_Version = 2;
+
+    // sample data starts on a page boundary so mapped doubles are always aligned
+    static constexpr std::size_t s_DataAlignment = 4096;
+
+    // background decodes shouldn't compete with the audio thread for every core, so both the
+    // files being cached and the chunks of each one share a couple of threads
+    static constexpr std::size_t s_WorkerCount = 2;
+    static constexpr std::size_t s_DecoderCount = 2;
+
+    static constexpr std::string_view s_EntrySuffix = "-f64.pcm";
+
+    struct SampleCacheData {
+        std::filesystem::path Directory;
+
+        std::unique_ptr<ThreadPool> Decoders;
+        std::unique_ptr<ThreadPool> Workers;
+
+        std::unordered_set<std::string> Pending;
+        std::atomic<bool> Stopping;
+
+        // committed entries, most recently used first
+        struct Usage {
+            std::size_t Size;
+            std::list<std::string>::iterator Position;
+        };
+
+        std::list<std::string> Recent;
+        std::unordered_map<std::string, Usage> Entries;
+        std::size_t TotalBytes, ByteBudget;
+    };
+
+    static std::mutex s_Mutex;
+    static std::unique_ptr<SampleCacheData> s_Data;
+
+    static std::string GetEntryName(const SampleCache::Key& key) {
+        return fmt::format("{:016x}-{}hz-{}ch{}", key.SourceHash, key.SampleRate, key.Channels,
+                           s_EntrySuffix);
+    }
+
+    // only depends on the source, so every playback format shares it
+    static std::string GetSeekIndexName(const SampleCache::Key& key) {
+        return fmt::format("{:016x}.seek", key.SourceHash);
+    }
+
+    // the caller holds s_Mutex
+    static void TouchEntry(SampleCacheData& data, const std::string& name, std::size_t size) {
+        auto it = data.Entries.find(name);
+        if (it != data.Entries.end()) {
+            data.Recent.splice(data.Recent.begin(), data.Recent, it->second.Position);
+
+            data.TotalBytes -= it->second.Size;
+            it->second.Size = size;
+        } else {
+            data.Recent.push_front(name);
+            data.Entries[name] = { size, data.Recent.begin() };
+        }
+
+        data.TotalBytes += size;
+    }
+
+    // the caller holds s_Mutex
+    // entries still mapped by a stream stay readable on posix; elsewhere removal fails and the
+    // entry is skipped until a later pass
+    static void EvictEntries(SampleCacheData& data) {
+        auto it = data.Recent.end();
+        while (data.TotalBytes > data.ByteBudget && it != data.Recent.begin()) {
+            --it;
+
+            const auto& name = *it;
+            std::error_code error;
+
+            if (!std::filesystem::remove(data.Directory / name, error) && error) {
+                continue;
+            }
+
+            SCHMIX_DEBUG("Evicted sample cache entry {}", name.c_str());
+
+            data.TotalBytes -= data.Entries.at(name).Size;
+            data.Entries.erase(name);
+
+            auto hash = name.substr(0, name.find('-'));
+            it = data.Recent.erase(it);
+
+            // the seek index goes with the last entry decoded from its source
+            bool shared = std::any_of(data.Recent.begin(), data.Recent.end(),
+                                      [&](const std::string& other) {
+                                          return other.compare(0, hash.size(), hash) == 0;
+                                      });
+
+            if (!shared) {
+                std::filesystem::remove(data.Directory / (hash + ".seek"), error);
+            }
+        }
+    }
+
+    // oldest first by modification time, which every cache hit bumps
+    static void ScanEntries(SampleCacheData& data) {
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> found;
+
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(data.Directory, error)) {
+            auto name = file.path().filename().string();
+
+            // left behind by a decode that never finished
+            if (file.path().extension() == ".tmp") {
+                std::filesystem::remove(file.path(), error);
+                continue;
+            }
+
+            if (name.ends_with(s_EntrySuffix) && file.is_regular_file(error)) {
+                found.emplace_back(file.last_write_time(error), file.path());
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+        for (const auto& [time, path] : found) {
+            TouchEntry(data, path.filename().string(), std::filesystem::file_size(path, error));
+        }
+    }
+
+    SampleCache::Entry::Entry(std::unique_ptr<MappedFile>&& file, std::size_t offset,
+                              std::size_t frames) {
+        m_File = std::move(file);
+
+        m_Samples = (const double*)((const std::uint8_t*)m_File->GetData() + offset);
+        m_Frames = frames;
+    }
+
+    SampleCache::Entry::~Entry() = default;
+
+    void SampleCache::Init(const std::filesystem::path& directory, std::size_t byteBudget) {
+        std::lock_guard lock(s_Mutex);
+        if (s_Data) {
+            return;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+
+        if (error) {
+            SCHMIX_WARN("Failed to create sample cache directory: {}", error.message().c_str());
+            return;
+        }
+
+        s_Data = std::make_unique<SampleCacheData>();
+        s_Data->Directory = directory;
+        s_Data->Workers = std::make_unique<ThreadPool>(s_WorkerCount);
+        s_Data->Decoders = std::make_unique<ThreadPool>(s_DecoderCount);
+        s_Data->Stopping.store(false);
+
+        s_Data->TotalBytes = 0;
+        s_Data->ByteBudget = byteBudget;
+
+        ScanEntries(*s_Data);
+        EvictEntries(*s_Data);
+
+        SCHMIX_DEBUG("Sample cache: {} ({} MiB of {} MiB)", directory.string().c_str(),
+                     s_Data->TotalBytes / (1024 * 1024), byteBudget / (1024 * 1024));
+    }
+
+    void SampleCache::Shutdown() {
+        std::unique_ptr<SampleCacheData> data;
+
+        {
+            std::lock_guard lock(s_Mutex);
+            data = std::move(s_Data);
+        }
+
+        if (!data) {
+            return;
+        }
+
+        // unfinished entries are discarded; the pools join once they bail out
+        // workers wait on decoders, so they go first
+        data->Stopping.store(true);
+        data->Workers.reset();
+        data->Decoders.reset();
+    }
+
+    std::optional<SampleCache::Key> SampleCache::ComputeKey(const std::filesystem::path& source,
+                                                            std::size_t sampleRate,
+                                                            std::size_t channels) {
+        // only the ends of the file are read, so hits are ready almost as soon as they open
+        auto callbacks = IO::OpenFile(source, IO::Mode::Input);
+        if (!callbacks.has_value()) {
+            return {};
+        }
+
+        FormatStream format(callbacks.value(), IO::Mode::Input, nullptr);
+        if (!format.IsOpen()) {
+            return {};
+        }
+
+        auto fingerprint = format.GetSourceFingerprint();
+        if (!fingerprint.has_value()) {
+            return {};
+        }
+
+        Key key;
+        key.SourceHash = fingerprint.value();
+        key.SampleRate = sampleRate;
+        key.Channels = channels;
+
+        return key;
+    }
+
+    std::unique_ptr<SampleCache::Entry> SampleCache::Load(const Key& key) {
+        auto name = GetEntryName(key);
+        std::filesystem::path path;
+
+        {
+            std::lock_guard lock(s_Mutex);
+            if (!s_Data) {
+                return nullptr;
+            }
+
+            path = s_Data->Directory / name;
+        }
+
+        if (!std::filesystem::is_regular_file(path)) {
+            return nullptr;
+        }
+
+        auto file = std::make_unique<MappedFile>(path);
+        if (!file->IsOpen() || file->GetSize() < sizeof(SampleCacheHeader)) {
+            return nullptr;
+        }
+
+        SampleCacheHeader header;
+        Memory::Copy(file->GetData(), &header, sizeof(SampleCacheHeader));
+
+        if (std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0 ||
+            header.Version != s_Version || header.Channels != key.Channels ||
+            header.SampleRate != key.SampleRate || header.DataOffset % s_DataAlignment != 0) {
+            SCHMIX_WARN("Ignoring stale sample cache entry: {}", path.string().c_str());
+            return nullptr;
+        }
+
+        std::size_t dataSize = header.Frames * header.Channels * sizeof(double);
+        if (header.DataOffset + dataSize > file->GetSize()) {
+            SCHMIX_WARN("Ignoring truncated sample cache entry: {}", path.string().c_str());
+            return nullptr;
+        }
+
+        file->Prefault();
+
+        // the modification time carries recency over to the next session
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(),
+                                         error);
+
+        {
+            std::lock_guard lock(s_Mutex);
+            if (s_Data) {
+                TouchEntry(*s_Data, name, file->GetSize());
+            }
+        }
+
+        return std::make_unique<Entry>(std::move(file), header.DataOffset, header.Frames);
+    }
+
+    static bool WriteEntry(const std::filesystem::path& source, const SampleCache::Key& key,
+                           const std::filesystem::path& destination,
+                           const std::filesystem::path& indexPath, ThreadPool& decoders,
+                           const std::atomic<bool>& stopping) {
+        ParallelDecoder decoder(source, key.Channels, key.SampleRate);
+        if (!decoder.IsOpen() || !decoder.PrepareSeekIndex(indexPath)) {
+            return false;
+        }
+
+        std::ofstream stream(destination, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            SCHMIX_ERROR("Failed to open sample cache entry for writing: {}",
+                         destination.string().c_str());
+
+            return false;
+        }
+
+        SampleCacheHeader header;
+        Memory::Copy(s_Magic, header.Magic, sizeof(s_Magic));
+
+        header.Version = s_Version;
+        header.Channels = (std::uint32_t)key.Channels;
+        header.SampleRate = key.SampleRate;
+        header.Frames = 0;
+        header.DataOffset = s_DataAlignment;
+
+        // the frame count is filled in once decoding finishes
+        std::vector<char> padding(s_DataAlignment, 0);
+        Memory::Copy(&header, padding.data(), sizeof(SampleCacheHeader));
+        stream.write(padding.data(), (std::streamsize)padding.size());
+
+        bool decoded = decoder.Decode(decoders, [&](const double* interleaved, std::size_t frames) {
+            if (stopping.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            stream.write((const char*)interleaved,
+                         (std::streamsize)(frames * key.Channels * sizeof(double)));
+
+            header.Frames += frames;
+            return true;
+        });
+
+        if (!decoded) {
+            return false;
+        }
+
+        stream.seekp(0);
+        stream.write((const char*)&header, sizeof(SampleCacheHeader));
+        stream.close();
+
+        if (!stream) {
+            SCHMIX_ERROR("Failed to write sample cache entry: {}", destination.string().c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    void SampleCache::Populate(const std::filesystem::path& source, const Key& key) {
+        std::lock_guard lock(s_Mutex);
+        if (!s_Data) {
+            return;
+        }
+
+        auto name = GetEntryName(key);
+        if (s_Data->Pending.contains(name)) {
+            return;
+        }
+
+        s_Data->Pending.insert(name);
+
+        auto data = s_Data.get();
+        data->Workers->Submit([data, source, key, name]() {
+            auto path = data->Directory / name;
+
+            auto temporaryPath = path;
+            temporaryPath += ".tmp";
+
+            std::error_code error;
+            auto indexPath = data->Directory / GetSeekIndexName(key);
+            if (WriteEntry(source, key, temporaryPath, indexPath, *data->Decoders,
+                           data->Stopping)) {
+                // readers only ever see complete entries
+                std::filesystem::rename(temporaryPath, path, error);
+                if (error) {
+                    SCHMIX_WARN("Failed to commit sample cache entry: {}",
+                                error.message().c_str());
+                } else {
+                    SCHMIX_DEBUG("Cached decoded sample {}", source.string().c_str());
+                }
+            }
+
+            std::filesystem::remove(temporaryPath, error);
+
+            std::size_t size = std::filesystem::file_size(path, error);
+            bool committed = !error;
+
+            std::lock_guard lock(s_Mutex);
+            data->Pending.erase(name);
+
+            if (committed) {
+                TouchEntry(*data, name, size);
+                EvictEntries(*data);
+            }
+        });
+    }
+} // namespace schmix
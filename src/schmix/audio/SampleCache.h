@@ -0,0 +1,56 @@
+#pragma once
+
+namespace schmix {
+    class MappedFile;
+
+    // decoded samples on disk, addressed by source content and playback format
+    // entries are memory-mapped so that cache hits never touch a decoder
+    // the least recently used entries are deleted once the cache outgrows its budget
+    class SampleCache {
+    public:
+        static constexpr std::size_t DefaultByteBudget = (std::size_t)4 * 1024 * 1024 * 1024;
+
+        struct Key {
+            // see FormatStream::GetSourceFingerprint
+            std::uint64_t SourceHash;
+            std::size_t SampleRate, Channels;
+        };
+
+        // interleaved doubles
+        class Entry {
+        public:
+            Entry(std::unique_ptr<MappedFile>&& file, std::size_t offset, std::size_t frames);
+            ~Entry();
+
+            Entry(const Entry&) = delete;
+            Entry& operator=(const Entry&) = delete;
+
+            const double* GetSamples() const { return m_Samples; }
+            std::size_t GetFrames() const { return m_Frames; }
+
+        private:
+            std::unique_ptr<MappedFile> m_File;
+
+            const double* m_Samples;
+            std::size_t m_Frames;
+        };
+
+        SampleCache() = delete;
+
+        static void Init(const std::filesystem::path& directory,
+                         std::size_t byteBudget = DefaultByteBudget);
+        static void Shutdown();
+
+        // empty optional means the source could not be read
+        static std::optional<Key> ComputeKey(const std::filesystem::path& source,
+                                             std::size_t sampleRate, std::size_t channels);
+
+        // null on a miss
+        // the entry is read in before returning, so that the audio thread never faults on it
+        static std::unique_ptr<Entry> Load(const Key& key);
+
+        // decodes the source into the cache on a background thread
+        // does nothing if the entry is already being written
+        static void Populate(const std::filesystem::path& source, const Key& key);
+    };
+} // namespace schmix
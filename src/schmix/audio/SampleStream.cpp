@@ -0,0 +1,377 @@
+#include "schmixpch.h"
+#include "schmix/audio/SampleStream.h"
+
+#include "schmix/encoding/AudioDecoder.h"
+
+namespace schmix {
+    // resident audio at the start of the file, in seconds
+    static constexpr double s_HeadDuration = 0.5;
+
+    // read-ahead kept past the playback position, in seconds
+    static constexpr double s_ReadAheadDuration = 4.0;
+
+    // frames decoded per ring refill
+    static constexpr std::size_t s_ChunkFrames = 4096;
+
+    // upper bound on how long the decoder sleeps without being notified
+    static constexpr auto s_PollInterval = std::chrono::milliseconds(5);
+
+    static constexpr std::uint64_t s_NoGeneration = std::numeric_limits<std::uint64_t>::max();
+
+    SampleStream::SampleStream(const std::filesystem::path& path, std::size_t channels,
+                               std::size_t sampleRate) {
+        m_Initialized = false;
+
+        m_Path = path;
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+
+        m_Head = nullptr;
+        m_HeadFrames = 0;
+        m_FullyResident = false;
+
+        m_RequestedGeneration.store(0);
+        m_BufferedGeneration.store(s_NoGeneration);
+        m_FinishedGeneration.store(s_NoGeneration);
+
+        m_State.store(State::Loading);
+        m_Underruns.store(0);
+
+        m_Playing = false;
+        m_RingConsumed = false;
+        m_Cursor = 0;
+
+        m_Stopping.store(false);
+        m_ReadWaiting.store(false);
+
+        if (channels == 0 || sampleRate == 0) {
+            SCHMIX_ERROR("Invalid sample stream format!");
+            return;
+        }
+
+        // check synchronously so that missing files are reported to the caller
+        if (!std::filesystem::is_regular_file(path)) {
+            SCHMIX_ERROR("Sample file does not exist: {}", path.string().c_str());
+            return;
+        }
+
+        m_Thread = std::thread([this]() { Decode(); });
+
+        m_Initialized = true;
+    }
+
+    SampleStream::~SampleStream() {
+        m_Stopping.store(true, std::memory_order_release);
+        m_Condition.notify_one();
+        m_DataCondition.notify_all();
+
+        if (m_Thread.joinable()) {
+            m_Thread.join();
+        }
+    }
+
+    void SampleStream::Trigger() {
+        if (GetState() != State::Ready) {
+            return;
+        }
+
+        m_Playing = true;
+        m_Cursor = 0;
+
+        // an untouched ring still picks up exactly where the head ends
+        if (m_RingConsumed) {
+            m_RingConsumed = false;
+
+            m_RequestedGeneration.fetch_add(1, std::memory_order_release);
+            m_Condition.notify_one();
+        }
+    }
+
+    void SampleStream::Stop() { m_Playing = false; }
+
+    void SampleStream::CopyHead(double* const* channels, std::size_t offset,
+                                std::size_t frames) const {
+        if (!m_HeadPlanes.empty()) {
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                Memory::Copy(m_HeadPlanes[i] + m_Cursor, channels[i] + offset,
+                             frames * sizeof(double));
+            }
+
+            return;
+        }
+
+        const double* source = m_Head + m_Cursor * m_Channels;
+        for (std::size_t i = 0; i < m_Channels; i++) {
+            double* destination = channels[i] + offset;
+            for (std::size_t j = 0; j < frames; j++) {
+                destination[j] = source[j * m_Channels + i];
+            }
+        }
+    }
+
+    std::size_t SampleStream::GetRingFrames() const {
+        // the decoder may be partway through filling the rings
+        std::size_t frames = std::numeric_limits<std::size_t>::max();
+        for (const auto& ring : m_Rings) {
+            frames = std::min(frames, ring->GetAvailable());
+        }
+
+        return frames;
+    }
+
+    std::size_t SampleStream::Read(double* const* channels, std::size_t frames, bool wait) {
+        std::size_t framesRead = 0;
+        if (m_Playing && GetState() == State::Ready) {
+            if (m_Cursor < m_HeadFrames) {
+                std::size_t toCopy = std::min(frames, m_HeadFrames - m_Cursor);
+                CopyHead(channels, 0, toCopy);
+
+                m_Cursor += toCopy;
+                framesRead += toCopy;
+            }
+
+            while (framesRead < frames && m_Cursor >= m_HeadFrames) {
+                std::uint64_t generation = m_RequestedGeneration.load(std::memory_order_relaxed);
+                bool ringValid =
+                    m_BufferedGeneration.load(std::memory_order_acquire) == generation;
+
+                std::size_t ringFrames = 0;
+                if (ringValid && !m_FullyResident) {
+                    ringFrames = std::min(GetRingFrames(), frames - framesRead);
+                    for (std::size_t i = 0; i < m_Channels; i++) {
+                        m_Rings[i]->Read(channels[i] + framesRead, ringFrames);
+                    }
+
+                    m_RingConsumed |= ringFrames > 0;
+                }
+
+                m_Cursor += ringFrames;
+                framesRead += ringFrames;
+
+                if (framesRead == frames) {
+                    break;
+                }
+
+                bool finished =
+                    m_FullyResident ||
+                    (ringValid &&
+                     m_FinishedGeneration.load(std::memory_order_acquire) == generation &&
+                     GetRingFrames() == 0);
+
+                if (finished) {
+                    m_Playing = false;
+                    break;
+                }
+
+                if (!wait) {
+                    m_Underruns.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+
+                if (!WaitForRing(generation)) {
+                    break;
+                }
+            }
+        }
+
+        if (framesRead < frames) {
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                Memory::Fill(channels[i] + framesRead, 0, (frames - framesRead) * sizeof(double));
+            }
+        }
+
+        return framesRead;
+    }
+
+    SampleStream::State SampleStream::WaitUntilLoaded() {
+        std::unique_lock lock(m_Mutex);
+        while (GetState() == State::Loading && m_Initialized) {
+            m_DataCondition.wait_for(lock, s_PollInterval);
+        }
+
+        return GetState();
+    }
+
+    bool SampleStream::WaitForRing(std::uint64_t generation) {
+        std::unique_lock lock(m_Mutex);
+
+        // the decoder otherwise only polls, so wake it up to refill what was just read
+        m_ReadWaiting.store(true, std::memory_order_release);
+        m_Condition.notify_one();
+
+        m_DataCondition.wait_for(lock, s_PollInterval, [&]() {
+            if (m_Stopping.load(std::memory_order_acquire) || GetState() != State::Ready) {
+                return true;
+            }
+
+            if (m_BufferedGeneration.load(std::memory_order_acquire) != generation) {
+                return false;
+            }
+
+            return GetRingFrames() > 0 ||
+                   m_FinishedGeneration.load(std::memory_order_acquire) == generation;
+        });
+
+        m_ReadWaiting.store(false, std::memory_order_release);
+        return !m_Stopping.load(std::memory_order_acquire) && GetState() == State::Ready;
+    }
+
+    void SampleStream::SetState(State state) {
+        m_State.store(state, std::memory_order_release);
+        m_DataCondition.notify_all();
+    }
+
+    void SampleStream::Decode() {
+        if (LoadCached()) {
+            m_BufferedGeneration.store(0, std::memory_order_release);
+            SetState(State::Ready);
+
+            return;
+        }
+
+        AudioDecoder decoder(m_Path, m_Channels, m_SampleRate, Resampler::Quality::Balanced,
+                             AudioDecoder::Layout::Planar);
+        if (!decoder.IsOpen()) {
+            SetState(State::Failed);
+            return;
+        }
+
+        if (!LoadHead(decoder)) {
+            SetState(State::Failed);
+            return;
+        }
+
+        if (!m_FullyResident) {
+            std::size_t capacity = (std::size_t)(s_ReadAheadDuration * (double)m_SampleRate);
+
+            m_Rings.resize(m_Channels);
+            for (auto& ring : m_Rings) {
+                ring = std::make_unique<RingBuffer<double>>(capacity);
+            }
+        }
+
+        // the ring follows the head for the first pass
+        m_BufferedGeneration.store(0, std::memory_order_release);
+        SetState(State::Ready);
+
+        if (m_FullyResident) {
+            return;
+        }
+
+        std::vector<double> scratch(s_ChunkFrames * m_Channels);
+        std::vector<double*> planes(m_Channels);
+
+        for (std::size_t i = 0; i < m_Channels; i++) {
+            planes[i] = scratch.data() + i * s_ChunkFrames;
+        }
+
+        std::uint64_t buffered = 0;
+        bool finished = false;
+
+        while (!m_Stopping.load(std::memory_order_acquire)) {
+            std::uint64_t requested = m_RequestedGeneration.load(std::memory_order_acquire);
+            if (requested != buffered) {
+                // the processing thread does not touch the ring until the new generation is
+                // published, so it is safe to reset here
+                if (!Restart(decoder)) {
+                    SetState(State::Failed);
+                    return;
+                }
+
+                buffered = requested;
+                finished = false;
+
+                m_BufferedGeneration.store(buffered, std::memory_order_release);
+                m_DataCondition.notify_all();
+
+                continue;
+            }
+
+            // every ring drains at the same pace, so the first speaks for all of them
+            if (!finished && m_Rings[0]->GetFree() >= s_ChunkFrames) {
+                auto framesRead = decoder.ReadPlanar(planes.data(), s_ChunkFrames);
+                if (!framesRead.has_value()) {
+                    SetState(State::Failed);
+                    return;
+                }
+
+                for (std::size_t i = 0; i < m_Channels; i++) {
+                    m_Rings[i]->Write(planes[i], framesRead.value());
+                }
+
+                if (framesRead.value() < s_ChunkFrames) {
+                    finished = true;
+                    m_FinishedGeneration.store(buffered, std::memory_order_release);
+                }
+
+                m_DataCondition.notify_all();
+                continue;
+            }
+
+            std::unique_lock lock(m_Mutex);
+            m_Condition.wait_for(lock, s_PollInterval, [&]() {
+                return m_Stopping.load(std::memory_order_acquire) ||
+                       m_ReadWaiting.load(std::memory_order_acquire) ||
+                       m_RequestedGeneration.load(std::memory_order_acquire) != buffered;
+            });
+        }
+    }
+
+    bool SampleStream::LoadCached() {
+        auto key = SampleCache::ComputeKey(m_Path, m_SampleRate, m_Channels);
+        if (!key.has_value()) {
+            return false;
+        }
+
+        m_CacheEntry = SampleCache::Load(key.value());
+        if (!m_CacheEntry) {
+            // stream this time, hit next time
+            SampleCache::Populate(m_Path, key.value());
+            return false;
+        }
+
+        m_Head = m_CacheEntry->GetSamples();
+        m_HeadFrames = m_CacheEntry->GetFrames();
+        m_FullyResident = true;
+
+        return true;
+    }
+
+    bool SampleStream::LoadHead(AudioDecoder& decoder) {
+        std::size_t headFrames = (std::size_t)(s_HeadDuration * (double)m_SampleRate);
+        m_HeadStorage.resize(headFrames * m_Channels);
+
+        std::vector<double*> planes(m_Channels);
+        for (std::size_t i = 0; i < m_Channels; i++) {
+            planes[i] = m_HeadStorage.data() + i * headFrames;
+        }
+
+        auto framesRead = decoder.ReadPlanar(planes.data(), headFrames);
+        if (!framesRead.has_value()) {
+            SCHMIX_ERROR("Failed to decode the start of the sample stream!");
+            return false;
+        }
+
+        m_HeadFrames = framesRead.value();
+        m_FullyResident = m_HeadFrames < headFrames;
+
+        // the planes stay where they are; a short file only leaves the end of each unused
+        m_HeadPlanes.assign(planes.begin(), planes.end());
+        m_Head = m_HeadStorage.data();
+
+        return true;
+    }
+
+    bool SampleStream::Restart(AudioDecoder& decoder) {
+        // pick up where the head leaves off without decoding it again
+        if (!decoder.Seek(m_HeadFrames)) {
+            return false;
+        }
+
+        for (auto& ring : m_Rings) {
+            ring->Reset();
+        }
+
+        return true;
+    }
+} // namespace schmix
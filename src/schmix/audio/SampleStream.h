@@ -0,0 +1,111 @@
+#pragma once
+#include "schmix/core/Ref.h"
+#include "schmix/core/RingBuffer.h"
+
+#include "schmix/audio/SampleCache.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace schmix {
+    class AudioDecoder;
+
+    // plays a file from disk without decoding it up front
+    // the first moments of the file stay resident so that triggers start instantly; the rest is
+    // decoded on a background thread into a bounded read-ahead ring per channel
+    // decoding is planar, so reads copy each channel straight through; files already in the
+    // sample cache are played from the mapped entry, which is interleaved
+    class SampleStream : public RefCounted {
+    public:
+        enum class State : std::int32_t { Loading = 0, Ready, Failed };
+
+        SampleStream(const std::filesystem::path& path, std::size_t channels,
+                     std::size_t sampleRate);
+
+        virtual ~SampleStream() override;
+
+        SampleStream(const SampleStream&) = delete;
+        SampleStream& operator=(const SampleStream&) = delete;
+
+        // processing thread only
+        void Trigger();
+        void Stop();
+
+        // always writes the requested number of frames into one buffer per channel, padding
+        // with silence; returns the number of frames that came from the file
+        // a waiting read blocks on the decoder instead of underrunning; for offline rendering,
+        // which runs faster than the decoder can keep the ring filled
+        std::size_t Read(double* const* channels, std::size_t frames, bool wait = false);
+
+        // blocks until the stream has either loaded or failed
+        State WaitUntilLoaded();
+
+        State GetState() const { return m_State.load(std::memory_order_acquire); }
+        bool IsPlaying() const { return m_Playing; }
+
+        std::size_t GetUnderruns() const { return m_Underruns.load(std::memory_order_relaxed); }
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+
+        bool IsInitialized() const { return m_Initialized; }
+
+    private:
+        void Decode();
+        bool LoadCached();
+        bool LoadHead(AudioDecoder& decoder);
+        bool Restart(AudioDecoder& decoder);
+
+        void SetState(State state);
+
+        void CopyHead(double* const* channels, std::size_t offset, std::size_t frames) const;
+
+        // whole frames in every channel's ring
+        std::size_t GetRingFrames() const;
+
+        // false if the stream failed or is being destroyed while waiting
+        bool WaitForRing(std::uint64_t generation);
+
+        std::filesystem::path m_Path;
+        std::size_t m_Channels, m_SampleRate;
+
+        // written by the decoder thread before the state becomes ready
+        // the head is either one plane per channel in m_HeadStorage, or the cache entry's
+        // interleaved samples
+        std::vector<double> m_HeadStorage;
+        std::vector<const double*> m_HeadPlanes;
+        std::unique_ptr<SampleCache::Entry> m_CacheEntry;
+
+        const double* m_Head;
+        std::size_t m_HeadFrames;
+        bool m_FullyResident;
+
+        // only allocated when streaming; the decoder fills every channel before publishing
+        std::vector<std::unique_ptr<RingBuffer<double>>> m_Rings;
+
+        // a generation is one pass over the file past the head
+        // the processing thread requests a new one when the ring no longer follows the head
+        std::atomic<std::uint64_t> m_RequestedGeneration;
+        std::atomic<std::uint64_t> m_BufferedGeneration;
+        std::atomic<std::uint64_t> m_FinishedGeneration;
+
+        std::atomic<State> m_State;
+        std::atomic<std::size_t> m_Underruns;
+
+        // processing thread state
+        bool m_Playing, m_RingConsumed;
+        std::size_t m_Cursor;
+
+        std::thread m_Thread;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::atomic<bool> m_Stopping;
+
+        // signalled by the decoder whenever it buffers data or changes state
+        std::condition_variable m_DataCondition;
+        std::atomic<bool> m_ReadWaiting;
+
+        bool m_Initialized;
+    };
+} // namespace schmix
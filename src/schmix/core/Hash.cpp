@@ -0,0 +1,174 @@
+#include "schmixpch.h"
+#include "schmix/core/Hash.h"
+
+#include <fstream>
+
+namespace schmix {
+    static constexpr std::uint64_t s_Prime1 = 0x9E3779B185EBCA87ULL;
+    static constexpr std::uint64_t s_Prime2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr std::uint64_t s_Prime3 = 0x165667B19E3779F9ULL;
+    static constexpr std::uint64_t s_Prime4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr std::uint64_t s_Prime5 = 0x27D4EB2F165667C5ULL;
+
+    static inline std::uint64_t RotateLeft(std::uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static inline std::uint64_t Read64(const std::uint8_t* data) {
+        std::uint64_t value;
+        Memory::Copy(data, &value, sizeof(std::uint64_t));
+        return value;
+    }
+
+    static inline std::uint32_t Read32(const std::uint8_t* data) {
+        std::uint32_t value;
+        Memory::Copy(data, &value, sizeof(std::uint32_t));
+        return value;
+    }
+
+    static inline std::uint64_t Round(std::uint64_t accumulator, std::uint64_t input) {
+        accumulator += input * s_Prime2;
+        accumulator = RotateLeft(accumulator, 31);
+        return accumulator * s_Prime1;
+    }
+
+    static inline std::uint64_t MergeRound(std::uint64_t accumulator, std::uint64_t value) {
+        accumulator ^= Round(0, value);
+        return accumulator * s_Prime1 + s_Prime4;
+    }
+
+    Hasher::Hasher(std::uint64_t seed) {
+        m_Seed = seed;
+        m_TotalSize = 0;
+        m_BufferSize = 0;
+
+        m_Accumulators[0] = seed + s_Prime1 + s_Prime2;
+        m_Accumulators[1] = seed + s_Prime2;
+        m_Accumulators[2] = seed;
+        m_Accumulators[3] = seed - s_Prime1;
+    }
+
+    void Hasher::Update(const void* data, std::size_t size) {
+        auto bytes = (const std::uint8_t*)data;
+        m_TotalSize += size;
+
+        if (m_BufferSize > 0) {
+            std::size_t copied = std::min(size, sizeof(m_Buffer) - m_BufferSize);
+            Memory::Copy(bytes, m_Buffer + m_BufferSize, copied);
+
+            m_BufferSize += copied;
+            bytes += copied;
+            size -= copied;
+
+            if (m_BufferSize < sizeof(m_Buffer)) {
+                return;
+            }
+
+            for (std::size_t i = 0; i < 4; i++) {
+                m_Accumulators[i] = Round(m_Accumulators[i], Read64(m_Buffer + i * 8));
+            }
+
+            m_BufferSize = 0;
+        }
+
+        while (size >= 32) {
+            for (std::size_t i = 0; i < 4; i++) {
+                m_Accumulators[i] = Round(m_Accumulators[i], Read64(bytes + i * 8));
+            }
+
+            bytes += 32;
+            size -= 32;
+        }
+
+        if (size > 0) {
+            Memory::Copy(bytes, m_Buffer, size);
+            m_BufferSize = size;
+        }
+    }
+
+    std::uint64_t Hasher::Finish() const {
+        std::uint64_t hash;
+        if (m_TotalSize >= 32) {
+            hash = RotateLeft(m_Accumulators[0], 1) + RotateLeft(m_Accumulators[1], 7) +
+                   RotateLeft(m_Accumulators[2], 12) + RotateLeft(m_Accumulators[3], 18);
+
+            for (std::size_t i = 0; i < 4; i++) {
+                hash = MergeRound(hash, m_Accumulators[i]);
+            }
+        } else {
+            hash = m_Seed + s_Prime5;
+        }
+
+        hash += m_TotalSize;
+
+        const std::uint8_t* tail = m_Buffer;
+        std::size_t remaining = m_BufferSize;
+
+        while (remaining >= 8) {
+            hash ^= Round(0, Read64(tail));
+            hash = RotateLeft(hash, 27) * s_Prime1 + s_Prime4;
+
+            tail += 8;
+            remaining -= 8;
+        }
+
+        if (remaining >= 4) {
+            hash ^= (std::uint64_t)Read32(tail) * s_Prime1;
+            hash = RotateLeft(hash, 23) * s_Prime2 + s_Prime3;
+
+            tail += 4;
+            remaining -= 4;
+        }
+
+        while (remaining > 0) {
+            hash ^= (std::uint64_t)(*tail) * s_Prime5;
+            hash = RotateLeft(hash, 11) * s_Prime1;
+
+            tail++;
+            remaining--;
+        }
+
+        hash ^= hash >> 33;
+        hash *= s_Prime2;
+        hash ^= hash >> 29;
+        hash *= s_Prime3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    std::uint64_t Hash::Compute(const void* data, std::size_t size, std::uint64_t seed) {
+        Hasher hasher(seed);
+        hasher.Update(data, size);
+
+        return hasher.Finish();
+    }
+
+    std::optional<std::uint64_t> Hash::File(const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream.is_open()) {
+            SCHMIX_ERROR("Failed to open file for hashing: {}", path.string().c_str());
+            return {};
+        }
+
+        static constexpr std::size_t chunkSize = 64 * 1024;
+        std::vector<char> chunk(chunkSize);
+
+        Hasher hasher;
+        while (stream) {
+            stream.read(chunk.data(), (std::streamsize)chunkSize);
+
+            std::streamsize bytesRead = stream.gcount();
+            if (bytesRead > 0) {
+                hasher.Update(chunk.data(), (std::size_t)bytesRead);
+            }
+        }
+
+        if (stream.bad()) {
+            SCHMIX_ERROR("Failed to read file for hashing: {}", path.string().c_str());
+            return {};
+        }
+
+        return hasher.Finish();
+    }
+} // namespace schmix
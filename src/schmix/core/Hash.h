@@ -0,0 +1,30 @@
+#pragma once
+
+namespace schmix {
+    // streaming 64-bit xxHash
+    class Hasher {
+    public:
+        Hasher(std::uint64_t seed = 0);
+
+        void Update(const void* data, std::size_t size);
+        std::uint64_t Finish() const;
+
+    private:
+        std::uint64_t m_Accumulators[4];
+        std::uint64_t m_Seed;
+        std::uint64_t m_TotalSize;
+
+        std::uint8_t m_Buffer[32];
+        std::size_t m_BufferSize;
+    };
+
+    class Hash {
+    public:
+        Hash() = delete;
+
+        static std::uint64_t Compute(const void* data, std::size_t size, std::uint64_t seed = 0);
+
+        // empty optional means the file could not be read
+        static std::optional<std::uint64_t> File(const std::filesystem::path& path);
+    };
+} // namespace schmix
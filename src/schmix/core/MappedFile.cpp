@@ -0,0 +1,151 @@
+#include "schmixpch.h"
+#include "schmix/core/MappedFile.h"
+
+#ifdef SCHMIX_PLATFORM_windows
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace schmix {
+#ifdef SCHMIX_PLATFORM_windows
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        m_Data = nullptr;
+        m_Size = 0;
+
+        m_File = nullptr;
+        m_Mapping = nullptr;
+
+        m_IsOpen = false;
+
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE) {
+            SCHMIX_ERROR("Failed to open file for mapping: {}", path.string().c_str());
+            return;
+        }
+
+        m_File = file;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            SCHMIX_ERROR("Failed to query size of file: {}", path.string().c_str());
+            return;
+        }
+
+        m_Size = (std::size_t)size.QuadPart;
+        if (m_Size == 0) {
+            // empty files cannot be mapped, but there is nothing to read either
+            m_IsOpen = true;
+            return;
+        }
+
+        m_Mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_Mapping == nullptr) {
+            SCHMIX_ERROR("Failed to create file mapping: {}", path.string().c_str());
+            return;
+        }
+
+        m_Data = MapViewOfFile((HANDLE)m_Mapping, FILE_MAP_READ, 0, 0, 0);
+        if (m_Data == nullptr) {
+            SCHMIX_ERROR("Failed to map view of file: {}", path.string().c_str());
+            return;
+        }
+
+        m_IsOpen = true;
+    }
+
+    MappedFile::~MappedFile() {
+        if (m_Data != nullptr) {
+            UnmapViewOfFile(m_Data);
+        }
+
+        if (m_Mapping != nullptr) {
+            CloseHandle((HANDLE)m_Mapping);
+        }
+
+        if (m_File != nullptr) {
+            CloseHandle((HANDLE)m_File);
+        }
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        m_Data = nullptr;
+        m_Size = 0;
+
+        m_IsOpen = false;
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            SCHMIX_ERROR("Failed to open file for mapping: {}", path.string().c_str());
+            return;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            SCHMIX_ERROR("Failed to query size of file: {}", path.string().c_str());
+
+            close(fd);
+            return;
+        }
+
+        m_Size = (std::size_t)info.st_size;
+        if (m_Size == 0) {
+            close(fd);
+
+            m_IsOpen = true;
+            return;
+        }
+
+        void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // the mapping keeps its own reference to the file
+        close(fd);
+
+        if (data == MAP_FAILED) {
+            SCHMIX_ERROR("Failed to map file: {}", path.string().c_str());
+            return;
+        }
+
+        // playback walks mapped files front to back
+        madvise(data, m_Size, MADV_SEQUENTIAL);
+
+        m_Data = data;
+        m_IsOpen = true;
+    }
+
+    MappedFile::~MappedFile() {
+        if (m_Data != nullptr) {
+            munmap(m_Data, m_Size);
+        }
+    }
+#endif
+
+    // the smallest page size of any supported platform; touching more often is harmless
+    static constexpr std::size_t s_PageSize = 4096;
+
+    void MappedFile::Prefault() const {
+        if (m_Data == nullptr) {
+            return;
+        }
+
+#ifndef SCHMIX_PLATFORM_windows
+        // starts readahead of the whole file, rather than a page at a time below
+        madvise(m_Data, m_Size, MADV_WILLNEED);
+#endif
+
+        auto bytes = (const volatile std::uint8_t*)m_Data;
+
+        std::uint8_t sum = 0;
+        for (std::size_t i = 0; i < m_Size; i += s_PageSize) {
+            sum += bytes[i];
+        }
+
+        (void)sum;
+    }
+} // namespace schmix
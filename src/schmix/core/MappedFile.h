@@ -0,0 +1,32 @@
+#pragma once
+
+namespace schmix {
+    // read-only view of a whole file
+    class MappedFile {
+    public:
+        MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool IsOpen() const { return m_IsOpen; }
+
+        const void* GetData() const { return m_Data; }
+        std::size_t GetSize() const { return m_Size; }
+
+        // reads every page in now, so that later reads never wait on the disk
+        void Prefault() const;
+
+    private:
+        void* m_Data;
+        std::size_t m_Size;
+
+#ifdef SCHMIX_PLATFORM_windows
+        void* m_File;
+        void* m_Mapping;
+#endif
+
+        bool m_IsOpen;
+    };
+} // namespace schmix
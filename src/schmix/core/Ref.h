@@ -58,7 +58,7 @@ namespace schmix {
             other.m_Instance = nullptr;
         }
 
-        Ref(const Ref<_Ty>& other) : m_Instance(other.m_Instance) { IncreaseRefCount(); }
+        Ref(const Ref<_Ty>& other) : m_Instance(other.m_Instance) { IncreaseRefCount(m_Instance); }
         Ref(Ref<_Ty>&& other) : m_Instance(other.m_Instance) { other.m_Instance = nullptr; }
 
         ~Ref() { DecreaseRefCount(m_Instance); }
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <bit>
+
+namespace schmix {
+    // single-producer single-consumer ring
+    // Write may only be called from one thread and Read from one other thread; neither blocks
+    template <typename _Ty>
+    class RingBuffer {
+    public:
+        static_assert(std::is_trivially_copyable_v<_Ty>,
+                      "Ring buffer elements must be trivially copyable!");
+
+        RingBuffer() : m_Data(nullptr), m_Capacity(0), m_Mask(0), m_ReadIndex(0), m_WriteIndex(0) {}
+
+        // capacity is rounded up to a power of two
+        RingBuffer(std::size_t capacity) : RingBuffer() {
+            m_Capacity = std::bit_ceil(std::max<std::size_t>(capacity, 1));
+            m_Mask = m_Capacity - 1;
+
+            m_Data = (_Ty*)Memory::Allocate(m_Capacity * sizeof(_Ty));
+            if (m_Data == nullptr) {
+                throw std::bad_alloc();
+            }
+        }
+
+        ~RingBuffer() { Memory::Free(m_Data); }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        std::size_t GetCapacity() const { return m_Capacity; }
+
+        std::size_t GetAvailable() const {
+            std::size_t write = m_WriteIndex.load(std::memory_order_acquire);
+            std::size_t read = m_ReadIndex.load(std::memory_order_acquire);
+
+            return write - read;
+        }
+
+        std::size_t GetFree() const { return m_Capacity - GetAvailable(); }
+
+        // producer side; returns the number of elements written
+        std::size_t Write(const _Ty* data, std::size_t count) {
+            std::size_t write = m_WriteIndex.load(std::memory_order_relaxed);
+            std::size_t read = m_ReadIndex.load(std::memory_order_acquire);
+
+            std::size_t toWrite = std::min(count, m_Capacity - (write - read));
+            CopyIn(data, write, toWrite);
+
+            m_WriteIndex.store(write + toWrite, std::memory_order_release);
+            return toWrite;
+        }
+
+        // consumer side; returns the number of elements read
+        std::size_t Read(_Ty* data, std::size_t count) {
+            std::size_t read = m_ReadIndex.load(std::memory_order_relaxed);
+            std::size_t write = m_WriteIndex.load(std::memory_order_acquire);
+
+            std::size_t toRead = std::min(count, write - read);
+            CopyOut(data, read, toRead);
+
+            m_ReadIndex.store(read + toRead, std::memory_order_release);
+            return toRead;
+        }
+
+        // consumer side
+        std::size_t Skip(std::size_t count) {
+            std::size_t read = m_ReadIndex.load(std::memory_order_relaxed);
+            std::size_t write = m_WriteIndex.load(std::memory_order_acquire);
+
+            std::size_t toSkip = std::min(count, write - read);
+            m_ReadIndex.store(read + toSkip, std::memory_order_release);
+
+            return toSkip;
+        }
+
+        // only safe while neither side is reading or writing
+        void Reset() {
+            m_ReadIndex.store(0, std::memory_order_relaxed);
+            m_WriteIndex.store(0, std::memory_order_release);
+        }
+
+    private:
+        void CopyIn(const _Ty* data, std::size_t index, std::size_t count) {
+            std::size_t offset = index & m_Mask;
+            std::size_t first = std::min(count, m_Capacity - offset);
+
+            Memory::Copy(data, m_Data + offset, first * sizeof(_Ty));
+            Memory::Copy(data + first, m_Data, (count - first) * sizeof(_Ty));
+        }
+
+        void CopyOut(_Ty* data, std::size_t index, std::size_t count) const {
+            std::size_t offset = index & m_Mask;
+            std::size_t first = std::min(count, m_Capacity - offset);
+
+            Memory::Copy(m_Data + offset, data, first * sizeof(_Ty));
+            Memory::Copy(m_Data, data + first, (count - first) * sizeof(_Ty));
+        }
+
+        _Ty* m_Data;
+        std::size_t m_Capacity, m_Mask;
+
+        // monotonically increasing; masked on access
+        alignas(64) std::atomic<std::size_t> m_ReadIndex;
+        alignas(64) std::atomic<std::size_t> m_WriteIndex;
+    };
+} // namespace schmix
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "schmix/core/RingBuffer.h"
+
+namespace schmix {
+    // bounded hand-off between two threads, one pushing and one popping
+    // the ring itself is lock-free; either side only sleeps while it cannot make progress
+    // the flag is shared with whoever cancels; waking the queue afterwards unblocks both sides
+    template <typename _Ty>
+    class StageQueue {
+    public:
+        StageQueue(std::size_t capacity, const std::atomic<bool>& cancelled)
+            : m_Ring(capacity), m_Sequence(0), m_Cancelled(cancelled) {}
+
+        StageQueue(const StageQueue&) = delete;
+        StageQueue& operator=(const StageQueue&) = delete;
+
+        // waits while the queue is full; false once cancelled
+        bool Push(_Ty item) {
+            while (true) {
+                auto seen = m_Sequence.load(std::memory_order_acquire);
+                if (m_Cancelled.load(std::memory_order_acquire)) {
+                    return false;
+                }
+
+                if (m_Ring.Write(&item, 1) == 1) {
+                    Wake();
+                    return true;
+                }
+
+                m_Sequence.wait(seen, std::memory_order_acquire);
+            }
+        }
+
+        // waits while the queue is empty; empty optional once cancelled
+        std::optional<_Ty> Pop() {
+            while (true) {
+                auto seen = m_Sequence.load(std::memory_order_acquire);
+                if (m_Cancelled.load(std::memory_order_acquire)) {
+                    return {};
+                }
+
+                _Ty item;
+                if (m_Ring.Read(&item, 1) == 1) {
+                    Wake();
+                    return item;
+                }
+
+                m_Sequence.wait(seen, std::memory_order_acquire);
+            }
+        }
+
+        // never waits; false when the queue is full
+        bool TryPush(_Ty item) {
+            if (m_Ring.Write(&item, 1) != 1) {
+                return false;
+            }
+
+            Wake();
+            return true;
+        }
+
+        // never waits; empty optional when nothing is queued
+        // also takes whatever is left once both sides have stopped
+        std::optional<_Ty> TryPop() {
+            _Ty item;
+            if (m_Ring.Read(&item, 1) != 1) {
+                return {};
+            }
+
+            Wake();
+            return item;
+        }
+
+        void Wake() {
+            m_Sequence.fetch_add(1, std::memory_order_release);
+            m_Sequence.notify_all();
+        }
+
+    private:
+        RingBuffer<_Ty> m_Ring;
+        std::atomic<std::uint32_t> m_Sequence;
+        const std::atomic<bool>& m_Cancelled;
+    };
+} // namespace schmix
@@ -0,0 +1,59 @@
+#include "schmixpch.h"
+#include "schmix/core/ThreadPool.h"
+
+namespace schmix {
+    ThreadPool::ThreadPool(std::size_t threadCount) {
+        m_Stopping = false;
+
+        if (threadCount == 0) {
+            threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        m_Threads.reserve(threadCount);
+        for (std::size_t i = 0; i < threadCount; i++) {
+            m_Threads.emplace_back(&ThreadPool::Work, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+
+        m_Condition.notify_all();
+        for (auto& thread : m_Threads) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::Enqueue(std::function<void()>&& job) {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Jobs.push(std::move(job));
+        }
+
+        m_Condition.notify_one();
+    }
+
+    void ThreadPool::Work() {
+        while (true) {
+            std::function<void()> job;
+
+            {
+                std::unique_lock lock(m_Mutex);
+                m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+                // drain remaining jobs before stopping so no future is left unfulfilled
+                if (m_Jobs.empty()) {
+                    return;
+                }
+
+                job = std::move(m_Jobs.front());
+                m_Jobs.pop();
+            }
+
+            job();
+        }
+    }
+} // namespace schmix
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <queue>
+
+namespace schmix {
+    class ThreadPool {
+    public:
+        // 0 threads means one per hardware thread
+        ThreadPool(std::size_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        template <typename _Func>
+        std::future<std::invoke_result_t<_Func>> Submit(_Func&& func) {
+            using Result = std::invoke_result_t<_Func>;
+
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<_Func>(func));
+            auto future = task->get_future();
+
+            Enqueue([task]() { (*task)(); });
+            return future;
+        }
+
+        std::size_t GetThreadCount() const { return m_Threads.size(); }
+
+    private:
+        void Enqueue(std::function<void()>&& job);
+        void Work();
+
+        std::vector<std::thread> m_Threads;
+        std::queue<std::function<void()>> m_Jobs;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_Stopping;
+    };
+} // namespace schmix
@@ -0,0 +1,220 @@
+#include "schmixpch.h"
+#include "schmix/encoding/AsyncEncoder.h"
+
+#include "schmix/encoding/FileEncoder.h"
+
+namespace schmix {
+    std::unique_ptr<AsyncEncoder> AsyncEncoder::OpenFile(const std::filesystem::path& path,
+                                                         std::size_t channels,
+                                                         std::size_t sampleRate,
+                                                         const Options& options) {
+        auto streams = FileEncoder::Open(path, channels, sampleRate, options.ThreadCount);
+        if (!streams.has_value()) {
+            return nullptr;
+        }
+
+        auto encoder =
+            std::make_unique<AsyncEncoder>(std::move(streams->Codec), std::move(streams->Format),
+                                           channels, sampleRate, options);
+
+        if (!encoder->IsOpen()) {
+            return nullptr;
+        }
+
+        return encoder;
+    }
+
+    AsyncEncoder::AsyncEncoder(std::unique_ptr<CodecStream> codec,
+                               std::unique_ptr<FormatStream> format, std::size_t channels,
+                               std::size_t sampleRate, const Options& options) {
+        m_Codec = std::move(codec);
+        m_Format = std::move(format);
+
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+        m_Options = options;
+
+        m_Current = nullptr;
+
+        m_DroppedFrames = 0;
+        m_Failed = false;
+
+        m_Stopping = false;
+        m_Finished = false;
+        m_IsOpen = false;
+
+        if (m_Options.BlockFrames == 0 || m_Options.BlockCount == 0) {
+            SCHMIX_ERROR("Encoder queue cannot be empty!");
+            return;
+        }
+
+        if (!FileEncoder::Connect(*m_Codec, m_Format.get(), m_Channels, m_SampleRate,
+                                  m_Options.Quality)) {
+            return;
+        }
+
+        // everything the producer will ever touch is allocated up front
+        m_Blocks.resize(m_Options.BlockCount);
+        for (auto& block : m_Blocks) {
+            block.Samples.resize(m_Options.BlockFrames * m_Channels);
+            m_FreeBlocks.push_back(&block);
+        }
+
+        m_Planes.resize(m_Channels);
+        m_Thread = std::thread([this]() { Work(); });
+
+        m_IsOpen = true;
+    }
+
+    AsyncEncoder::~AsyncEncoder() {
+        if (m_IsOpen && !m_Finished) {
+            Finish();
+        }
+
+        // the codec writes into the muxer
+        m_Codec.reset();
+        m_Format.reset();
+    }
+
+    bool AsyncEncoder::Write(const double* const* channels, std::size_t frames) {
+        if (!m_IsOpen || m_Finished) {
+            SCHMIX_ERROR("Encoder is not open!");
+            return false;
+        }
+
+        std::size_t blockFrames = m_Options.BlockFrames;
+        for (std::size_t offset = 0; offset < frames;) {
+            if (m_Current == nullptr) {
+                m_Current = AcquireBlock();
+
+                if (m_Current == nullptr) {
+                    m_DroppedFrames += frames - offset;
+                    return false;
+                }
+            }
+
+            std::size_t toCopy = std::min(frames - offset, blockFrames - m_Current->Frames);
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                double* destination = m_Current->Samples.data() + i * blockFrames;
+                Memory::Copy(channels[i] + offset, destination + m_Current->Frames,
+                             toCopy * sizeof(double));
+            }
+
+            m_Current->Frames += toCopy;
+            offset += toCopy;
+
+            if (m_Current->Frames == blockFrames) {
+                Submit(m_Current);
+                m_Current = nullptr;
+            }
+        }
+
+        return !m_Failed;
+    }
+
+    bool AsyncEncoder::Finish() {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Encoder is not open!");
+            return false;
+        }
+
+        if (m_Finished) {
+            return !m_Failed;
+        }
+
+        m_Finished = true;
+        if (m_Current != nullptr) {
+            Submit(m_Current);
+            m_Current = nullptr;
+        }
+
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+
+        m_ReadyCondition.notify_one();
+        m_Thread.join();
+
+        if (m_Failed) {
+            return false;
+        }
+
+        // nothing else touches the streams now
+        bool success = m_Codec->Flush();
+        if (m_Format) {
+            success &= m_Format->Finish();
+        }
+
+        m_Failed = !success;
+        return success;
+    }
+
+    AsyncEncoder::Block* AsyncEncoder::AcquireBlock() {
+        std::unique_lock lock(m_Mutex);
+
+        if (m_Options.OnOverflow == Overflow::Block) {
+            m_FreeCondition.wait(lock, [this]() { return !m_FreeBlocks.empty() || m_Failed; });
+        }
+
+        if (m_FreeBlocks.empty() || m_Failed) {
+            return nullptr;
+        }
+
+        auto block = m_FreeBlocks.back();
+        m_FreeBlocks.pop_back();
+
+        return block;
+    }
+
+    void AsyncEncoder::Submit(Block* block) {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_ReadyBlocks.push(block);
+        }
+
+        m_ReadyCondition.notify_one();
+    }
+
+    void AsyncEncoder::Work() {
+        while (true) {
+            Block* block;
+
+            {
+                std::unique_lock lock(m_Mutex);
+                m_ReadyCondition.wait(lock,
+                                      [this]() { return !m_ReadyBlocks.empty() || m_Stopping; });
+
+                if (m_ReadyBlocks.empty()) {
+                    break;
+                }
+
+                block = m_ReadyBlocks.front();
+                m_ReadyBlocks.pop();
+            }
+
+            // blocks keep cycling after a failure so that the producer never waits on them
+            if (!m_Failed && !Encode(*block)) {
+                SCHMIX_ERROR("Background encoding failed - dropping the rest of the stream");
+                m_Failed = true;
+            }
+
+            {
+                std::lock_guard lock(m_Mutex);
+
+                block->Frames = 0;
+                m_FreeBlocks.push_back(block);
+            }
+
+            m_FreeCondition.notify_one();
+        }
+    }
+
+    bool AsyncEncoder::Encode(const Block& block) {
+        for (std::size_t i = 0; i < m_Channels; i++) {
+            m_Planes[i] = block.Samples.data() + i * m_Options.BlockFrames;
+        }
+
+        return m_Codec->WriteSignal(m_Planes.data(), m_Channels, block.Frames);
+    }
+} // namespace schmix
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "schmix/encoding/CodecStream.h"
+#include "schmix/encoding/FormatStream.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <queue>
+
+namespace schmix {
+    // encodes, and muxes if given a format stream, on a thread of its own
+    // writes only copy planar doubles into a free block of a bounded queue and return; the
+    // worker converts, encodes and writes them out in order
+    class AsyncEncoder {
+    public:
+        // what a write does when every block is still queued up
+        enum class Overflow : std::int32_t { Block = 0, Drop };
+
+        struct Options {
+            std::size_t BlockFrames = 4096;
+            std::size_t BlockCount = 64;
+
+            Overflow OnOverflow = Overflow::Block;
+
+            // passed on to libavcodec; see CodecStream::Options
+            std::size_t ThreadCount = 1;
+
+            Resampler::Quality Quality = Resampler::Quality::Balanced;
+        };
+
+        // picks the container and codec from the file name
+        // samples are written at the given rate and converted to whatever the codec takes
+        static std::unique_ptr<AsyncEncoder> OpenFile(const std::filesystem::path& path,
+                                                      std::size_t channels,
+                                                      std::size_t sampleRate,
+                                                      const Options& options);
+
+        // without a format stream, packets go wherever the codec stream sends them
+        AsyncEncoder(std::unique_ptr<CodecStream> codec, std::unique_ptr<FormatStream> format,
+                     std::size_t channels, std::size_t sampleRate, const Options& options);
+
+        ~AsyncEncoder();
+
+        AsyncEncoder(const AsyncEncoder&) = delete;
+        AsyncEncoder& operator=(const AsyncEncoder&) = delete;
+
+        bool IsOpen() const { return m_IsOpen; }
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+
+        // any number of frames, one buffer per channel
+        // false if the worker has failed, or if frames had to be dropped
+        bool Write(const double* const* channels, std::size_t frames);
+
+        // queues the last partial block, waits for the worker, then drains the encoder and
+        // writes the trailer; done on destruction if not called before
+        bool Finish();
+
+        bool HasFailed() const { return m_Failed; }
+        std::size_t GetDroppedFrames() const { return m_DroppedFrames; }
+
+    private:
+        struct Block {
+            // one run of BlockFrames samples per channel
+            std::vector<double> Samples;
+            std::size_t Frames = 0;
+        };
+
+        // null if the queue is full and writes drop, or if the worker has failed
+        Block* AcquireBlock();
+        void Submit(Block* block);
+
+        void Work();
+        bool Encode(const Block& block);
+
+        std::unique_ptr<CodecStream> m_Codec;
+        std::unique_ptr<FormatStream> m_Format;
+
+        std::size_t m_Channels, m_SampleRate;
+        Options m_Options;
+
+        std::vector<Block> m_Blocks;
+        std::vector<Block*> m_FreeBlocks;
+        std::queue<Block*> m_ReadyBlocks;
+
+        // owned by the producer until it fills up
+        Block* m_Current;
+
+        // worker only
+        std::vector<const double*> m_Planes;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_ReadyCondition, m_FreeCondition;
+        std::thread m_Thread;
+
+        std::atomic<std::size_t> m_DroppedFrames;
+        std::atomic<bool> m_Failed;
+
+        bool m_Stopping, m_Finished;
+        bool m_IsOpen;
+    };
+} // namespace schmix
@@ -0,0 +1,590 @@
+#include "schmixpch.h"
+#include "schmix/encoding/AudioDecoder.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+namespace schmix {
+    // frames handed to the resampler per step when reading mapped pcm
+    static constexpr std::size_t s_ChunkFrames = 4096;
+
+    // decoded ahead of a seek target when the codec does not say how much it needs
+    static constexpr std::size_t s_DefaultSeekPreroll = 2048;
+
+    // output frames decoded and dropped ahead of a seek target so the resampler has history
+    static constexpr std::size_t s_ResamplerPreroll = 256;
+
+    // spacing of seek index points, in source samples
+    static constexpr std::size_t s_SeekIndexInterval = 4096;
+
+    AudioDecoder::AudioDecoder(std::size_t channels, std::size_t sampleRate,
+                               Resampler::Quality quality, Layout layout) {
+        m_Packet = nullptr;
+        m_Frame = nullptr;
+
+        m_ReaderCursor = 0;
+        m_Chunk = nullptr;
+        m_ChunkFrames = 0;
+
+        m_PendingOffset = 0;
+        m_PendingFrames = 0;
+
+        m_Position = 0;
+
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+        m_Quality = quality;
+        m_Layout = layout;
+
+        m_EOF = false;
+        m_Drained = false;
+        m_IsOpen = false;
+    }
+
+    AudioDecoder::AudioDecoder(const IO::Callbacks& callbacks, std::size_t channels,
+                               std::size_t sampleRate, Resampler::Quality quality, Layout layout)
+        : AudioDecoder(channels, sampleRate, quality, layout) {
+        m_IsOpen = OpenStreams(callbacks);
+    }
+
+    AudioDecoder::AudioDecoder(const std::filesystem::path& path, std::size_t channels,
+                               std::size_t sampleRate, Resampler::Quality quality, Layout layout)
+        : AudioDecoder(channels, sampleRate, quality, layout) {
+        if (PCM::IsWAV(path)) {
+            auto reader = std::make_unique<PCM::Reader>(path);
+
+            // anything the reader does not understand still goes through libavcodec
+            if (reader->IsOpen()) {
+                m_Reader = std::move(reader);
+                m_IsOpen = true;
+
+                return;
+            }
+        }
+
+        auto callbacks = IO::OpenFile(path, IO::Mode::Input);
+        if (!callbacks.has_value()) {
+            return;
+        }
+
+        m_IsOpen = OpenStreams(callbacks.value());
+    }
+
+    bool AudioDecoder::OpenStreams(const IO::Callbacks& callbacks) {
+        m_Format = std::make_unique<FormatStream>(callbacks, IO::Mode::Input, nullptr);
+        if (!m_Format->IsOpen()) {
+            SCHMIX_ERROR("Failed to open input format!");
+            return false;
+        }
+
+        m_Codec = std::make_unique<CodecStream>(callbacks, IO::Mode::Input,
+                                                m_Format->GetCodecParameters(),
+                                                m_Format->GetAudioStreamIndex());
+
+        if (!m_Codec->IsOpen()) {
+            SCHMIX_ERROR("Failed to open decoder!");
+            return false;
+        }
+
+        m_Packet = av_packet_alloc();
+        m_Frame = av_frame_alloc();
+
+        if (m_Packet == nullptr || m_Frame == nullptr) {
+            SCHMIX_ERROR("Failed to allocate packet or frame!");
+            return false;
+        }
+
+        return true;
+    }
+
+    AudioDecoder::~AudioDecoder() {
+        av_frame_free(&m_Frame);
+        av_packet_free(&m_Packet);
+
+        // the codec may still reference packet data owned by the demuxer
+        m_Codec.reset();
+        m_Format.reset();
+    }
+
+    std::size_t AudioDecoder::GetSampleRate() const {
+        return m_SampleRate > 0 ? m_SampleRate : GetSourceSampleRate();
+    }
+
+    std::size_t AudioDecoder::GetSourceSampleRate() const {
+        if (m_Reader) {
+            return m_Reader->GetFormat().SampleRate;
+        }
+
+        return m_Format->GetCodecParameters().GetSampleRate();
+    }
+
+    std::optional<std::size_t> AudioDecoder::Read(double* interleaved, std::size_t frames) {
+        if (m_Layout != Layout::Interleaved) {
+            SCHMIX_ERROR("Decoder does not produce interleaved output!");
+            return {};
+        }
+
+        return ReadInto(&interleaved, frames);
+    }
+
+    std::optional<std::size_t> AudioDecoder::ReadPlanar(double* const* channels,
+                                                        std::size_t frames) {
+        if (m_Layout != Layout::Planar) {
+            SCHMIX_ERROR("Decoder does not produce planar output!");
+            return {};
+        }
+
+        return ReadInto(channels, frames);
+    }
+
+    std::size_t AudioDecoder::GetPlaneCount() const {
+        return m_Layout == Layout::Planar ? m_Channels : 1;
+    }
+
+    void AudioDecoder::SetOutput(double* const* planes, std::size_t offset) {
+        std::size_t planeCount = GetPlaneCount();
+        std::size_t stride = m_Layout == Layout::Planar ? 1 : m_Channels;
+
+        m_Output.resize(planeCount);
+        for (std::size_t i = 0; i < planeCount; i++) {
+            m_Output[i] = (std::uint8_t*)(planes[i] + offset * stride);
+        }
+    }
+
+    std::optional<std::size_t> AudioDecoder::ReadInto(double* const* planes, std::size_t frames) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return {};
+        }
+
+        std::size_t planeCount = GetPlaneCount();
+        std::size_t stride = m_Layout == Layout::Planar ? 1 : m_Channels;
+
+        std::size_t framesRead = 0;
+        while (framesRead < frames) {
+            std::size_t remaining = frames - framesRead;
+
+            if (m_PendingFrames > 0) {
+                std::size_t toCopy = std::min(m_PendingFrames, remaining);
+                for (std::size_t i = 0; i < planeCount; i++) {
+                    Memory::Copy(m_PendingPlanes[i] + m_PendingOffset * stride,
+                                 planes[i] + framesRead * stride,
+                                 toCopy * stride * sizeof(double));
+                }
+
+                m_PendingOffset += toCopy;
+                m_PendingFrames -= toCopy;
+                framesRead += toCopy;
+
+                continue;
+            }
+
+            const std::uint8_t* const* input = nullptr;
+            std::size_t inputFrames = 0;
+
+            if (m_EOF) {
+                // the resampler holds the last few frames until it is drained
+                if (!m_Resampler || m_Drained) {
+                    break;
+                }
+            } else {
+                auto decoded = m_Reader ? ReadNextChunk() : DecodeNextFrame();
+                if (!decoded.has_value()) {
+                    return {};
+                }
+
+                if (!decoded.value()) {
+                    m_EOF = true;
+                    continue;
+                }
+
+                if (m_Reader) {
+                    input = &m_Chunk;
+                    inputFrames = m_ChunkFrames;
+                } else {
+                    if (!PrepareResampler(m_Frame)) {
+                        return {};
+                    }
+
+                    input = m_Frame->extended_data;
+                    inputFrames = (std::size_t)m_Frame->nb_samples;
+
+                    if (!SkipToSeekTarget(input, inputFrames)) {
+                        continue;
+                    }
+                }
+            }
+
+            std::size_t capacity = m_Resampler->GetOutputCapacity(inputFrames);
+            if (capacity == 0) {
+                m_Drained = m_EOF;
+                continue;
+            }
+
+            std::optional<std::size_t> converted;
+            if (capacity <= remaining) {
+                // the common case: straight into the caller's buffers
+                SetOutput(planes, framesRead);
+                converted = m_Resampler->Convert(input, inputFrames, m_Output.data(), capacity);
+
+                if (converted.has_value()) {
+                    framesRead += converted.value();
+                }
+            } else {
+                if (m_Pending.size() < capacity * m_Channels) {
+                    m_Pending.resize(capacity * m_Channels);
+                }
+
+                m_PendingPlanes.resize(planeCount);
+                for (std::size_t i = 0; i < planeCount; i++) {
+                    m_PendingPlanes[i] = m_Pending.data() + i * capacity;
+                }
+
+                SetOutput(m_PendingPlanes.data(), 0);
+                converted = m_Resampler->Convert(input, inputFrames, m_Output.data(), capacity);
+
+                if (converted.has_value()) {
+                    m_PendingOffset = 0;
+                    m_PendingFrames = converted.value();
+                }
+            }
+
+            if (!converted.has_value()) {
+                return {};
+            }
+
+            if (m_EOF && converted.value() == 0) {
+                m_Drained = true;
+            }
+        }
+
+        return framesRead;
+    }
+
+    bool AudioDecoder::Rewind() {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        if (m_Reader) {
+            m_ReaderCursor = 0;
+        } else {
+            if (!m_Format->Rewind()) {
+                return false;
+            }
+
+            m_Codec->Reset();
+            av_frame_unref(m_Frame);
+        }
+
+        m_SeekTarget.reset();
+        return ResetOutput();
+    }
+
+    bool AudioDecoder::Seek(std::size_t frame) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        auto sourceRate = (std::int64_t)GetSourceSampleRate();
+        auto outputRate = (std::int64_t)GetSampleRate();
+
+        // a little output before the frame is decoded and dropped so the filter is warm
+        std::size_t discard = sourceRate != outputRate ? std::min(frame, s_ResamplerPreroll) : 0;
+        std::int64_t target = av_rescale((std::int64_t)(frame - discard), sourceRate, outputRate);
+
+        if (m_Reader) {
+            m_ReaderCursor = std::min((std::size_t)target, m_Reader->GetFrames());
+        } else {
+            const auto& parameters = m_Format->GetCodecParameters();
+
+            // decoders need some history before their output is valid again
+            std::size_t preroll =
+                std::max(parameters.GetSeekPreroll(), parameters.GetFrameSize() * 2);
+
+            if (preroll == 0) {
+                preroll = s_DefaultSeekPreroll;
+            }
+
+            std::int64_t start = std::max(target - (std::int64_t)preroll, (std::int64_t)0);
+            if (!m_Format->Seek(start)) {
+                return false;
+            }
+
+            m_Codec->Reset();
+            av_frame_unref(m_Frame);
+
+            // the demuxer may land earlier still; frame timestamps correct this
+            m_Position = start;
+            m_SeekTarget = target;
+        }
+
+        if (!ResetOutput()) {
+            return false;
+        }
+
+        if (discard > 0) {
+            std::size_t planeCount = GetPlaneCount();
+            std::size_t planeSize = m_Layout == Layout::Planar ? discard : discard * m_Channels;
+
+            std::vector<double> scratch(planeSize * planeCount);
+            std::vector<double*> planes(planeCount);
+
+            for (std::size_t i = 0; i < planeCount; i++) {
+                planes[i] = scratch.data() + i * planeSize;
+            }
+
+            if (!ReadInto(planes.data(), discard).has_value()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool AudioDecoder::PrepareSeekIndex(const std::filesystem::path& path) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        // mapped pcm is cheaper to index than to load an index for
+        if (m_Reader) {
+            return BuildSeekIndex();
+        }
+
+        auto index = SeekIndex::Load(path);
+        if (index.has_value() && SetSeekIndex(index.value())) {
+            return true;
+        }
+
+        if (!BuildSeekIndex()) {
+            return false;
+        }
+
+        if (!m_SeekIndex->Save(path)) {
+            SCHMIX_WARN("Seek index will be rebuilt next time");
+        }
+
+        return true;
+    }
+
+    bool AudioDecoder::BuildSeekIndex() {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        if (m_Reader) {
+            const auto& format = m_Reader->GetFormat();
+            // never saved, so it needs no fingerprint
+            SeekIndex index(format.SampleRate, 0);
+
+            std::size_t frames = m_Reader->GetFrames();
+            for (std::size_t frame = 0; frame < frames; frame += s_SeekIndexInterval) {
+                SeekIndex::Point point;
+                point.Sample = (std::int64_t)frame;
+                point.Timestamp = AV_NOPTS_VALUE;
+                point.Position = -1;
+
+                index.Add(point);
+            }
+
+            m_SeekIndex = std::move(index);
+            return true;
+        }
+
+        auto index = m_Format->BuildSeekIndex(s_SeekIndexInterval);
+        if (!index.has_value()) {
+            SCHMIX_ERROR("Failed to build seek index!");
+            return false;
+        }
+
+        // the demuxer was rewound underneath us
+        if (!Rewind()) {
+            return false;
+        }
+
+        m_Format->ApplySeekIndex(index.value());
+        m_SeekIndex = std::move(index);
+
+        return true;
+    }
+
+    bool AudioDecoder::SetSeekIndex(const SeekIndex& index) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        if (!m_Reader && !m_Format->ApplySeekIndex(index)) {
+            return false;
+        }
+
+        m_SeekIndex = index;
+        return true;
+    }
+
+    bool AudioDecoder::ResetOutput() {
+        // the filter history belongs to the old position
+        if (m_Resampler && !m_Resampler->Reset()) {
+            return false;
+        }
+
+        m_PendingOffset = 0;
+        m_PendingFrames = 0;
+
+        m_EOF = false;
+        m_Drained = false;
+
+        return true;
+    }
+
+    bool AudioDecoder::SkipToSeekTarget(const std::uint8_t* const*& input, std::size_t& frames) {
+        std::int64_t position = m_Position;
+        if (m_Frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+            position = m_Format->GetSamplePosition(m_Frame->best_effort_timestamp);
+        }
+
+        m_Position = position + (std::int64_t)frames;
+        if (!m_SeekTarget.has_value()) {
+            return true;
+        }
+
+        std::int64_t target = m_SeekTarget.value();
+        if (m_Position <= target) {
+            return false;
+        }
+
+        m_SeekTarget.reset();
+        if (position >= target) {
+            return true;
+        }
+
+        auto sampleFormat = (AVSampleFormat)m_Frame->format;
+        bool planar = av_sample_fmt_is_planar(sampleFormat) != 0;
+
+        std::size_t channels = (std::size_t)m_Frame->ch_layout.nb_channels;
+        std::size_t planeCount = planar ? channels : 1;
+
+        auto skipped = (std::size_t)(target - position);
+        std::size_t offset = skipped * (std::size_t)av_get_bytes_per_sample(sampleFormat) *
+                             (planar ? 1 : channels);
+
+        m_Trimmed.resize(planeCount);
+        for (std::size_t i = 0; i < planeCount; i++) {
+            m_Trimmed[i] = input[i] + offset;
+        }
+
+        input = m_Trimmed.data();
+        frames -= skipped;
+
+        return true;
+    }
+
+    std::optional<bool> AudioDecoder::DecodeNextFrame() {
+        av_frame_unref(m_Frame);
+
+        while (true) {
+            auto received = m_Codec->ReceiveFrame(m_Frame);
+            if (!received.has_value()) {
+                return {};
+            }
+
+            if (received.value()) {
+                return true;
+            }
+
+            if (m_Codec->IsDraining()) {
+                return false;
+            }
+
+            auto read = m_Format->ReadPacket(m_Packet);
+            if (!read.has_value()) {
+                return {};
+            }
+
+            bool sent = m_Codec->SendPacket(read.value() ? m_Packet : nullptr);
+            av_packet_unref(m_Packet);
+
+            if (!sent) {
+                return {};
+            }
+        }
+    }
+
+    std::optional<bool> AudioDecoder::ReadNextChunk() {
+        std::size_t frames = std::min(s_ChunkFrames, m_Reader->GetFrames() - m_ReaderCursor);
+        if (frames == 0) {
+            return false;
+        }
+
+        const auto& format = m_Reader->GetFormat();
+        const void* data = m_Reader->GetFrame(m_ReaderCursor);
+
+        Resampler::Format input;
+        input.Channels = format.Channels;
+        input.SampleRate = format.SampleRate;
+
+        auto sampleFormat = PCM::GetAVSampleFormat(format.SampleEncoding);
+        if (sampleFormat.has_value()) {
+            input.SampleFormat = sampleFormat.value();
+        } else {
+            // swresample has no packed 24-bit format
+            std::size_t samples = frames * format.Channels;
+            if (m_Widened.size() < samples) {
+                m_Widened.resize(samples);
+            }
+
+            PCM::WidenS24(data, m_Widened.data(), samples);
+
+            data = m_Widened.data();
+            input.SampleFormat = AV_SAMPLE_FMT_S32;
+        }
+
+        if (!PrepareResampler(input)) {
+            return {};
+        }
+
+        m_Chunk = (const std::uint8_t*)data;
+        m_ChunkFrames = frames;
+        m_ReaderCursor += frames;
+
+        return true;
+    }
+
+    bool AudioDecoder::PrepareResampler(const AVFrame* frame) {
+        Resampler::Format input;
+        input.Channels = (std::size_t)frame->ch_layout.nb_channels;
+        input.SampleRate = (std::size_t)frame->sample_rate;
+        input.SampleFormat = frame->format;
+
+        return PrepareResampler(input);
+    }
+
+    bool AudioDecoder::PrepareResampler(const Resampler::Format& input) {
+        if (m_Resampler && m_Resampler->GetInputFormat() == input) {
+            return true;
+        }
+
+        if (m_Resampler) {
+            // samples still buffered under the old format are lost
+            SCHMIX_WARN("Decoded stream changed format mid-file - restarting conversion");
+        }
+
+        Resampler::Format output;
+        output.Channels = m_Channels;
+        output.SampleRate = m_SampleRate > 0 ? m_SampleRate : input.SampleRate;
+        output.SampleFormat =
+            m_Layout == Layout::Planar ? AV_SAMPLE_FMT_DBLP : AV_SAMPLE_FMT_DBL;
+
+        m_Resampler = std::make_unique<Resampler>(input, output, m_Quality);
+        if (!m_Resampler->IsInitialized()) {
+            m_Resampler.reset();
+            return false;
+        }
+
+        return true;
+    }
+} // namespace schmix
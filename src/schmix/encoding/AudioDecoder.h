@@ -0,0 +1,126 @@
+#pragma once
+
+#include "schmix/encoding/FormatStream.h"
+#include "schmix/encoding/CodecStream.h"
+#include "schmix/encoding/Resampler.h"
+#include "schmix/encoding/PCM.h"
+
+namespace schmix {
+    // pulls double samples out of a demuxer and decoder pair
+    // output is converted to the requested channel count and rate; a rate of 0 keeps the source's
+    // wav files opened by path are read straight out of a memory map instead
+    class AudioDecoder {
+    public:
+        // interleaved output goes into one buffer, planar output into one buffer per channel
+        enum class Layout : std::int32_t { Interleaved = 0, Planar };
+
+        AudioDecoder(const IO::Callbacks& callbacks, std::size_t channels,
+                     std::size_t sampleRate = 0,
+                     Resampler::Quality quality = Resampler::Quality::Balanced,
+                     Layout layout = Layout::Interleaved);
+
+        AudioDecoder(const std::filesystem::path& path, std::size_t channels,
+                     std::size_t sampleRate = 0,
+                     Resampler::Quality quality = Resampler::Quality::Balanced,
+                     Layout layout = Layout::Interleaved);
+
+        ~AudioDecoder();
+
+        AudioDecoder(const AudioDecoder&) = delete;
+        AudioDecoder& operator=(const AudioDecoder&) = delete;
+
+        bool IsOpen() const { return m_IsOpen; }
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const;
+        std::size_t GetSourceSampleRate() const;
+        Layout GetLayout() const { return m_Layout; }
+
+        // reads up to the requested number of frames
+        // empty optional means error; fewer frames than requested means eof
+        std::optional<std::size_t> Read(double* interleaved, std::size_t frames);
+        std::optional<std::size_t> ReadPlanar(double* const* channels, std::size_t frames);
+
+        bool Rewind();
+
+        // positions the next read at the given frame, in the output rate
+        // compressed files land on an earlier packet and decode up to the frame, so the decoder
+        // is primed by the time output starts
+        bool Seek(std::size_t frame);
+
+        // loads the seek index at the given path, or builds one there if it is missing or stale
+        // building reads through the whole file and rewinds the decoder
+        bool PrepareSeekIndex(const std::filesystem::path& path);
+
+        // same as above without touching the disk; mapped pcm is indexed without reading anything
+        bool BuildSeekIndex();
+
+        // hands over an index built earlier, e.g. by another decoder reading the same file
+        bool SetSeekIndex(const SeekIndex& index);
+
+        const std::optional<SeekIndex>& GetSeekIndex() const { return m_SeekIndex; }
+
+    private:
+        AudioDecoder(std::size_t channels, std::size_t sampleRate, Resampler::Quality quality,
+                     Layout layout);
+
+        bool OpenStreams(const IO::Callbacks& callbacks);
+
+        std::optional<std::size_t> ReadInto(double* const* planes, std::size_t frames);
+
+        // drops buffered output and filter history after the source moves
+        bool ResetOutput();
+
+        // trims decoded input that comes before the seek target; false if all of it does
+        bool SkipToSeekTarget(const std::uint8_t* const*& input, std::size_t& frames);
+
+        std::optional<bool> DecodeNextFrame();
+        std::optional<bool> ReadNextChunk();
+
+        bool PrepareResampler(const AVFrame* frame);
+        bool PrepareResampler(const Resampler::Format& input);
+
+        std::size_t GetPlaneCount() const;
+
+        // points m_Output at the given planes, skipping the given number of frames
+        void SetOutput(double* const* planes, std::size_t offset);
+
+        std::unique_ptr<FormatStream> m_Format;
+        std::unique_ptr<CodecStream> m_Codec;
+
+        AVPacket* m_Packet;
+        AVFrame* m_Frame;
+
+        // present instead of the streams above when the file is plain pcm
+        std::unique_ptr<PCM::Reader> m_Reader;
+        std::size_t m_ReaderCursor;
+
+        // the mapped chunk handed to the resampler; 24-bit files are widened first
+        const std::uint8_t* m_Chunk;
+        std::size_t m_ChunkFrames;
+        std::vector<std::int32_t> m_Widened;
+
+        std::unique_ptr<Resampler> m_Resampler;
+        std::vector<std::uint8_t*> m_Output;
+
+        // only used for the frame straddling the end of a read; everything else is converted
+        // straight into the caller's buffers
+        std::vector<double> m_Pending;
+        std::vector<double*> m_PendingPlanes;
+        std::size_t m_PendingOffset, m_PendingFrames;
+
+        std::optional<SeekIndex> m_SeekIndex;
+
+        // in source samples; the position only matters while a seek target is set
+        std::optional<std::int64_t> m_SeekTarget;
+        std::int64_t m_Position;
+        std::vector<const std::uint8_t*> m_Trimmed;
+
+        std::size_t m_Channels, m_SampleRate;
+        Resampler::Quality m_Quality;
+        Layout m_Layout;
+
+        bool m_EOF, m_Drained;
+        bool m_IsOpen;
+    };
+} // namespace schmix
@@ -0,0 +1,97 @@
+#include "schmixpch.h"
+#include "schmix/encoding/AudioFIFO.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+namespace schmix {
+    AudioFIFO::AudioFIFO(std::size_t channels, std::int32_t sampleFormat, std::size_t frameSize) {
+        m_FrameSize = frameSize;
+        m_Buffered = 0;
+
+        auto format = (AVSampleFormat)sampleFormat;
+        bool planar = av_sample_fmt_is_planar(format) != 0;
+
+        m_Planes = planar ? channels : 1;
+        m_PlaneFrameSize =
+            (planar ? 1 : channels) * (std::size_t)av_get_bytes_per_sample(format);
+
+        m_Buffer.resize(m_Planes * m_PlaneFrameSize * m_FrameSize);
+        m_BufferPlanes.resize(m_Planes);
+        m_Offset.resize(m_Planes);
+
+        for (std::size_t i = 0; i < m_Planes; i++) {
+            m_BufferPlanes[i] = m_Buffer.data() + i * m_PlaneFrameSize * m_FrameSize;
+        }
+    }
+
+    bool AudioFIFO::Write(const std::uint8_t* const* planes, std::size_t frames,
+                          const Sink& sink) {
+        if (frames == 0) {
+            return true;
+        }
+
+        if (m_FrameSize == 0) {
+            return sink(planes, frames);
+        }
+
+        std::size_t offset = 0;
+
+        // top up a partial frame first so ordering is kept
+        if (m_Buffered > 0) {
+            std::size_t toCopy = std::min(frames, m_FrameSize - m_Buffered);
+            Append(planes, toCopy);
+
+            offset += toCopy;
+            if (m_Buffered < m_FrameSize) {
+                return true;
+            }
+
+            m_Buffered = 0;
+            if (!sink(m_BufferPlanes.data(), m_FrameSize)) {
+                return false;
+            }
+        }
+
+        for (; frames - offset >= m_FrameSize; offset += m_FrameSize) {
+            if (!sink(Offset(planes, offset), m_FrameSize)) {
+                return false;
+            }
+        }
+
+        Append(Offset(planes, offset), frames - offset);
+        return true;
+    }
+
+    bool AudioFIFO::Flush(const Sink& sink) {
+        if (m_Buffered == 0) {
+            return true;
+        }
+
+        std::size_t frames = m_Buffered;
+        m_Buffered = 0;
+
+        return sink(m_BufferPlanes.data(), frames);
+    }
+
+    const std::uint8_t* const* AudioFIFO::Offset(const std::uint8_t* const* planes,
+                                                 std::size_t frame) {
+        for (std::size_t i = 0; i < m_Planes; i++) {
+            m_Offset[i] = planes[i] + frame * m_PlaneFrameSize;
+        }
+
+        return m_Offset.data();
+    }
+
+    void AudioFIFO::Append(const std::uint8_t* const* planes, std::size_t frames) {
+        if (frames == 0) {
+            return;
+        }
+
+        for (std::size_t i = 0; i < m_Planes; i++) {
+            auto destination = (std::uint8_t*)m_BufferPlanes[i] + m_Buffered * m_PlaneFrameSize;
+            Memory::Copy(planes[i], destination, frames * m_PlaneFrameSize);
+        }
+
+        m_Buffered += frames;
+    }
+} // namespace schmix
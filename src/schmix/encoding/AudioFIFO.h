@@ -0,0 +1,43 @@
+#pragma once
+
+namespace schmix {
+    // re-chunks writes of any length into frames of a fixed size, e.g. an encoder's frame size
+    // only the remainder that does not fill a whole frame is copied; everything else is handed
+    // on straight from the caller's buffers
+    class AudioFIFO {
+    public:
+        // planes follow libav conventions; packed formats use a single plane
+        // returning false stops the write and fails it
+        using Sink = std::function<bool(const std::uint8_t* const* planes, std::size_t frames)>;
+
+        // a frame size of 0 passes every write through as it comes
+        AudioFIFO(std::size_t channels, std::int32_t sampleFormat, std::size_t frameSize);
+
+        AudioFIFO(const AudioFIFO&) = delete;
+        AudioFIFO& operator=(const AudioFIFO&) = delete;
+
+        std::size_t GetFrameSize() const { return m_FrameSize; }
+        std::size_t GetBufferedFrames() const { return m_Buffered; }
+
+        bool Write(const std::uint8_t* const* planes, std::size_t frames, const Sink& sink);
+
+        // hands on whatever is buffered as one short frame
+        bool Flush(const Sink& sink);
+
+        void Reset() { m_Buffered = 0; }
+
+    private:
+        // points m_Offset at the given frame of each plane
+        const std::uint8_t* const* Offset(const std::uint8_t* const* planes, std::size_t frame);
+
+        void Append(const std::uint8_t* const* planes, std::size_t frames);
+
+        std::size_t m_FrameSize, m_Buffered;
+
+        std::size_t m_Planes;
+        std::size_t m_PlaneFrameSize;
+
+        std::vector<std::uint8_t> m_Buffer;
+        std::vector<const std::uint8_t*> m_BufferPlanes, m_Offset;
+    };
+} // namespace schmix
@@ -0,0 +1,56 @@
+#include "schmixpch.h"
+#include "schmix/encoding/AudioFrame.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+namespace schmix {
+    static std::atomic<std::size_t> s_LiveFrames = 0;
+
+    std::size_t AudioFrame::GetLiveCount() { return s_LiveFrames.load(std::memory_order_relaxed); }
+
+    AudioFrame::AudioFrame(AVFrame* frame) {
+        m_Frame = av_frame_alloc();
+        if (m_Frame == nullptr) {
+            throw std::runtime_error("Failed to allocate frame!");
+        }
+
+        av_frame_move_ref(m_Frame, frame);
+        s_LiveFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    AudioFrame::~AudioFrame() {
+        av_frame_free(&m_Frame);
+        s_LiveFrames.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::size_t AudioFrame::GetSamples() const { return (std::size_t)m_Frame->nb_samples; }
+
+    std::size_t AudioFrame::GetChannels() const {
+        return (std::size_t)m_Frame->ch_layout.nb_channels;
+    }
+
+    std::size_t AudioFrame::GetSampleRate() const { return (std::size_t)m_Frame->sample_rate; }
+
+    std::int32_t AudioFrame::GetAVSampleFormat() const { return m_Frame->format; }
+
+    bool AudioFrame::IsPlanar() const {
+        return av_sample_fmt_is_planar((AVSampleFormat)m_Frame->format) != 0;
+    }
+
+    std::size_t AudioFrame::GetPlaneCount() const { return IsPlanar() ? GetChannels() : 1; }
+
+    const void* AudioFrame::GetPlane(std::size_t index) const {
+        if (index >= GetPlaneCount()) {
+            return nullptr;
+        }
+
+        return m_Frame->extended_data[index];
+    }
+
+    std::size_t AudioFrame::GetPlaneSize() const {
+        std::size_t sampleSize = av_get_bytes_per_sample((AVSampleFormat)m_Frame->format);
+        std::size_t samplesPerPlane = GetSamples() * (IsPlanar() ? 1 : GetChannels());
+
+        return samplesPerPlane * sampleSize;
+    }
+} // namespace schmix
@@ -0,0 +1,42 @@
+#pragma once
+#include "schmix/core/Ref.h"
+
+typedef struct AVFrame AVFrame;
+
+namespace schmix {
+    // a decoded frame holding references to libav's own buffers
+    // the buffers go back to the decoder's pool once the last reference is dropped
+    class AudioFrame : public RefCounted {
+    public:
+        // takes over the references held by the given frame, leaving it blank
+        AudioFrame(AVFrame* frame);
+        virtual ~AudioFrame() override;
+
+        AudioFrame(const AudioFrame&) = delete;
+        AudioFrame& operator=(const AudioFrame&) = delete;
+
+        std::size_t GetSamples() const;
+        std::size_t GetChannels() const;
+        std::size_t GetSampleRate() const;
+
+        // int32 so we dont have to include the header
+        std::int32_t GetAVSampleFormat() const;
+
+        bool IsPlanar() const;
+
+        // one plane per channel for planar formats, otherwise a single interleaved plane
+        std::size_t GetPlaneCount() const;
+        const void* GetPlane(std::size_t index) const;
+
+        // bytes of sample data in each plane
+        std::size_t GetPlaneSize() const;
+
+        const AVFrame* Get() const { return m_Frame; }
+
+        // frames constructed and not yet destroyed, across every thread
+        static std::size_t GetLiveCount();
+
+    private:
+        AVFrame* m_Frame;
+    };
+} // namespace schmix
@@ -0,0 +1,393 @@
+#include "schmixpch.h"
+#include "schmix/encoding/BatchTranscoder.h"
+
+#include "schmix/encoding/AudioDecoder.h"
+#include "schmix/encoding/FileEncoder.h"
+#include "schmix/encoding/MediaPipeline.h"
+#include "schmix/encoding/PCM.h"
+
+#include "schmix/core/ThreadPool.h"
+
+namespace schmix {
+    // frames per channel decoded and encoded at a time, per job
+    static constexpr std::size_t s_BlockFrames = 8192;
+
+    bool BatchTranscoder::MatchGlob(std::string_view pattern, std::string_view path) {
+        if (pattern.empty()) {
+            return path.empty();
+        }
+
+        if (pattern.starts_with("**")) {
+            auto rest = pattern.substr(2);
+
+            // "**/" also matches no directories at all
+            if (rest.starts_with('/') && MatchGlob(rest.substr(1), path)) {
+                return true;
+            }
+
+            for (std::size_t i = 0; i <= path.size(); i++) {
+                if (MatchGlob(rest, path.substr(i))) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        if (pattern[0] == '*') {
+            auto rest = pattern.substr(1);
+            for (std::size_t i = 0; i <= path.size(); i++) {
+                if (MatchGlob(rest, path.substr(i))) {
+                    return true;
+                }
+
+                if (i < path.size() && path[i] == '/') {
+                    break;
+                }
+            }
+
+            return false;
+        }
+
+        if (path.empty()) {
+            return false;
+        }
+
+        bool matches = pattern[0] == '?' ? path[0] != '/' : pattern[0] == path[0];
+        return matches && MatchGlob(pattern.substr(1), path.substr(1));
+    }
+
+    // the same file spelled differently compares equal; outputs need not exist yet
+    static std::string GetPathKey(const std::filesystem::path& path) {
+        std::error_code error;
+        auto canonical = std::filesystem::weakly_canonical(path, error);
+
+        if (error) {
+            canonical = std::filesystem::absolute(path, error).lexically_normal();
+        }
+
+        return canonical.generic_string();
+    }
+
+    std::optional<std::vector<BatchTranscoder::Job>> BatchTranscoder::CollectJobs(
+        const std::string& inputGlob, const std::string& outputPattern) {
+        std::string glob = std::filesystem::path(inputGlob).generic_string();
+
+        std::filesystem::path root;
+        std::vector<std::filesystem::path> inputs;
+
+        std::size_t wildcard = glob.find_first_of("*?");
+        if (wildcard == std::string::npos) {
+            std::filesystem::path input = glob;
+            if (!std::filesystem::is_regular_file(input)) {
+                SCHMIX_ERROR("No such file: {}", glob.c_str());
+                return {};
+            }
+
+            root = input.parent_path();
+            inputs.push_back(input);
+        } else {
+            std::size_t slash = glob.rfind('/', wildcard);
+
+            std::string pattern;
+            if (slash == std::string::npos) {
+                root = ".";
+                pattern = glob;
+            } else {
+                root = slash == 0 ? "/" : glob.substr(0, slash);
+                pattern = glob.substr(slash + 1);
+            }
+
+            auto matches = [&](const std::filesystem::directory_entry& entry) {
+                if (!entry.is_regular_file()) {
+                    return;
+                }
+
+                auto relative = entry.path().lexically_relative(root).generic_string();
+                if (MatchGlob(pattern, relative)) {
+                    inputs.push_back(entry.path());
+                }
+            };
+
+            static constexpr auto iteratorOptions =
+                std::filesystem::directory_options::skip_permission_denied;
+
+            std::error_code error;
+            if (pattern.find('/') != std::string::npos || pattern.find("**") != std::string::npos) {
+                for (const auto& entry :
+                     std::filesystem::recursive_directory_iterator(root, iteratorOptions, error)) {
+                    matches(entry);
+                }
+            } else {
+                for (const auto& entry :
+                     std::filesystem::directory_iterator(root, iteratorOptions, error)) {
+                    matches(entry);
+                }
+            }
+
+            if (error) {
+                SCHMIX_ERROR("Failed to list {}: {}", root.string().c_str(),
+                             error.message().c_str());
+
+                return {};
+            }
+        }
+
+        std::size_t star = outputPattern.find('*');
+        if (star != std::string::npos && outputPattern.find('*', star + 1) != std::string::npos) {
+            SCHMIX_ERROR("Output pattern can only have one *: {}", outputPattern.c_str());
+            return {};
+        }
+
+        if (star == std::string::npos && inputs.size() > 1) {
+            SCHMIX_ERROR("Output pattern needs a * when more than one file matches");
+            return {};
+        }
+
+        std::sort(inputs.begin(), inputs.end());
+
+        std::vector<Job> jobs;
+        for (const auto& input : inputs) {
+            auto& job = jobs.emplace_back();
+            job.Input = input;
+
+            if (star == std::string::npos) {
+                job.Output = outputPattern;
+                continue;
+            }
+
+            auto relative = input.lexically_relative(root).replace_extension().generic_string();
+            job.Output = outputPattern.substr(0, star) + relative + outputPattern.substr(star + 1);
+        }
+
+        std::unordered_set<std::string> outputs;
+        for (const auto& job : jobs) {
+            outputs.insert(GetPathKey(job.Output));
+        }
+
+        // a glob that also covers the output directory picks up earlier outputs as inputs, and
+        // an input mapped onto itself would be truncated before it is read
+        std::erase_if(jobs, [&](const Job& job) {
+            if (!outputs.contains(GetPathKey(job.Input))) {
+                return false;
+            }
+
+            SCHMIX_WARN("Skipping {} - it is also an output", job.Input.string().c_str());
+            return true;
+        });
+
+        // e.g. a.wav and a.flac both mapping onto a.mp3
+        std::unordered_map<std::string, const Job*> claimed;
+        for (const auto& job : jobs) {
+            auto [it, inserted] = claimed.try_emplace(GetPathKey(job.Output), &job);
+            if (!inserted) {
+                SCHMIX_ERROR("{} and {} would both be written to {}",
+                             it->second->Input.string().c_str(), job.Input.string().c_str(),
+                             job.Output.string().c_str());
+
+                return {};
+            }
+        }
+
+        return jobs;
+    }
+
+    BatchTranscoder::BatchTranscoder(const Options& options) { m_Options = options; }
+
+    bool BatchTranscoder::Run(const std::vector<Job>& jobs, const ProgressCallback& callback,
+                              std::chrono::milliseconds interval) {
+        std::atomic<std::size_t> frames, completed, failed, skipped;
+        frames = completed = failed = skipped = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        auto report = [&]() {
+            if (!callback) {
+                return;
+            }
+
+            Progress progress;
+            progress.Total = jobs.size();
+            progress.Completed = completed;
+            progress.Failed = failed;
+            progress.Skipped = skipped;
+            progress.Frames = frames;
+            progress.Elapsed = std::chrono::steady_clock::now() - start;
+
+            callback(progress);
+        };
+
+        ThreadPool pool(m_Options.Jobs);
+        SCHMIX_INFO("Transcoding {} files on {} workers", jobs.size(), pool.GetThreadCount());
+
+        // one job per worker keeps every core busy on its own
+        bool pipelined = jobs.size() < pool.GetThreadCount();
+
+        std::vector<std::future<void>> results;
+        results.reserve(jobs.size());
+
+        for (const auto& job : jobs) {
+            results.push_back(pool.Submit([&]() {
+                std::error_code error;
+                if (!m_Options.Overwrite && std::filesystem::exists(job.Output, error)) {
+                    SCHMIX_DEBUG("Skipping {} - output exists", job.Input.string().c_str());
+
+                    skipped++;
+                    return;
+                }
+
+                if (Transcode(job, frames, pipelined)) {
+                    completed++;
+                } else {
+                    failed++;
+                }
+            }));
+        }
+
+        auto next = start + interval;
+        for (auto& result : results) {
+            while (result.wait_until(next) != std::future_status::ready) {
+                report();
+                next += interval;
+            }
+        }
+
+        report();
+        return failed == 0;
+    }
+
+    static bool EncodeFile(AudioDecoder& decoder, FileEncoder::Streams& streams,
+                           Resampler::Quality quality, std::atomic<std::size_t>& frames) {
+        std::size_t channels = decoder.GetChannels();
+        if (!FileEncoder::Connect(*streams.Codec, streams.Format.get(), channels,
+                                  decoder.GetSampleRate(), quality)) {
+            return false;
+        }
+
+        std::vector<double> buffer(s_BlockFrames * channels);
+        std::vector<double*> planes(channels);
+
+        for (std::size_t i = 0; i < channels; i++) {
+            planes[i] = buffer.data() + i * s_BlockFrames;
+        }
+
+        while (true) {
+            auto read = decoder.ReadPlanar(planes.data(), s_BlockFrames);
+            if (!read.has_value()) {
+                return false;
+            }
+
+            if (read.value() > 0 &&
+                !streams.Codec->WriteSignal(planes.data(), channels, read.value())) {
+                return false;
+            }
+
+            frames += read.value();
+            if (read.value() < s_BlockFrames) {
+                break;
+            }
+        }
+
+        return streams.Codec->Flush() && streams.Format->Finish();
+    }
+
+    static bool EncodePipelined(MediaPipeline& pipeline, FileEncoder::Streams& streams,
+                                Resampler::Quality quality, std::atomic<std::size_t>& frames) {
+        std::size_t channels = pipeline.GetChannels();
+        if (!FileEncoder::Connect(*streams.Codec, streams.Format.get(), channels,
+                                  pipeline.GetSampleRate(), quality)) {
+            return false;
+        }
+
+        // the encoder runs on the pipeline's last stage
+        auto sink = [&](const double* const* planes, std::size_t count) {
+            if (!streams.Codec->WriteSignal(planes, channels, count)) {
+                return false;
+            }
+
+            frames += count;
+            return true;
+        };
+
+        if (!pipeline.Start(sink)) {
+            return false;
+        }
+
+        // a write that fails stops the pipeline through the sink
+        if (pipeline.Wait() != MediaPipeline::Status::Finished) {
+            return false;
+        }
+
+        return streams.Codec->Flush() && streams.Format->Finish();
+    }
+
+    bool BatchTranscoder::Transcode(const Job& job, std::atomic<std::size_t>& frames,
+                                    bool pipelined) const {
+        auto input = job.Input.string();
+
+        // wav is read straight out of memory, so there is nothing for a pipeline to overlap
+        pipelined &= !PCM::IsWAV(job.Input);
+
+        std::unique_ptr<AudioDecoder> decoder;
+        std::unique_ptr<MediaPipeline> pipeline;
+        std::size_t sampleRate;
+
+        if (pipelined) {
+            MediaPipeline::Options pipelineOptions;
+            pipelineOptions.Quality = m_Options.Quality;
+
+            pipeline = std::make_unique<MediaPipeline>(job.Input, m_Options.Channels,
+                                                       m_Options.SampleRate, pipelineOptions);
+
+            if (!pipeline->IsOpen()) {
+                SCHMIX_ERROR("Failed to open {} for decoding", input.c_str());
+                return false;
+            }
+
+            sampleRate = pipeline->GetSampleRate();
+        } else {
+            decoder = std::make_unique<AudioDecoder>(job.Input, m_Options.Channels,
+                                                     m_Options.SampleRate, m_Options.Quality,
+                                                     AudioDecoder::Layout::Planar);
+
+            if (!decoder->IsOpen()) {
+                SCHMIX_ERROR("Failed to open {} for decoding", input.c_str());
+                return false;
+            }
+
+            sampleRate = decoder->GetSampleRate();
+        }
+
+        std::error_code error;
+        auto directory = job.Output.parent_path();
+        if (!directory.empty()) {
+            std::filesystem::create_directories(directory, error);
+        }
+
+        auto streams =
+            FileEncoder::Open(job.Output, m_Options.Channels, sampleRate, m_Options.CodecThreads);
+
+        if (!streams.has_value()) {
+            SCHMIX_ERROR("Failed to open {} for encoding", job.Output.string().c_str());
+            return false;
+        }
+
+        bool success =
+            pipeline ? EncodePipelined(*pipeline, streams.value(), m_Options.Quality, frames)
+                     : EncodeFile(*decoder, streams.value(), m_Options.Quality, frames);
+
+        // the codec writes into the muxer
+        streams->Codec.reset();
+        streams->Format.reset();
+
+        if (!success) {
+            SCHMIX_ERROR("Failed to transcode {}", input.c_str());
+
+            // never leave a truncated file behind for the next run to skip
+            std::filesystem::remove(job.Output, error);
+            return false;
+        }
+
+        SCHMIX_DEBUG("Transcoded {} to {}", input.c_str(), job.Output.string().c_str());
+        return true;
+    }
+} // namespace schmix
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "schmix/encoding/Resampler.h"
+
+namespace schmix {
+    // converts many files at once, one file per worker, with no window or script runtime
+    // each job decodes, converts and encodes on its worker's thread alone, so throughput scales
+    // with the number of workers rather than with how well a single codec threads
+    // with fewer jobs than workers, each job demuxes, decodes and converts on a media pipeline
+    // of its own instead, so that the spare cores still help
+    class BatchTranscoder {
+    public:
+        struct Options {
+            std::size_t Channels = 2;
+
+            // 0 keeps each source's rate
+            std::size_t SampleRate = 0;
+
+            // 0 means one per hardware thread
+            std::size_t Jobs = 0;
+
+            // passed on to libavcodec for each encoder; see CodecStream::Options
+            std::size_t CodecThreads = 1;
+
+            Resampler::Quality Quality = Resampler::Quality::Balanced;
+
+            // existing outputs are skipped otherwise
+            bool Overwrite = false;
+        };
+
+        struct Job {
+            std::filesystem::path Input, Output;
+        };
+
+        struct Progress {
+            std::size_t Total = 0;
+            std::size_t Completed = 0;
+            std::size_t Failed = 0;
+            std::size_t Skipped = 0;
+
+            // output frames encoded so far, across every job
+            std::size_t Frames = 0;
+
+            std::chrono::duration<double> Elapsed;
+        };
+
+        // called on the thread that called Run, roughly once per interval and once at the end
+        using ProgressCallback = std::function<void(const Progress& progress)>;
+
+        // the input glob takes *, ? and ** (any number of directories)
+        // the single * in the output pattern is replaced with each input's path relative to the
+        // first wildcard of the glob, minus its extension; the output extension picks the format
+        // inputs that are also some job's output are left out, and two inputs mapping onto the
+        // same output fail the whole collection
+        static std::optional<std::vector<Job>> CollectJobs(const std::string& inputGlob,
+                                                           const std::string& outputPattern);
+
+        // matches a whole path, with / as the only separator
+        static bool MatchGlob(std::string_view pattern, std::string_view path);
+
+        BatchTranscoder(const Options& options);
+        ~BatchTranscoder() = default;
+
+        BatchTranscoder(const BatchTranscoder&) = delete;
+        BatchTranscoder& operator=(const BatchTranscoder&) = delete;
+
+        // blocks until every job has run; false if any of them failed
+        bool Run(const std::vector<Job>& jobs, const ProgressCallback& callback,
+                 std::chrono::milliseconds interval);
+
+        // a single job, blocking the calling thread; the frame count is updated as it goes
+        // a pipelined job spreads its stages over threads of its own
+        bool Transcode(const Job& job, std::atomic<std::size_t>& frames, bool pipelined) const;
+
+    private:
+        Options m_Options;
+    };
+} // namespace schmix
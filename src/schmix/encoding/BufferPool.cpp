@@ -0,0 +1,75 @@
+#include "schmixpch.h"
+#include "schmix/encoding/BufferPool.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+#include <bit>
+
+namespace schmix {
+    BufferPool::BufferPool() {
+        m_Pool = nullptr;
+        m_BufferSize = 0;
+    }
+
+    BufferPool::~BufferPool() {
+        // outstanding buffers keep the pool alive until they are released
+        av_buffer_pool_uninit(&m_Pool);
+    }
+
+    AVBufferRef* BufferPool::Get(std::size_t size) {
+        std::size_t required = size + AV_INPUT_BUFFER_PADDING_SIZE;
+
+        if (m_Pool == nullptr || required > m_BufferSize) {
+            av_buffer_pool_uninit(&m_Pool);
+
+            // round up so that slowly growing requests dont resize every time
+            m_BufferSize = std::bit_ceil(std::max(required, m_BufferSize));
+            m_Pool = av_buffer_pool_init(m_BufferSize, nullptr);
+
+            if (m_Pool == nullptr) {
+                SCHMIX_ERROR("Failed to allocate buffer pool!");
+
+                m_BufferSize = 0;
+                return nullptr;
+            }
+        }
+
+        auto buffer = av_buffer_pool_get(m_Pool);
+        if (buffer == nullptr) {
+            SCHMIX_ERROR("Failed to get buffer from pool!");
+            return nullptr;
+        }
+
+        Memory::Fill(buffer->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        return buffer;
+    }
+
+    bool BufferPool::GetFrame(AVFrame* frame) {
+        auto sampleFormat = (AVSampleFormat)frame->format;
+        int channels = frame->ch_layout.nb_channels;
+
+        int bufferSize =
+            av_samples_get_buffer_size(nullptr, channels, frame->nb_samples, sampleFormat, 1);
+
+        if (bufferSize < 0) {
+            SCHMIX_ERROR("Invalid frame size!");
+            return false;
+        }
+
+        auto buffer = Get((std::size_t)bufferSize);
+        if (buffer == nullptr) {
+            return false;
+        }
+
+        frame->buf[0] = buffer;
+        if (avcodec_fill_audio_frame(frame, channels, sampleFormat, buffer->data, bufferSize, 1) <
+            0) {
+            SCHMIX_ERROR("Failed to set up frame pointers!");
+
+            av_frame_unref(frame);
+            return false;
+        }
+
+        return true;
+    }
+} // namespace schmix
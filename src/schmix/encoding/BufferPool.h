@@ -0,0 +1,32 @@
+#pragma once
+
+typedef struct AVBufferPool AVBufferPool;
+typedef struct AVBufferRef AVBufferRef;
+typedef struct AVFrame AVFrame;
+
+namespace schmix {
+    // hands out ref-counted libav buffers that go back to the pool once every reference is dropped
+    // the pool grows to fit the largest request; buffers from before a resize are simply freed
+    class BufferPool {
+    public:
+        BufferPool();
+        ~BufferPool();
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        // the returned buffer is at least the requested size plus libav's input padding
+        // the padding is zeroed; null on failure
+        AVBufferRef* Get(std::size_t size);
+
+        // backs a frame with a pooled buffer, so that whoever it is sent to can keep a reference
+        // instead of copying it; sample count, format and channel layout must already be set
+        bool GetFrame(AVFrame* frame);
+
+        std::size_t GetBufferSize() const { return m_BufferSize; }
+
+    private:
+        AVBufferPool* m_Pool;
+        std::size_t m_BufferSize;
+    };
+} // namespace schmix
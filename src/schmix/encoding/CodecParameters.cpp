@@ -49,6 +49,9 @@ namespace schmix {
     }
 
     std::size_t CodecParameters::GetChannels() const { return m_Parameters->ch_layout.nb_channels; }
+    std::size_t CodecParameters::GetSampleRate() const { return m_Parameters->sample_rate; }
+    std::size_t CodecParameters::GetFrameSize() const { return m_Parameters->frame_size; }
+    std::size_t CodecParameters::GetSeekPreroll() const { return m_Parameters->seek_preroll; }
 
     std::int32_t CodecParameters::GetAVSampleFormat() const {
         return (std::int32_t)m_Parameters->format;
@@ -58,6 +61,6 @@ namespace schmix {
         int channels = m_Parameters->ch_layout.nb_channels;
         auto sampleFormat = (AVSampleFormat)m_Parameters->format;
 
-        return av_samples_get_buffer_size(nullptr, channels, (int)samples, sampleFormat, 0);
+        return av_samples_get_buffer_size(nullptr, channels, (int)samples, sampleFormat, 1);
     }
 } // namespace schmix
@@ -20,6 +20,13 @@ namespace schmix {
         const AVCodecParameters* Get() const { return m_Parameters; }
 
         std::size_t GetChannels() const;
+        std::size_t GetSampleRate() const;
+
+        // samples per frame; 0 when it varies or is unknown
+        std::size_t GetFrameSize() const;
+
+        // samples the decoder needs to settle after a discontinuity
+        std::size_t GetSeekPreroll() const;
 
         // int32 so we dont have to include the header
         std::int32_t GetAVSampleFormat() const;
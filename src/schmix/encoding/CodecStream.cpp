@@ -5,8 +5,14 @@
 
 namespace schmix {
     CodecStream::CodecStream(const IO::Callbacks& callbacks, IO::Mode mode,
-                             const CodecParameters& parameters, std::size_t streamIndex) {
+                             const CodecParameters& parameters, std::size_t streamIndex)
+        : CodecStream(callbacks, mode, parameters, streamIndex, Options()) {}
+
+    CodecStream::CodecStream(const IO::Callbacks& callbacks, IO::Mode mode,
+                             const CodecParameters& parameters, std::size_t streamIndex,
+                             const Options& options) {
         m_IsOpen = false;
+        m_Draining = false;
 
         m_Callbacks = callbacks;
         m_Mode = mode;
@@ -14,9 +20,19 @@ namespace schmix {
         m_Parameters = parameters;
         m_StreamIndex = streamIndex;
 
+        m_Muxer = nullptr;
+        m_MuxerStream = 0;
+
         m_Codec = nullptr;
         m_Context = nullptr;
 
+        m_Frame = nullptr;
+        m_ConvertedFrame = nullptr;
+        m_Packet = nullptr;
+
+        m_ConversionQuality = Resampler::Quality::Balanced;
+        m_NextPTS = 0;
+
         auto codecParams = m_Parameters.Get();
         auto avCodecID = codecParams->codec_id;
 
@@ -42,34 +58,148 @@ namespace schmix {
 
         avcodec_parameters_to_context(m_Context, codecParams);
 
+        // timestamps count samples
+        if (mode == IO::Mode::Output) {
+            m_Context->time_base = { 1, m_Context->sample_rate };
+
+            if (options.GlobalHeader) {
+                m_Context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+        }
+
+        int threadType = 0;
+        if (options.FrameThreads && (m_Codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) != 0) {
+            threadType |= FF_THREAD_FRAME;
+        }
+
+        if (options.SliceThreads && (m_Codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) != 0) {
+            threadType |= FF_THREAD_SLICE;
+        }
+
+        m_Context->thread_count = (int)options.ThreadCount;
+        m_Context->thread_type = threadType;
+
         if (avcodec_open2(m_Context, m_Codec, nullptr) < 0) {
             SCHMIX_ERROR("Failed to open codec in context!");
             return;
         }
 
+        // the encoder fills in what it settled on, e.g. its frame size and headers for the muxer
+        if (mode == IO::Mode::Output) {
+            if (avcodec_parameters_from_context(m_Parameters.Get(), m_Context) < 0) {
+                SCHMIX_ERROR("Failed to read back encoder parameters!");
+                return;
+            }
+        }
+
+        m_Frame = av_frame_alloc();
+        m_ConvertedFrame = av_frame_alloc();
+        m_Packet = av_packet_alloc();
+
+        if (m_Frame == nullptr || m_ConvertedFrame == nullptr || m_Packet == nullptr) {
+            SCHMIX_ERROR("Failed to allocate frame or packet!");
+            return;
+        }
+
+        if (mode == IO::Mode::Output) {
+            // codecs that take any frame size get every write as it comes
+            std::size_t frameSize = (std::size_t)m_Context->frame_size;
+            if ((m_Codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) != 0) {
+                frameSize = 0;
+            }
+
+            m_FIFO = std::make_unique<AudioFIFO>((std::size_t)m_Context->ch_layout.nb_channels,
+                                                 m_Context->sample_fmt, frameSize);
+        }
+
         m_IsOpen = true;
     }
 
-    CodecStream::~CodecStream() { avcodec_free_context(&m_Context); }
+    CodecStream::~CodecStream() {
+        av_frame_free(&m_Frame);
+        av_frame_free(&m_ConvertedFrame);
+        av_packet_free(&m_Packet);
+
+        avcodec_free_context(&m_Context);
+    }
 
     std::size_t CodecStream::GetFrameSize() const { return m_Context->frame_size; }
 
-    static std::optional<std::size_t> CopyFrameToNewBuffer(const AVFrame* frame,
-                                                           std::size_t streamIndex, void** data) {
+    bool CodecStream::SetConversion(const Resampler::Format& format, Resampler::Quality quality) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        m_ConversionFormat = format;
+        m_ConversionQuality = quality;
+        m_Conversion.reset();
+
+        if (m_Mode != IO::Mode::Output) {
+            // the decoder's output format is only known once frames come out
+            return true;
+        }
+
+        Resampler::Format codecFormat;
+        codecFormat.Channels = (std::size_t)m_Context->ch_layout.nb_channels;
+        codecFormat.SampleRate = (std::size_t)m_Context->sample_rate;
+        codecFormat.SampleFormat = m_Context->sample_fmt;
+
+        if (codecFormat == format) {
+            return true;
+        }
+
+        m_Conversion = std::make_unique<Resampler>(format, codecFormat, quality);
+        if (!m_Conversion->IsInitialized()) {
+            m_Conversion.reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool CodecStream::PrepareConversion(const AVFrame* frame) {
+        Resampler::Format input;
+        input.Channels = (std::size_t)frame->ch_layout.nb_channels;
+        input.SampleRate = (std::size_t)frame->sample_rate;
+        input.SampleFormat = frame->format;
+
+        if (m_Conversion && m_Conversion->GetInputFormat() == input) {
+            return true;
+        }
+
+        m_Conversion = std::make_unique<Resampler>(input, m_ConversionFormat.value(),
+                                                   m_ConversionQuality);
+
+        if (!m_Conversion->IsInitialized()) {
+            m_Conversion.reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    // planar frames come out one plane after another
+    static std::optional<std::size_t> CopyFrameToNewBuffer(const AVFrame* frame, void** data) {
         std::size_t samples = frame->nb_samples;
         std::size_t channels = frame->ch_layout.nb_channels;
         auto sampleFormat = (AVSampleFormat)frame->format;
 
-        std::size_t bufferSize =
-            av_samples_get_buffer_size(nullptr, channels, samples, sampleFormat, 0);
+        bool planar = av_sample_fmt_is_planar(sampleFormat) != 0;
+        std::size_t planes = planar ? channels : 1;
+        std::size_t planeSize =
+            samples * (planar ? 1 : channels) * av_get_bytes_per_sample(sampleFormat);
 
-        void* buffer = Memory::Allocate(bufferSize);
+        void* buffer = Memory::Allocate(planeSize * planes);
         if (buffer == nullptr) {
             SCHMIX_ERROR("Failed to allocate memory for frame output!");
             return {};
         }
 
-        Memory::Copy(frame->data[streamIndex], buffer, bufferSize);
+        for (std::size_t i = 0; i < planes; i++) {
+            Memory::Copy(frame->extended_data[i], (std::uint8_t*)buffer + i * planeSize,
+                         planeSize);
+        }
 
         *data = buffer;
         return samples;
@@ -78,6 +208,32 @@ namespace schmix {
     std::optional<std::size_t> CodecStream::ReadFrame(void** data) {
         *data = nullptr;
 
+        auto decoded = DecodeNextFrame();
+        if (!decoded.has_value() || !decoded.value()) {
+            // eof is reported the same way as errors
+            return {};
+        }
+
+        auto result = CopyFrameToNewBuffer(m_Frame, data);
+        av_frame_unref(m_Frame);
+
+        return result;
+    }
+
+    std::optional<Ref<AudioFrame>> CodecStream::ReadAudioFrame() {
+        auto decoded = DecodeNextFrame();
+        if (!decoded.has_value()) {
+            return {};
+        }
+
+        if (!decoded.value()) {
+            return Ref<AudioFrame>();
+        }
+
+        return Ref<AudioFrame>::Create(m_Frame);
+    }
+
+    std::optional<bool> CodecStream::DecodeNextFrame() {
         if (m_Mode != IO::Mode::Input) {
             SCHMIX_ERROR("Not an input stream!");
             return {};
@@ -91,62 +247,154 @@ namespace schmix {
         // todo: pull this number from somewhere other than my ass
         std::size_t packetSize = 2048;
 
-        std::size_t bufferSize = packetSize + AV_INPUT_BUFFER_PADDING_SIZE;
-        void* packetBuffer = Memory::Allocate(bufferSize);
-
-        bool success = true;
+        // only feed the decoder as much as it takes to produce the next frame
         while (true) {
-            std::int32_t bytesRead = m_Callbacks.ReadPacket(packetBuffer, packetSize);
+            av_frame_unref(m_Frame);
+
+            auto received = ReceiveFrame(m_Frame);
+            if (!received.has_value()) {
+                return {};
+            }
+
+            if (received.value() || m_Draining) {
+                if (!m_ConversionFormat.has_value()) {
+                    return received.value();
+                }
+
+                const std::uint8_t* const* input = nullptr;
+                std::size_t samples = 0;
+
+                if (received.value()) {
+                    if (!PrepareConversion(m_Frame)) {
+                        return {};
+                    }
+
+                    input = m_Frame->extended_data;
+                    samples = (std::size_t)m_Frame->nb_samples;
+                } else if (!m_Conversion) {
+                    return false;
+                }
+
+                // a null input drains the resampler once the decoder has nothing left
+                bool converted =
+                    m_Conversion->ConvertFrame(input, samples, m_ConvertedFrame, m_BufferPool);
+                av_frame_unref(m_Frame);
+
+                if (!converted) {
+                    return {};
+                }
+
+                if (m_ConvertedFrame->nb_samples > 0) {
+                    av_frame_move_ref(m_Frame, m_ConvertedFrame);
+                    return true;
+                }
+
+                // the resampler may hold on to the first few frames
+                av_frame_unref(m_ConvertedFrame);
+                if (!received.value()) {
+                    return false;
+                }
+
+                continue;
+            }
+
+            m_Packet->buf = m_BufferPool.Get(packetSize);
+            if (m_Packet->buf == nullptr) {
+                return {};
+            }
+
+            m_Packet->data = m_Packet->buf->data;
+            m_Packet->size = (int)packetSize;
+
+            std::int32_t bytesRead = m_Callbacks.ReadPacket(m_Packet->data, packetSize);
             if (bytesRead < 0) {
                 SCHMIX_WARN("Failed to read packet from stream - assuming EOF");
-                break;
             }
 
-            if (bytesRead == 0) {
-                SCHMIX_DEBUG("Packet stream EOF");
-                break;
+            bool sent;
+            if (bytesRead > 0) {
+                av_shrink_packet(m_Packet, bytesRead);
+                sent = SendPacket(m_Packet);
+            } else {
+                sent = SendPacket(nullptr);
             }
 
-            auto packet = av_packet_alloc();
-            av_packet_from_data(packet, (uint8_t*)packetBuffer, bytesRead);
+            av_packet_unref(m_Packet);
+            if (!sent) {
+                return {};
+            }
+        }
+    }
+
+    bool CodecStream::SendPacket(const AVPacket* packet) {
+        if (m_Mode != IO::Mode::Input) {
+            SCHMIX_ERROR("Not an input stream!");
+            return false;
+        }
 
-            int result = avcodec_send_packet(m_Context, packet);
-            av_packet_free(&packet);
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
 
-            if (result < 0) {
-                SCHMIX_ERROR("Failed to send packet to stream!");
+        if (m_Draining) {
+            // already flushed; nothing more will be accepted until reset
+            return packet == nullptr;
+        }
 
-                success = true;
-                break;
-            }
+        int ret = avcodec_send_packet(m_Context, packet);
+        if (ret < 0) {
+            SCHMIX_ERROR("Failed to send packet to stream!");
+            return false;
         }
 
-        Memory::Free(packetBuffer);
-        if (!success) {
-            SCHMIX_WARN("Error piping in data to stream - may be incomplete");
+        m_Draining = packet == nullptr;
+        return true;
+    }
 
-            // do we want to fail here?
+    std::optional<bool> CodecStream::ReceiveFrame(AVFrame* frame) {
+        if (m_Mode != IO::Mode::Input) {
+            SCHMIX_ERROR("Not an input stream!");
+            return {};
         }
 
-        auto frame = av_frame_alloc();
-        if (frame == nullptr) {
-            SCHMIX_ERROR("Failed to allocate frame!");
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
             return {};
         }
 
         int ret = avcodec_receive_frame(m_Context, frame);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return false;
+        }
 
-        std::optional<std::size_t> result;
-        if (ret >= 0) {
-            result = CopyFrameToNewBuffer(frame, m_StreamIndex, data);
-        } else if (ret != AVERROR_EOF) {
+        if (ret < 0) {
             SCHMIX_ERROR("Failed to receive frame from stream!");
+            return {};
         }
 
-        av_frame_unref(frame);
-        av_frame_free(&frame);
+        return true;
+    }
 
-        return result;
+    void CodecStream::SetMuxer(FormatStream* format, std::size_t streamIndex) {
+        m_Muxer = format;
+        m_MuxerStream = streamIndex;
+    }
+
+    void CodecStream::Reset() {
+        if (m_Context != nullptr) {
+            avcodec_flush_buffers(m_Context);
+        }
+
+        if (m_Conversion) {
+            m_Conversion->Reset();
+        }
+
+        if (m_FIFO) {
+            m_FIFO->Reset();
+        }
+
+        m_Draining = false;
     }
 
     bool CodecStream::WriteFrame(const void* data, std::size_t samples) {
@@ -163,62 +411,244 @@ namespace schmix {
         std::size_t channels = m_Parameters.GetChannels();
         auto sampleFormat = (AVSampleFormat)m_Parameters.GetAVSampleFormat();
 
-        std::size_t sampleBufferSize =
-            av_samples_get_buffer_size(nullptr, channels, samples, sampleFormat, 0);
+        if (m_Conversion) {
+            const auto& format = m_Conversion->GetInputFormat();
+
+            channels = format.Channels;
+            sampleFormat = (AVSampleFormat)format.SampleFormat;
+        }
+
+        m_InputPlanes.resize(channels);
+        av_samples_fill_arrays((std::uint8_t**)m_InputPlanes.data(), nullptr,
+                               (const std::uint8_t*)data, (int)channels, (int)samples,
+                               sampleFormat, 1);
+
+        return WritePlanes((const void* const*)m_InputPlanes.data(), samples);
+    }
+
+    bool CodecStream::WritePlanes(const void* const* planes, std::size_t samples) {
+        if (m_Mode != IO::Mode::Output) {
+            SCHMIX_ERROR("Not an output stream!");
+            return false;
+        }
+
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        auto input = (const std::uint8_t* const*)planes;
+
+        // the caller's buffers may be gone by the time the encoder is done with them
+        if (!m_Conversion) {
+            auto sink = [this](const std::uint8_t* const* frame, std::size_t frames) {
+                return SendFrame(frame, frames);
+            };
+
+            return m_FIFO->Write(input, samples, sink);
+        }
+
+        if (!m_Conversion->ConvertFrame(input, samples, m_ConvertedFrame, m_BufferPool)) {
+            return false;
+        }
+
+        // whole frames come straight out of the converted frame's pooled buffer
+        auto sink = [this](const std::uint8_t* const* frame, std::size_t frames) {
+            return SendFrame(frame, frames, m_ConvertedFrame);
+        };
+
+        bool written = m_FIFO->Write(m_ConvertedFrame->extended_data,
+                                     (std::size_t)m_ConvertedFrame->nb_samples, sink);
+
+        av_frame_unref(m_ConvertedFrame);
+        return written;
+    }
+
+    bool CodecStream::WriteSignal(const double* const* channels, std::size_t channelCount,
+                                  std::size_t samples) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        // a rate given to SetConversion earlier is kept
+        Resampler::Format format;
+        format.Channels = channelCount;
+        format.SampleRate = m_ConversionFormat.has_value() ? m_ConversionFormat->SampleRate
+                                                           : (std::size_t)m_Context->sample_rate;
+        format.SampleFormat = AV_SAMPLE_FMT_DBLP;
+
+        // switching formats mid-stream drops whatever the old conversion still holds
+        if (m_ConversionFormat != format && !SetConversion(format, m_ConversionQuality)) {
+            return false;
+        }
+
+        return WritePlanes((const void* const*)channels, samples);
+    }
+
+    static bool IsInBuffer(const AVBufferRef* buffer, const std::uint8_t* pointer) {
+        if (buffer == nullptr) {
+            return false;
+        }
+
+        auto address = (std::uintptr_t)pointer;
+        auto start = (std::uintptr_t)buffer->data;
+
+        return address >= start && address < start + buffer->size;
+    }
+
+    // whether every plane points into one of the frame's ref-counted buffers
+    static bool IsBackedBy(const AVFrame* frame, const std::uint8_t* const* planes,
+                           std::size_t planeCount) {
+        for (std::size_t i = 0; i < planeCount; i++) {
+            bool found = false;
+            for (std::size_t j = 0; j < AV_NUM_DATA_POINTERS && !found; j++) {
+                found = IsInBuffer(frame->buf[j], planes[i]);
+            }
+
+            for (int j = 0; j < frame->nb_extended_buf && !found; j++) {
+                found = IsInBuffer(frame->extended_buf[j], planes[i]);
+            }
+
+            if (!found) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool CodecStream::SendFrame(const std::uint8_t* const* planes, std::size_t samples,
+                                const AVFrame* source, bool last) {
+        std::size_t channels = (std::size_t)m_Context->ch_layout.nb_channels;
+        auto sampleFormat = m_Context->sample_fmt;
+        std::size_t planeCount = av_sample_fmt_is_planar(sampleFormat) != 0 ? channels : 1;
 
-        std::size_t bufferSize = sampleBufferSize + AV_INPUT_BUFFER_PADDING_SIZE;
-        auto frameBuffer = Memory::Allocate(bufferSize);
+        // libavcodec would pad the frame itself, but only by copying it once more
+        std::size_t frameSamples = samples;
+        std::size_t frameSize = (std::size_t)m_Context->frame_size;
+        int anySize = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_VARIABLE_FRAME_SIZE;
+
+        if (last && samples < frameSize && (m_Codec->capabilities & anySize) == 0) {
+            frameSamples = frameSize;
+        }
+
+        if (frameSamples == samples && source != nullptr &&
+            IsBackedBy(source, planes, planeCount)) {
+            // the encoder keeps a reference to the pooled buffer, which goes back to the pool
+            // once it lets go
+            if (av_frame_ref(m_Frame, source) < 0) {
+                SCHMIX_ERROR("Failed to reference frame!");
+                return false;
+            }
+
+            for (std::size_t i = 0; i < planeCount; i++) {
+                m_Frame->extended_data[i] = (std::uint8_t*)planes[i];
+                if (i < AV_NUM_DATA_POINTERS) {
+                    m_Frame->data[i] = (std::uint8_t*)planes[i];
+                }
+            }
 
-        Memory::Copy(data, frameBuffer, sampleBufferSize);
+            m_Frame->nb_samples = (int)samples;
+            m_Frame->pts = m_NextPTS;
+            av_channel_layout_copy(&m_Frame->ch_layout, &m_Context->ch_layout);
+        } else {
+            m_Frame->nb_samples = (int)frameSamples;
+            m_Frame->format = (int)sampleFormat;
+            m_Frame->sample_rate = m_Context->sample_rate;
+            m_Frame->pts = m_NextPTS;
+            av_channel_layout_copy(&m_Frame->ch_layout, &m_Context->ch_layout);
+
+            // anything else is copied once into a pooled buffer
+            if (!m_BufferPool.GetFrame(m_Frame)) {
+                av_frame_unref(m_Frame);
+                return false;
+            }
 
-        auto frame = av_frame_alloc();
-        frame->ch_layout = m_Parameters.Get()->ch_layout;
-        frame->nb_samples = samples;
-        frame->format = (int)sampleFormat;
+            av_samples_copy(m_Frame->extended_data, (std::uint8_t* const*)planes, 0, 0,
+                            (int)samples, (int)channels, sampleFormat);
 
-        avcodec_fill_audio_frame(frame, channels, sampleFormat, (uint8_t*)frameBuffer, bufferSize,
-                                 0);
+            if (frameSamples > samples) {
+                av_samples_set_silence(m_Frame->extended_data, (int)samples,
+                                       (int)(frameSamples - samples), (int)channels,
+                                       sampleFormat);
+            }
+        }
 
-        int ret = avcodec_send_frame(m_Context, frame);
+        int ret = avcodec_send_frame(m_Context, m_Frame);
+        if (ret == AVERROR(EAGAIN)) {
+            // the encoder wants its output taken first
+            if (FlushPackets()) {
+                ret = avcodec_send_frame(m_Context, m_Frame);
+            }
+        }
 
-        av_frame_free(&frame);
-        Memory::Free(frameBuffer);
+        av_frame_unref(m_Frame);
 
         if (ret < 0) {
             SCHMIX_ERROR("Failed to send frame to stream!");
             return false;
         }
 
+        m_NextPTS += (std::int64_t)frameSamples;
         return FlushPackets();
     }
 
     bool CodecStream::Flush() {
         if (!m_IsOpen) {
             SCHMIX_ERROR("Stream is not open!");
+            return false;
         }
 
-        if (m_Mode == IO::Mode::Output || !FlushPackets()) {
-            SCHMIX_ERROR("Failed to flush packets to underlying stream!");
+        if (m_Mode == IO::Mode::Input) {
+            avcodec_flush_buffers(m_Context);
+            return true;
+        }
+
+        auto sink = [this](const std::uint8_t* const* frame, std::size_t frames) {
+            return SendFrame(frame, frames, m_ConvertedFrame);
+        };
+
+        auto lastSink = [this](const std::uint8_t* const* frame, std::size_t frames) {
+            return SendFrame(frame, frames, nullptr, true);
+        };
+
+        // the resampler's tail, then the last short frame, then whatever the encoder holds
+        if (m_Conversion) {
+            if (!m_Conversion->ConvertFrame(nullptr, 0, m_ConvertedFrame, m_BufferPool)) {
+                return false;
+            }
+
+            bool written = m_FIFO->Write(m_ConvertedFrame->extended_data,
+                                         (std::size_t)m_ConvertedFrame->nb_samples, sink);
+
+            av_frame_unref(m_ConvertedFrame);
+            if (!written) {
+                return false;
+            }
+        }
+
+        if (!m_FIFO->Flush(lastSink)) {
             return false;
         }
 
-        avcodec_flush_buffers(m_Context);
+        if (avcodec_send_frame(m_Context, nullptr) < 0 || !FlushPackets()) {
+            SCHMIX_ERROR("Failed to flush packets to underlying stream!");
+            return false;
+        }
 
         return true;
     }
 
     bool CodecStream::FlushPackets() {
-        auto packet = av_packet_alloc();
-        if (packet == nullptr) {
-            SCHMIX_ERROR("Failed to allocate packet!");
-            return false;
-        }
+        auto packet = m_Packet;
 
         bool success = true;
         while (true) {
             int ret = avcodec_receive_packet(m_Context, packet);
             if (ret < 0) {
-                if (ret != AVERROR_EOF) {
+                // the encoder either wants more input or is done
+                if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
                     SCHMIX_ERROR("Failed to retrieve encoded packet from stream!");
                     success = false;
                 }
@@ -226,6 +656,15 @@ namespace schmix {
                 break;
             }
 
+            if (m_Muxer != nullptr) {
+                // the muxer logs its own errors
+                if (!m_Muxer->WritePacket(packet, m_MuxerStream)) {
+                    success = false;
+                }
+
+                continue;
+            }
+
             std::int32_t bytesWritten = m_Callbacks.WritePacket(packet->data, packet->size);
             if (bytesWritten < 0) {
                 SCHMIX_ERROR("Failed to write packet to stream!");
@@ -234,8 +673,6 @@ namespace schmix {
         }
 
         av_packet_unref(packet);
-        av_packet_free(&packet);
-
         return success;
     }
 } // namespace schmix
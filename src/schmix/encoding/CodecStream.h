@@ -1,17 +1,40 @@
 #pragma once
 
 #include "schmix/encoding/CodecParameters.h"
+#include "schmix/encoding/FormatStream.h"
 #include "schmix/encoding/IO.h"
+#include "schmix/encoding/Resampler.h"
+#include "schmix/encoding/BufferPool.h"
+#include "schmix/encoding/AudioFrame.h"
+#include "schmix/encoding/AudioFIFO.h"
 
 typedef struct AVCodec AVCodec;
 typedef struct AVCodecContext AVCodecContext;
+typedef struct AVPacket AVPacket;
+typedef struct AVFrame AVFrame;
 
 namespace schmix {
     class CodecStream {
     public:
+        struct Options {
+            // 0 lets libavcodec use one thread per core; 1 keeps all work on the calling thread
+            std::size_t ThreadCount = 1;
+
+            // either kind is only used if the codec supports it
+            bool FrameThreads = true;
+            bool SliceThreads = true;
+
+            // encoding; set when the container wants codec headers out of band
+            bool GlobalHeader = false;
+        };
+
         CodecStream(const IO::Callbacks& callbacks, IO::Mode mode,
                     const CodecParameters& parameters, std::size_t streamIndex);
 
+        CodecStream(const IO::Callbacks& callbacks, IO::Mode mode,
+                    const CodecParameters& parameters, std::size_t streamIndex,
+                    const Options& options);
+
         ~CodecStream();
 
         CodecStream(const CodecStream&) = delete;
@@ -26,14 +49,68 @@ namespace schmix {
 
         std::size_t GetFrameSize() const;
 
+        // samples passed to WriteFrame or returned by ReadFrame are converted from/to this format
+        // instead of the codec's own; packed formats are interleaved, planar ones are one plane
+        // after another
+        bool SetConversion(const Resampler::Format& format,
+                           Resampler::Quality quality = Resampler::Quality::Balanced);
+
+        const std::optional<Resampler::Format>& GetConversionFormat() const {
+            return m_ConversionFormat;
+        }
+
+        // copies the next frame into a buffer to be freed with Memory::Free
+        // planar samples are laid out one plane after another
+        // empty optional means error or eof
         std::optional<std::size_t> ReadFrame(void** data);
+
+        // hands out the next frame without copying it
+        // empty optional means error; a null frame means eof
+        std::optional<Ref<AudioFrame>> ReadAudioFrame();
+
+        // any number of samples may be written; they are re-chunked to the encoder's frame size
         bool WriteFrame(const void* data, std::size_t samples);
 
+        // same as above, with one pointer per plane, e.g. the channels of a signal
+        bool WritePlanes(const void* const* planes, std::size_t samples);
+
+        // planar doubles, e.g. the channels of a signal; conversion from them is set up as needed
+        // samples are taken to be at the rate last given to SetConversion, or the codec's own
+        bool WriteSignal(const double* const* channels, std::size_t channelCount,
+                         std::size_t samples);
+
+        // decoding; a null packet starts draining the decoder
+        bool SendPacket(const AVPacket* packet);
+
+        // empty optional means error
+        // false means more input is needed, or eof if the decoder is draining
+        std::optional<bool> ReceiveFrame(AVFrame* frame);
+
+        bool IsDraining() const { return m_Draining; }
+
+        // encoded packets go to the given stream of a muxer instead of the write callback
+        // the muxer has to outlive this stream, or be unset first
+        void SetMuxer(FormatStream* format, std::size_t streamIndex);
+
+        // drops buffered state, e.g. after the demuxer seeks
+        void Reset();
+
+        // encoding; writes out the last short frame and drains the encoder, which takes no more
+        // samples afterwards
         bool Flush();
 
     private:
+        // planes inside one of the source frame's buffers are referenced rather than copied
+        // the last frame is padded out with silence for codecs that cannot take a short one
+        bool SendFrame(const std::uint8_t* const* planes, std::size_t samples,
+                       const AVFrame* source = nullptr, bool last = false);
         bool FlushPackets();
 
+        // leaves the next frame in m_Frame; false means eof
+        std::optional<bool> DecodeNextFrame();
+
+        bool PrepareConversion(const AVFrame* frame);
+
         const AVCodec* m_Codec;
         AVCodecContext* m_Context;
 
@@ -43,6 +120,25 @@ namespace schmix {
         CodecParameters m_Parameters;
         std::size_t m_StreamIndex;
 
+        FormatStream* m_Muxer;
+        std::size_t m_MuxerStream;
+
+        std::optional<Resampler::Format> m_ConversionFormat;
+        Resampler::Quality m_ConversionQuality;
+        std::unique_ptr<Resampler> m_Conversion;
+
+        // reused across calls instead of allocated per frame
+        AVFrame* m_Frame;
+        AVFrame* m_ConvertedFrame;
+        AVPacket* m_Packet;
+        BufferPool m_BufferPool;
+
+        // encoding only; holds the samples that do not fill a whole frame yet
+        std::unique_ptr<AudioFIFO> m_FIFO;
+        std::vector<const std::uint8_t*> m_InputPlanes;
+        std::int64_t m_NextPTS;
+
+        bool m_Draining;
         bool m_IsOpen;
     };
 } // namespace schmix
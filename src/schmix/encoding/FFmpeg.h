@@ -2,6 +2,8 @@
 
 extern "C" {
 #include <libavutil/avutil.h>
+#include <libavutil/opt.h>
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libswresample/swresample.h>
 }
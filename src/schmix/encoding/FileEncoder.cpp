@@ -0,0 +1,128 @@
+#include "schmixpch.h"
+#include "schmix/encoding/FileEncoder.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+namespace schmix {
+    template <typename _Ty>
+    static const _Ty* GetEncoderSupport(const AVCodec* codec, AVCodecConfig config, int* items) {
+        const void* data = nullptr;
+        if (avcodec_get_supported_config(nullptr, codec, config, 0, &data, items) < 0) {
+            return nullptr;
+        }
+
+        return (const _Ty*)data;
+    }
+
+    // float keeps full quality through every lossy encoder and skips dithering
+    static AVSampleFormat SelectSampleFormat(const AVCodec* codec) {
+        int count = 0;
+        auto formats = GetEncoderSupport<AVSampleFormat>(codec, AV_CODEC_CONFIG_SAMPLE_FORMAT,
+                                                         &count);
+
+        if (formats == nullptr || count == 0) {
+            return AV_SAMPLE_FMT_FLTP;
+        }
+
+        for (auto preferred : { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLT }) {
+            for (int i = 0; i < count; i++) {
+                if (formats[i] == preferred) {
+                    return preferred;
+                }
+            }
+        }
+
+        return formats[0];
+    }
+
+    static int SelectSampleRate(const AVCodec* codec, std::size_t sampleRate) {
+        int count = 0;
+        auto rates = GetEncoderSupport<int>(codec, AV_CODEC_CONFIG_SAMPLE_RATE, &count);
+
+        if (rates == nullptr || count == 0) {
+            return (int)sampleRate;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if ((std::size_t)rates[i] == sampleRate) {
+                return rates[i];
+            }
+        }
+
+        SCHMIX_WARN("No support found for sample rate of {} Hz - resampling to {} Hz", sampleRate,
+                    rates[0]);
+
+        return rates[0];
+    }
+
+    std::optional<FileEncoder::Streams> FileEncoder::Open(const std::filesystem::path& path,
+                                                          std::size_t channels,
+                                                          std::size_t sampleRate,
+                                                          std::size_t threadCount) {
+        auto outputFormat = FormatStream::GuessOutputFormat(path);
+        if (outputFormat == nullptr || outputFormat->audio_codec == AV_CODEC_ID_NONE) {
+            SCHMIX_ERROR("Failed to guess an audio format for {}", path.string().c_str());
+            return {};
+        }
+
+        auto codec = avcodec_find_encoder(outputFormat->audio_codec);
+        if (codec == nullptr) {
+            SCHMIX_ERROR("No encoder available for {}", path.string().c_str());
+            return {};
+        }
+
+        CodecParameters parameters;
+        auto params = parameters.Get();
+
+        params->codec_type = AVMEDIA_TYPE_AUDIO;
+        params->codec_id = codec->id;
+        params->format = SelectSampleFormat(codec);
+        params->sample_rate = SelectSampleRate(codec, sampleRate);
+        av_channel_layout_default(&params->ch_layout, (int)channels);
+
+        auto callbacks = IO::OpenFile(path, IO::Mode::Output);
+        if (!callbacks.has_value()) {
+            return {};
+        }
+
+        Streams streams;
+        streams.Format =
+            std::make_unique<FormatStream>(callbacks.value(), IO::Mode::Output, outputFormat);
+
+        if (!streams.Format->IsOpen()) {
+            return {};
+        }
+
+        CodecStream::Options codecOptions;
+        codecOptions.ThreadCount = threadCount;
+        codecOptions.GlobalHeader = streams.Format->NeedsGlobalHeader();
+
+        streams.Codec = std::make_unique<CodecStream>(callbacks.value(), IO::Mode::Output,
+                                                      parameters, 0, codecOptions);
+
+        if (!streams.Codec->IsOpen()) {
+            return {};
+        }
+
+        return streams;
+    }
+
+    bool FileEncoder::Connect(CodecStream& codec, FormatStream* format, std::size_t channels,
+                              std::size_t sampleRate, Resampler::Quality quality) {
+        if (format != nullptr) {
+            auto streamIndex = format->AddStream(codec.GetParameters());
+            if (!streamIndex.has_value()) {
+                return false;
+            }
+
+            codec.SetMuxer(format, streamIndex.value());
+        }
+
+        Resampler::Format input;
+        input.Channels = channels;
+        input.SampleRate = sampleRate;
+        input.SampleFormat = AV_SAMPLE_FMT_DBLP;
+
+        return codec.SetConversion(input, quality);
+    }
+} // namespace schmix
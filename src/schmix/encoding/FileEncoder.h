@@ -0,0 +1,27 @@
+#pragma once
+
+#include "schmix/encoding/CodecStream.h"
+#include "schmix/encoding/FormatStream.h"
+
+namespace schmix {
+    // opens an encoder and muxer for a file, picking the container and codec from its name
+    class FileEncoder {
+    public:
+        struct Streams {
+            std::unique_ptr<CodecStream> Codec;
+            std::unique_ptr<FormatStream> Format;
+        };
+
+        FileEncoder() = delete;
+
+        // the codec is not yet attached to the muxer, so that the caller can add its stream
+        // samples are expected at the given rate and converted to whatever the codec takes
+        static std::optional<Streams> Open(const std::filesystem::path& path,
+                                           std::size_t channels, std::size_t sampleRate,
+                                           std::size_t threadCount);
+
+        // adds the codec's stream to the muxer, if given, and has the codec take planar doubles
+        static bool Connect(CodecStream& codec, FormatStream* format, std::size_t channels,
+                            std::size_t sampleRate, Resampler::Quality quality);
+    };
+} // namespace schmix
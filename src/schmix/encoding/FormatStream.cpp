@@ -3,19 +3,26 @@
 
 #include "schmix/encoding/FFmpeg.h"
 
+#include "schmix/core/Hash.h"
+
 namespace schmix {
     const AVOutputFormat* FormatStream::GuessOutputFormat(const std::filesystem::path& path) {
         auto pathString = path.string();
         return av_guess_format(nullptr, pathString.c_str(), nullptr);
     }
 
+    // matches libavformat's own default
+    static constexpr std::size_t s_DefaultBufferSize = 32 * 1024;
+
     static int AVIOReadCallback(void* opaque, uint8_t* buf, int buf_size) {
         auto callbacks = (const IO::Callbacks*)opaque;
 
         std::int32_t bytesRead = callbacks->ReadPacket(buf, (std::size_t)buf_size);
+        if (bytesRead < 0) {
+            return AVERROR(EIO);
+        }
 
-        // assume eof
-        return bytesRead < 0 ? (int)bytesRead : AVERROR_EOF;
+        return bytesRead > 0 ? (int)bytesRead : AVERROR_EOF;
     }
 
     static int AVIOWriteCallback(void* opaque, const uint8_t* buf, int buf_size) {
@@ -35,16 +42,20 @@ namespace schmix {
         m_BufferSize = 0;
 
         m_FormatContext = nullptr;
+        m_Packet = nullptr;
+
+        m_AudioIndex = 0;
 
         m_Callbacks = callbacks;
         m_Mode = mode;
 
+        m_HeaderWritten = false;
+        m_Finished = false;
         m_IsOpen = false;
 
-        // todo: base this off of something? lol
-        // 1 kb
-        m_BufferSize = 1024;
-        m_IOBuffer = Memory::Allocate(m_BufferSize);
+        // libavformat may swap this buffer out from under us, so it has to come from av_malloc
+        m_BufferSize = callbacks.BufferSize > 0 ? callbacks.BufferSize : s_DefaultBufferSize;
+        m_IOBuffer = av_malloc(m_BufferSize);
 
         if (m_IOBuffer == nullptr) {
             SCHMIX_ERROR("Failed to allocate IO buffer!");
@@ -89,24 +100,46 @@ namespace schmix {
             return;
         }
 
-        bool streamFound = false;
+        // streams are only added later when muxing
+        if (mode == IO::Mode::Output) {
+            m_IsOpen = true;
+            return;
+        }
+
         for (unsigned int i = 0; i < m_FormatContext->nb_streams; i++) {
             auto stream = m_FormatContext->streams[i];
             auto params = stream->codecpar;
 
             if (params->codec_type != AVMEDIA_TYPE_AUDIO) {
+                // cover art and the like are skipped by the demuxer instead of read and dropped
+                if (mode == IO::Mode::Input) {
+                    stream->discard = AVDISCARD_ALL;
+                }
+
                 continue;
             }
 
-            m_AudioIndex = i;
-            m_Parameters = params;
+            auto& audioStream = m_AudioStreams.emplace_back();
+            audioStream.Index = i;
+            audioStream.Parameters = params;
+            audioStream.TimeBase = av_q2d(stream->time_base);
+            audioStream.StartTime = stream->start_time != AV_NOPTS_VALUE
+                                        ? (double)stream->start_time * audioStream.TimeBase
+                                        : 0.0;
+
+            audioStream.Duration = stream->duration != AV_NOPTS_VALUE
+                                       ? (double)stream->duration * audioStream.TimeBase
+                                       : -1.0;
         }
 
-        if (!streamFound) {
+        if (m_AudioStreams.empty()) {
             SCHMIX_ERROR("Failed to find audio stream!");
             return;
         }
 
+        m_AudioIndex = m_AudioStreams[0].Index;
+        m_Parameters = m_AudioStreams[0].Parameters;
+
         m_IsOpen = true;
     }
 
@@ -126,11 +159,14 @@ namespace schmix {
             avformat_free_context(m_FormatContext);
         }
 
+        av_packet_free(&m_Packet);
+
         if (m_IOContext != nullptr) {
+            av_freep(&m_IOContext->buffer);
             avio_context_free(&m_IOContext);
+        } else {
+            av_free(m_IOBuffer);
         }
-
-        Memory::Free(m_IOBuffer);
     }
 
     std::optional<std::size_t> FormatStream::ReadPacket(void** data) {
@@ -165,9 +201,88 @@ namespace schmix {
         return dataSize;
     }
 
-    bool FormatStream::WritePacket(const void* data, std::size_t dataSize) {
-        if (m_Mode != IO::Mode::Output) {
-            SCHMIX_ERROR("This stream is not an output stream!");
+    std::optional<bool> FormatStream::ReadPacket(AVPacket* packet) {
+        if (m_Mode != IO::Mode::Input) {
+            SCHMIX_ERROR("This stream is not an input stream!");
+            return {};
+        }
+
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return {};
+        }
+
+        while (true) {
+            av_packet_unref(packet);
+
+            int result = av_read_frame(m_FormatContext, packet);
+            if (result == AVERROR_EOF) {
+                return false;
+            }
+
+            if (result < 0) {
+                SCHMIX_ERROR("Failed to read frame packet from stream!");
+                return {};
+            }
+
+            if ((std::size_t)packet->stream_index == m_AudioIndex) {
+                return true;
+            }
+        }
+    }
+
+    std::optional<bool> FormatStream::ReadAnyPacket(AVPacket* packet) {
+        if (m_Mode != IO::Mode::Input) {
+            SCHMIX_ERROR("This stream is not an input stream!");
+            return {};
+        }
+
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return {};
+        }
+
+        av_packet_unref(packet);
+
+        int result = av_read_frame(m_FormatContext, packet);
+        if (result == AVERROR_EOF) {
+            return false;
+        }
+
+        if (result < 0) {
+            SCHMIX_ERROR("Failed to read frame packet from stream!");
+            return {};
+        }
+
+        // everything but audio is discarded, so nothing else reaches us
+        return true;
+    }
+
+    bool FormatStream::Rewind() {
+        if (m_Mode != IO::Mode::Input) {
+            SCHMIX_ERROR("This stream is not an input stream!");
+            return false;
+        }
+
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        auto stream = m_FormatContext->streams[m_AudioIndex];
+        int64_t start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+        if (av_seek_frame(m_FormatContext, (int)m_AudioIndex, start, AVSEEK_FLAG_BACKWARD) < 0) {
+            SCHMIX_ERROR("Failed to seek to the start of the stream!");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool FormatStream::Seek(std::int64_t sample) {
+        if (m_Mode != IO::Mode::Input) {
+            SCHMIX_ERROR("This stream is not an input stream!");
             return false;
         }
 
@@ -176,16 +291,281 @@ namespace schmix {
             return false;
         }
 
-        auto packetBuffer = Memory::Allocate(dataSize);
-        Memory::Copy(data, packetBuffer, dataSize);
+        int64_t timestamp = GetTimestamp(sample);
+        if (avformat_seek_file(m_FormatContext, (int)m_AudioIndex, INT64_MIN, timestamp, timestamp,
+                               0) < 0) {
+            SCHMIX_ERROR("Failed to seek to sample {}!", sample);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::int64_t FormatStream::GetSamplePosition(std::int64_t timestamp) const {
+        auto stream = m_FormatContext->streams[m_AudioIndex];
+        int64_t start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+        AVRational sampleBase = { 1, (int)m_Parameters.GetSampleRate() };
+        return av_rescale_q(timestamp - start, stream->time_base, sampleBase);
+    }
+
+    std::int64_t FormatStream::GetTimestamp(std::int64_t sample) const {
+        auto stream = m_FormatContext->streams[m_AudioIndex];
+        int64_t start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+        AVRational sampleBase = { 1, (int)m_Parameters.GetSampleRate() };
+        return start + av_rescale_q(sample, sampleBase, stream->time_base);
+    }
+
+    std::int64_t FormatStream::GetSourceSize() const {
+        if (m_IOContext == nullptr) {
+            return -1;
+        }
+
+        return avio_size(m_IOContext);
+    }
+
+    // bytes hashed at either end of the source
+    static constexpr std::size_t s_FingerprintBlockSize = 64 * 1024;
+
+    std::optional<std::uint64_t> FormatStream::GetSourceFingerprint() {
+        std::int64_t size = GetSourceSize();
+        if (size < 0) {
+            return {};
+        }
+
+        std::int64_t position = avio_tell(m_IOContext);
+
+        Hasher hasher;
+        hasher.Update(&size, sizeof(std::int64_t));
+
+        auto blockSize = std::min((std::int64_t)s_FingerprintBlockSize, size);
+        std::vector<std::uint8_t> block((std::size_t)blockSize);
+
+        bool success = true;
+        for (std::int64_t offset : { (std::int64_t)0, size - blockSize }) {
+            if (avio_seek(m_IOContext, offset, SEEK_SET) < 0) {
+                success = false;
+                break;
+            }
+
+            int bytesRead = avio_read(m_IOContext, block.data(), (int)blockSize);
+            if (bytesRead < 0) {
+                success = false;
+                break;
+            }
+
+            hasher.Update(block.data(), (std::size_t)bytesRead);
+        }
+
+        if (avio_seek(m_IOContext, position, SEEK_SET) < 0 || !success) {
+            SCHMIX_WARN("Failed to fingerprint the source");
+            return {};
+        }
+
+        return hasher.Finish();
+    }
+
+    std::optional<SeekIndex> FormatStream::BuildSeekIndex(std::size_t interval) {
+        if (!Rewind()) {
+            return {};
+        }
+
+        // an index without a fingerprint is never taken for a source's own
+        SeekIndex index(m_Parameters.GetSampleRate(), GetSourceFingerprint().value_or(0));
+
+        auto stream = m_FormatContext->streams[m_AudioIndex];
+        AVRational sampleBase = { 1, (int)m_Parameters.GetSampleRate() };
 
         auto packet = av_packet_alloc();
-        av_packet_from_data(packet, (uint8_t*)packetBuffer, dataSize);
+        if (packet == nullptr) {
+            SCHMIX_ERROR("Failed to allocate packet!");
+            return {};
+        }
+
+        // packets without timestamps are placed right after the previous one
+        std::int64_t nextSample = 0;
+        std::int64_t lastPoint = 0;
+
+        bool success = true;
+        while (true) {
+            auto read = ReadPacket(packet);
+            if (!read.has_value()) {
+                success = false;
+                break;
+            }
+
+            if (!read.value()) {
+                break;
+            }
+
+            std::int64_t sample =
+                packet->pts != AV_NOPTS_VALUE ? GetSamplePosition(packet->pts) : nextSample;
+
+            if (index.GetPoints().empty() || sample - lastPoint >= (std::int64_t)interval) {
+                SeekIndex::Point point;
+                point.Sample = sample;
+                point.Timestamp = packet->pts;
+                point.Position = packet->pos;
+
+                index.Add(point);
+                lastPoint = sample;
+            }
+
+            std::int64_t duration = packet->duration > 0
+                                        ? av_rescale_q(packet->duration, stream->time_base,
+                                                       sampleBase)
+                                        : (std::int64_t)m_Parameters.GetFrameSize();
 
-        int result = av_write_frame(m_FormatContext, packet);
+            nextSample = sample + duration;
+        }
 
         av_packet_free(&packet);
-        Memory::Free(packetBuffer);
+
+        if (!success || !Rewind()) {
+            return {};
+        }
+
+        return index;
+    }
+
+    bool FormatStream::ApplySeekIndex(const SeekIndex& index) {
+        if (m_Mode != IO::Mode::Input) {
+            SCHMIX_ERROR("This stream is not an input stream!");
+            return false;
+        }
+
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        // a file rewritten in place to the same size still changes at its start or end
+        auto fingerprint = GetSourceFingerprint();
+        if (index.GetSampleRate() != m_Parameters.GetSampleRate() || !fingerprint.has_value() ||
+            index.GetSourceFingerprint() != fingerprint.value()) {
+            SCHMIX_WARN("Seek index does not match this stream - ignoring");
+            return false;
+        }
+
+        auto stream = m_FormatContext->streams[m_AudioIndex];
+        for (const auto& point : index.GetPoints()) {
+            if (point.Timestamp == AV_NOPTS_VALUE || point.Position < 0) {
+                continue;
+            }
+
+            // libavformat merges these with whatever index it already has
+            av_add_index_entry(stream, point.Position, point.Timestamp, 0, 0, AVINDEX_KEYFRAME);
+        }
+
+        return true;
+    }
+
+    std::optional<std::size_t> FormatStream::AddStream(const CodecParameters& parameters) {
+        if (m_Mode != IO::Mode::Output) {
+            SCHMIX_ERROR("This stream is not an output stream!");
+            return {};
+        }
+
+        if (!m_IsOpen || m_HeaderWritten) {
+            SCHMIX_ERROR("Streams can only be added before anything is written!");
+            return {};
+        }
+
+        auto stream = avformat_new_stream(m_FormatContext, nullptr);
+        if (stream == nullptr) {
+            SCHMIX_ERROR("Failed to allocate output stream!");
+            return {};
+        }
+
+        if (avcodec_parameters_copy(stream->codecpar, parameters.Get()) < 0) {
+            SCHMIX_ERROR("Failed to copy codec parameters to output stream!");
+            return {};
+        }
+
+        // the muxer picks its own tag for the codec
+        stream->codecpar->codec_tag = 0;
+        stream->time_base = { 1, stream->codecpar->sample_rate };
+
+        if (m_AudioStreams.empty()) {
+            m_AudioIndex = (std::size_t)stream->index;
+            m_Parameters = parameters;
+        }
+
+        auto& audioStream = m_AudioStreams.emplace_back();
+        audioStream.Index = (std::size_t)stream->index;
+        audioStream.Parameters = parameters;
+        audioStream.StartTime = 0.0;
+        audioStream.Duration = -1.0;
+        audioStream.TimeBase = av_q2d(stream->time_base);
+
+        return audioStream.Index;
+    }
+
+    bool FormatStream::NeedsGlobalHeader() const {
+        return m_FormatContext != nullptr && m_FormatContext->oformat != nullptr &&
+               (m_FormatContext->oformat->flags & AVFMT_GLOBALHEADER) != 0;
+    }
+
+    bool FormatStream::WritePacket(AVPacket* packet, std::size_t streamIndex) {
+        if (m_Mode != IO::Mode::Output) {
+            SCHMIX_ERROR("This stream is not an output stream!");
+            return false;
+        }
+
+        if (!m_IsOpen || m_Finished) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        if (streamIndex >= m_FormatContext->nb_streams) {
+            SCHMIX_ERROR("Invalid output stream index: {}", streamIndex);
+            return false;
+        }
+
+        if (!m_HeaderWritten && !WriteHeader()) {
+            return false;
+        }
+
+        auto stream = m_FormatContext->streams[streamIndex];
+        AVRational sampleBase = { 1, stream->codecpar->sample_rate };
+
+        packet->stream_index = (int)streamIndex;
+        av_packet_rescale_ts(packet, sampleBase, stream->time_base);
+
+        // takes ownership of the packet's reference and leaves it blank
+        if (av_interleaved_write_frame(m_FormatContext, packet) < 0) {
+            SCHMIX_ERROR("Failed to write packet to stream!");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool FormatStream::WritePacket(const void* data, std::size_t dataSize) {
+        if (m_Mode != IO::Mode::Output) {
+            SCHMIX_ERROR("This stream is not an output stream!");
+            return false;
+        }
+
+        if (!m_IsOpen || m_Finished) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        if (!m_HeaderWritten && !WriteHeader()) {
+            return false;
+        }
+
+        // av_write_frame does not hold on to the data, so it is used in place
+        m_Packet->data = (std::uint8_t*)data;
+        m_Packet->size = (int)dataSize;
+        m_Packet->stream_index = 0;
+
+        int result = av_write_frame(m_FormatContext, m_Packet);
+
+        m_Packet->data = nullptr;
+        m_Packet->size = 0;
 
         if (result < 0) {
             SCHMIX_ERROR("Failed to write packet to stream!");
@@ -195,13 +575,65 @@ namespace schmix {
         return true;
     }
 
+    bool FormatStream::WriteHeader() {
+        if (m_FormatContext->nb_streams == 0) {
+            SCHMIX_ERROR("No streams to write!");
+            return false;
+        }
+
+        if (avformat_write_header(m_FormatContext, nullptr) < 0) {
+            SCHMIX_ERROR("Failed to write header to stream!");
+            return false;
+        }
+
+        m_HeaderWritten = true;
+        return true;
+    }
+
+    bool FormatStream::Finish() {
+        if (m_Mode != IO::Mode::Output) {
+            SCHMIX_ERROR("This stream is not an output stream!");
+            return false;
+        }
+
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Stream is not open!");
+            return false;
+        }
+
+        if (m_Finished) {
+            return true;
+        }
+
+        m_Finished = true;
+        if (!m_HeaderWritten && !WriteHeader()) {
+            return false;
+        }
+
+        if (av_write_trailer(m_FormatContext) < 0) {
+            SCHMIX_ERROR("Failed to write trailer to stream!");
+            return false;
+        }
+
+        avio_flush(m_IOContext);
+        return true;
+    }
+
     bool FormatStream::Flush() {
         if (!m_IsOpen) {
             SCHMIX_ERROR("Attempted to flush stream that is not open!");
             return false;
         }
 
-        if (avformat_flush(m_FormatContext) < 0) {
+        int result = 0;
+        if (m_Mode == IO::Mode::Input) {
+            result = avformat_flush(m_FormatContext);
+        } else if (m_HeaderWritten && !m_Finished) {
+            // empties the interleaving queue
+            result = av_interleaved_write_frame(m_FormatContext, nullptr);
+        }
+
+        if (result < 0) {
             SCHMIX_ERROR("Failed to flush libavformat context!");
             return false;
         }
@@ -228,13 +660,20 @@ namespace schmix {
     void FormatStream::CloseInput() { avformat_close_input(&m_FormatContext); }
 
     bool FormatStream::OpenOutput() {
-        if (avformat_write_header(m_FormatContext, nullptr) < 0) {
-            SCHMIX_ERROR("Failed to write header to stream!");
+        if (m_FormatContext->oformat == nullptr) {
+            SCHMIX_ERROR("No output format given!");
+            return false;
+        }
+
+        // reused for raw writes; the header waits until the streams are known
+        m_Packet = av_packet_alloc();
+        if (m_Packet == nullptr) {
+            SCHMIX_ERROR("Failed to allocate packet!");
             return false;
         }
 
         return true;
     }
 
-    void FormatStream::CloseOutput() { /* nothing? */ }
+    void FormatStream::CloseOutput() { Finish(); }
 } // namespace schmix
@@ -2,10 +2,12 @@
 
 #include "schmix/encoding/CodecParameters.h"
 #include "schmix/encoding/IO.h"
+#include "schmix/encoding/SeekIndex.h"
 
 typedef struct AVIOContext AVIOContext;
 typedef struct AVFormatContext AVFormatContext;
 typedef struct AVOutputFormat AVOutputFormat;
+typedef struct AVPacket AVPacket;
 
 namespace schmix {
     class FormatStream {
@@ -23,15 +25,87 @@ namespace schmix {
         IO::Mode GetMode() const { return m_Mode; }
         bool IsOpen() const { return m_IsOpen; }
 
+        struct AudioStream {
+            std::size_t Index;
+            CodecParameters Parameters;
+
+            // where the stream's first sample sits on the container's timeline, in seconds
+            double StartTime;
+
+            // in seconds; negative when the container does not say
+            double Duration;
+
+            // seconds per tick of the stream's packet timestamps
+            double TimeBase;
+        };
+
+        // the first audio stream; seeking, rewinding and ReadPacket work in terms of this one
         std::size_t GetAudioStreamIndex() const { return m_AudioIndex; }
         const CodecParameters& GetCodecParameters() const { return m_Parameters; }
 
+        // every audio stream in the file, in container order
+        const std::vector<AudioStream>& GetAudioStreams() const { return m_AudioStreams; }
+
         std::optional<std::size_t> ReadPacket(void** data);
+
+        // reads the next audio packet into the given packet, replacing its contents
+        // empty optional means error, false means eof
+        std::optional<bool> ReadPacket(AVPacket* packet);
+
+        // same as above, but packets of every audio stream are returned
+        // the packet's stream index says which stream it belongs to
+        std::optional<bool> ReadAnyPacket(AVPacket* packet);
+
+        // seeks back to the start of the audio stream
+        bool Rewind();
+
+        // lands on a packet at or before the given sample, in the stream's own rate
+        // packets read afterwards carry their real timestamps
+        bool Seek(std::int64_t sample);
+
+        // conversions between stream timestamps and samples from the start of the stream
+        std::int64_t GetSamplePosition(std::int64_t timestamp) const;
+        std::int64_t GetTimestamp(std::int64_t sample) const;
+
+        // total size of the underlying data in bytes; negative if unknown
+        std::int64_t GetSourceSize() const;
+
+        // hash of the size and the first and last blocks of the underlying data, cheap enough
+        // to check on every open; empty if the source cannot seek
+        // the read position is restored afterwards
+        std::optional<std::uint64_t> GetSourceFingerprint();
+
+        // reads every packet of the audio stream without decoding, then rewinds
+        // a point is kept at least every given number of samples
+        std::optional<SeekIndex> BuildSeekIndex(std::size_t interval);
+
+        // hands a prebuilt index to the demuxer, so that seeks land on exact packets even in
+        // files without a table of contents
+        bool ApplySeekIndex(const SeekIndex& index);
+
+        // muxing; streams are added before the first packet is written
+        // empty optional means error
+        std::optional<std::size_t> AddStream(const CodecParameters& parameters);
+
+        // whether encoders should be opened with their headers kept out of band
+        bool NeedsGlobalHeader() const;
+
+        // writes an encoded packet to the given stream, rescaling timestamps from samples at the
+        // stream's rate; the header goes out with the first packet
+        bool WritePacket(AVPacket* packet, std::size_t streamIndex);
+
+        // raw data for the first stream, without timestamps
         bool WritePacket(const void* data, std::size_t dataSize);
 
         bool Flush();
 
+        // writes the trailer; nothing may be written afterwards
+        // done on destruction if not called before
+        bool Finish();
+
     private:
+        bool WriteHeader();
+
         bool OpenInput();
         void CloseInput();
 
@@ -43,13 +117,16 @@ namespace schmix {
         std::size_t m_BufferSize;
 
         AVFormatContext* m_FormatContext;
+        AVPacket* m_Packet;
 
         std::size_t m_AudioIndex;
         CodecParameters m_Parameters;
+        std::vector<AudioStream> m_AudioStreams;
 
         IO::Callbacks m_Callbacks;
         IO::Mode m_Mode;
 
+        bool m_HeaderWritten, m_Finished;
         bool m_IsOpen;
     };
 } // namespace schmix
@@ -3,6 +3,10 @@
 
 #include "schmix/encoding/FFmpeg.h"
 
+#include "schmix/core/MappedFile.h"
+
+#include <cstdio>
+
 namespace schmix {
     static void FFmpegLogCallback(void* avcl, int level, const char* fmt, va_list vl) {
         static constexpr std::size_t maxMessageLength = 256;
@@ -44,4 +48,178 @@ namespace schmix {
         av_log_set_level(AV_LOG_TRACE);
         av_log_set_callback(FFmpegLogCallback);
     }
+
+    static int SeekFile(std::FILE* file, std::int64_t offset, int origin) {
+#ifdef SCHMIX_PLATFORM_windows
+        return _fseeki64(file, offset, origin);
+#else
+        return fseeko(file, (off_t)offset, origin);
+#endif
+    }
+
+    static std::int64_t TellFile(std::FILE* file) {
+#ifdef SCHMIX_PLATFORM_windows
+        return _ftelli64(file);
+#else
+        return (std::int64_t)ftello(file);
+#endif
+    }
+
+    std::optional<IO::Callbacks> IO::OpenFile(const std::filesystem::path& path, Mode mode,
+                                              std::size_t bufferSize) {
+        auto pathString = path.string();
+        auto handle = std::fopen(pathString.c_str(), mode == Mode::Input ? "rb" : "wb");
+
+        if (handle == nullptr) {
+            SCHMIX_ERROR("Failed to open file: {}", pathString);
+            return {};
+        }
+
+        if (bufferSize == 0) {
+            bufferSize = DefaultFileBufferSize;
+        }
+
+        // reads at least this large bypass the stdio buffer entirely
+        std::setvbuf(handle, nullptr, _IOFBF, bufferSize);
+
+        auto file = std::shared_ptr<std::FILE>(handle, std::fclose);
+
+        Callbacks callbacks;
+        callbacks.BufferSize = bufferSize;
+
+        switch (mode) {
+        case Mode::Input:
+            callbacks.ReadPacket = [file](void* buffer, std::size_t bufferSize) -> std::int32_t {
+                std::size_t bytesRead = std::fread(buffer, 1, bufferSize, file.get());
+                if (bytesRead == 0 && std::ferror(file.get())) {
+                    return -1;
+                }
+
+                return (std::int32_t)bytesRead;
+            };
+
+            break;
+        case Mode::Output:
+            callbacks.WritePacket = [file](const void* buffer,
+                                           std::size_t bufferSize) -> std::int32_t {
+                std::size_t bytesWritten = std::fwrite(buffer, 1, bufferSize, file.get());
+                if (bytesWritten < bufferSize) {
+                    return -1;
+                }
+
+                return (std::int32_t)bytesWritten;
+            };
+
+            break;
+        }
+
+        callbacks.Seek = [file](std::int64_t offset, std::int32_t origin) -> std::int64_t {
+            auto handle = file.get();
+
+            // libavformat asks for the total size this way
+            if ((origin & AVSEEK_SIZE) != 0) {
+                std::int64_t position = TellFile(handle);
+                if (SeekFile(handle, 0, SEEK_END) != 0) {
+                    return -1;
+                }
+
+                std::int64_t size = TellFile(handle);
+                SeekFile(handle, position, SEEK_SET);
+
+                return size;
+            }
+
+            if (SeekFile(handle, offset, origin & ~AVSEEK_FORCE) != 0) {
+                return -1;
+            }
+
+            return TellFile(handle);
+        };
+
+        return callbacks;
+    }
+
+    struct MemorySource {
+        const std::uint8_t* Data;
+        std::size_t Size;
+        std::int64_t Position;
+
+        // keeps the data alive
+        std::shared_ptr<void> Owner;
+    };
+
+    static IO::Callbacks CreateMemoryCallbacks(const std::shared_ptr<MemorySource>& source) {
+        IO::Callbacks callbacks;
+
+        callbacks.ReadPacket = [source](void* buffer, std::size_t bufferSize) -> std::int32_t {
+            std::size_t remaining = source->Size - (std::size_t)source->Position;
+            std::size_t bytesRead = std::min(remaining, bufferSize);
+
+            Memory::Copy(source->Data + source->Position, buffer, bytesRead);
+            source->Position += (std::int64_t)bytesRead;
+
+            return (std::int32_t)bytesRead;
+        };
+
+        callbacks.Seek = [source](std::int64_t offset, std::int32_t origin) -> std::int64_t {
+            if ((origin & AVSEEK_SIZE) != 0) {
+                return (std::int64_t)source->Size;
+            }
+
+            std::int64_t position;
+            switch (origin & ~AVSEEK_FORCE) {
+            case SEEK_SET:
+                position = offset;
+                break;
+            case SEEK_CUR:
+                position = source->Position + offset;
+                break;
+            case SEEK_END:
+                position = (std::int64_t)source->Size + offset;
+                break;
+            default:
+                return -1;
+            }
+
+            if (position < 0 || position > (std::int64_t)source->Size) {
+                return -1;
+            }
+
+            source->Position = position;
+            return position;
+        };
+
+        // there is no syscall to amortize, so hand out large chunks
+        callbacks.BufferSize = IO::DefaultFileBufferSize;
+
+        return callbacks;
+    }
+
+    std::optional<IO::Callbacks> IO::MapFile(const std::filesystem::path& path) {
+        auto file = std::make_shared<MappedFile>(path);
+        if (!file->IsOpen()) {
+            return {};
+        }
+
+        auto source = std::make_shared<MemorySource>();
+        source->Data = (const std::uint8_t*)file->GetData();
+        source->Size = file->GetSize();
+        source->Position = 0;
+        source->Owner = file;
+
+        return CreateMemoryCallbacks(source);
+    }
+
+    IO::Callbacks IO::OpenMemory(const void* data, std::size_t size) {
+        auto buffer = std::make_shared<std::vector<std::uint8_t>>(size);
+        Memory::Copy(data, buffer->data(), size);
+
+        auto source = std::make_shared<MemorySource>();
+        source->Data = buffer->data();
+        source->Size = size;
+        source->Position = 0;
+        source->Owner = buffer;
+
+        return CreateMemoryCallbacks(source);
+    }
 } // namespace schmix
@@ -7,6 +7,9 @@ namespace schmix {
             std::function<std::int32_t(void* buffer, std::size_t bufferSize)> ReadPacket;
             std::function<std::int32_t(const void* buffer, std::size_t bufferSize)> WritePacket;
             std::function<std::int64_t(std::int64_t offset, std::int32_t origin)> Seek;
+
+            // preferred read/write granularity; 0 leaves it up to the consumer
+            std::size_t BufferSize = 0;
         };
 
         enum class Mode : std::int32_t { Input = 0, Output };
@@ -14,5 +17,19 @@ namespace schmix {
         IO() = delete;
 
         static void Init();
+
+        static constexpr std::size_t DefaultFileBufferSize = 64 * 1024;
+
+        // native backends; state is shared between copies and released with the last one
+
+        // buffered file on disk; 0 selects the default buffer size
+        static std::optional<Callbacks> OpenFile(const std::filesystem::path& path, Mode mode,
+                                                 std::size_t bufferSize = 0);
+
+        // read-only memory map of a file on disk
+        static std::optional<Callbacks> MapFile(const std::filesystem::path& path);
+
+        // read-only copy of the given data
+        static Callbacks OpenMemory(const void* data, std::size_t size);
     };
 } // namespace schmix
@@ -0,0 +1,429 @@
+#include "schmixpch.h"
+#include "schmix/encoding/MediaPipeline.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+namespace schmix {
+    MediaPipeline::MediaPipeline(std::size_t channels, std::size_t sampleRate,
+                                 const Options& options) {
+        m_Cancelled = false;
+        m_Failed = false;
+        m_Stopped = false;
+        m_FramesProcessed = 0;
+
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+        m_Options = options;
+
+        m_IsOpen = false;
+    }
+
+    MediaPipeline::MediaPipeline(const IO::Callbacks& callbacks, std::size_t channels,
+                                 std::size_t sampleRate, const Options& options)
+        : MediaPipeline(channels, sampleRate, options) {
+        m_IsOpen = OpenStreams(callbacks);
+    }
+
+    MediaPipeline::MediaPipeline(const std::filesystem::path& path, std::size_t channels,
+                                 std::size_t sampleRate, const Options& options)
+        : MediaPipeline(channels, sampleRate, options) {
+        auto callbacks = IO::OpenFile(path, IO::Mode::Input);
+        if (!callbacks.has_value()) {
+            return;
+        }
+
+        m_IsOpen = OpenStreams(callbacks.value());
+    }
+
+    bool MediaPipeline::OpenStreams(const IO::Callbacks& callbacks) {
+        m_Format = std::make_unique<FormatStream>(callbacks, IO::Mode::Input, nullptr);
+        if (!m_Format->IsOpen()) {
+            SCHMIX_ERROR("Failed to open input format!");
+            return false;
+        }
+
+        m_Codec = std::make_unique<CodecStream>(callbacks, IO::Mode::Input,
+                                                m_Format->GetCodecParameters(),
+                                                m_Format->GetAudioStreamIndex());
+
+        if (!m_Codec->IsOpen()) {
+            SCHMIX_ERROR("Failed to open decoder!");
+            return false;
+        }
+
+        if (m_SampleRate == 0) {
+            m_SampleRate = m_Format->GetCodecParameters().GetSampleRate();
+        }
+
+        // room for everything queued plus the item each side of a queue holds
+        std::size_t freePackets = m_Options.PacketQueue + 2;
+        std::size_t freeFrames = m_Options.FrameQueue + 2;
+
+        m_Packets = std::make_unique<StageQueue<AVPacket*>>(m_Options.PacketQueue, m_Cancelled);
+        m_FreePackets = std::make_unique<StageQueue<AVPacket*>>(freePackets, m_Cancelled);
+
+        m_Decoded = std::make_unique<StageQueue<AVFrame*>>(m_Options.FrameQueue, m_Cancelled);
+        m_FreeDecoded = std::make_unique<StageQueue<AVFrame*>>(freeFrames, m_Cancelled);
+
+        m_Converted = std::make_unique<StageQueue<AVFrame*>>(m_Options.FrameQueue, m_Cancelled);
+        m_FreeConverted = std::make_unique<StageQueue<AVFrame*>>(freeFrames, m_Cancelled);
+
+        return true;
+    }
+
+    MediaPipeline::~MediaPipeline() {
+        if (!m_Threads.empty()) {
+            Cancel();
+            Wait();
+        }
+
+        if (m_IsOpen) {
+            FreeQueuedItems();
+        }
+
+        // the codec may still reference packet data owned by the demuxer
+        m_Codec.reset();
+        m_Format.reset();
+    }
+
+    bool MediaPipeline::Start(const Sink& sink) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Pipeline is not open!");
+            return false;
+        }
+
+        if (!m_Threads.empty()) {
+            SCHMIX_ERROR("Pipeline is already running!");
+            return false;
+        }
+
+        m_Threads.emplace_back([this]() { Demux(); });
+        m_Threads.emplace_back([this]() { Decode(); });
+        m_Threads.emplace_back([this]() { Convert(); });
+        m_Threads.emplace_back([this, sink]() { Deliver(sink); });
+
+        return true;
+    }
+
+    MediaPipeline::Status MediaPipeline::Wait() {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Pipeline is not open!");
+            return Status::Failed;
+        }
+
+        for (auto& thread : m_Threads) {
+            thread.join();
+        }
+
+        m_Threads.clear();
+
+        // whatever was in flight when the pipeline stopped, and the spent items waiting for reuse
+        FreeQueuedItems();
+
+        if (m_Failed) {
+            return Status::Failed;
+        }
+
+        if (m_Stopped) {
+            return Status::Stopped;
+        }
+
+        return m_Cancelled ? Status::Cancelled : Status::Finished;
+    }
+
+    void MediaPipeline::FreeQueuedItems() {
+        for (auto queue : { m_Packets.get(), m_FreePackets.get() }) {
+            while (auto packet = queue->TryPop()) {
+                av_packet_free(&packet.value());
+            }
+        }
+
+        for (auto queue : { m_Decoded.get(), m_FreeDecoded.get(), m_Converted.get(),
+                            m_FreeConverted.get() }) {
+            while (auto frame = queue->TryPop()) {
+                av_frame_free(&frame.value());
+            }
+        }
+    }
+
+    void MediaPipeline::Cancel() {
+        m_Cancelled = true;
+
+        if (!m_IsOpen) {
+            return;
+        }
+
+        m_Packets->Wake();
+        m_Decoded->Wake();
+        m_Converted->Wake();
+    }
+
+    void MediaPipeline::Fail() {
+        m_Failed = true;
+        Cancel();
+    }
+
+    AVPacket* MediaPipeline::AcquirePacket() {
+        auto packet = m_FreePackets->TryPop();
+        if (packet.has_value()) {
+            return packet.value();
+        }
+
+        auto allocated = av_packet_alloc();
+        if (allocated == nullptr) {
+            SCHMIX_ERROR("Failed to allocate packet!");
+        }
+
+        return allocated;
+    }
+
+    AVFrame* MediaPipeline::AcquireFrame(StageQueue<AVFrame*>& free) {
+        auto frame = free.TryPop();
+        if (frame.has_value()) {
+            return frame.value();
+        }
+
+        auto allocated = av_frame_alloc();
+        if (allocated == nullptr) {
+            SCHMIX_ERROR("Failed to allocate frame!");
+        }
+
+        return allocated;
+    }
+
+    void MediaPipeline::ReleasePacket(AVPacket* packet) {
+        if (packet == nullptr) {
+            return;
+        }
+
+        av_packet_unref(packet);
+        if (!m_FreePackets->TryPush(packet)) {
+            av_packet_free(&packet);
+        }
+    }
+
+    void MediaPipeline::ReleaseFrame(StageQueue<AVFrame*>& free, AVFrame* frame) {
+        if (frame == nullptr) {
+            return;
+        }
+
+        // the pooled sample buffer goes back to its pool here
+        av_frame_unref(frame);
+        if (!free.TryPush(frame)) {
+            av_frame_free(&frame);
+        }
+    }
+
+    // each free list is only ever pushed to by the stage after it and popped by the one before,
+    // so a stage frees whatever it took and could not hand on instead of giving it back itself
+
+    void MediaPipeline::Demux() {
+        while (true) {
+            auto packet = AcquirePacket();
+            if (packet == nullptr) {
+                Fail();
+                return;
+            }
+
+            auto read = m_Format->ReadPacket(packet);
+            if (!read.has_value() || !read.value()) {
+                av_packet_free(&packet);
+
+                if (!read.has_value()) {
+                    Fail();
+                } else {
+                    m_Packets->Push(nullptr);
+                }
+
+                return;
+            }
+
+            if (!m_Packets->Push(packet)) {
+                av_packet_free(&packet);
+                return;
+            }
+        }
+    }
+
+    void MediaPipeline::Decode() {
+        // kept for the next packet when the decoder had nothing to put in it
+        AVFrame* frame = nullptr;
+
+        bool draining = false;
+        while (!draining) {
+            auto packet = m_Packets->Pop();
+            if (!packet.has_value()) {
+                av_frame_free(&frame);
+                return;
+            }
+
+            draining = packet.value() == nullptr;
+
+            bool sent = m_Codec->SendPacket(packet.value());
+            ReleasePacket(packet.value());
+
+            if (!sent) {
+                av_frame_free(&frame);
+
+                Fail();
+                return;
+            }
+
+            while (true) {
+                if (frame == nullptr) {
+                    frame = AcquireFrame(*m_FreeDecoded);
+                    if (frame == nullptr) {
+                        Fail();
+                        return;
+                    }
+                }
+
+                auto received = m_Codec->ReceiveFrame(frame);
+                if (!received.has_value()) {
+                    av_frame_free(&frame);
+
+                    Fail();
+                    return;
+                }
+
+                if (!received.value()) {
+                    break;
+                }
+
+                if (!m_Decoded->Push(frame)) {
+                    av_frame_free(&frame);
+                    return;
+                }
+
+                frame = nullptr;
+            }
+        }
+
+        av_frame_free(&frame);
+        m_Decoded->Push(nullptr);
+    }
+
+    void MediaPipeline::Convert() {
+        // kept for the next input when the resampler had nothing to put in it
+        AVFrame* output = nullptr;
+
+        while (true) {
+            auto decoded = m_Decoded->Pop();
+            if (!decoded.has_value()) {
+                av_frame_free(&output);
+                return;
+            }
+
+            AVFrame* input = decoded.value();
+            if (input != nullptr && !PrepareResampler(input)) {
+                ReleaseFrame(*m_FreeDecoded, input);
+                av_frame_free(&output);
+
+                Fail();
+                return;
+            }
+
+            // nothing was ever decoded
+            if (input == nullptr && !m_Resampler) {
+                av_frame_free(&output);
+
+                m_Converted->Push(nullptr);
+                return;
+            }
+
+            if (output == nullptr) {
+                output = AcquireFrame(*m_FreeConverted);
+                if (output == nullptr) {
+                    ReleaseFrame(*m_FreeDecoded, input);
+
+                    Fail();
+                    return;
+                }
+            }
+
+            // a null input drains the resampler
+            bool converted = m_Resampler->ConvertFrame(
+                input != nullptr ? input->extended_data : nullptr,
+                input != nullptr ? (std::size_t)input->nb_samples : 0, output, m_BufferPool);
+
+            bool finished = input == nullptr;
+            ReleaseFrame(*m_FreeDecoded, input);
+
+            if (!converted) {
+                av_frame_free(&output);
+
+                Fail();
+                return;
+            }
+
+            if (output->nb_samples == 0) {
+                av_frame_unref(output);
+            } else if (!m_Converted->Push(output)) {
+                av_frame_free(&output);
+                return;
+            } else {
+                output = nullptr;
+            }
+
+            if (finished) {
+                av_frame_free(&output);
+
+                m_Converted->Push(nullptr);
+                return;
+            }
+        }
+    }
+
+    void MediaPipeline::Deliver(const Sink& sink) {
+        while (true) {
+            auto converted = m_Converted->Pop();
+            if (!converted.has_value() || converted.value() == nullptr) {
+                return;
+            }
+
+            AVFrame* frame = converted.value();
+            auto frames = (std::size_t)frame->nb_samples;
+
+            bool accepted = sink((const double* const*)frame->extended_data, frames);
+            ReleaseFrame(*m_FreeConverted, frame);
+
+            if (!accepted) {
+                m_Stopped = true;
+                Cancel();
+
+                return;
+            }
+
+            m_FramesProcessed += frames;
+        }
+    }
+
+    bool MediaPipeline::PrepareResampler(const AVFrame* frame) {
+        Resampler::Format input;
+        input.Channels = (std::size_t)frame->ch_layout.nb_channels;
+        input.SampleRate = (std::size_t)frame->sample_rate;
+        input.SampleFormat = frame->format;
+
+        if (m_Resampler && m_Resampler->GetInputFormat() == input) {
+            return true;
+        }
+
+        if (m_Resampler) {
+            // samples still buffered under the old format are lost
+            SCHMIX_WARN("Decoded stream changed format mid-file - restarting conversion");
+        }
+
+        Resampler::Format output;
+        output.Channels = m_Channels;
+        output.SampleRate = m_SampleRate;
+        output.SampleFormat = AV_SAMPLE_FMT_DBLP;
+
+        m_Resampler = std::make_unique<Resampler>(input, output, m_Options.Quality);
+        if (!m_Resampler->IsInitialized()) {
+            m_Resampler.reset();
+            return false;
+        }
+
+        return true;
+    }
+} // namespace schmix
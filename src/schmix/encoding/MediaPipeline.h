@@ -0,0 +1,116 @@
+#pragma once
+
+#include "schmix/core/StageQueue.h"
+
+#include "schmix/encoding/FormatStream.h"
+#include "schmix/encoding/CodecStream.h"
+#include "schmix/encoding/Resampler.h"
+
+#include <thread>
+
+namespace schmix {
+    // demux -> decode -> resample -> sink, every stage on a thread of its own
+    // stages hand packets and frames on through bounded queues, so a slow stage holds the ones
+    // before it back instead of letting memory grow, and I/O, decoding and conversion overlap
+    // spent packets and frames travel back up through free lists to be filled again
+    class MediaPipeline {
+    public:
+        enum class Status : std::int32_t {
+            // the whole source went through the sink
+            Finished = 0,
+
+            // the sink asked to stop
+            Stopped,
+
+            Cancelled,
+            Failed
+        };
+
+        // planar doubles at the output rate; returning false cancels the pipeline
+        using Sink = std::function<bool(const double* const* channels, std::size_t frames)>;
+
+        struct Options {
+            // in packets and frames respectively
+            std::size_t PacketQueue = 64;
+            std::size_t FrameQueue = 16;
+
+            Resampler::Quality Quality = Resampler::Quality::Balanced;
+        };
+
+        // a rate of 0 keeps the source's
+        MediaPipeline(const IO::Callbacks& callbacks, std::size_t channels,
+                      std::size_t sampleRate, const Options& options);
+
+        MediaPipeline(const std::filesystem::path& path, std::size_t channels,
+                      std::size_t sampleRate, const Options& options);
+
+        ~MediaPipeline();
+
+        MediaPipeline(const MediaPipeline&) = delete;
+        MediaPipeline& operator=(const MediaPipeline&) = delete;
+
+        bool IsOpen() const { return m_IsOpen; }
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+
+        // starts every stage; the sink is called on the last stage's thread
+        bool Start(const Sink& sink);
+
+        // blocks until every stage has stopped
+        Status Wait();
+
+        // stops every stage at its next item; safe from any thread
+        void Cancel();
+
+        bool IsCancelled() const { return m_Cancelled; }
+
+        // output frames handed to the sink so far
+        std::size_t GetFramesProcessed() const { return m_FramesProcessed; }
+
+    private:
+        MediaPipeline(std::size_t channels, std::size_t sampleRate, const Options& options);
+
+        bool OpenStreams(const IO::Callbacks& callbacks);
+
+        // a null item marks the end of the stream
+        void Demux();
+        void Decode();
+        void Convert();
+        void Deliver(const Sink& sink);
+
+        bool PrepareResampler(const AVFrame* frame);
+
+        // stops the pipeline because of an error rather than a request
+        void Fail();
+
+        // reuses a spent item from the free list if there is one; null on failure
+        AVPacket* AcquirePacket();
+        AVFrame* AcquireFrame(StageQueue<AVFrame*>& free);
+
+        // empties the item and hands it back up; freed if the list is full
+        void ReleasePacket(AVPacket* packet);
+        void ReleaseFrame(StageQueue<AVFrame*>& free, AVFrame* frame);
+
+        void FreeQueuedItems();
+
+        std::unique_ptr<FormatStream> m_Format;
+        std::unique_ptr<CodecStream> m_Codec;
+        std::unique_ptr<Resampler> m_Resampler;
+        BufferPool m_BufferPool;
+
+        std::atomic<bool> m_Cancelled, m_Failed, m_Stopped;
+        std::atomic<std::size_t> m_FramesProcessed;
+
+        std::unique_ptr<StageQueue<AVPacket*>> m_Packets, m_FreePackets;
+        std::unique_ptr<StageQueue<AVFrame*>> m_Decoded, m_FreeDecoded;
+        std::unique_ptr<StageQueue<AVFrame*>> m_Converted, m_FreeConverted;
+
+        std::vector<std::thread> m_Threads;
+
+        std::size_t m_Channels, m_SampleRate;
+        Options m_Options;
+
+        bool m_IsOpen;
+    };
+} // namespace schmix
@@ -0,0 +1,510 @@
+#include "schmixpch.h"
+#include "schmix/encoding/PCM.h"
+
+#include "schmix/core/MappedFile.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+#include <cstring>
+
+namespace schmix {
+    static constexpr std::uint16_t s_FormatTagPCM = 0x0001;
+    static constexpr std::uint16_t s_FormatTagFloat = 0x0003;
+    static constexpr std::uint16_t s_FormatTagExtensible = 0xFFFE;
+
+#pragma pack(push, 1)
+    struct RIFFChunkHeader {
+        char ID[4];
+        std::uint32_t Size;
+    };
+
+    struct WAVFormatChunk {
+        std::uint16_t FormatTag;
+        std::uint16_t Channels;
+        std::uint32_t SampleRate;
+        std::uint32_t ByteRate;
+        std::uint16_t BlockAlign;
+        std::uint16_t BitsPerSample;
+    };
+
+    // RIFF header, fmt chunk and data chunk header
+    struct WAVHeader {
+        RIFFChunkHeader RIFF;
+        char WAVE[4];
+
+        RIFFChunkHeader FormatHeader;
+        WAVFormatChunk Format;
+
+        RIFFChunkHeader DataHeader;
+    };
+#pragma pack(pop)
+
+    std::optional<PCM::Container> PCM::GuessContainer(const std::filesystem::path& path) {
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](char c) { return (char)std::tolower((unsigned char)c); });
+
+        if (extension == ".wav" || extension == ".wave") {
+            return Container::WAV;
+        }
+
+        if (extension == ".raw" || extension == ".pcm") {
+            return Container::Raw;
+        }
+
+        return {};
+    }
+
+    bool PCM::IsWAV(const std::filesystem::path& path) {
+        return GuessContainer(path) == Container::WAV;
+    }
+
+    std::size_t PCM::GetSampleSize(Encoding encoding) {
+        switch (encoding) {
+        case Encoding::U8:
+            return 1;
+        case Encoding::S16:
+            return 2;
+        case Encoding::S24:
+            return 3;
+        case Encoding::S32:
+        case Encoding::Float:
+            return 4;
+        case Encoding::Double:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    std::optional<std::int32_t> PCM::GetAVSampleFormat(Encoding encoding) {
+        switch (encoding) {
+        case Encoding::U8:
+            return AV_SAMPLE_FMT_U8;
+        case Encoding::S16:
+            return AV_SAMPLE_FMT_S16;
+        case Encoding::S32:
+            return AV_SAMPLE_FMT_S32;
+        case Encoding::Float:
+            return AV_SAMPLE_FMT_FLT;
+        case Encoding::Double:
+            return AV_SAMPLE_FMT_DBL;
+        default:
+            return {};
+        }
+    }
+
+    // the loops below are kept branch-free so that the compiler can vectorize them
+
+    template <typename _Ty>
+    static void DecodeSamples(const void* source, double* destination, std::size_t samples,
+                              double offset, double scale) {
+        const _Ty* typed = (const _Ty*)source;
+        for (std::size_t i = 0; i < samples; i++) {
+            destination[i] = ((double)typed[i] - offset) * scale;
+        }
+    }
+
+    template <typename _Ty>
+    static void EncodeSamples(const double* source, void* destination, std::size_t samples,
+                              double offset, double scale) {
+        _Ty* typed = (_Ty*)destination;
+        for (std::size_t i = 0; i < samples; i++) {
+            double clamped = std::clamp(source[i], -1.0, 1.0);
+            typed[i] = (_Ty)std::floor(clamped * scale + offset + 0.5);
+        }
+    }
+
+    void PCM::Decode(const void* source, Encoding encoding, double* destination,
+                     std::size_t samples) {
+        switch (encoding) {
+        case Encoding::U8:
+            DecodeSamples<std::uint8_t>(source, destination, samples, 128.0, 1.0 / 128.0);
+            break;
+        case Encoding::S16:
+            DecodeSamples<std::int16_t>(source, destination, samples, 0.0, 1.0 / 32768.0);
+            break;
+        case Encoding::S24: {
+            auto bytes = (const std::uint8_t*)source;
+            for (std::size_t i = 0; i < samples; i++) {
+                // into the top three bytes so that the sign comes along
+                std::int32_t value = (std::int32_t)(((std::uint32_t)bytes[i * 3] << 8) |
+                                                    ((std::uint32_t)bytes[i * 3 + 1] << 16) |
+                                                    ((std::uint32_t)bytes[i * 3 + 2] << 24));
+
+                destination[i] = (double)value * (1.0 / 2147483648.0);
+            }
+        } break;
+        case Encoding::S32:
+            DecodeSamples<std::int32_t>(source, destination, samples, 0.0, 1.0 / 2147483648.0);
+            break;
+        case Encoding::Float:
+            DecodeSamples<float>(source, destination, samples, 0.0, 1.0);
+            break;
+        case Encoding::Double:
+            Memory::Copy(source, destination, samples * sizeof(double));
+            break;
+        }
+    }
+
+    void PCM::Encode(const double* source, void* destination, Encoding encoding,
+                     std::size_t samples) {
+        switch (encoding) {
+        case Encoding::U8:
+            EncodeSamples<std::uint8_t>(source, destination, samples, 128.0, 127.0);
+            break;
+        case Encoding::S16:
+            EncodeSamples<std::int16_t>(source, destination, samples, 0.0, 32767.0);
+            break;
+        case Encoding::S24: {
+            auto bytes = (std::uint8_t*)destination;
+            for (std::size_t i = 0; i < samples; i++) {
+                double clamped = std::clamp(source[i], -1.0, 1.0);
+                auto value = (std::int32_t)std::floor(clamped * 8388607.0 + 0.5);
+
+                bytes[i * 3] = (std::uint8_t)(value & 0xFF);
+                bytes[i * 3 + 1] = (std::uint8_t)((value >> 8) & 0xFF);
+                bytes[i * 3 + 2] = (std::uint8_t)((value >> 16) & 0xFF);
+            }
+        } break;
+        case Encoding::S32:
+            EncodeSamples<std::int32_t>(source, destination, samples, 0.0, 2147483647.0);
+            break;
+        case Encoding::Float: {
+            auto typed = (float*)destination;
+            for (std::size_t i = 0; i < samples; i++) {
+                typed[i] = (float)source[i];
+            }
+        } break;
+        case Encoding::Double:
+            Memory::Copy(source, destination, samples * sizeof(double));
+            break;
+        }
+    }
+
+    void PCM::WidenS24(const void* source, std::int32_t* destination, std::size_t samples) {
+        auto bytes = (const std::uint8_t*)source;
+        for (std::size_t i = 0; i < samples; i++) {
+            destination[i] = (std::int32_t)(((std::uint32_t)bytes[i * 3] << 8) |
+                                            ((std::uint32_t)bytes[i * 3 + 1] << 16) |
+                                            ((std::uint32_t)bytes[i * 3 + 2] << 24));
+        }
+    }
+
+    PCM::Reader::Reader(const std::filesystem::path& path) {
+        m_Data = nullptr;
+        m_Frames = 0;
+        m_IsOpen = false;
+
+        m_File = std::make_unique<MappedFile>(path);
+        if (!m_File->IsOpen()) {
+            return;
+        }
+
+        if (!ParseWAV()) {
+            return;
+        }
+
+        m_IsOpen = true;
+    }
+
+    PCM::Reader::Reader(const std::filesystem::path& path, const Format& format) {
+        m_Format = format;
+
+        m_Data = nullptr;
+        m_Frames = 0;
+        m_IsOpen = false;
+
+        std::size_t frameSize = format.Channels * GetSampleSize(format.SampleEncoding);
+        if (frameSize == 0 || format.SampleRate == 0) {
+            SCHMIX_ERROR("Invalid raw PCM format!");
+            return;
+        }
+
+        m_File = std::make_unique<MappedFile>(path);
+        if (!m_File->IsOpen()) {
+            return;
+        }
+
+        m_Data = (const std::uint8_t*)m_File->GetData();
+        m_Frames = m_File->GetSize() / frameSize;
+
+        m_IsOpen = true;
+    }
+
+    PCM::Reader::~Reader() = default;
+
+    const void* PCM::Reader::GetFrame(std::size_t frame) const {
+        std::size_t frameSize = m_Format.Channels * GetSampleSize(m_Format.SampleEncoding);
+        return m_Data + frame * frameSize;
+    }
+
+    static std::optional<PCM::Encoding> GetWAVEncoding(std::uint16_t formatTag,
+                                                       std::uint16_t bitsPerSample) {
+        if (formatTag == s_FormatTagPCM) {
+            switch (bitsPerSample) {
+            case 8:
+                return PCM::Encoding::U8;
+            case 16:
+                return PCM::Encoding::S16;
+            case 24:
+                return PCM::Encoding::S24;
+            case 32:
+                return PCM::Encoding::S32;
+            }
+        } else if (formatTag == s_FormatTagFloat) {
+            switch (bitsPerSample) {
+            case 32:
+                return PCM::Encoding::Float;
+            case 64:
+                return PCM::Encoding::Double;
+            }
+        }
+
+        return {};
+    }
+
+    bool PCM::Reader::ParseWAV() {
+        auto data = (const std::uint8_t*)m_File->GetData();
+        std::size_t size = m_File->GetSize();
+
+        if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 ||
+            std::memcmp(data + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        std::optional<WAVFormatChunk> format;
+        std::uint16_t formatTag = 0;
+
+        std::size_t cursor = 12;
+        while (cursor + sizeof(RIFFChunkHeader) <= size) {
+            RIFFChunkHeader header;
+            Memory::Copy(data + cursor, &header, sizeof(RIFFChunkHeader));
+            cursor += sizeof(RIFFChunkHeader);
+
+            std::size_t chunkSize = std::min((std::size_t)header.Size, size - cursor);
+
+            if (std::memcmp(header.ID, "fmt ", 4) == 0 && chunkSize >= sizeof(WAVFormatChunk)) {
+                format = WAVFormatChunk{};
+                Memory::Copy(data + cursor, &format.value(), sizeof(WAVFormatChunk));
+
+                formatTag = format->FormatTag;
+
+                // the real tag is the first two bytes of the sub-format guid
+                if (formatTag == s_FormatTagExtensible && chunkSize >= 26) {
+                    Memory::Copy(data + cursor + 24, &formatTag, sizeof(std::uint16_t));
+                }
+            } else if (std::memcmp(header.ID, "data", 4) == 0) {
+                if (!format.has_value()) {
+                    SCHMIX_ERROR("WAV data chunk precedes its format chunk!");
+                    return false;
+                }
+
+                auto encoding = GetWAVEncoding(formatTag, format->BitsPerSample);
+                if (!encoding.has_value()) {
+                    // compressed or unusual; libavcodec can have it
+                    return false;
+                }
+
+                m_Format.Channels = format->Channels;
+                m_Format.SampleRate = format->SampleRate;
+                m_Format.SampleEncoding = encoding.value();
+
+                std::size_t frameSize = m_Format.Channels * GetSampleSize(encoding.value());
+                if (frameSize == 0 || format->BlockAlign != frameSize) {
+                    SCHMIX_ERROR("Unsupported WAV block alignment!");
+                    return false;
+                }
+
+                // streamed files may leave the size unset
+                m_Data = data + cursor;
+                m_Frames = chunkSize / frameSize;
+
+                return true;
+            }
+
+            // chunks are padded to an even size
+            cursor += chunkSize + (chunkSize & 1);
+        }
+
+        SCHMIX_ERROR("WAV file has no data chunk!");
+        return false;
+    }
+
+    // large enough that the stream rarely goes back to the kernel
+    static constexpr std::size_t s_WriterChunkFrames = 16384;
+
+    PCM::Writer::Writer(const std::filesystem::path& path, Container container,
+                        const Format& format) {
+        m_Container = container;
+        m_Format = format;
+        m_Frames = 0;
+
+        m_IsOpen = false;
+
+        if (format.Channels == 0 || format.SampleRate == 0) {
+            SCHMIX_ERROR("Invalid PCM output format!");
+            return;
+        }
+
+        m_Stream.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!m_Stream.is_open()) {
+            SCHMIX_ERROR("Failed to open PCM file for writing: {}", path.string().c_str());
+            return;
+        }
+
+        // the sizes are filled in on close
+        if (!WriteHeader()) {
+            return;
+        }
+
+        m_Staging.resize(s_WriterChunkFrames * format.Channels *
+                         GetSampleSize(format.SampleEncoding));
+
+        m_IsOpen = true;
+    }
+
+    PCM::Writer::~Writer() {
+        if (m_IsOpen) {
+            Close();
+        }
+    }
+
+    bool PCM::Writer::Write(const double* interleaved, std::size_t frames) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("PCM writer is not open!");
+            return false;
+        }
+
+        while (frames > 0) {
+            std::size_t chunkFrames = std::min(frames, s_WriterChunkFrames);
+            if (!WriteChunk(interleaved, chunkFrames)) {
+                return false;
+            }
+
+            interleaved += chunkFrames * m_Format.Channels;
+            frames -= chunkFrames;
+        }
+
+        return true;
+    }
+
+    bool PCM::Writer::WritePlanar(const double* const* channels, std::size_t frames) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("PCM writer is not open!");
+            return false;
+        }
+
+        std::size_t channelCount = m_Format.Channels;
+        if (m_Interleaved.empty()) {
+            m_Interleaved.resize(s_WriterChunkFrames * channelCount);
+        }
+
+        for (std::size_t offset = 0; offset < frames;) {
+            std::size_t chunkFrames = std::min(frames - offset, s_WriterChunkFrames);
+            for (std::size_t i = 0; i < channelCount; i++) {
+                const double* source = channels[i] + offset;
+                for (std::size_t j = 0; j < chunkFrames; j++) {
+                    m_Interleaved[j * channelCount + i] = source[j];
+                }
+            }
+
+            if (!WriteChunk(m_Interleaved.data(), chunkFrames)) {
+                return false;
+            }
+
+            offset += chunkFrames;
+        }
+
+        return true;
+    }
+
+    bool PCM::Writer::WriteChunk(const double* interleaved, std::size_t frames) {
+        std::size_t samples = frames * m_Format.Channels;
+        std::size_t sampleSize = GetSampleSize(m_Format.SampleEncoding);
+
+        Encode(interleaved, m_Staging.data(), m_Format.SampleEncoding, samples);
+        m_Stream.write((const char*)m_Staging.data(), (std::streamsize)(samples * sampleSize));
+
+        if (!m_Stream) {
+            SCHMIX_ERROR("Failed to write PCM samples!");
+            return false;
+        }
+
+        m_Frames += frames;
+        return true;
+    }
+
+    bool PCM::Writer::Close() {
+        if (!m_IsOpen) {
+            return false;
+        }
+
+        m_IsOpen = false;
+
+        bool success = true;
+        if (m_Container == Container::WAV) {
+            // riff chunks are word-aligned, so an odd-sized data chunk takes a pad byte
+            if ((GetDataSize() & 1) != 0) {
+                m_Stream.put('\0');
+            }
+
+            m_Stream.seekp(0);
+            success = WriteHeader();
+        }
+
+        m_Stream.close();
+        if (!success || !m_Stream) {
+            SCHMIX_ERROR("Failed to finish PCM file!");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool PCM::Writer::WriteHeader() {
+        if (m_Container != Container::WAV) {
+            return true;
+        }
+
+        std::size_t sampleSize = GetSampleSize(m_Format.SampleEncoding);
+        std::size_t dataSize = GetDataSize();
+        std::size_t riffSize =
+            sizeof(WAVHeader) - sizeof(RIFFChunkHeader) + dataSize + (dataSize & 1);
+
+        // saturated rather than wrapped, which most readers take as "read to the end"
+        constexpr std::size_t maxSize = std::numeric_limits<std::uint32_t>::max();
+        if (riffSize > maxSize) {
+            SCHMIX_WARN("WAV output exceeds 4 GiB - header sizes will be saturated");
+        }
+
+        bool isFloat = m_Format.SampleEncoding == Encoding::Float ||
+                       m_Format.SampleEncoding == Encoding::Double;
+
+        WAVHeader header;
+        Memory::Copy("RIFF", header.RIFF.ID, 4);
+        header.RIFF.Size = (std::uint32_t)std::min(riffSize, maxSize);
+        Memory::Copy("WAVE", header.WAVE, 4);
+
+        Memory::Copy("fmt ", header.FormatHeader.ID, 4);
+        header.FormatHeader.Size = sizeof(WAVFormatChunk);
+
+        header.Format.FormatTag = isFloat ? s_FormatTagFloat : s_FormatTagPCM;
+        header.Format.Channels = (std::uint16_t)m_Format.Channels;
+        header.Format.SampleRate = (std::uint32_t)m_Format.SampleRate;
+        header.Format.BlockAlign = (std::uint16_t)(m_Format.Channels * sampleSize);
+        header.Format.ByteRate = header.Format.SampleRate * header.Format.BlockAlign;
+        header.Format.BitsPerSample = (std::uint16_t)(sampleSize * 8);
+
+        Memory::Copy("data", header.DataHeader.ID, 4);
+        header.DataHeader.Size = (std::uint32_t)std::min(dataSize, maxSize);
+
+        m_Stream.write((const char*)&header, sizeof(WAVHeader));
+        if (!m_Stream) {
+            SCHMIX_ERROR("Failed to write WAV header!");
+            return false;
+        }
+
+        return true;
+    }
+} // namespace schmix
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <fstream>
+
+namespace schmix {
+    class MappedFile;
+
+    // uncompressed audio without a trip through libavcodec
+    // all supported platforms are little-endian, as are wav and our raw files
+    class PCM {
+    public:
+        enum class Encoding : std::int32_t { U8 = 0, S16, S24, S32, Float, Double };
+        enum class Container : std::int32_t { WAV = 0, Raw };
+
+        struct Format {
+            std::size_t Channels = 0;
+            std::size_t SampleRate = 0;
+            Encoding SampleEncoding = Encoding::S16;
+        };
+
+        PCM() = delete;
+
+        // from the extension alone; anything else goes through libavformat
+        static std::optional<Container> GuessContainer(const std::filesystem::path& path);
+        static bool IsWAV(const std::filesystem::path& path);
+
+        static std::size_t GetSampleSize(Encoding encoding);
+
+        // the packed libav format with the same layout; empty for 24-bit samples
+        static std::optional<std::int32_t> GetAVSampleFormat(Encoding encoding);
+
+        // sample counts include every channel
+        static void Decode(const void* source, Encoding encoding, double* destination,
+                           std::size_t samples);
+
+        static void Encode(const double* source, void* destination, Encoding encoding,
+                           std::size_t samples);
+
+        // 24-bit samples into the top of 32-bit ones, which libav can read
+        static void WidenS24(const void* source, std::int32_t* destination, std::size_t samples);
+
+        // reads straight out of a memory-mapped file
+        class Reader {
+        public:
+            // wav; the format comes from the header
+            Reader(const std::filesystem::path& path);
+
+            // raw; the whole file is samples in the given format
+            Reader(const std::filesystem::path& path, const Format& format);
+
+            ~Reader();
+
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+
+            bool IsOpen() const { return m_IsOpen; }
+
+            const Format& GetFormat() const { return m_Format; }
+            std::size_t GetFrames() const { return m_Frames; }
+
+            // interleaved samples in the file's own encoding
+            const void* GetData() const { return m_Data; }
+            const void* GetFrame(std::size_t frame) const;
+
+        private:
+            bool ParseWAV();
+
+            std::unique_ptr<MappedFile> m_File;
+
+            Format m_Format;
+            const std::uint8_t* m_Data;
+            std::size_t m_Frames;
+
+            bool m_IsOpen;
+        };
+
+        // streams doubles out to disk at the speed of the disk, with no codec in between
+        // wav gets a header with placeholder sizes up front, which close seeks back to fill in
+        class Writer {
+        public:
+            Writer(const std::filesystem::path& path, Container container, const Format& format);
+            ~Writer();
+
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            bool IsOpen() const { return m_IsOpen; }
+
+            const Format& GetFormat() const { return m_Format; }
+            std::size_t GetFrames() const { return m_Frames; }
+
+            bool Write(const double* interleaved, std::size_t frames);
+
+            // one buffer per channel, as the encoders take them
+            bool WritePlanar(const double* const* channels, std::size_t frames);
+
+            // fills in the header; called by the destructor if not called before
+            bool Close();
+
+        private:
+            bool WriteHeader();
+            bool WriteChunk(const double* interleaved, std::size_t frames);
+
+            std::size_t GetDataSize() const {
+                return m_Frames * m_Format.Channels * GetSampleSize(m_Format.SampleEncoding);
+            }
+
+            std::ofstream m_Stream;
+            std::vector<std::uint8_t> m_Staging;
+
+            // planar writes only
+            std::vector<double> m_Interleaved;
+
+            Container m_Container;
+            Format m_Format;
+            std::size_t m_Frames;
+
+            bool m_IsOpen;
+        };
+    };
+} // namespace schmix
@@ -0,0 +1,244 @@
+#include "schmixpch.h"
+#include "schmix/encoding/ParallelDecoder.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+#include <deque>
+
+namespace schmix {
+    // long enough that opening a decoder and priming it is noise next to decoding the chunk
+    static constexpr double s_ChunkDuration = 30.0;
+
+    // chunks queued or decoding per worker
+    static constexpr std::size_t s_ChunksPerWorker = 2;
+
+    // decoded samples held at once across every chunk in flight; one chunk is always let through
+    static constexpr std::size_t s_MaxInFlightBytes = 256 * 1024 * 1024;
+
+    // read size for the last chunk, whose length is not known up front
+    static constexpr std::size_t s_ReadFrames = 65536;
+
+    using ChunkSamples = std::optional<std::vector<double>>;
+
+    static ChunkSamples DecodeChunk(const std::filesystem::path& path, std::size_t channels,
+                                    std::size_t sampleRate, Resampler::Quality quality,
+                                    const std::shared_ptr<const SeekIndex>& index,
+                                    std::size_t start, std::optional<std::size_t> frames) {
+        AudioDecoder decoder(path, channels, sampleRate, quality);
+        if (!decoder.IsOpen()) {
+            return {};
+        }
+
+        // the first chunk starts out primed anyway
+        if (start > 0 && (!decoder.SetSeekIndex(*index) || !decoder.Seek(start))) {
+            return {};
+        }
+
+        std::vector<double> samples;
+        std::size_t framesRead = 0;
+
+        while (true) {
+            std::size_t toRead = frames.has_value() ? frames.value() - framesRead : s_ReadFrames;
+            if (toRead == 0) {
+                break;
+            }
+
+            samples.resize((framesRead + toRead) * channels);
+
+            auto read = decoder.Read(samples.data() + framesRead * channels, toRead);
+            if (!read.has_value()) {
+                return {};
+            }
+
+            framesRead += read.value();
+            if (read.value() < toRead) {
+                break;
+            }
+        }
+
+        samples.resize(framesRead * channels);
+        return samples;
+    }
+
+    ParallelDecoder::ParallelDecoder(const std::filesystem::path& path, std::size_t channels,
+                                     std::size_t sampleRate, Resampler::Quality quality) {
+        m_Path = path;
+        m_Channels = channels;
+        m_Quality = quality;
+
+        m_IsOpen = false;
+
+        m_Decoder = std::make_unique<AudioDecoder>(path, channels, sampleRate, quality);
+        if (!m_Decoder->IsOpen()) {
+            return;
+        }
+
+        m_IsOpen = true;
+    }
+
+    ParallelDecoder::~ParallelDecoder() = default;
+
+    bool ParallelDecoder::PrepareSeekIndex(const std::filesystem::path& path) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        return m_Decoder->PrepareSeekIndex(path);
+    }
+
+    bool ParallelDecoder::Decode(ThreadPool& pool, const Sink& sink) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        if (!m_Decoder->GetSeekIndex().has_value() && !m_Decoder->BuildSeekIndex()) {
+            return false;
+        }
+
+        // one copy shared by every job
+        auto index = std::make_shared<const SeekIndex>(m_Decoder->GetSeekIndex().value());
+        auto chunks = SplitChunks();
+
+        std::size_t sourceRate = m_Decoder->GetSourceSampleRate();
+        std::size_t outputRate = GetSampleRate();
+
+        std::unique_ptr<Resampler> resampler;
+        std::vector<double> resampled;
+
+        if (sourceRate != outputRate) {
+            Resampler::Format input;
+            input.Channels = m_Channels;
+            input.SampleRate = sourceRate;
+            input.SampleFormat = AV_SAMPLE_FMT_DBL;
+
+            auto output = input;
+            output.SampleRate = outputRate;
+
+            resampler = std::make_unique<Resampler>(input, output, m_Quality);
+            if (!resampler->IsInitialized()) {
+                return false;
+            }
+        }
+
+        // interleaved source frames in, output frames out to the sink; null drains
+        auto emit = [&](const double* samples, std::size_t frames) {
+            if (!resampler) {
+                return sink(samples, frames);
+            }
+
+            std::size_t capacity = resampler->GetOutputCapacity(frames);
+            if (resampled.size() < capacity * m_Channels) {
+                resampled.resize(capacity * m_Channels);
+            }
+
+            auto input = (const std::uint8_t*)samples;
+            auto output = (std::uint8_t*)resampled.data();
+
+            auto converted = resampler->Convert(samples != nullptr ? &input : nullptr, frames,
+                                                &output, capacity);
+
+            if (!converted.has_value()) {
+                return false;
+            }
+
+            return converted.value() == 0 || sink(resampled.data(), converted.value());
+        };
+
+        // the last chunk's length is unknown, so it is taken to be as long as the others
+        auto estimateBytes = [&](const Chunk& chunk) {
+            std::size_t frames = chunk.Frames.value_or((std::size_t)(s_ChunkDuration * sourceRate));
+            return frames * m_Channels * sizeof(double);
+        };
+
+        std::size_t window = std::max<std::size_t>(pool.GetThreadCount() * s_ChunksPerWorker, 1);
+
+        // each future alongside the bytes it was admitted with
+        std::deque<std::pair<std::future<ChunkSamples>, std::size_t>> inFlight;
+        std::size_t inFlightBytes = 0;
+        std::size_t nextChunk = 0;
+
+        bool success = true;
+        while (nextChunk < chunks.size() || !inFlight.empty()) {
+            while (nextChunk < chunks.size() && inFlight.size() < window) {
+                const auto& chunk = chunks[nextChunk];
+
+                std::size_t bytes = estimateBytes(chunk);
+                if (!inFlight.empty() && inFlightBytes + bytes > s_MaxInFlightBytes) {
+                    break;
+                }
+
+                nextChunk++;
+                inFlightBytes += bytes;
+
+                auto future = pool.Submit([path = m_Path, channels = m_Channels, sourceRate,
+                                           quality = m_Quality, index, chunk]() {
+                    return DecodeChunk(path, channels, sourceRate, quality, index, chunk.Start,
+                                       chunk.Frames);
+                });
+
+                inFlight.emplace_back(std::move(future), bytes);
+            }
+
+            auto samples = inFlight.front().first.get();
+            inFlightBytes -= inFlight.front().second;
+            inFlight.pop_front();
+
+            if (!samples.has_value()) {
+                SCHMIX_ERROR("Failed to decode chunk of {}", m_Path.string().c_str());
+
+                success = false;
+                break;
+            }
+
+            if (!emit(samples->data(), samples->size() / m_Channels)) {
+                success = false;
+                break;
+            }
+        }
+
+        if (success && resampler) {
+            success = emit(nullptr, 0);
+        }
+
+        // jobs only hold copies, but nothing should outlive the call
+        for (auto& [future, bytes] : inFlight) {
+            future.wait();
+        }
+
+        return success;
+    }
+
+    std::vector<ParallelDecoder::Chunk> ParallelDecoder::SplitChunks() const {
+        const auto& index = m_Decoder->GetSeekIndex().value();
+
+        auto sourceRate = (std::int64_t)index.GetSampleRate();
+        auto chunkSamples = std::max((std::int64_t)(s_ChunkDuration * (double)sourceRate),
+                                     (std::int64_t)1);
+
+        // boundaries fall on index points
+        std::vector<std::size_t> starts = { 0 };
+        std::int64_t lastBoundary = 0;
+
+        for (const auto& point : index.GetPoints()) {
+            if (point.Sample - lastBoundary < chunkSamples) {
+                continue;
+            }
+
+            starts.push_back((std::size_t)point.Sample);
+            lastBoundary = point.Sample;
+        }
+
+        std::vector<Chunk> chunks(starts.size());
+        for (std::size_t i = 0; i < starts.size(); i++) {
+            chunks[i].Start = starts[i];
+
+            if (i + 1 < starts.size()) {
+                chunks[i].Frames = starts[i + 1] - starts[i];
+            }
+        }
+
+        return chunks;
+    }
+} // namespace schmix
@@ -0,0 +1,55 @@
+#pragma once
+#include "schmix/core/ThreadPool.h"
+
+#include "schmix/encoding/AudioDecoder.h"
+
+namespace schmix {
+    // decodes a whole file by splitting it at seek index points
+    // every chunk is decoded on the pool with its own demuxer and decoder at the source rate,
+    // where seeking is exact to the sample, so the pieces butt up against each other exactly
+    // resampling then runs serially over the joined stream, since a resampler started fresh
+    // for each chunk would begin at a different phase and click at every boundary
+    class ParallelDecoder {
+    public:
+        // interleaved frames in file order; returning false stops decoding
+        using Sink = std::function<bool(const double* interleaved, std::size_t frames)>;
+
+        ParallelDecoder(const std::filesystem::path& path, std::size_t channels,
+                        std::size_t sampleRate = 0,
+                        Resampler::Quality quality = Resampler::Quality::Balanced);
+
+        ~ParallelDecoder();
+
+        ParallelDecoder(const ParallelDecoder&) = delete;
+        ParallelDecoder& operator=(const ParallelDecoder&) = delete;
+
+        bool IsOpen() const { return m_IsOpen; }
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const { return m_Decoder->GetSampleRate(); }
+
+        // see AudioDecoder; without this an index is built in memory before decoding
+        bool PrepareSeekIndex(const std::filesystem::path& path);
+
+        // chunks in flight are capped both per worker and by their size in bytes
+        bool Decode(ThreadPool& pool, const Sink& sink);
+
+    private:
+        // in source frames; chunks without a length run to the end of the file
+        struct Chunk {
+            std::size_t Start;
+            std::optional<std::size_t> Frames;
+        };
+
+        std::vector<Chunk> SplitChunks() const;
+
+        std::filesystem::path m_Path;
+        std::size_t m_Channels;
+        Resampler::Quality m_Quality;
+
+        // owns the index and fixes the output rate
+        std::unique_ptr<AudioDecoder> m_Decoder;
+
+        bool m_IsOpen;
+    };
+} // namespace schmix
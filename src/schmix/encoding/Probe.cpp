@@ -0,0 +1,437 @@
+#include "schmixpch.h"
+#include "schmix/encoding/Probe.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+#include <fstream>
+#include <cstring>
+#include <mutex>
+
+namespace schmix {
+    // enough for every header we parse; ogg pages at the tail are at most 64 KiB
+    static constexpr std::size_t s_HeadSize = 64 * 1024;
+    static constexpr std::size_t s_TailSize = 64 * 1024;
+
+    struct ProbeCacheEntry {
+        std::filesystem::file_time_type Modified;
+        std::uintmax_t Size;
+
+        Probe::Info Info;
+    };
+
+    static std::mutex s_CacheMutex;
+    static std::unordered_map<std::string, ProbeCacheEntry> s_Cache;
+
+    static std::uint16_t ReadLE16(const std::uint8_t* data) {
+        return (std::uint16_t)(data[0] | (data[1] << 8));
+    }
+
+    static std::uint32_t ReadLE32(const std::uint8_t* data) {
+        return (std::uint32_t)data[0] | ((std::uint32_t)data[1] << 8) |
+               ((std::uint32_t)data[2] << 16) | ((std::uint32_t)data[3] << 24);
+    }
+
+    static std::uint64_t ReadLE64(const std::uint8_t* data) {
+        return (std::uint64_t)ReadLE32(data) | ((std::uint64_t)ReadLE32(data + 4) << 32);
+    }
+
+    static std::uint32_t ReadBE32(const std::uint8_t* data) {
+        return ((std::uint32_t)data[0] << 24) | ((std::uint32_t)data[1] << 16) |
+               ((std::uint32_t)data[2] << 8) | (std::uint32_t)data[3];
+    }
+
+    // reads up to the given number of bytes; the buffer is shrunk to what was read
+    static bool ReadRange(std::ifstream& stream, std::uint64_t offset, std::size_t size,
+                          std::vector<std::uint8_t>& buffer) {
+        stream.clear();
+        stream.seekg((std::streamoff)offset);
+
+        buffer.resize(size);
+        stream.read((char*)buffer.data(), (std::streamsize)size);
+        buffer.resize((std::size_t)stream.gcount());
+
+        return !buffer.empty();
+    }
+
+    // id3v2 tags sit in front of mp3 and sometimes flac data
+    static std::uint64_t SkipID3(const std::vector<std::uint8_t>& head) {
+        if (head.size() < 10 || std::memcmp(head.data(), "ID3", 3) != 0) {
+            return 0;
+        }
+
+        // synchsafe; seven bits per byte
+        std::uint64_t size = ((std::uint64_t)(head[6] & 0x7F) << 21) |
+                             ((std::uint64_t)(head[7] & 0x7F) << 14) |
+                             ((std::uint64_t)(head[8] & 0x7F) << 7) | (head[9] & 0x7F);
+
+        bool footer = (head[5] & 0x10) != 0;
+        return 10 + size + (footer ? 10 : 0);
+    }
+
+    static std::optional<Probe::Info> ProbeWAV(const std::vector<std::uint8_t>& head) {
+        if (head.size() < 12 || std::memcmp(head.data(), "RIFF", 4) != 0 ||
+            std::memcmp(head.data() + 8, "WAVE", 4) != 0) {
+            return {};
+        }
+
+        Probe::Info info;
+
+        std::uint16_t formatTag = 0, blockAlign = 0;
+        std::optional<std::uint32_t> factSamples;
+
+        std::size_t cursor = 12;
+        while (cursor + 8 <= head.size()) {
+            const std::uint8_t* chunk = head.data() + cursor;
+            std::uint32_t size = ReadLE32(chunk + 4);
+
+            cursor += 8;
+            if (std::memcmp(chunk, "fmt ", 4) == 0 && cursor + 16 <= head.size()) {
+                formatTag = ReadLE16(chunk + 8);
+                info.Channels = ReadLE16(chunk + 10);
+                info.SampleRate = ReadLE32(chunk + 12);
+                blockAlign = ReadLE16(chunk + 20);
+
+                if (formatTag == 0xFFFE && size >= 26 && cursor + 26 <= head.size()) {
+                    formatTag = ReadLE16(chunk + 8 + 24);
+                }
+            } else if (std::memcmp(chunk, "fact", 4) == 0 && cursor + 4 <= head.size()) {
+                factSamples = ReadLE32(chunk + 8);
+            } else if (std::memcmp(chunk, "data", 4) == 0) {
+                bool pcm = formatTag == 0x0001 || formatTag == 0x0003;
+
+                info.AudioCodec = pcm ? Probe::Codec::PCM : Probe::Codec::Other;
+                info.CodecName = pcm ? "pcm" : fmt::format("wav-0x{:04x}", formatTag);
+
+                if (info.SampleRate == 0) {
+                    return info;
+                }
+
+                // streamed files leave the size unset
+                if (pcm && blockAlign > 0 && size != 0xFFFFFFFF) {
+                    info.Duration = (double)(size / blockAlign) / (double)info.SampleRate;
+                } else if (factSamples.has_value()) {
+                    info.Duration = (double)factSamples.value() / (double)info.SampleRate;
+                }
+
+                return info;
+            }
+
+            cursor += size + (size & 1);
+        }
+
+        return {};
+    }
+
+    struct MP3FrameHeader {
+        std::size_t SampleRate;
+        std::size_t Channels;
+        std::size_t Bitrate;
+        std::size_t SamplesPerFrame;
+
+        // bytes between the frame header and the xing tag
+        std::size_t SideInfoSize;
+    };
+
+    // layer iii only; layers i and ii are rare enough to leave to libavformat
+    static std::optional<MP3FrameHeader> ParseMP3FrameHeader(const std::uint8_t* data) {
+        if (data[0] != 0xFF || (data[1] & 0xE0) != 0xE0) {
+            return {};
+        }
+
+        std::uint32_t version = (data[1] >> 3) & 3;
+        std::uint32_t layer = (data[1] >> 1) & 3;
+        std::uint32_t bitrateIndex = (data[2] >> 4) & 0xF;
+        std::uint32_t rateIndex = (data[2] >> 2) & 3;
+        std::uint32_t channelMode = (data[3] >> 6) & 3;
+
+        if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 ||
+            rateIndex == 3) {
+            return {};
+        }
+
+        static constexpr std::size_t rates[3] = { 44100, 48000, 32000 };
+        static constexpr std::size_t bitratesV1[15] = { 0,   32,  40,  48,  56,  64,  80, 96,
+                                                        112, 128, 160, 192, 224, 256, 320 };
+        static constexpr std::size_t bitratesV2[15] = { 0,  8,  16, 24,  32,  40,  48, 56,
+                                                        64, 80, 96, 112, 128, 144, 160 };
+
+        bool mpeg1 = version == 3;
+        bool mono = channelMode == 3;
+
+        MP3FrameHeader header;
+        header.SampleRate = rates[rateIndex] >> (mpeg1 ? 0 : (version == 2 ? 1 : 2));
+        header.Channels = mono ? 1 : 2;
+        header.Bitrate = (mpeg1 ? bitratesV1 : bitratesV2)[bitrateIndex] * 1000;
+        header.SamplesPerFrame = mpeg1 ? 1152 : 576;
+        header.SideInfoSize = mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+
+        return header;
+    }
+
+    static std::optional<Probe::Info> ProbeMP3(std::ifstream& stream, std::uint64_t start,
+                                               std::uint64_t fileSize) {
+        std::vector<std::uint8_t> data;
+        if (!ReadRange(stream, start, s_HeadSize, data) || data.size() < 4) {
+            return {};
+        }
+
+        // skip any junk between the tag and the first frame
+        std::size_t offset = 0;
+        std::optional<MP3FrameHeader> header;
+
+        for (; offset + 4 <= data.size(); offset++) {
+            header = ParseMP3FrameHeader(data.data() + offset);
+            if (header.has_value()) {
+                break;
+            }
+        }
+
+        if (!header.has_value()) {
+            return {};
+        }
+
+        Probe::Info info;
+        info.AudioCodec = Probe::Codec::MP3;
+        info.CodecName = "mp3";
+        info.SampleRate = header->SampleRate;
+        info.Channels = header->Channels;
+
+        // vbr files carry a frame count in a xing ("Info" when cbr) or vbri tag
+        std::optional<std::uint32_t> frames;
+
+        std::size_t xing = offset + 4 + header->SideInfoSize;
+        std::size_t vbri = offset + 4 + 32;
+
+        if (xing + 12 <= data.size() && (std::memcmp(data.data() + xing, "Xing", 4) == 0 ||
+                                         std::memcmp(data.data() + xing, "Info", 4) == 0)) {
+            std::uint32_t flags = ReadBE32(data.data() + xing + 4);
+            if ((flags & 1) != 0) {
+                frames = ReadBE32(data.data() + xing + 8);
+            }
+        } else if (vbri + 18 <= data.size() && std::memcmp(data.data() + vbri, "VBRI", 4) == 0) {
+            frames = ReadBE32(data.data() + vbri + 14);
+        }
+
+        if (frames.has_value()) {
+            info.Duration = (double)frames.value() * (double)header->SamplesPerFrame /
+                            (double)info.SampleRate;
+        } else {
+            // constant bitrate is the only thing left to assume
+            std::uint64_t audioBytes = fileSize - std::min(fileSize, start + offset);
+            info.Duration = (double)audioBytes * 8.0 / (double)header->Bitrate;
+        }
+
+        return info;
+    }
+
+    static std::optional<Probe::Info> ProbeFLAC(const std::vector<std::uint8_t>& data,
+                                                std::size_t offset) {
+        // marker, block header, then the 34-byte streaminfo block which always comes first
+        if (offset + 8 + 18 > data.size() || std::memcmp(data.data() + offset, "fLaC", 4) != 0) {
+            return {};
+        }
+
+        const std::uint8_t* info = data.data() + offset + 8 + 10;
+
+        std::uint64_t packed = ((std::uint64_t)ReadBE32(info) << 32) | ReadBE32(info + 4);
+        std::uint64_t sampleRate = packed >> 44;
+        std::uint64_t channels = ((packed >> 41) & 0x7) + 1;
+        std::uint64_t totalSamples = packed & 0xFFFFFFFFFull;
+
+        Probe::Info result;
+        result.AudioCodec = Probe::Codec::FLAC;
+        result.CodecName = "flac";
+        result.SampleRate = (std::size_t)sampleRate;
+        result.Channels = (std::size_t)channels;
+
+        if (sampleRate > 0 && totalSamples > 0) {
+            result.Duration = (double)totalSamples / (double)sampleRate;
+        }
+
+        return result;
+    }
+
+    static std::optional<Probe::Info> ProbeOgg(std::ifstream& stream,
+                                               const std::vector<std::uint8_t>& head,
+                                               std::uint64_t fileSize) {
+        if (head.size() < 28 || std::memcmp(head.data(), "OggS", 4) != 0) {
+            return {};
+        }
+
+        std::size_t segments = head[26];
+        std::size_t packet = 27 + segments;
+
+        if (packet + 19 > head.size()) {
+            return {};
+        }
+
+        const std::uint8_t* data = head.data() + packet;
+
+        Probe::Info info;
+        std::uint64_t preSkip = 0;
+
+        if (std::memcmp(data, "\x01vorbis", 7) == 0) {
+            info.AudioCodec = Probe::Codec::Vorbis;
+            info.CodecName = "vorbis";
+            info.Channels = data[11];
+            info.SampleRate = ReadLE32(data + 12);
+        } else if (std::memcmp(data, "OpusHead", 8) == 0) {
+            // granule positions always count at 48 kHz, whatever the input rate was
+            info.AudioCodec = Probe::Codec::Opus;
+            info.CodecName = "opus";
+            info.Channels = data[9];
+            info.SampleRate = 48000;
+
+            preSkip = ReadLE16(data + 10);
+        } else {
+            return {};
+        }
+
+        std::vector<std::uint8_t> tail;
+        std::uint64_t tailStart = fileSize - std::min<std::uint64_t>(fileSize, s_TailSize);
+
+        if (info.SampleRate == 0 || !ReadRange(stream, tailStart, s_TailSize, tail)) {
+            return info;
+        }
+
+        // the last page with a granule position marks the end of the stream
+        for (std::size_t i = tail.size() >= 14 ? tail.size() - 13 : 0; i-- > 0;) {
+            if (std::memcmp(tail.data() + i, "OggS", 4) != 0) {
+                continue;
+            }
+
+            std::uint64_t granule = ReadLE64(tail.data() + i + 6);
+            if (granule == ~(std::uint64_t)0) {
+                continue;
+            }
+
+            std::uint64_t samples = granule - std::min(granule, preSkip);
+            info.Duration = (double)samples / (double)info.SampleRate;
+
+            break;
+        }
+
+        return info;
+    }
+
+    // containers we do not parse ourselves; avformat_open_input only reads headers, unlike
+    // avformat_find_stream_info
+    static std::optional<Probe::Info> ProbeGeneric(const std::filesystem::path& path) {
+        auto pathString = path.string();
+
+        AVFormatContext* context = nullptr;
+        if (avformat_open_input(&context, pathString.c_str(), nullptr, nullptr) < 0) {
+            return {};
+        }
+
+        std::optional<Probe::Info> result;
+        for (unsigned int i = 0; i < context->nb_streams; i++) {
+            auto stream = context->streams[i];
+            auto params = stream->codecpar;
+
+            if (params->codec_type != AVMEDIA_TYPE_AUDIO) {
+                continue;
+            }
+
+            Probe::Info info;
+            info.AudioCodec = Probe::Codec::Other;
+            info.CodecName = avcodec_get_name(params->codec_id);
+            info.SampleRate = (std::size_t)std::max(params->sample_rate, 0);
+            info.Channels = (std::size_t)std::max(params->ch_layout.nb_channels, 0);
+
+            if (stream->duration != AV_NOPTS_VALUE) {
+                info.Duration = (double)stream->duration * av_q2d(stream->time_base);
+            } else if (context->duration != AV_NOPTS_VALUE) {
+                info.Duration = (double)context->duration / AV_TIME_BASE;
+            }
+
+            result = info;
+            break;
+        }
+
+        avformat_close_input(&context);
+        return result;
+    }
+
+    static std::optional<Probe::Info> ProbeUncached(const std::filesystem::path& path,
+                                                    std::uint64_t fileSize) {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream.is_open()) {
+            return {};
+        }
+
+        std::vector<std::uint8_t> head;
+        if (!ReadRange(stream, 0, s_HeadSize, head)) {
+            return {};
+        }
+
+        if (auto info = ProbeWAV(head)) {
+            return info;
+        }
+
+        if (auto info = ProbeOgg(stream, head, fileSize)) {
+            return info;
+        }
+
+        std::uint64_t start = SkipID3(head);
+        if (start + 4 <= head.size()) {
+            if (auto info = ProbeFLAC(head, (std::size_t)start)) {
+                return info;
+            }
+        }
+
+        // mp3 has no magic of its own, so only trust it for files that look like mp3
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](char c) { return (char)std::tolower((unsigned char)c); });
+
+        if (extension == ".mp3" || start > 0) {
+            if (auto info = ProbeMP3(stream, start, fileSize)) {
+                return info;
+            }
+        }
+
+        stream.close();
+        return ProbeGeneric(path);
+    }
+
+    std::optional<Probe::Info> Probe::File(const std::filesystem::path& path) {
+        std::error_code error;
+
+        auto modified = std::filesystem::last_write_time(path, error);
+        if (error) {
+            return {};
+        }
+
+        auto size = std::filesystem::file_size(path, error);
+        if (error) {
+            return {};
+        }
+
+        auto key = path.string();
+
+        {
+            std::lock_guard lock(s_CacheMutex);
+
+            auto it = s_Cache.find(key);
+            if (it != s_Cache.end() && it->second.Modified == modified && it->second.Size == size) {
+                return it->second.Info;
+            }
+        }
+
+        auto info = ProbeUncached(path, size);
+        if (!info.has_value()) {
+            return {};
+        }
+
+        std::lock_guard lock(s_CacheMutex);
+        s_Cache[key] = { modified, size, info.value() };
+
+        return info;
+    }
+
+    void Probe::ClearCache() {
+        std::lock_guard lock(s_CacheMutex);
+        s_Cache.clear();
+    }
+} // namespace schmix
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace schmix {
+    // stream details read from container headers alone; nothing is decoded
+    // results are cached per path, modification time and size
+    class Probe {
+    public:
+        enum class Codec : std::int32_t { Unknown = 0, PCM, MP3, Vorbis, Opus, FLAC, Other };
+
+        struct Info {
+            Codec AudioCodec = Codec::Unknown;
+
+            // libavcodec's name for the codec
+            std::string CodecName;
+
+            std::size_t SampleRate = 0;
+            std::size_t Channels = 0;
+
+            // in seconds; empty when the headers do not say
+            std::optional<double> Duration;
+        };
+
+        Probe() = delete;
+
+        // empty optional means the file could not be read or is not audio
+        static std::optional<Info> File(const std::filesystem::path& path);
+
+        static void ClearCache();
+    };
+} // namespace schmix
@@ -0,0 +1,166 @@
+#include "schmixpch.h"
+#include "schmix/encoding/Resampler.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+namespace schmix {
+    std::optional<Resampler::Quality> Resampler::ParseQuality(const std::string& name) {
+        static const std::unordered_map<std::string, Quality> qualities = {
+            { "fast", Quality::Fast },
+            { "balanced", Quality::Balanced },
+            { "high", Quality::High },
+        };
+
+        auto it = qualities.find(name);
+        if (it == qualities.end()) {
+            return {};
+        }
+
+        return it->second;
+    }
+
+    static void ApplyQuality(SwrContext* context, Resampler::Quality quality) {
+        switch (quality) {
+        case Resampler::Quality::Fast:
+            // short filters in single precision; swresample has simd kernels for planar float
+            av_opt_set_int(context, "filter_size", 8, 0);
+            av_opt_set_int(context, "phase_shift", 6, 0);
+            av_opt_set_int(context, "linear_interp", 1, 0);
+            av_opt_set_sample_fmt(context, "internal_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
+            break;
+        case Resampler::Quality::Balanced:
+            // swresample defaults
+            break;
+        case Resampler::Quality::High:
+            av_opt_set_int(context, "filter_size", 128, 0);
+            av_opt_set_int(context, "phase_shift", 12, 0);
+            av_opt_set_double(context, "cutoff", 0.98, 0);
+            av_opt_set_sample_fmt(context, "internal_sample_fmt", AV_SAMPLE_FMT_DBLP, 0);
+            break;
+        }
+    }
+
+    Resampler::Resampler(const Format& input, const Format& output, Quality quality) {
+        m_Input = input;
+        m_Output = output;
+        m_Quality = quality;
+
+        m_Context = nullptr;
+        m_Initialized = false;
+
+        AVChannelLayout inputLayout, outputLayout;
+        av_channel_layout_default(&inputLayout, (int)input.Channels);
+        av_channel_layout_default(&outputLayout, (int)output.Channels);
+
+        int result = swr_alloc_set_opts2(
+            &m_Context, &outputLayout, (AVSampleFormat)output.SampleFormat,
+            (int)output.SampleRate, &inputLayout, (AVSampleFormat)input.SampleFormat,
+            (int)input.SampleRate, 0, nullptr);
+
+        av_channel_layout_uninit(&inputLayout);
+        av_channel_layout_uninit(&outputLayout);
+
+        if (result < 0 || m_Context == nullptr) {
+            SCHMIX_ERROR("Failed to allocate resampling context!");
+            return;
+        }
+
+        ApplyQuality(m_Context, quality);
+
+        if (swr_init(m_Context) < 0) {
+            SCHMIX_ERROR("Failed to initialize resampling context!");
+            return;
+        }
+
+        m_Initialized = true;
+    }
+
+    Resampler::~Resampler() { swr_free(&m_Context); }
+
+    std::size_t Resampler::GetOutputCapacity(std::size_t inputFrames) const {
+        int capacity = swr_get_out_samples(m_Context, (int)inputFrames);
+        return capacity > 0 ? (std::size_t)capacity : 0;
+    }
+
+    std::optional<std::size_t> Resampler::Convert(const std::uint8_t* const* input,
+                                                  std::size_t inputFrames,
+                                                  std::uint8_t* const* output,
+                                                  std::size_t outputCapacity) {
+        if (!m_Initialized) {
+            SCHMIX_ERROR("Resampler is not initialized!");
+            return {};
+        }
+
+        int frames = swr_convert(m_Context, output, (int)outputCapacity, input,
+                                 input != nullptr ? (int)inputFrames : 0);
+
+        if (frames < 0) {
+            SCHMIX_ERROR("Failed to convert samples!");
+            return {};
+        }
+
+        return (std::size_t)frames;
+    }
+
+    bool Resampler::ConvertFrame(const std::uint8_t* const* input, std::size_t inputFrames,
+                                 AVFrame* output, BufferPool& pool) {
+        auto sampleFormat = (AVSampleFormat)m_Output.SampleFormat;
+
+        std::size_t capacity = GetOutputCapacity(inputFrames);
+        if (capacity == 0) {
+            return true;
+        }
+
+        int bufferSize = av_samples_get_buffer_size(nullptr, (int)m_Output.Channels, (int)capacity,
+                                                    sampleFormat, 1);
+
+        if (bufferSize < 0) {
+            SCHMIX_ERROR("Invalid frame size!");
+            return false;
+        }
+
+        auto buffer = pool.Get((std::size_t)bufferSize);
+        if (buffer == nullptr) {
+            return false;
+        }
+
+        output->buf[0] = buffer;
+        output->nb_samples = (int)capacity;
+        output->format = (int)sampleFormat;
+        output->sample_rate = (int)m_Output.SampleRate;
+        av_channel_layout_default(&output->ch_layout, (int)m_Output.Channels);
+
+        if (avcodec_fill_audio_frame(output, (int)m_Output.Channels, sampleFormat, buffer->data,
+                                     bufferSize, 1) < 0) {
+            SCHMIX_ERROR("Failed to set up frame pointers!");
+
+            av_frame_unref(output);
+            return false;
+        }
+
+        auto converted = Convert(input, inputFrames, output->extended_data, capacity);
+        if (!converted.has_value()) {
+            av_frame_unref(output);
+            return false;
+        }
+
+        // planes stay where they are; only the sample count shrinks
+        output->nb_samples = (int)converted.value();
+        return true;
+    }
+
+    bool Resampler::Reset() {
+        if (m_Context == nullptr) {
+            return false;
+        }
+
+        swr_close(m_Context);
+
+        m_Initialized = swr_init(m_Context) >= 0;
+        if (!m_Initialized) {
+            SCHMIX_ERROR("Failed to reinitialize resampling context!");
+        }
+
+        return m_Initialized;
+    }
+} // namespace schmix
@@ -0,0 +1,62 @@
+#pragma once
+#include "schmix/encoding/BufferPool.h"
+
+typedef struct SwrContext SwrContext;
+typedef struct AVFrame AVFrame;
+
+namespace schmix {
+    // sample rate, channel layout and sample format conversion in one pass
+    class Resampler {
+    public:
+        enum class Quality : std::int32_t { Fast = 0, Balanced, High };
+
+        struct Format {
+            std::size_t Channels = 0;
+            std::size_t SampleRate = 0;
+
+            // int32 so we dont have to include the header
+            std::int32_t SampleFormat = -1;
+
+            bool operator==(const Format& other) const = default;
+        };
+
+        static std::optional<Quality> ParseQuality(const std::string& name);
+
+        Resampler(const Format& input, const Format& output, Quality quality = Quality::Balanced);
+        ~Resampler();
+
+        Resampler(const Resampler&) = delete;
+        Resampler& operator=(const Resampler&) = delete;
+
+        bool IsInitialized() const { return m_Initialized; }
+
+        const Format& GetInputFormat() const { return m_Input; }
+        const Format& GetOutputFormat() const { return m_Output; }
+        Quality GetQuality() const { return m_Quality; }
+
+        // upper bound on the frames produced by converting the given input plus anything buffered
+        std::size_t GetOutputCapacity(std::size_t inputFrames) const;
+
+        // planes follow libav conventions; packed formats use a single plane
+        // null input drains buffered samples
+        // empty optional means error; otherwise the number of frames written
+        std::optional<std::size_t> Convert(const std::uint8_t* const* input,
+                                           std::size_t inputFrames, std::uint8_t* const* output,
+                                           std::size_t outputCapacity);
+
+        // converts into a blank frame backed by a buffer from the pool
+        // the frame is left with zero samples while the resampler is still filling up
+        bool ConvertFrame(const std::uint8_t* const* input, std::size_t inputFrames,
+                          AVFrame* output, BufferPool& pool);
+
+        // drops buffered samples, e.g. after a seek
+        bool Reset();
+
+    private:
+        Format m_Input, m_Output;
+        Quality m_Quality;
+
+        SwrContext* m_Context;
+        bool m_Initialized;
+    };
+} // namespace schmix
@@ -0,0 +1,105 @@
+#include "schmixpch.h"
+#include "schmix/encoding/SeekIndex.h"
+
+#include <fstream>
+#include <cstring>
+
+namespace schmix {
+    struct SeekIndexHeader {
+        char Magic[8];
+        std::uint32_t Version;
+        std::uint32_t Reserved;
+        std::uint64_t SampleRate;
+        std::uint64_t SourceFingerprint;
+        std::uint64_t PointCount;
+    };
+
+    static constexpr char s_Magic[8] = { 'S', 'C', 'H', 'M', 'I', 'X', 'S', 'I' };
+    static constexpr std::uint32_t s_Version = 2;
+
+    SeekIndex::SeekIndex(std::size_t sampleRate, std::uint64_t sourceFingerprint) {
+        m_SampleRate = sampleRate;
+        m_SourceFingerprint = sourceFingerprint;
+    }
+
+    std::optional<SeekIndex> SeekIndex::Load(const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream.is_open()) {
+            return {};
+        }
+
+        SeekIndexHeader header;
+        stream.read((char*)&header, sizeof(SeekIndexHeader));
+
+        if (!stream || std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0 ||
+            header.Version != s_Version) {
+            SCHMIX_WARN("Ignoring invalid seek index: {}", path.string().c_str());
+            return {};
+        }
+
+        // a corrupt count must not turn into a huge allocation
+        std::error_code error;
+        auto fileSize = std::filesystem::file_size(path, error);
+
+        if (error || fileSize < sizeof(SeekIndexHeader) ||
+            header.PointCount > (fileSize - sizeof(SeekIndexHeader)) / sizeof(Point)) {
+            SCHMIX_WARN("Ignoring truncated seek index: {}", path.string().c_str());
+            return {};
+        }
+
+        SeekIndex index((std::size_t)header.SampleRate, header.SourceFingerprint);
+        index.m_Points.resize((std::size_t)header.PointCount);
+
+        stream.read((char*)index.m_Points.data(),
+                    (std::streamsize)(index.m_Points.size() * sizeof(Point)));
+
+        if (!stream) {
+            SCHMIX_WARN("Ignoring truncated seek index: {}", path.string().c_str());
+            return {};
+        }
+
+        return index;
+    }
+
+    bool SeekIndex::Save(const std::filesystem::path& path) const {
+        // written aside and renamed so that concurrent readers never see half an index
+        auto temporaryPath = path;
+        temporaryPath += ".tmp";
+
+        std::ofstream stream(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            SCHMIX_ERROR("Failed to open seek index for writing: {}", path.string().c_str());
+            return false;
+        }
+
+        SeekIndexHeader header;
+        Memory::Copy(s_Magic, header.Magic, sizeof(s_Magic));
+
+        header.Version = s_Version;
+        header.Reserved = 0;
+        header.SampleRate = m_SampleRate;
+        header.SourceFingerprint = m_SourceFingerprint;
+        header.PointCount = m_Points.size();
+
+        stream.write((const char*)&header, sizeof(SeekIndexHeader));
+        stream.write((const char*)m_Points.data(),
+                     (std::streamsize)(m_Points.size() * sizeof(Point)));
+        stream.close();
+
+        std::error_code error;
+        if (stream) {
+            std::filesystem::rename(temporaryPath, path, error);
+        }
+
+        if (!stream || error) {
+            SCHMIX_ERROR("Failed to write seek index: {}", path.string().c_str());
+
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    void SeekIndex::Add(const Point& point) { m_Points.push_back(point); }
+} // namespace schmix
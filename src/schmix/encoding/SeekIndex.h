@@ -0,0 +1,39 @@
+#pragma once
+
+namespace schmix {
+    // maps sample positions in an audio stream to the packets that hold them
+    // sample positions are in the stream's own sample rate, counted from its start
+    class SeekIndex {
+    public:
+        struct Point {
+            std::int64_t Sample;
+
+            // in stream time base; AV_NOPTS_VALUE when the demuxer gave none
+            std::int64_t Timestamp;
+
+            // byte offset of the packet; negative when unknown
+            std::int64_t Position;
+        };
+
+        // the source fingerprint is used to spot stale indices when loading from disk
+        // see FormatStream::GetSourceFingerprint
+        SeekIndex(std::size_t sampleRate, std::uint64_t sourceFingerprint);
+
+        static std::optional<SeekIndex> Load(const std::filesystem::path& path);
+        bool Save(const std::filesystem::path& path) const;
+
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+        std::uint64_t GetSourceFingerprint() const { return m_SourceFingerprint; }
+
+        const std::vector<Point>& GetPoints() const { return m_Points; }
+
+        // points are expected in increasing sample order
+        void Add(const Point& point);
+
+    private:
+        std::size_t m_SampleRate;
+        std::uint64_t m_SourceFingerprint;
+
+        std::vector<Point> m_Points;
+    };
+} // namespace schmix
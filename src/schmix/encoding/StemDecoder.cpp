@@ -0,0 +1,430 @@
+#include "schmixpch.h"
+#include "schmix/encoding/StemDecoder.h"
+
+#include "schmix/encoding/FFmpeg.h"
+
+namespace schmix {
+    // how far the other stems may demux past a stem's last packet before it counts as ended
+    // muxers interleave streams far tighter than this, so it only caps the read-ahead memory
+    static constexpr double s_MaxInterleave = 10.0;
+
+    // the same for a stem whose stream duration has passed; durations can be estimates, so the
+    // demuxer still has to be a little further along before the stem is given up on
+    static constexpr double s_EndSlack = 1.0;
+
+    StemDecoder::StemDecoder(std::size_t channels, std::size_t sampleRate,
+                             Resampler::Quality quality) {
+        m_Packet = nullptr;
+        m_Frame = nullptr;
+
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+        m_Quality = quality;
+
+        m_DemuxTime = 0.0;
+        m_EOF = false;
+        m_IsOpen = false;
+    }
+
+    StemDecoder::StemDecoder(const IO::Callbacks& callbacks, std::size_t channels,
+                             std::size_t sampleRate, Resampler::Quality quality)
+        : StemDecoder(channels, sampleRate, quality) {
+        m_IsOpen = OpenStreams(callbacks);
+    }
+
+    StemDecoder::StemDecoder(const std::filesystem::path& path, std::size_t channels,
+                             std::size_t sampleRate, Resampler::Quality quality)
+        : StemDecoder(channels, sampleRate, quality) {
+        auto callbacks = IO::OpenFile(path, IO::Mode::Input);
+        if (!callbacks.has_value()) {
+            return;
+        }
+
+        m_IsOpen = OpenStreams(callbacks.value());
+    }
+
+    bool StemDecoder::OpenStreams(const IO::Callbacks& callbacks) {
+        m_Format = std::make_unique<FormatStream>(callbacks, IO::Mode::Input, nullptr);
+        if (!m_Format->IsOpen()) {
+            SCHMIX_ERROR("Failed to open input format!");
+            return false;
+        }
+
+        for (const auto& audioStream : m_Format->GetAudioStreams()) {
+            auto codec = std::make_unique<CodecStream>(callbacks, IO::Mode::Input,
+                                                       audioStream.Parameters, audioStream.Index);
+
+            if (!codec->IsOpen()) {
+                SCHMIX_ERROR("Failed to open decoder for stream {}!", audioStream.Index);
+                return false;
+            }
+
+            m_StreamStems[audioStream.Index] = m_Stems.size();
+
+            auto& stem = m_Stems.emplace_back();
+            stem.StreamIndex = audioStream.Index;
+            stem.Codec = std::move(codec);
+        }
+
+        if (m_SampleRate == 0) {
+            m_SampleRate = m_Format->GetCodecParameters().GetSampleRate();
+        }
+
+        // line every stem up against the one that starts first
+        const auto& audioStreams = m_Format->GetAudioStreams();
+
+        double earliest = audioStreams[0].StartTime;
+        for (const auto& audioStream : audioStreams) {
+            earliest = std::min(earliest, audioStream.StartTime);
+        }
+
+        for (std::size_t i = 0; i < m_Stems.size(); i++) {
+            const auto& audioStream = audioStreams[i];
+            auto& stem = m_Stems[i];
+
+            double delay = audioStream.StartTime - earliest;
+            stem.LeadIn = (std::size_t)std::llround(delay * (double)m_SampleRate);
+
+            stem.TimeBase = audioStream.TimeBase;
+            stem.End = audioStream.Duration >= 0.0 ? audioStream.StartTime + audioStream.Duration
+                                                   : std::numeric_limits<double>::infinity();
+
+            ResetStem(stem);
+        }
+
+        m_DemuxTime = earliest;
+
+        m_Packet = av_packet_alloc();
+        m_Frame = av_frame_alloc();
+
+        if (m_Packet == nullptr || m_Frame == nullptr) {
+            SCHMIX_ERROR("Failed to allocate packet or frame!");
+            return false;
+        }
+
+        return true;
+    }
+
+    StemDecoder::~StemDecoder() {
+        av_frame_free(&m_Frame);
+        av_packet_free(&m_Packet);
+
+        // the codecs may still reference packet data owned by the demuxer
+        m_Stems.clear();
+        m_Format.reset();
+    }
+
+    std::size_t StemDecoder::GetStreamIndex(std::size_t stem) const {
+        return m_Stems[stem].StreamIndex;
+    }
+
+    std::optional<std::size_t> StemDecoder::Read(double* const* stems, std::size_t frames) {
+        auto framesRead = Fill(frames);
+        if (!framesRead.has_value()) {
+            return {};
+        }
+
+        for (std::size_t i = 0; i < m_Stems.size(); i++) {
+            auto& stem = m_Stems[i];
+
+            std::size_t available = std::min(framesRead.value(), GetBufferedFrames(stem));
+            const double* source = stem.Buffered.data() + stem.BufferedOffset;
+
+            Memory::Copy(source, stems[i], available * m_Channels * sizeof(double));
+            std::fill(stems[i] + available * m_Channels,
+                      stems[i] + framesRead.value() * m_Channels, 0.0);
+
+            Consume(stem, available);
+        }
+
+        return framesRead;
+    }
+
+    std::optional<std::size_t> StemDecoder::ReadPlanar(double* const* const* stems,
+                                                       std::size_t frames) {
+        auto framesRead = Fill(frames);
+        if (!framesRead.has_value()) {
+            return {};
+        }
+
+        for (std::size_t i = 0; i < m_Stems.size(); i++) {
+            auto& stem = m_Stems[i];
+
+            std::size_t available = std::min(framesRead.value(), GetBufferedFrames(stem));
+            const double* source = stem.Buffered.data() + stem.BufferedOffset;
+
+            for (std::size_t j = 0; j < m_Channels; j++) {
+                double* plane = stems[i][j];
+                for (std::size_t k = 0; k < available; k++) {
+                    plane[k] = source[k * m_Channels + j];
+                }
+
+                std::fill(plane + available, plane + framesRead.value(), 0.0);
+            }
+
+            Consume(stem, available);
+        }
+
+        return framesRead;
+    }
+
+    std::optional<std::size_t> StemDecoder::Fill(std::size_t frames) {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return {};
+        }
+
+        while (!m_EOF && !IsFilled(frames)) {
+            auto decoded = DecodeNextPacket();
+            if (!decoded.has_value()) {
+                return {};
+            }
+
+            if (!decoded.value()) {
+                if (!Drain()) {
+                    return {};
+                }
+
+                m_EOF = true;
+            } else if (!UpdateEnded()) {
+                return {};
+            }
+        }
+
+        // every stem that has not ended holds the full request; the longest stem decides and
+        // the rest are padded
+        std::size_t framesRead = 0;
+        for (const auto& stem : m_Stems) {
+            framesRead = std::max(framesRead, std::min(frames, GetBufferedFrames(stem)));
+        }
+
+        return framesRead;
+    }
+
+    void StemDecoder::Consume(Stem& stem, std::size_t frames) {
+        stem.BufferedOffset += frames * m_Channels;
+
+        // compact once more has been read than is left, so the buffer stays small
+        if (stem.BufferedOffset * 2 >= stem.Buffered.size()) {
+            stem.Buffered.erase(stem.Buffered.begin(),
+                                stem.Buffered.begin() + (std::ptrdiff_t)stem.BufferedOffset);
+
+            stem.BufferedOffset = 0;
+        }
+    }
+
+    bool StemDecoder::Rewind() {
+        if (!m_IsOpen) {
+            SCHMIX_ERROR("Decoder is not open!");
+            return false;
+        }
+
+        if (!m_Format->Rewind()) {
+            return false;
+        }
+
+        double earliest = std::numeric_limits<double>::infinity();
+        for (const auto& audioStream : m_Format->GetAudioStreams()) {
+            earliest = std::min(earliest, audioStream.StartTime);
+        }
+
+        for (auto& stem : m_Stems) {
+            stem.Codec->Reset();
+
+            // the filter history belongs to the old position
+            if (stem.Conversion && !stem.Conversion->Reset()) {
+                return false;
+            }
+
+            ResetStem(stem);
+        }
+
+        av_frame_unref(m_Frame);
+
+        m_DemuxTime = earliest;
+        m_EOF = false;
+
+        return true;
+    }
+
+    bool StemDecoder::IsFilled(std::size_t frames) const {
+        for (const auto& stem : m_Stems) {
+            if (!stem.Ended && GetBufferedFrames(stem) < frames) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool StemDecoder::UpdateEnded() {
+        for (auto& stem : m_Stems) {
+            if (stem.Ended) {
+                continue;
+            }
+
+            bool pastDuration = m_DemuxTime - stem.End > s_EndSlack;
+            bool leftBehind = m_DemuxTime - stem.LastPacketEnd > s_MaxInterleave;
+
+            if ((pastDuration || leftBehind) && !EndStem(stem)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool StemDecoder::EndStem(Stem& stem) {
+        // whatever the decoder and resampler still hold belongs before the padding
+        if (!stem.Codec->SendPacket(nullptr) || !ReceiveFrames(stem) ||
+            !Convert(stem, nullptr, 0)) {
+            return false;
+        }
+
+        stem.Ended = true;
+        return true;
+    }
+
+    std::optional<bool> StemDecoder::DecodeNextPacket() {
+        auto read = m_Format->ReadAnyPacket(m_Packet);
+        if (!read.has_value()) {
+            return {};
+        }
+
+        if (!read.value()) {
+            return false;
+        }
+
+        auto it = m_StreamStems.find((std::size_t)m_Packet->stream_index);
+        if (it == m_StreamStems.end()) {
+            av_packet_unref(m_Packet);
+            return true;
+        }
+
+        auto& stem = m_Stems[it->second];
+        if (stem.Ended) {
+            SCHMIX_WARN("Dropping a late packet for stream {}, which has already ended",
+                        stem.StreamIndex);
+
+            av_packet_unref(m_Packet);
+            return true;
+        }
+
+        // durations are missing from some packets; the start still moves the demuxer along
+        std::int64_t timestamp = m_Packet->pts != AV_NOPTS_VALUE ? m_Packet->pts : m_Packet->dts;
+        if (timestamp != AV_NOPTS_VALUE) {
+            double packetEnd =
+                (double)(timestamp + std::max<std::int64_t>(m_Packet->duration, 0)) *
+                stem.TimeBase;
+
+            stem.LastPacketEnd = std::max(stem.LastPacketEnd, packetEnd);
+            m_DemuxTime = std::max(m_DemuxTime, packetEnd);
+        }
+
+        bool sent = stem.Codec->SendPacket(m_Packet);
+        av_packet_unref(m_Packet);
+
+        if (!sent || !ReceiveFrames(stem)) {
+            return {};
+        }
+
+        return true;
+    }
+
+    bool StemDecoder::ReceiveFrames(Stem& stem) {
+        while (true) {
+            av_frame_unref(m_Frame);
+
+            auto received = stem.Codec->ReceiveFrame(m_Frame);
+            if (!received.has_value()) {
+                return false;
+            }
+
+            if (!received.value()) {
+                return true;
+            }
+
+            if (!Convert(stem, m_Frame->extended_data, (std::size_t)m_Frame->nb_samples)) {
+                return false;
+            }
+        }
+    }
+
+    bool StemDecoder::Convert(Stem& stem, const std::uint8_t* const* input, std::size_t frames) {
+        if (input != nullptr) {
+            Resampler::Format inputFormat;
+            inputFormat.Channels = (std::size_t)m_Frame->ch_layout.nb_channels;
+            inputFormat.SampleRate = (std::size_t)m_Frame->sample_rate;
+            inputFormat.SampleFormat = m_Frame->format;
+
+            if (!stem.Conversion || stem.Conversion->GetInputFormat() != inputFormat) {
+                if (stem.Conversion) {
+                    // samples still buffered under the old format are lost
+                    SCHMIX_WARN("Stream {} changed format mid-file - restarting conversion",
+                                stem.StreamIndex);
+                }
+
+                Resampler::Format outputFormat;
+                outputFormat.Channels = m_Channels;
+                outputFormat.SampleRate = m_SampleRate;
+                outputFormat.SampleFormat = AV_SAMPLE_FMT_DBL;
+
+                stem.Conversion = std::make_unique<Resampler>(inputFormat, outputFormat, m_Quality);
+                if (!stem.Conversion->IsInitialized()) {
+                    stem.Conversion.reset();
+                    return false;
+                }
+            }
+        } else if (!stem.Conversion) {
+            // nothing was ever decoded, so there is nothing to drain
+            return true;
+        }
+
+        while (true) {
+            std::size_t capacity = stem.Conversion->GetOutputCapacity(frames);
+            if (capacity == 0) {
+                return true;
+            }
+
+            std::size_t end = stem.Buffered.size();
+            stem.Buffered.resize(end + capacity * m_Channels);
+
+            auto output = (std::uint8_t*)(stem.Buffered.data() + end);
+            auto converted = stem.Conversion->Convert(input, frames, &output, capacity);
+
+            if (!converted.has_value()) {
+                return false;
+            }
+
+            stem.Buffered.resize(end + converted.value() * m_Channels);
+
+            // input is consumed in one call; only draining needs to loop
+            if (input != nullptr || converted.value() == 0) {
+                return true;
+            }
+        }
+    }
+
+    bool StemDecoder::Drain() {
+        for (auto& stem : m_Stems) {
+            if (!stem.Ended && !EndStem(stem)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::size_t StemDecoder::GetBufferedFrames(const Stem& stem) const {
+        return (stem.Buffered.size() - stem.BufferedOffset) / m_Channels;
+    }
+
+    void StemDecoder::ResetStem(Stem& stem) {
+        stem.Buffered.assign(stem.LeadIn * m_Channels, 0.0);
+        stem.BufferedOffset = 0;
+
+        const auto& audioStreams = m_Format->GetAudioStreams();
+        stem.LastPacketEnd = audioStreams[m_StreamStems.at(stem.StreamIndex)].StartTime;
+        stem.Ended = false;
+    }
+} // namespace schmix
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "schmix/encoding/FormatStream.h"
+#include "schmix/encoding/CodecStream.h"
+#include "schmix/encoding/Resampler.h"
+
+namespace schmix {
+    // decodes every audio stream of a multitrack file in a single demux pass
+    // packets are routed to one decoder per stream, and every stem is converted to the same
+    // channel count and rate so that they line up frame for frame
+    // stems starting later on the container's timeline are delayed with leading silence
+    // a stem that runs out early is padded with silence once it has ended: when its stream's
+    // duration has passed, or when the other stems have demuxed well past its last packet
+    class StemDecoder {
+    public:
+        StemDecoder(const IO::Callbacks& callbacks, std::size_t channels,
+                    std::size_t sampleRate = 0,
+                    Resampler::Quality quality = Resampler::Quality::Balanced);
+
+        StemDecoder(const std::filesystem::path& path, std::size_t channels,
+                    std::size_t sampleRate = 0,
+                    Resampler::Quality quality = Resampler::Quality::Balanced);
+
+        ~StemDecoder();
+
+        StemDecoder(const StemDecoder&) = delete;
+        StemDecoder& operator=(const StemDecoder&) = delete;
+
+        bool IsOpen() const { return m_IsOpen; }
+
+        std::size_t GetStemCount() const { return m_Stems.size(); }
+        std::size_t GetChannels() const { return m_Channels; }
+
+        // a rate of 0 resolves to the first stream's rate
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+
+        // the container's index for the stream behind the given stem
+        std::size_t GetStreamIndex(std::size_t stem) const;
+
+        // reads up to the requested number of interleaved frames into one buffer per stem
+        // empty optional means error; fewer frames than requested means eof
+        std::optional<std::size_t> Read(double* const* stems, std::size_t frames);
+
+        // same, but into one buffer per channel of each stem
+        std::optional<std::size_t> ReadPlanar(double* const* const* stems, std::size_t frames);
+
+        bool Rewind();
+
+    private:
+        struct Stem {
+            std::size_t StreamIndex;
+
+            std::unique_ptr<CodecStream> Codec;
+            std::unique_ptr<Resampler> Conversion;
+
+            // silence ahead of the first decoded sample, in output frames
+            std::size_t LeadIn = 0;
+
+            // container timeline, in seconds; the end is infinite when unknown
+            double TimeBase = 0.0;
+            double End = 0.0;
+            double LastPacketEnd = 0.0;
+
+            // drained; the stem is padded from here on
+            bool Ended = false;
+
+            // converted samples waiting to be read, starting at the offset
+            std::vector<double> Buffered;
+            std::size_t BufferedOffset = 0;
+        };
+
+        StemDecoder(std::size_t channels, std::size_t sampleRate, Resampler::Quality quality);
+
+        bool OpenStreams(const IO::Callbacks& callbacks);
+
+        // decodes until every stem either holds the given number of frames or has ended
+        // returns how many frames a read can hand out
+        std::optional<std::size_t> Fill(std::size_t frames);
+
+        // drops frames handed out by a read
+        void Consume(Stem& stem, std::size_t frames);
+
+        bool IsFilled(std::size_t frames) const;
+
+        // ends the stems the demuxer has moved past
+        bool UpdateEnded();
+        bool EndStem(Stem& stem);
+
+        // demuxes one packet and decodes it into its stem; false means eof
+        std::optional<bool> DecodeNextPacket();
+
+        bool ReceiveFrames(Stem& stem);
+        bool Convert(Stem& stem, const std::uint8_t* const* input, std::size_t frames);
+
+        // empties every decoder and resampler that has not ended yet, once the demuxer runs dry
+        bool Drain();
+
+        std::size_t GetBufferedFrames(const Stem& stem) const;
+
+        // clears a stem back to its lead-in silence and start time
+        void ResetStem(Stem& stem);
+
+        std::unique_ptr<FormatStream> m_Format;
+        std::vector<Stem> m_Stems;
+
+        // container stream index to stem
+        std::unordered_map<std::size_t, std::size_t> m_StreamStems;
+
+        AVPacket* m_Packet;
+        AVFrame* m_Frame;
+
+        std::size_t m_Channels, m_SampleRate;
+        Resampler::Quality m_Quality;
+
+        // furthest packet end demuxed so far, in seconds
+        double m_DemuxTime;
+
+        bool m_EOF;
+        bool m_IsOpen;
+    };
+} // namespace schmix
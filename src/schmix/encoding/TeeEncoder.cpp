@@ -0,0 +1,281 @@
+#include "schmixpch.h"
+#include "schmix/encoding/TeeEncoder.h"
+
+#include "schmix/encoding/FileEncoder.h"
+
+namespace schmix {
+    TeeEncoder::TeeEncoder(std::size_t channels, std::size_t sampleRate,
+                           const Options& options) {
+        m_Channels = channels;
+        m_SampleRate = sampleRate;
+        m_Options = options;
+
+        m_Current = nullptr;
+
+        m_Cancelled = false;
+        m_FailedOutputs = 0;
+
+        m_Started = false;
+        m_Finished = false;
+    }
+
+    TeeEncoder::~TeeEncoder() {
+        if (m_Started && !m_Finished) {
+            Finish();
+        }
+
+        // each codec writes into its muxer
+        for (auto& output : m_Outputs) {
+            output->Codec.reset();
+            output->Format.reset();
+            output->Writer.reset();
+        }
+    }
+
+    bool TeeEncoder::AddFile(const std::filesystem::path& path) {
+        auto container = PCM::GuessContainer(path);
+        if (container.has_value()) {
+            PCM::Format format;
+            format.Channels = m_Channels;
+            format.SampleRate = m_SampleRate;
+            format.SampleEncoding = m_Options.SampleEncoding;
+
+            auto output = std::make_unique<Output>();
+            output->Writer = std::make_unique<PCM::Writer>(path, container.value(), format);
+
+            if (!output->Writer->IsOpen()) {
+                return false;
+            }
+
+            return AddOutput(std::move(output));
+        }
+
+        auto streams = FileEncoder::Open(path, m_Channels, m_SampleRate, m_Options.ThreadCount);
+        if (!streams.has_value()) {
+            return false;
+        }
+
+        return AddOutput(std::move(streams->Codec), std::move(streams->Format));
+    }
+
+    bool TeeEncoder::AddOutput(std::unique_ptr<CodecStream> codec,
+                               std::unique_ptr<FormatStream> format) {
+        if (!codec || !codec->IsOpen()) {
+            SCHMIX_ERROR("Tee output needs an open encoder!");
+            return false;
+        }
+
+        if (!FileEncoder::Connect(*codec, format.get(), m_Channels, m_SampleRate,
+                                  m_Options.Quality)) {
+            return false;
+        }
+
+        auto output = std::make_unique<Output>();
+        output->Codec = std::move(codec);
+        output->Format = std::move(format);
+
+        return AddOutput(std::move(output));
+    }
+
+    bool TeeEncoder::AddOutput(std::unique_ptr<Output> output) {
+        if (m_Started) {
+            SCHMIX_ERROR("Cannot add an output once writing has started!");
+            return false;
+        }
+
+        output->Planes.resize(m_Channels);
+        output->Failed = false;
+
+        m_Outputs.push_back(std::move(output));
+        return true;
+    }
+
+    void TeeEncoder::Start() {
+        m_Started = true;
+
+        // everything the producer will ever touch is allocated up front
+        m_Blocks.resize(m_Options.BlockCount);
+        for (auto& block : m_Blocks) {
+            block = std::make_unique<Block>();
+            block->Samples.resize(m_Options.BlockFrames * m_Channels);
+            block->References = 0;
+
+            m_FreeBlocks.push_back(block.get());
+        }
+
+        for (auto& output : m_Outputs) {
+            // room for every block plus the end marker, so pushing never waits
+            output->Queue =
+                std::make_unique<StageQueue<Block*>>(m_Options.BlockCount + 1, m_Cancelled);
+
+            auto target = output.get();
+            output->Thread = std::thread([this, target]() { Work(*target); });
+        }
+    }
+
+    bool TeeEncoder::Write(const double* const* channels, std::size_t frames) {
+        if (m_Finished) {
+            SCHMIX_ERROR("Encoder has already finished!");
+            return false;
+        }
+
+        if (m_Outputs.empty() || m_Options.BlockFrames == 0 || m_Options.BlockCount == 0) {
+            SCHMIX_ERROR("Nothing to encode into!");
+            return false;
+        }
+
+        if (!m_Started) {
+            Start();
+        }
+
+        std::size_t blockFrames = m_Options.BlockFrames;
+        for (std::size_t offset = 0; offset < frames;) {
+            if (m_Current == nullptr) {
+                m_Current = AcquireBlock();
+            }
+
+            std::size_t toCopy = std::min(frames - offset, blockFrames - m_Current->Frames);
+            for (std::size_t i = 0; i < m_Channels; i++) {
+                double* destination = m_Current->Samples.data() + i * blockFrames;
+                Memory::Copy(channels[i] + offset, destination + m_Current->Frames,
+                             toCopy * sizeof(double));
+            }
+
+            m_Current->Frames += toCopy;
+            offset += toCopy;
+
+            if (m_Current->Frames == blockFrames) {
+                Submit(m_Current);
+                m_Current = nullptr;
+            }
+        }
+
+        return m_FailedOutputs < m_Outputs.size();
+    }
+
+    bool TeeEncoder::Finish() {
+        if (m_Finished) {
+            return m_FailedOutputs == 0;
+        }
+
+        m_Finished = true;
+        if (!m_Started) {
+            // nothing was written, but every output still gets a valid, empty file
+            Start();
+        }
+
+        if (m_Current != nullptr) {
+            Submit(m_Current);
+            m_Current = nullptr;
+        }
+
+        for (auto& output : m_Outputs) {
+            output->Queue->Push(nullptr);
+        }
+
+        bool success = true;
+        for (std::size_t i = 0; i < m_Outputs.size(); i++) {
+            auto& output = *m_Outputs[i];
+            output.Thread.join();
+
+            // nothing else touches the streams now
+            if (!output.Failed) {
+                bool finished;
+                if (output.Writer) {
+                    finished = output.Writer->Close();
+                } else {
+                    finished = output.Codec->Flush();
+                    if (output.Format) {
+                        finished &= output.Format->Finish();
+                    }
+                }
+
+                if (!finished) {
+                    output.Failed = true;
+                    m_FailedOutputs++;
+                }
+            }
+
+            if (output.Failed) {
+                SCHMIX_ERROR("Output {} failed to encode", i);
+                success = false;
+            }
+        }
+
+        return success;
+    }
+
+    bool TeeEncoder::HasFailed(std::size_t output) const {
+        if (output >= m_Outputs.size()) {
+            return true;
+        }
+
+        return m_Outputs[output]->Failed;
+    }
+
+    TeeEncoder::Block* TeeEncoder::AcquireBlock() {
+        std::unique_lock lock(m_Mutex);
+        m_FreeCondition.wait(lock, [this]() { return !m_FreeBlocks.empty(); });
+
+        auto block = m_FreeBlocks.back();
+        m_FreeBlocks.pop_back();
+
+        return block;
+    }
+
+    void TeeEncoder::Submit(Block* block) {
+        // set before any output can see the block
+        block->References.store(m_Outputs.size(), std::memory_order_relaxed);
+
+        for (auto& output : m_Outputs) {
+            output->Queue->Push(block);
+        }
+    }
+
+    void TeeEncoder::Release(Block* block) {
+        if (block->References.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+
+        {
+            std::lock_guard lock(m_Mutex);
+
+            block->Frames = 0;
+            m_FreeBlocks.push_back(block);
+        }
+
+        m_FreeCondition.notify_one();
+    }
+
+    void TeeEncoder::Work(Output& output) {
+        while (true) {
+            auto popped = output.Queue->Pop();
+            if (!popped.has_value() || popped.value() == nullptr) {
+                break;
+            }
+
+            Block* block = popped.value();
+
+            // a failed output keeps releasing blocks so that it never holds the others up
+            if (!output.Failed) {
+                for (std::size_t i = 0; i < m_Channels; i++) {
+                    output.Planes[i] = block->Samples.data() + i * m_Options.BlockFrames;
+                }
+
+                auto planes = output.Planes.data();
+                bool written = output.Writer
+                                   ? output.Writer->WritePlanar(planes, block->Frames)
+                                   : output.Codec->WriteSignal(planes, m_Channels, block->Frames);
+
+                if (!written) {
+                    SCHMIX_ERROR("Tee output failed to encode - dropping the rest of its stream");
+
+                    output.Failed = true;
+                    m_FailedOutputs++;
+                }
+            }
+
+            Release(block);
+        }
+    }
+} // namespace schmix
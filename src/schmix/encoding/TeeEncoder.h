@@ -0,0 +1,119 @@
+#pragma once
+
+#include "schmix/core/StageQueue.h"
+
+#include "schmix/encoding/CodecStream.h"
+#include "schmix/encoding/FormatStream.h"
+#include "schmix/encoding/PCM.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace schmix {
+    // encodes one stream of samples into several outputs at once, each on a thread of its own
+    // a write is copied into a block once and every output reads that same block, which goes
+    // back to the pool when the last of them is done with it; the slowest output sets the pace
+    class TeeEncoder {
+    public:
+        struct Options {
+            std::size_t BlockFrames = 4096;
+            std::size_t BlockCount = 64;
+
+            // per output; see CodecStream::Options
+            std::size_t ThreadCount = 1;
+
+            Resampler::Quality Quality = Resampler::Quality::Balanced;
+
+            // wav and raw files; the same samples libavformat's wav muxer would write
+            PCM::Encoding SampleEncoding = PCM::Encoding::S16;
+        };
+
+        TeeEncoder(std::size_t channels, std::size_t sampleRate, const Options& options);
+        ~TeeEncoder();
+
+        TeeEncoder(const TeeEncoder&) = delete;
+        TeeEncoder& operator=(const TeeEncoder&) = delete;
+
+        std::size_t GetChannels() const { return m_Channels; }
+        std::size_t GetSampleRate() const { return m_SampleRate; }
+
+        // outputs can only be added before the first write
+        // picks the container and codec from the file name; wav and raw files skip libavcodec
+        // and go straight to disk through PCM::Writer
+        bool AddFile(const std::filesystem::path& path);
+
+        // without a format stream, packets go wherever the codec stream sends them
+        bool AddOutput(std::unique_ptr<CodecStream> codec, std::unique_ptr<FormatStream> format);
+
+        std::size_t GetOutputCount() const { return m_Outputs.size(); }
+
+        // any number of frames, one buffer per channel; waits while every block is in use
+        // false once every output has failed
+        bool Write(const double* const* channels, std::size_t frames);
+
+        // queues the last partial block, waits for every output, then drains each encoder and
+        // writes its trailer; done on destruction if not called before
+        // false if any output failed, though the others are still finished
+        bool Finish();
+
+        bool HasFailed(std::size_t output) const;
+
+    private:
+        struct Block {
+            // one run of BlockFrames samples per channel
+            std::vector<double> Samples;
+            std::size_t Frames = 0;
+
+            // outputs yet to encode the block
+            std::atomic<std::size_t> References;
+        };
+
+        // either a codec, with or without a muxer, or a pcm writer
+        struct Output {
+            std::unique_ptr<CodecStream> Codec;
+            std::unique_ptr<FormatStream> Format;
+            std::unique_ptr<PCM::Writer> Writer;
+
+            // a null block marks the end of the stream
+            std::unique_ptr<StageQueue<Block*>> Queue;
+            std::thread Thread;
+
+            // worker only
+            std::vector<const double*> Planes;
+
+            std::atomic<bool> Failed;
+        };
+
+        bool AddOutput(std::unique_ptr<Output> output);
+
+        void Start();
+
+        Block* AcquireBlock();
+        void Submit(Block* block);
+        void Release(Block* block);
+
+        void Work(Output& output);
+
+        std::size_t m_Channels, m_SampleRate;
+        Options m_Options;
+
+        std::vector<std::unique_ptr<Output>> m_Outputs;
+
+        std::vector<std::unique_ptr<Block>> m_Blocks;
+        std::vector<Block*> m_FreeBlocks;
+
+        // owned by the producer until it fills up
+        Block* m_Current;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_FreeCondition;
+
+        // never set; the queues always run to their end marker
+        std::atomic<bool> m_Cancelled;
+
+        std::atomic<std::size_t> m_FailedOutputs;
+
+        bool m_Started, m_Finished;
+    };
+} // namespace schmix
@@ -1,12 +1,22 @@
 #include "schmixpch.h"
 #include "schmix/script/Bindings.h"
 
+#include "schmix/script/Plugin.h"
+
 #include "schmix/core/Ref.h"
 
 #include "schmix/audio/AudioDevice.h"
+#include "schmix/audio/SampleStream.h"
+#include "schmix/audio/Recorder.h"
+#include "schmix/audio/CaptureBuffer.h"
 
 #include "schmix/encoding/FormatStream.h"
 #include "schmix/encoding/CodecStream.h"
+#include "schmix/encoding/AudioDecoder.h"
+#include "schmix/encoding/AsyncEncoder.h"
+#include "schmix/encoding/TeeEncoder.h"
+#include "schmix/encoding/Probe.h"
+#include "schmix/encoding/StemDecoder.h"
 
 #include "schmix/ui/Application.h"
 #include "schmix/ui/ImGuiInstance.h"
@@ -32,9 +42,34 @@ namespace schmix {
         g_Logger->log(loc, level, msg.Data());
     }
 
+    static void GarbageCollector_ReportCycle_Impl(std::int32_t gen0, std::int32_t gen1,
+                                                  std::int32_t gen2, std::int64_t pauseTicks,
+                                                  Coral::Bool32 regionHeld) {
+        GCCycleStatistics cycle;
+        cycle.Collections[0] = (std::uint32_t)gen0;
+        cycle.Collections[1] = (std::uint32_t)gen1;
+        cycle.Collections[2] = (std::uint32_t)gen2;
+
+        // TimeSpan ticks are 100 ns
+        cycle.Pause = std::chrono::nanoseconds(pauseTicks * 100);
+        cycle.NoGCRegionHeld = regionHeld;
+
+        auto& app = Application::Get();
+        app.GetRuntime()->ReportGCCycle(cycle);
+    }
+
     static void* MemoryAllocator_Allocate_Impl(std::size_t size) { return Memory::Allocate(size); }
     static void MemoryAllocator_Free_Impl(void* block) { Memory::Free(block); }
 
+    static std::int32_t Plugin_LoadAssembly_Impl(Coral::String path) {
+        return Plugin::LoadAssembly(path.Data());
+    }
+
+    static void Plugin_RecordPlugin_Impl(std::int32_t assemblyID, Coral::String name,
+                                         Coral::String typeName) {
+        Plugin::RecordPlugin(assemblyID, name.Data(), typeName.Data());
+    }
+
     static std::uint32_t AudioDevice_GetDummy_Impl() { return AudioDevice::GetDummyID(); }
 
     static std::uint32_t AudioDevice_GetDefaultInput_Impl() {
@@ -152,6 +187,118 @@ namespace schmix {
 
     static Coral::Bool32 AudioDevice_Flush_Impl(AudioDevice* device) { return device->Flush(); }
 
+    static SampleStream* SampleStream_ctor_Impl(Coral::String path, std::int32_t channels,
+                                                std::int32_t sampleRate) {
+        auto stream = new SampleStream(path.Data(), channels, sampleRate);
+        if (!stream->IsInitialized()) {
+            delete stream;
+            stream = nullptr;
+        }
+
+        return stream;
+    }
+
+    static void SampleStream_Trigger_Impl(SampleStream* stream) { stream->Trigger(); }
+    static void SampleStream_Stop_Impl(SampleStream* stream) { stream->Stop(); }
+
+    static std::int32_t SampleStream_Read_Impl(SampleStream* stream, double* const* channels,
+                                               std::int32_t frames, Coral::Bool32 wait) {
+        return (std::int32_t)stream->Read(channels, (std::size_t)frames, wait);
+    }
+
+    static SampleStream::State SampleStream_WaitUntilLoaded_Impl(SampleStream* stream) {
+        return stream->WaitUntilLoaded();
+    }
+
+    static SampleStream::State SampleStream_GetState_Impl(SampleStream* stream) {
+        return stream->GetState();
+    }
+
+    static Coral::Bool32 SampleStream_IsPlaying_Impl(SampleStream* stream) {
+        return stream->IsPlaying();
+    }
+
+    static std::int32_t SampleStream_GetUnderruns_Impl(SampleStream* stream) {
+        return (std::int32_t)stream->GetUnderruns();
+    }
+
+    static Recorder* Recorder_ctor_Impl(Coral::String path, std::int32_t channels,
+                                        std::int32_t sampleRate, std::int32_t ringFrames) {
+        auto recorder = new Recorder(path.Data(), (std::size_t)channels, (std::size_t)sampleRate,
+                                     (std::size_t)ringFrames);
+
+        if (!recorder->IsInitialized()) {
+            delete recorder;
+            recorder = nullptr;
+        }
+
+        return recorder;
+    }
+
+    static Coral::Bool32 Recorder_Write_Impl(Recorder* recorder, const double* const* channels,
+                                             std::int32_t frames, Coral::Bool32 wait) {
+        return recorder->Write(channels, (std::size_t)frames, wait);
+    }
+
+    static Coral::Bool32 Recorder_Stop_Impl(Recorder* recorder) { return recorder->Stop(); }
+
+    static Coral::Bool32 Recorder_IsRecording_Impl(Recorder* recorder) {
+        return recorder->IsRecording();
+    }
+
+    static Coral::Bool32 Recorder_HasFailed_Impl(Recorder* recorder) {
+        return recorder->HasFailed();
+    }
+
+    static std::int64_t Recorder_GetRecordedFrames_Impl(Recorder* recorder) {
+        return (std::int64_t)recorder->GetRecordedFrames();
+    }
+
+    static std::int64_t Recorder_GetOverflows_Impl(Recorder* recorder) {
+        return (std::int64_t)recorder->GetOverflows();
+    }
+
+    static std::int64_t Recorder_GetDroppedFrames_Impl(Recorder* recorder) {
+        return (std::int64_t)recorder->GetDroppedFrames();
+    }
+
+    static CaptureBuffer* CaptureBuffer_ctor_Impl(std::int32_t channels, std::int32_t sampleRate,
+                                                  double duration) {
+        auto buffer = new CaptureBuffer((std::size_t)channels, (std::size_t)sampleRate, duration);
+        if (!buffer->IsInitialized()) {
+            delete buffer;
+            buffer = nullptr;
+        }
+
+        return buffer;
+    }
+
+    static void CaptureBuffer_Write_Impl(CaptureBuffer* buffer, const double* const* channels,
+                                         std::int32_t frames) {
+        buffer->Write(channels, (std::size_t)frames);
+    }
+
+    static Coral::Bool32 CaptureBuffer_Save_Impl(CaptureBuffer* buffer, Coral::String path,
+                                                 double seconds) {
+        return buffer->Save(path.Data(), seconds);
+    }
+
+    static CaptureBuffer::SaveState CaptureBuffer_GetSaveState_Impl(CaptureBuffer* buffer) {
+        return buffer->GetSaveState();
+    }
+
+    static double CaptureBuffer_GetCapturedDuration_Impl(CaptureBuffer* buffer) {
+        return buffer->GetCapturedDuration();
+    }
+
+    static double CaptureBuffer_GetDuration_Impl(CaptureBuffer* buffer) {
+        return buffer->GetDuration();
+    }
+
+    static std::int64_t CaptureBuffer_GetMemoryUsage_Impl(CaptureBuffer* buffer) {
+        return (std::int64_t)buffer->GetMemoryUsage();
+    }
+
     static Coral::Bool32 Application_IsRunning_Impl() {
         auto& app = Application::Get();
         return app.IsRunning();
@@ -231,9 +378,33 @@ namespace schmix {
         return FormatStream::GuessOutputFormat(path.Data());
     }
 
-    static FormatStream* FormatStream_ctor_Impl(const ManagedStreamCallbacks* srcCallbacks,
-                                                IO::Mode mode, const AVOutputFormat* outputFormat) {
-        auto callbacks = FromManagedCallbacks(srcCallbacks);
+    static IO::Callbacks* NativeIO_OpenFile_Impl(Coral::String path, IO::Mode mode,
+                                                 std::int32_t bufferSize) {
+        auto callbacks = IO::OpenFile(path.Data(), mode, (std::size_t)std::max(bufferSize, 0));
+        if (!callbacks.has_value()) {
+            return nullptr;
+        }
+
+        return new IO::Callbacks(std::move(callbacks.value()));
+    }
+
+    static IO::Callbacks* NativeIO_MapFile_Impl(Coral::String path) {
+        auto callbacks = IO::MapFile(path.Data());
+        if (!callbacks.has_value()) {
+            return nullptr;
+        }
+
+        return new IO::Callbacks(std::move(callbacks.value()));
+    }
+
+    static IO::Callbacks* NativeIO_OpenMemory_Impl(const void* data, std::int32_t size) {
+        return new IO::Callbacks(IO::OpenMemory(data, (std::size_t)size));
+    }
+
+    static void NativeIO_Close_Impl(IO::Callbacks* callbacks) { delete callbacks; }
+
+    static FormatStream* OpenFormatStream(const IO::Callbacks& callbacks, IO::Mode mode,
+                                          const AVOutputFormat* outputFormat) {
         auto stream = new FormatStream(callbacks, mode, outputFormat);
 
         if (!stream->IsOpen()) {
@@ -246,6 +417,18 @@ namespace schmix {
         return stream;
     }
 
+    static FormatStream* FormatStream_ctor_Impl(const ManagedStreamCallbacks* srcCallbacks,
+                                                IO::Mode mode, const AVOutputFormat* outputFormat) {
+        return OpenFormatStream(FromManagedCallbacks(srcCallbacks), mode, outputFormat);
+    }
+
+    // no managed code runs per buffer
+    static FormatStream* FormatStream_ctorNative_Impl(const IO::Callbacks* callbacks,
+                                                      IO::Mode mode,
+                                                      const AVOutputFormat* outputFormat) {
+        return OpenFormatStream(*callbacks, mode, outputFormat);
+    }
+
     static void FormatStream_Close_Impl(FormatStream* stream) { delete stream; }
 
     static IO::Mode FormatStream_GetMode_Impl(FormatStream* stream) { return stream->GetMode(); }
@@ -276,10 +459,9 @@ namespace schmix {
 
     static Coral::Bool32 FormatStream_Flush_Impl(FormatStream* stream) { return stream->Flush(); }
 
-    static CodecStream* CodecStream_ctor_Impl(const ManagedStreamCallbacks* srcCallbacks,
-                                              IO::Mode mode, const CodecParameters* parameters,
-                                              std::int32_t streamIndex) {
-        auto callbacks = FromManagedCallbacks(srcCallbacks);
+    static CodecStream* OpenCodecStream(const IO::Callbacks& callbacks, IO::Mode mode,
+                                        const CodecParameters* parameters,
+                                        std::int32_t streamIndex) {
         auto stream = new CodecStream(callbacks, mode, *parameters, streamIndex);
 
         if (!stream->IsOpen()) {
@@ -292,6 +474,19 @@ namespace schmix {
         return stream;
     }
 
+    static CodecStream* CodecStream_ctor_Impl(const ManagedStreamCallbacks* srcCallbacks,
+                                              IO::Mode mode, const CodecParameters* parameters,
+                                              std::int32_t streamIndex) {
+        return OpenCodecStream(FromManagedCallbacks(srcCallbacks), mode, parameters, streamIndex);
+    }
+
+    static CodecStream* CodecStream_ctorNative_Impl(const IO::Callbacks* callbacks,
+                                                    IO::Mode mode,
+                                                    const CodecParameters* parameters,
+                                                    std::int32_t streamIndex) {
+        return OpenCodecStream(*callbacks, mode, parameters, streamIndex);
+    }
+
     static void CodecStream_Close_Impl(CodecStream* stream) { delete stream; }
 
     static IO::Mode CodecStream_GetMode_Impl(CodecStream* stream) { return stream->GetMode(); }
@@ -324,8 +519,218 @@ namespace schmix {
         return stream->WriteFrame(data, samples);
     }
 
+    static Coral::Bool32 CodecStream_WriteSignal_Impl(CodecStream* stream,
+                                                      const double* const* channels,
+                                                      std::int32_t channelCount,
+                                                      std::int32_t samples) {
+        return stream->WriteSignal(channels, (std::size_t)channelCount, (std::size_t)samples);
+    }
+
+    // 1 with a frame holding a reference for the caller, 0 at eof, -1 on error
+    static std::int32_t CodecStream_ReadAudioFrame_Impl(CodecStream* stream, AudioFrame** frame) {
+        *frame = nullptr;
+
+        auto result = stream->ReadAudioFrame();
+        if (!result.has_value()) {
+            return -1;
+        }
+
+        if (!result.value()) {
+            return 0;
+        }
+
+        *frame = result.value().Raw();
+        Ref<AudioFrame>::IncreaseRefCount(*frame);
+
+        return 1;
+    }
+
     static Coral::Bool32 CodecStream_Flush_Impl(CodecStream* stream) { return stream->Flush(); }
 
+    static std::int32_t AudioFrame_GetSamples_Impl(AudioFrame* frame) {
+        return (std::int32_t)frame->GetSamples();
+    }
+
+    static std::int32_t AudioFrame_GetChannels_Impl(AudioFrame* frame) {
+        return (std::int32_t)frame->GetChannels();
+    }
+
+    static std::int32_t AudioFrame_GetSampleRate_Impl(AudioFrame* frame) {
+        return (std::int32_t)frame->GetSampleRate();
+    }
+
+    static std::int32_t AudioFrame_GetSampleFormat_Impl(AudioFrame* frame) {
+        return frame->GetAVSampleFormat();
+    }
+
+    static Coral::Bool32 AudioFrame_IsPlanar_Impl(AudioFrame* frame) { return frame->IsPlanar(); }
+
+    static std::int32_t AudioFrame_GetLiveCount_Impl() {
+        return (std::int32_t)AudioFrame::GetLiveCount();
+    }
+
+    static std::int32_t AudioFrame_GetPlaneCount_Impl(AudioFrame* frame) {
+        return (std::int32_t)frame->GetPlaneCount();
+    }
+
+    static const void* AudioFrame_GetPlane_Impl(AudioFrame* frame, std::int32_t index) {
+        return frame->GetPlane((std::size_t)index);
+    }
+
+    static std::int32_t AudioFrame_GetPlaneSize_Impl(AudioFrame* frame) {
+        return (std::int32_t)frame->GetPlaneSize();
+    }
+
+    // planar, so that managed code can decode straight into signal channels
+    static AudioDecoder* AudioDecoder_ctor_Impl(const IO::Callbacks* callbacks,
+                                                std::int32_t channels, std::int32_t sampleRate,
+                                                Resampler::Quality quality) {
+        auto decoder = new AudioDecoder(*callbacks, (std::size_t)channels, (std::size_t)sampleRate,
+                                        quality, AudioDecoder::Layout::Planar);
+
+        if (!decoder->IsOpen()) {
+            delete decoder;
+            decoder = nullptr;
+        }
+
+        return decoder;
+    }
+
+    static void AudioDecoder_Delete_Impl(AudioDecoder* decoder) { delete decoder; }
+
+    static std::int32_t AudioDecoder_Read_Impl(AudioDecoder* decoder, double* const* channels,
+                                               std::int32_t frames) {
+        auto framesRead = decoder->ReadPlanar(channels, (std::size_t)frames);
+        if (!framesRead.has_value()) {
+            return -1;
+        }
+
+        return (std::int32_t)framesRead.value();
+    }
+
+    static Coral::Bool32 AudioDecoder_Rewind_Impl(AudioDecoder* decoder) {
+        return decoder->Rewind();
+    }
+
+    static Coral::Bool32 AudioDecoder_Seek_Impl(AudioDecoder* decoder, std::int64_t frame) {
+        return decoder->Seek((std::size_t)frame);
+    }
+
+    static Coral::Bool32 AudioDecoder_PrepareSeekIndex_Impl(AudioDecoder* decoder,
+                                                            Coral::String path) {
+        return decoder->PrepareSeekIndex(path.Data());
+    }
+
+    static std::int32_t AudioDecoder_GetSampleRate_Impl(AudioDecoder* decoder) {
+        return (std::int32_t)decoder->GetSampleRate();
+    }
+
+    static std::int32_t AudioDecoder_GetSourceSampleRate_Impl(AudioDecoder* decoder) {
+        return (std::int32_t)decoder->GetSourceSampleRate();
+    }
+
+    static StemDecoder* StemDecoder_ctor_Impl(const IO::Callbacks* callbacks,
+                                              std::int32_t channels, std::int32_t sampleRate,
+                                              Resampler::Quality quality) {
+        auto decoder =
+            new StemDecoder(*callbacks, (std::size_t)channels, (std::size_t)sampleRate, quality);
+
+        if (!decoder->IsOpen()) {
+            delete decoder;
+            decoder = nullptr;
+        }
+
+        return decoder;
+    }
+
+    static void StemDecoder_Delete_Impl(StemDecoder* decoder) { delete decoder; }
+
+    static std::int32_t StemDecoder_Read_Impl(StemDecoder* decoder, double* const* const* stems,
+                                              std::int32_t frames) {
+        auto framesRead = decoder->ReadPlanar(stems, (std::size_t)frames);
+        if (!framesRead.has_value()) {
+            return -1;
+        }
+
+        return (std::int32_t)framesRead.value();
+    }
+
+    static Coral::Bool32 StemDecoder_Rewind_Impl(StemDecoder* decoder) {
+        return decoder->Rewind();
+    }
+
+    static std::int32_t StemDecoder_GetStemCount_Impl(StemDecoder* decoder) {
+        return (std::int32_t)decoder->GetStemCount();
+    }
+
+    static std::int32_t StemDecoder_GetSampleRate_Impl(StemDecoder* decoder) {
+        return (std::int32_t)decoder->GetSampleRate();
+    }
+
+    static AsyncEncoder* AsyncEncoder_OpenFile_Impl(Coral::String path, std::int32_t channels,
+                                                    std::int32_t sampleRate) {
+        AsyncEncoder::Options options;
+        auto encoder = AsyncEncoder::OpenFile(path.Data(), (std::size_t)channels,
+                                              (std::size_t)sampleRate, options);
+
+        return encoder.release();
+    }
+
+    static void AsyncEncoder_Delete_Impl(AsyncEncoder* encoder) { delete encoder; }
+
+    static Coral::Bool32 AsyncEncoder_Write_Impl(AsyncEncoder* encoder,
+                                                 const double* const* channels,
+                                                 std::int32_t frames) {
+        return encoder->Write(channels, (std::size_t)frames);
+    }
+
+    static Coral::Bool32 AsyncEncoder_Finish_Impl(AsyncEncoder* encoder) {
+        return encoder->Finish();
+    }
+
+    static TeeEncoder* TeeEncoder_Create_Impl(std::int32_t channels, std::int32_t sampleRate) {
+        TeeEncoder::Options options;
+        return new TeeEncoder((std::size_t)channels, (std::size_t)sampleRate, options);
+    }
+
+    static void TeeEncoder_Delete_Impl(TeeEncoder* encoder) { delete encoder; }
+
+    static Coral::Bool32 TeeEncoder_AddFile_Impl(TeeEncoder* encoder, Coral::String path) {
+        return encoder->AddFile(path.Data());
+    }
+
+    static Coral::Bool32 TeeEncoder_Write_Impl(TeeEncoder* encoder, const double* const* channels,
+                                               std::int32_t frames) {
+        return encoder->Write(channels, (std::size_t)frames);
+    }
+
+    static Coral::Bool32 TeeEncoder_Finish_Impl(TeeEncoder* encoder) {
+        return encoder->Finish();
+    }
+
+    struct ProbeResult {
+        Probe::Codec AudioCodec;
+        std::int32_t SampleRate;
+        std::int32_t Channels;
+
+        // negative when unknown
+        double Duration;
+    };
+
+    static Coral::Bool32 Probe_File_Impl(Coral::String path, ProbeResult* result) {
+        auto info = Probe::File(path.Data());
+        if (!info.has_value()) {
+            return false;
+        }
+
+        result->AudioCodec = info->AudioCodec;
+        result->SampleRate = (std::int32_t)info->SampleRate;
+        result->Channels = (std::int32_t)info->Channels;
+        result->Duration = info->Duration.value_or(-1.0);
+
+        return true;
+    }
+
     void Bindings::Get(std::vector<ScriptBinding>& bindings) {
         bindings.insert(
             bindings.end(),
@@ -335,9 +740,15 @@ namespace schmix {
 
                 { "Schmix.Core.Log", "Print_Impl", (void*)Log_Print_Impl },
 
+                { "Schmix.Core.GarbageCollector", "ReportCycle_Impl",
+                  (void*)GarbageCollector_ReportCycle_Impl },
+
                 { "Schmix.Core.MemoryAllocator", "Allocate_Impl", (void*)MemoryAllocator_Allocate_Impl },
                 { "Schmix.Core.MemoryAllocator", "Free_Impl", (void*)MemoryAllocator_Free_Impl },
 
+                { "Schmix.Extension.Plugin", "LoadAssembly_Impl", (void*)Plugin_LoadAssembly_Impl },
+                { "Schmix.Extension.Plugin", "RecordPlugin_Impl", (void*)Plugin_RecordPlugin_Impl },
+
                 { "Schmix.Audio.AudioDevice", "GetDummy_Impl", (void*)AudioDevice_GetDummy_Impl },
                 { "Schmix.Audio.AudioDevice", "GetDefaultInput_Impl",
                   (void*)AudioDevice_GetDefaultInput_Impl },
@@ -364,6 +775,42 @@ namespace schmix {
                 { "Schmix.Audio.AudioDevice", "PutAudio_Impl", (void*)AudioDevice_PutAudio_Impl },
                 { "Schmix.Audio.AudioDevice", "Flush_Impl", (void*)AudioDevice_Flush_Impl },
 
+                { "Schmix.Audio.SampleStream", "ctor_Impl", (void*)SampleStream_ctor_Impl },
+                { "Schmix.Audio.SampleStream", "Trigger_Impl", (void*)SampleStream_Trigger_Impl },
+                { "Schmix.Audio.SampleStream", "Stop_Impl", (void*)SampleStream_Stop_Impl },
+                { "Schmix.Audio.SampleStream", "Read_Impl", (void*)SampleStream_Read_Impl },
+                { "Schmix.Audio.SampleStream", "WaitUntilLoaded_Impl",
+                  (void*)SampleStream_WaitUntilLoaded_Impl },
+                { "Schmix.Audio.SampleStream", "GetState_Impl",
+                  (void*)SampleStream_GetState_Impl },
+                { "Schmix.Audio.SampleStream", "IsPlaying_Impl",
+                  (void*)SampleStream_IsPlaying_Impl },
+                { "Schmix.Audio.SampleStream", "GetUnderruns_Impl",
+                  (void*)SampleStream_GetUnderruns_Impl },
+
+                { "Schmix.Audio.Recorder", "ctor_Impl", (void*)Recorder_ctor_Impl },
+                { "Schmix.Audio.Recorder", "Write_Impl", (void*)Recorder_Write_Impl },
+                { "Schmix.Audio.Recorder", "Stop_Impl", (void*)Recorder_Stop_Impl },
+                { "Schmix.Audio.Recorder", "IsRecording_Impl", (void*)Recorder_IsRecording_Impl },
+                { "Schmix.Audio.Recorder", "HasFailed_Impl", (void*)Recorder_HasFailed_Impl },
+                { "Schmix.Audio.Recorder", "GetRecordedFrames_Impl",
+                  (void*)Recorder_GetRecordedFrames_Impl },
+                { "Schmix.Audio.Recorder", "GetOverflows_Impl", (void*)Recorder_GetOverflows_Impl },
+                { "Schmix.Audio.Recorder", "GetDroppedFrames_Impl",
+                  (void*)Recorder_GetDroppedFrames_Impl },
+
+                { "Schmix.Audio.CaptureBuffer", "ctor_Impl", (void*)CaptureBuffer_ctor_Impl },
+                { "Schmix.Audio.CaptureBuffer", "Write_Impl", (void*)CaptureBuffer_Write_Impl },
+                { "Schmix.Audio.CaptureBuffer", "Save_Impl", (void*)CaptureBuffer_Save_Impl },
+                { "Schmix.Audio.CaptureBuffer", "GetSaveState_Impl",
+                  (void*)CaptureBuffer_GetSaveState_Impl },
+                { "Schmix.Audio.CaptureBuffer", "GetCapturedDuration_Impl",
+                  (void*)CaptureBuffer_GetCapturedDuration_Impl },
+                { "Schmix.Audio.CaptureBuffer", "GetDuration_Impl",
+                  (void*)CaptureBuffer_GetDuration_Impl },
+                { "Schmix.Audio.CaptureBuffer", "GetMemoryUsage_Impl",
+                  (void*)CaptureBuffer_GetMemoryUsage_Impl },
+
                 { "Schmix.UI.Application", "IsRunning_Impl", (void*)Application_IsRunning_Impl },
                 { "Schmix.UI.Application", "Quit_Impl", (void*)Application_Quit_Impl },
                 { "Schmix.UI.Application", "GetImGuiInstance_Impl",
@@ -381,7 +828,15 @@ namespace schmix {
 
                 { "Schmix.Encoding.FormatStream", "GuessOutputFormat_Impl",
                   (void*)FormatStream_GuessOutputFormat_Impl },
+                { "Schmix.Encoding.NativeIO", "OpenFile_Impl", (void*)NativeIO_OpenFile_Impl },
+                { "Schmix.Encoding.NativeIO", "MapFile_Impl", (void*)NativeIO_MapFile_Impl },
+                { "Schmix.Encoding.NativeIO", "OpenMemory_Impl",
+                  (void*)NativeIO_OpenMemory_Impl },
+                { "Schmix.Encoding.NativeIO", "Close_Impl", (void*)NativeIO_Close_Impl },
+
                 { "Schmix.Encoding.FormatStream", "ctor_Impl", (void*)FormatStream_ctor_Impl },
+                { "Schmix.Encoding.FormatStream", "ctorNative_Impl",
+                  (void*)FormatStream_ctorNative_Impl },
                 { "Schmix.Encoding.FormatStream", "Close_Impl", (void*)FormatStream_Close_Impl },
                 { "Schmix.Encoding.FormatStream", "GetMode_Impl",
                   (void*)FormatStream_GetMode_Impl },
@@ -396,6 +851,8 @@ namespace schmix {
                 { "Schmix.Encoding.FormatStream", "Flush_Impl", (void*)FormatStream_Flush_Impl },
 
                 { "Schmix.Encoding.CodecStream", "ctor_Impl", (void*)CodecStream_ctor_Impl },
+                { "Schmix.Encoding.CodecStream", "ctorNative_Impl",
+                  (void*)CodecStream_ctorNative_Impl },
                 { "Schmix.Encoding.CodecStream", "Close_Impl", (void*)CodecStream_Close_Impl },
                 { "Schmix.Encoding.CodecStream", "GetMode_Impl", (void*)CodecStream_GetMode_Impl },
                 { "Schmix.Encoding.CodecStream", "GetParameters_Impl",
@@ -408,7 +865,63 @@ namespace schmix {
                   (void*)CodecStream_ReadFrame_Impl },
                 { "Schmix.Encoding.CodecStream", "WriteFrame_Impl",
                   (void*)CodecStream_WriteFrame_Impl },
+                { "Schmix.Encoding.CodecStream", "WriteSignal_Impl",
+                  (void*)CodecStream_WriteSignal_Impl },
+                { "Schmix.Encoding.CodecStream", "ReadAudioFrame_Impl",
+                  (void*)CodecStream_ReadAudioFrame_Impl },
                 { "Schmix.Encoding.CodecStream", "Flush_Impl", (void*)CodecStream_Flush_Impl },
+
+                { "Schmix.Encoding.AudioDecoder", "ctor_Impl", (void*)AudioDecoder_ctor_Impl },
+                { "Schmix.Encoding.AudioDecoder", "Delete_Impl", (void*)AudioDecoder_Delete_Impl },
+                { "Schmix.Encoding.AudioDecoder", "Read_Impl", (void*)AudioDecoder_Read_Impl },
+                { "Schmix.Encoding.AudioDecoder", "Rewind_Impl", (void*)AudioDecoder_Rewind_Impl },
+                { "Schmix.Encoding.AudioDecoder", "Seek_Impl", (void*)AudioDecoder_Seek_Impl },
+                { "Schmix.Encoding.AudioDecoder", "PrepareSeekIndex_Impl",
+                  (void*)AudioDecoder_PrepareSeekIndex_Impl },
+                { "Schmix.Encoding.AudioDecoder", "GetSampleRate_Impl",
+                  (void*)AudioDecoder_GetSampleRate_Impl },
+                { "Schmix.Encoding.AudioDecoder", "GetSourceSampleRate_Impl",
+                  (void*)AudioDecoder_GetSourceSampleRate_Impl },
+
+                { "Schmix.Encoding.StemDecoder", "ctor_Impl", (void*)StemDecoder_ctor_Impl },
+                { "Schmix.Encoding.StemDecoder", "Delete_Impl", (void*)StemDecoder_Delete_Impl },
+                { "Schmix.Encoding.StemDecoder", "Read_Impl", (void*)StemDecoder_Read_Impl },
+                { "Schmix.Encoding.StemDecoder", "Rewind_Impl", (void*)StemDecoder_Rewind_Impl },
+                { "Schmix.Encoding.StemDecoder", "GetStemCount_Impl",
+                  (void*)StemDecoder_GetStemCount_Impl },
+                { "Schmix.Encoding.StemDecoder", "GetSampleRate_Impl",
+                  (void*)StemDecoder_GetSampleRate_Impl },
+
+                { "Schmix.Encoding.AsyncEncoder", "OpenFile_Impl",
+                  (void*)AsyncEncoder_OpenFile_Impl },
+                { "Schmix.Encoding.AsyncEncoder", "Delete_Impl", (void*)AsyncEncoder_Delete_Impl },
+                { "Schmix.Encoding.AsyncEncoder", "Write_Impl", (void*)AsyncEncoder_Write_Impl },
+                { "Schmix.Encoding.AsyncEncoder", "Finish_Impl", (void*)AsyncEncoder_Finish_Impl },
+
+                { "Schmix.Encoding.TeeEncoder", "Create_Impl", (void*)TeeEncoder_Create_Impl },
+                { "Schmix.Encoding.TeeEncoder", "Delete_Impl", (void*)TeeEncoder_Delete_Impl },
+                { "Schmix.Encoding.TeeEncoder", "AddFile_Impl", (void*)TeeEncoder_AddFile_Impl },
+                { "Schmix.Encoding.TeeEncoder", "Write_Impl", (void*)TeeEncoder_Write_Impl },
+                { "Schmix.Encoding.TeeEncoder", "Finish_Impl", (void*)TeeEncoder_Finish_Impl },
+
+                { "Schmix.Encoding.AudioFrame", "GetSamples_Impl",
+                  (void*)AudioFrame_GetSamples_Impl },
+                { "Schmix.Encoding.AudioFrame", "GetChannels_Impl",
+                  (void*)AudioFrame_GetChannels_Impl },
+                { "Schmix.Encoding.AudioFrame", "GetSampleRate_Impl",
+                  (void*)AudioFrame_GetSampleRate_Impl },
+                { "Schmix.Encoding.AudioFrame", "GetSampleFormat_Impl",
+                  (void*)AudioFrame_GetSampleFormat_Impl },
+                { "Schmix.Encoding.AudioFrame", "IsPlanar_Impl", (void*)AudioFrame_IsPlanar_Impl },
+                { "Schmix.Encoding.AudioFrame", "GetLiveCount_Impl",
+                  (void*)AudioFrame_GetLiveCount_Impl },
+                { "Schmix.Encoding.AudioFrame", "GetPlaneCount_Impl",
+                  (void*)AudioFrame_GetPlaneCount_Impl },
+                { "Schmix.Encoding.AudioFrame", "GetPlane_Impl", (void*)AudioFrame_GetPlane_Impl },
+                { "Schmix.Encoding.AudioFrame", "GetPlaneSize_Impl",
+                  (void*)AudioFrame_GetPlaneSize_Impl },
+
+                { "Schmix.Encoding.Probe", "File_Impl", (void*)Probe_File_Impl },
             });
     }
 } // namespace schmix
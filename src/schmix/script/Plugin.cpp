@@ -1,8 +1,15 @@
 #include "schmixpch.h"
 #include "schmix/script/Plugin.h"
 
+#include "schmix/script/PluginIndex.h"
+
+#include "schmix/core/Hash.h"
+#include "schmix/core/ThreadPool.h"
+
 #include <Coral/GC.hpp>
 
+#include <fstream>
+
 namespace schmix {
     struct PluginData {
         Ref<ScriptRuntime> Runtime;
@@ -10,6 +17,9 @@ namespace schmix {
 
         bool PluginsLoaded;
         std::filesystem::path PluginDirectory;
+
+        // index entries of assemblies being scanned, by assembly id
+        std::unordered_map<std::int32_t, PluginIndex::AssemblyEntry*> ScanTargets;
     };
 
     static std::unique_ptr<PluginData> s_Data;
@@ -49,12 +59,159 @@ namespace schmix {
         s_Data.reset();
     }
 
-    bool Plugin::LoadPlugins(const std::filesystem::path& directory) {
-        if (!s_Data || s_Data->PluginsLoaded) {
+    struct AssemblyCandidate {
+        std::string Path;
+        PluginIndex::AssemblyEntry Entry;
+
+        bool Changed;
+        bool Valid;
+        bool ReadyToRun;
+    };
+
+    template <typename T>
+    static bool ReadAt(std::ifstream& stream, std::uint64_t offset, T& value) {
+        stream.seekg((std::streamoff)offset);
+        stream.read((char*)&value, sizeof(T));
+
+        return stream.good();
+    }
+
+    // checks the cli header of a pe image for a managed native (ReadyToRun) header
+    static bool IsReadyToRunImage(const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        std::uint32_t peOffset, signature;
+        if (!ReadAt(stream, 0x3C, peOffset) || !ReadAt(stream, peOffset, signature) ||
+            signature != 0x00004550) {
             return false;
         }
 
-        auto& host = s_Data->Runtime->GetHost();
+        std::uint64_t coffHeader = (std::uint64_t)peOffset + 4;
+        std::uint64_t optionalHeader = coffHeader + 20;
+
+        std::uint16_t sectionCount, optionalHeaderSize, magic;
+        if (!ReadAt(stream, coffHeader + 2, sectionCount) ||
+            !ReadAt(stream, coffHeader + 16, optionalHeaderSize) ||
+            !ReadAt(stream, optionalHeader, magic)) {
+            return false;
+        }
+
+        // data directories start at 96 bytes for pe32 and 112 for pe32+
+        std::uint64_t directories = optionalHeader + (magic == 0x20B ? 112 : 96);
+        std::uint32_t cliRVA, cliSize;
+
+        // the cli header is directory 14
+        if (!ReadAt(stream, directories + 14 * 8, cliRVA) ||
+            !ReadAt(stream, directories + 14 * 8 + 4, cliSize) || cliSize == 0) {
+            return false;
+        }
+
+        std::uint64_t sections = optionalHeader + optionalHeaderSize;
+        for (std::uint16_t i = 0; i < sectionCount; i++) {
+            std::uint64_t section = sections + i * 40;
+
+            std::uint32_t virtualSize, virtualAddress, rawOffset;
+            if (!ReadAt(stream, section + 8, virtualSize) ||
+                !ReadAt(stream, section + 12, virtualAddress) ||
+                !ReadAt(stream, section + 20, rawOffset)) {
+                return false;
+            }
+
+            if (cliRVA < virtualAddress || cliRVA >= virtualAddress + virtualSize) {
+                continue;
+            }
+
+            // ManagedNativeHeader is the last directory in the cli header
+            std::uint64_t cliHeader = (std::uint64_t)rawOffset + (cliRVA - virtualAddress);
+            std::uint32_t nativeHeaderSize;
+
+            return ReadAt(stream, cliHeader + 68, nativeHeaderSize) && nativeHeaderSize > 0;
+        }
+
+        return false;
+    }
+
+    static AssemblyCandidate InspectAssembly(const std::filesystem::path& path,
+                                             const PluginIndex& index) {
+        AssemblyCandidate candidate;
+        candidate.Path = path.string();
+        candidate.Entry = {};
+        candidate.Changed = true;
+        candidate.Valid = false;
+        candidate.ReadyToRun = IsReadyToRunImage(path);
+
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        auto modifiedTime = std::filesystem::last_write_time(path, error);
+
+        if (error) {
+            SCHMIX_ERROR("Failed to stat plugin library {}: {}", candidate.Path.c_str(),
+                         error.message().c_str());
+
+            return candidate;
+        }
+
+        candidate.Entry.Size = (std::uint64_t)size;
+        candidate.Entry.ModifiedTime = (std::int64_t)modifiedTime.time_since_epoch().count();
+
+        auto cached = index.Find(candidate.Path);
+        if (cached != nullptr && cached->Size == candidate.Entry.Size &&
+            cached->ModifiedTime == candidate.Entry.ModifiedTime) {
+            candidate.Entry = *cached;
+            candidate.Changed = false;
+            candidate.Valid = true;
+
+            return candidate;
+        }
+
+        auto hash = Hash::File(path);
+        if (!hash.has_value()) {
+            return candidate;
+        }
+
+        candidate.Entry.Hash = hash.value();
+        candidate.Valid = true;
+
+        // touched but identical; keep the recorded plugins
+        if (cached != nullptr && cached->Hash == candidate.Entry.Hash) {
+            candidate.Entry.Plugins = cached->Plugins;
+            candidate.Changed = false;
+        }
+
+        return candidate;
+    }
+
+    static void InvokeWithStrings(const std::string& method, const std::vector<std::string>& strings) {
+        std::vector<Coral::String> nativeStrings;
+        for (const auto& string : strings) {
+            nativeStrings.push_back(Coral::String::New(string));
+        }
+
+        switch (nativeStrings.size()) {
+        case 1:
+            s_Data->PluginType->InvokeStaticMethod(method, nativeStrings[0]);
+            break;
+        case 3:
+            s_Data->PluginType->InvokeStaticMethod(method, nativeStrings[0], nativeStrings[1],
+                                                   nativeStrings[2]);
+            break;
+        default:
+            throw std::runtime_error("Unsupported argument count!");
+        }
+
+        for (auto& string : nativeStrings) {
+            Coral::String::Free(string);
+        }
+    }
+
+    bool Plugin::LoadPlugins(const std::filesystem::path& directory,
+                             const std::optional<std::filesystem::path>& indexPath) {
+        if (!s_Data || s_Data->PluginsLoaded) {
+            return false;
+        }
 
         s_Data->PluginsLoaded = true;
         s_Data->PluginDirectory = directory;
@@ -65,7 +222,7 @@ namespace schmix {
 
         SCHMIX_INFO("Loading plugins in directory: {}", directory.string().c_str());
 
-        std::size_t pluginCount = 0;
+        std::vector<std::filesystem::path> paths;
         if (std::filesystem::is_directory(directory)) {
             for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
                 if (!entry.is_regular_file()) {
@@ -73,41 +230,112 @@ namespace schmix {
                 }
 
                 auto path = entry.path().lexically_normal();
-                auto extension = path.extension();
-
-                if (extension != ".dll") {
-                    continue;
+                if (path.extension() == ".dll") {
+                    paths.push_back(path);
                 }
+            }
+        }
 
-                std::string pathStr = path.string();
-                SCHMIX_INFO("Loading plugin library: {}", pathStr.c_str());
+        // deterministic load order regardless of directory iteration order
+        std::sort(paths.begin(), paths.end());
 
-                auto& assembly = s_Data->Runtime->LoadAssembly(pathStr);
-                if (assembly.GetLoadStatus() != Coral::AssemblyLoadStatus::Success) {
-                    SCHMIX_ERROR("Failed to load plugin library: {}", pathStr.c_str());
+        PluginIndex index;
+        if (indexPath.has_value()) {
+            index.Load(indexPath.value());
+        }
 
-                    UnloadPlugins();
-                    return false;
-                }
+        std::vector<AssemblyCandidate> candidates(paths.size());
+        if (!paths.empty()) {
+            ThreadPool pool(std::min<std::size_t>(std::thread::hardware_concurrency(), paths.size()));
+
+            std::vector<std::future<AssemblyCandidate>> inspections;
+            for (const auto& path : paths) {
+                inspections.push_back(
+                    pool.Submit([&path, &index]() { return InspectAssembly(path, index); }));
+            }
+
+            for (std::size_t i = 0; i < inspections.size(); i++) {
+                candidates[i] = inspections[i].get();
+            }
+        }
 
-                std::int32_t id = assembly.GetAssemblyID();
-                std::int32_t pluginsLoaded =
-                    s_Data->PluginType
-                        ->InvokeStaticMethod<std::int32_t, std::int32_t, std::int32_t>(
-                            "LoadPluginsFromAssembly_Native", std::move(contextID), std::move(id));
+        InvokeWithStrings("SetPluginDirectory_Native", { directory.string() });
 
-                if (pluginsLoaded < 0) {
-                    SCHMIX_ERROR("Failed to load plugins from assembly {}", pathStr.c_str());
+        std::size_t pluginCount = 0;
+        std::size_t changedCount = 0;
+        std::size_t precompiledCount = 0;
+
+        for (auto& candidate : candidates) {
+            if (!candidate.Valid) {
+                SCHMIX_ERROR("Failed to inspect plugin library: {}", candidate.Path.c_str());
+
+                UnloadPlugins();
+                return false;
+            }
+
+            if (candidate.ReadyToRun) {
+                precompiledCount++;
+            } else if (s_Data->Runtime->GetOptions().ReadyToRun) {
+                SCHMIX_DEBUG("Plugin library is not precompiled; modules will be jitted on first "
+                             "use: {}",
+                             candidate.Path.c_str());
+            }
+
+            if (!candidate.Changed) {
+                SCHMIX_DEBUG("Plugin library unchanged; deferring load: {}", candidate.Path.c_str());
 
-                    UnloadPlugins();
-                    return false;
+                for (const auto& plugin : candidate.Entry.Plugins) {
+                    InvokeWithStrings("RegisterIndexedPlugin_Native",
+                                      { plugin.Name, plugin.TypeName, candidate.Path });
                 }
 
-                pluginCount += (std::size_t)pluginsLoaded;
+                pluginCount += candidate.Entry.Plugins.size();
+                continue;
+            }
+
+            SCHMIX_INFO("Loading plugin library: {}", candidate.Path.c_str());
+
+            // the load context is not thread-safe; only the reflection scan runs in parallel
+            auto& assembly = s_Data->Runtime->LoadAssembly(candidate.Path);
+            if (assembly.GetLoadStatus() != Coral::AssemblyLoadStatus::Success) {
+                SCHMIX_ERROR("Failed to load plugin library: {}", candidate.Path.c_str());
+
+                UnloadPlugins();
+                return false;
+            }
+
+            std::int32_t id = assembly.GetAssemblyID();
+            s_Data->ScanTargets[id] = &candidate.Entry;
+            s_Data->PluginType->InvokeStaticMethod("QueueAssembly_Native", std::move(id));
+
+            changedCount++;
+        }
+
+        std::int32_t pluginsLoaded = s_Data->PluginType->InvokeStaticMethod<std::int32_t, std::int32_t>(
+            "LoadQueuedAssemblies_Native", std::move(contextID));
+
+        s_Data->ScanTargets.clear();
+        if (pluginsLoaded < 0) {
+            SCHMIX_ERROR("Failed to load plugins from changed assemblies!");
+
+            UnloadPlugins();
+            return false;
+        }
+
+        pluginCount += (std::size_t)pluginsLoaded;
+
+        if (indexPath.has_value()) {
+            index.Clear();
+            for (const auto& candidate : candidates) {
+                index.Set(candidate.Path, candidate.Entry);
             }
+
+            index.Save(indexPath.value());
         }
 
-        SCHMIX_INFO("Loaded {} plugin(s)", pluginCount);
+        SCHMIX_INFO("Loaded {} plugin(s); scanned {} of {} libraries, {} precompiled", pluginCount,
+                    changedCount, candidates.size(), precompiledCount);
+
         return true;
     }
 
@@ -125,4 +353,35 @@ namespace schmix {
         s_Data->PluginType->InvokeStaticMethod("UnloadPlugins");
         s_Data->PluginsLoaded = false;
     }
+
+    std::int32_t Plugin::LoadAssembly(const std::filesystem::path& path) {
+        if (!s_Data) {
+            return -1;
+        }
+
+        auto pathStr = path.string();
+        SCHMIX_INFO("Loading plugin library on demand: {}", pathStr.c_str());
+
+        auto& assembly = s_Data->Runtime->LoadAssembly(path);
+        if (assembly.GetLoadStatus() != Coral::AssemblyLoadStatus::Success) {
+            SCHMIX_ERROR("Failed to load plugin library: {}", pathStr.c_str());
+            return -1;
+        }
+
+        return assembly.GetAssemblyID();
+    }
+
+    void Plugin::RecordPlugin(std::int32_t assemblyID, const std::string& name,
+                              const std::string& typeName) {
+        if (!s_Data) {
+            return;
+        }
+
+        auto it = s_Data->ScanTargets.find(assemblyID);
+        if (it == s_Data->ScanTargets.end()) {
+            return;
+        }
+
+        it->second->Plugins.push_back({ name, typeName });
+    }
 } // namespace schmix
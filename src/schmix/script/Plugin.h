@@ -7,7 +7,16 @@ namespace schmix {
         static bool Init(const Ref<ScriptRuntime>& runtime);
         static void Cleanup();
 
-        static bool LoadPlugins(const std::filesystem::path& directory);
+        // if indexPath is given, assemblies unchanged since the last run are registered from the
+        // index and only loaded on first use
+        static bool LoadPlugins(const std::filesystem::path& directory,
+                                const std::optional<std::filesystem::path>& indexPath = {});
+
         static void UnloadPlugins();
+
+        // called from managed code
+        static std::int32_t LoadAssembly(const std::filesystem::path& path);
+        static void RecordPlugin(std::int32_t assemblyID, const std::string& name,
+                                 const std::string& typeName);
     };
 } // namespace schmix
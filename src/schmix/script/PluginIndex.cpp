@@ -0,0 +1,123 @@
+#include "schmixpch.h"
+#include "schmix/script/PluginIndex.h"
+
+#include <fstream>
+
+namespace schmix {
+    static const std::string s_Header = "schmix-plugin-index 1";
+
+    static std::vector<std::string> SplitFields(const std::string& line) {
+        std::vector<std::string> fields;
+
+        std::size_t start = 0;
+        while (true) {
+            std::size_t end = line.find('\t', start);
+            fields.push_back(line.substr(start, end - start));
+
+            if (end == std::string::npos) {
+                break;
+            }
+
+            start = end + 1;
+        }
+
+        return fields;
+    }
+
+    bool PluginIndex::Load(const std::filesystem::path& path) {
+        m_Entries.clear();
+
+        std::ifstream stream(path);
+        if (!stream.is_open()) {
+            SCHMIX_DEBUG("No plugin index at {}", path.string().c_str());
+            return false;
+        }
+
+        std::string line;
+        if (!std::getline(stream, line) || line != s_Header) {
+            SCHMIX_WARN("Plugin index {} is invalid or outdated - ignoring", path.string().c_str());
+            return false;
+        }
+
+        AssemblyEntry* current = nullptr;
+        while (std::getline(stream, line)) {
+            auto fields = SplitFields(line);
+
+            try {
+                if (fields[0] == "assembly" && fields.size() == 5) {
+                    AssemblyEntry entry;
+                    entry.ModifiedTime = std::stoll(fields[1]);
+                    entry.Size = std::stoull(fields[2]);
+                    entry.Hash = std::stoull(fields[3], nullptr, 16);
+
+                    current = &(m_Entries[fields[4]] = entry);
+                } else if (fields[0] == "plugin" && fields.size() == 3 && current != nullptr) {
+                    current->Plugins.push_back({ fields[1], fields[2] });
+                } else {
+                    throw std::runtime_error("Malformed line");
+                }
+            } catch (const std::exception&) {
+                SCHMIX_WARN("Plugin index {} is corrupt - ignoring", path.string().c_str());
+
+                m_Entries.clear();
+                return false;
+            }
+        }
+
+        SCHMIX_DEBUG("Loaded plugin index with {} assemblies", m_Entries.size());
+        return true;
+    }
+
+    bool PluginIndex::Save(const std::filesystem::path& path) const {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        // write next to the destination and swap in, so a crash never leaves a partial index
+        auto tempPath = path;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream stream(tempPath, std::ios::out | std::ios::trunc);
+            if (!stream.is_open()) {
+                SCHMIX_ERROR("Failed to open plugin index for writing: {}", path.string().c_str());
+                return false;
+            }
+
+            stream << s_Header << '\n';
+            for (const auto& [assemblyPath, entry] : m_Entries) {
+                stream << "assembly\t" << entry.ModifiedTime << '\t' << entry.Size << '\t'
+                       << std::hex << entry.Hash << std::dec << '\t' << assemblyPath << '\n';
+
+                for (const auto& plugin : entry.Plugins) {
+                    stream << "plugin\t" << plugin.Name << '\t' << plugin.TypeName << '\n';
+                }
+            }
+
+            if (!stream) {
+                SCHMIX_ERROR("Failed to write plugin index: {}", path.string().c_str());
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            SCHMIX_ERROR("Failed to replace plugin index: {}", error.message().c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    const PluginIndex::AssemblyEntry* PluginIndex::Find(const std::string& assemblyPath) const {
+        auto it = m_Entries.find(assemblyPath);
+        if (it == m_Entries.end()) {
+            return nullptr;
+        }
+
+        return &it->second;
+    }
+
+    void PluginIndex::Set(const std::string& assemblyPath, const AssemblyEntry& entry) {
+        m_Entries[assemblyPath] = entry;
+    }
+} // namespace schmix
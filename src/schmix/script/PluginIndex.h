@@ -0,0 +1,36 @@
+#pragma once
+
+namespace schmix {
+    // persisted record of which plugin types each assembly registers, so unchanged assemblies
+    // can skip the reflection scan on startup
+    class PluginIndex {
+    public:
+        struct PluginEntry {
+            std::string Name;
+            std::string TypeName;
+        };
+
+        struct AssemblyEntry {
+            std::int64_t ModifiedTime;
+            std::uint64_t Size;
+            std::uint64_t Hash;
+
+            std::vector<PluginEntry> Plugins;
+        };
+
+        bool Load(const std::filesystem::path& path);
+        bool Save(const std::filesystem::path& path) const;
+
+        const AssemblyEntry* Find(const std::string& assemblyPath) const;
+        void Set(const std::string& assemblyPath, const AssemblyEntry& entry);
+
+        void Clear() { m_Entries.clear(); }
+
+        const std::unordered_map<std::string, AssemblyEntry>& GetEntries() const {
+            return m_Entries;
+        }
+
+    private:
+        std::unordered_map<std::string, AssemblyEntry> m_Entries;
+    };
+} // namespace schmix
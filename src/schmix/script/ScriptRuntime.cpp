@@ -26,15 +26,59 @@ namespace schmix {
         SCHMIX_ERROR("Managed exception: {}", messageStr.c_str());
     }
 
-    ScriptRuntime::ScriptRuntime(const std::filesystem::path& runtimeDir) {
+    static void SetRuntimeVariable(const std::string& name, const std::string& value) {
+        SCHMIX_DEBUG("Setting runtime variable {}={}", name.c_str(), value.c_str());
+
+#ifdef SCHMIX_PLATFORM_windows
+        _putenv_s(name.c_str(), value.c_str());
+#else
+        setenv(name.c_str(), value.c_str(), 1);
+#endif
+    }
+
+    // a variable the user already set in the environment wins over the option
+    static void SetRuntimeDefault(const std::string& name, const std::string& value) {
+        const char* existing = std::getenv(name.c_str());
+        if (existing != nullptr) {
+            SCHMIX_INFO("Keeping runtime variable {}={} from the environment", name.c_str(),
+                        existing);
+
+            return;
+        }
+
+        SetRuntimeVariable(name, value);
+    }
+
+    static void ApplyStartupOptions(const ScriptRuntimeOptions& options) {
+        // the gc reads these once when the runtime is loaded
+        SetRuntimeDefault("DOTNET_gcConcurrent", options.ConcurrentGC ? "1" : "0");
+        SetRuntimeDefault("DOTNET_gcServer", options.ServerGC ? "1" : "0");
+
+        if (options.Gen0Size > 0) {
+            // hex, per runtime convention
+            SetRuntimeDefault("DOTNET_GCgen0size", fmt::format("{:x}", options.Gen0Size));
+        }
+
+        SetRuntimeDefault("DOTNET_ReadyToRun", options.ReadyToRun ? "1" : "0");
+        SetRuntimeDefault("DOTNET_TieredCompilation", options.TieredCompilation ? "1" : "0");
+        SetRuntimeDefault("DOTNET_TieredPGO", options.TieredPGO ? "1" : "0");
+    }
+
+    ScriptRuntime::ScriptRuntime(const std::filesystem::path& runtimeDir,
+                                 const ScriptRuntimeOptions& options) {
         m_Initialized = false;
 
+        m_Options = options;
+        m_GCStatistics = {};
+
         m_RuntimeDirectory = runtimeDir.lexically_normal();
         if (!std::filesystem::is_directory(m_RuntimeDirectory)) {
             SCHMIX_ERROR("No such directory: {}", m_RuntimeDirectory.string().c_str());
             return;
         }
 
+        ApplyStartupOptions(m_Options);
+
         Coral::HostSettings settings;
         settings.CoralDirectory = m_RuntimeDirectory;
         settings.MessageCallback = CoralMessageCallback;
@@ -85,6 +129,52 @@ namespace schmix {
         return true;
     }
 
+    bool ScriptRuntime::ConfigureGC() {
+        if (!m_Initialized) {
+            SCHMIX_WARN("Script runtime not initialized; skipping GC configuration...");
+            return false;
+        }
+
+        SCHMIX_INFO("Configuring GC: latency mode {}, no-GC region of {} bytes",
+                    (std::int32_t)m_Options.LatencyMode, m_Options.NoGCRegionSize);
+
+        auto& gcType = GetType("Schmix.Core.GarbageCollector");
+        return gcType.InvokeStaticMethod<bool, std::int32_t, std::int64_t>(
+            "Configure", (std::int32_t)m_Options.LatencyMode,
+            (std::int64_t)m_Options.NoGCRegionSize);
+    }
+
+    void ScriptRuntime::ReportGCCycle(const GCCycleStatistics& cycle) {
+        auto& stats = m_GCStatistics;
+        stats.Cycles++;
+
+        bool collected = false;
+        for (std::size_t i = 0; i < 3; i++) {
+            stats.Collections[i] += cycle.Collections[i];
+            collected |= cycle.Collections[i] > 0;
+        }
+
+        if (!cycle.NoGCRegionHeld && m_Options.NoGCRegionSize > 0) {
+            stats.NoGCRegionFailures++;
+        }
+
+        stats.TotalPause += cycle.Pause;
+        if (cycle.Pause > stats.MaxCyclePause) {
+            stats.MaxCyclePause = cycle.Pause;
+        }
+
+        stats.LastCycle = cycle;
+
+        if (collected) {
+            stats.CyclesWithCollections++;
+
+            auto pauseUs = std::chrono::duration_cast<std::chrono::microseconds>(cycle.Pause);
+            SCHMIX_DEBUG("GC during processing cycle {}: gen0 {}, gen1 {}, gen2 {}; paused {} us",
+                         stats.Cycles, cycle.Collections[0], cycle.Collections[1],
+                         cycle.Collections[2], pauseUs.count());
+        }
+    }
+
     Coral::Type& ScriptRuntime::GetType(std::string_view name) const {
         return m_CoreAssembly->GetType(name);
     }
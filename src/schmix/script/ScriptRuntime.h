@@ -10,9 +10,62 @@ namespace schmix {
         void* CallbackPtr;
     };
 
+    // mirrors System.Runtime.GCLatencyMode
+    enum class GCLatencyMode : std::int32_t {
+        Batch = 0,
+        Interactive,
+        LowLatency,
+        SustainedLowLatency
+    };
+
+    struct ScriptRuntimeOptions {
+        GCLatencyMode LatencyMode = GCLatencyMode::Interactive;
+
+        // these two are read by the runtime on startup and cannot change afterwards
+        // like every startup option, they give way to the matching DOTNET_ environment variable
+        bool ConcurrentGC = true;
+        bool ServerGC = false;
+
+        // gen0 budget in bytes; 0 keeps the runtime default
+        std::size_t Gen0Size = 0;
+
+        // bytes reserved for the no-GC region entered around each rack processing cycle
+        // 0 disables the region
+        std::size_t NoGCRegionSize = 0;
+
+        // jit settings, also only read on startup
+        // disabling ReadyToRun forces precompiled assemblies to be jitted anyway
+        bool ReadyToRun = true;
+        bool TieredCompilation = true;
+        bool TieredPGO = true;
+
+        // run newly added modules on silent buffers before they join the rack
+        bool WarmUpModules = true;
+    };
+
+    struct GCCycleStatistics {
+        std::uint32_t Collections[3];
+        std::chrono::nanoseconds Pause;
+
+        // false if the cycle allocated past the reserved no-GC region
+        bool NoGCRegionHeld;
+    };
+
+    struct GCStatistics {
+        std::uint64_t Cycles;
+        std::uint64_t CyclesWithCollections;
+        std::uint64_t NoGCRegionFailures;
+
+        std::uint64_t Collections[3];
+        std::chrono::nanoseconds TotalPause, MaxCyclePause;
+
+        GCCycleStatistics LastCycle;
+    };
+
     class ScriptRuntime : public RefCounted {
     public:
-        ScriptRuntime(const std::filesystem::path& runtimeDir);
+        ScriptRuntime(const std::filesystem::path& runtimeDir,
+                      const ScriptRuntimeOptions& options = {});
         virtual ~ScriptRuntime() override;
 
         ScriptRuntime(const ScriptRuntime&) = delete;
@@ -22,6 +75,11 @@ namespace schmix {
 
         bool RegisterCoreBindings(const std::vector<ScriptBinding>& bindings);
 
+        // must be called after bindings are registered
+        bool ConfigureGC();
+
+        void ReportGCCycle(const GCCycleStatistics& cycle);
+
         Coral::HostInstance& GetHost() { return m_Host; }
         const Coral::HostInstance& GetHost() const { return m_Host; }
 
@@ -29,6 +87,9 @@ namespace schmix {
 
         bool IsInitialized() const { return m_Initialized; }
 
+        const ScriptRuntimeOptions& GetOptions() const { return m_Options; }
+        const GCStatistics& GetGCStatistics() const { return m_GCStatistics; }
+
         const Coral::ManagedAssembly* GetCore() const { return m_CoreAssembly; }
 
         Coral::Type& GetType(std::string_view name) const;
@@ -41,6 +102,9 @@ namespace schmix {
         Coral::ManagedAssembly* m_CoreAssembly;
 
         std::filesystem::path m_RuntimeDirectory;
+        ScriptRuntimeOptions m_Options;
+        GCStatistics m_GCStatistics;
+
         bool m_Initialized;
     };
 } // namespace schmix
@@ -1,11 +1,15 @@
 #include "schmixpch.h"
 #include "schmix/ui/Application.h"
 
+#include "schmix/ui/TranscodeCommand.h"
+
 #include "schmix/script/Bindings.h"
 #include "schmix/script/Plugin.h"
 
 #include "schmix/encoding/IO.h"
 
+#include "schmix/audio/SampleCache.h"
+
 namespace schmix {
     static Application* s_App = nullptr;
 
@@ -19,6 +23,11 @@ namespace schmix {
             arguments[i] = argv[i];
         }
 
+        // headless commands never bring up the window or the runtime
+        if (arguments.size() > 1 && arguments[1] == TranscodeCommand::Name) {
+            return TranscodeCommand::Run(arguments);
+        }
+
         Application app(arguments);
         s_App = &app;
 
@@ -30,6 +39,86 @@ namespace schmix {
 
     Application& Application::Get() { return *s_App; }
 
+    static std::filesystem::path GetUserCacheDirectory() {
+#ifdef SCHMIX_PLATFORM_windows
+        const char* localAppData = std::getenv("LOCALAPPDATA");
+        if (localAppData != nullptr) {
+            return std::filesystem::path(localAppData) / "schmix" / "cache";
+        }
+#else
+        const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+        if (cacheHome != nullptr && *cacheHome != '\0') {
+            return std::filesystem::path(cacheHome) / "schmix";
+        }
+
+        const char* home = std::getenv("HOME");
+        if (home != nullptr) {
+            return std::filesystem::path(home) / ".cache" / "schmix";
+        }
+#endif
+
+        return std::filesystem::temp_directory_path() / "schmix";
+    }
+
+    static std::optional<GCLatencyMode> ParseLatencyMode(const std::string& value) {
+        static const std::unordered_map<std::string, GCLatencyMode> modes = {
+            { "batch", GCLatencyMode::Batch },
+            { "interactive", GCLatencyMode::Interactive },
+            { "low", GCLatencyMode::LowLatency },
+            { "sustained", GCLatencyMode::SustainedLowLatency },
+        };
+
+        auto it = modes.find(value);
+        if (it == modes.end()) {
+            return {};
+        }
+
+        return it->second;
+    }
+
+    static ScriptRuntimeOptions ParseRuntimeOptions(const std::vector<std::string>& arguments) {
+        ScriptRuntimeOptions options;
+
+        for (std::size_t i = 1; i < arguments.size(); i++) {
+            const auto& argument = arguments[i];
+
+            std::size_t separator = argument.find('=');
+            std::string name = argument.substr(0, separator);
+            std::string value = separator != std::string::npos ? argument.substr(separator + 1) : "";
+
+            try {
+                if (name == "--gc-latency") {
+                    auto mode = ParseLatencyMode(value);
+                    if (mode.has_value()) {
+                        options.LatencyMode = mode.value();
+                    } else {
+                        SCHMIX_WARN("Unknown GC latency mode: {}", value.c_str());
+                    }
+                } else if (name == "--gc-non-concurrent") {
+                    options.ConcurrentGC = false;
+                } else if (name == "--gc-server") {
+                    options.ServerGC = true;
+                } else if (name == "--gc-gen0-size") {
+                    options.Gen0Size = (std::size_t)std::stoull(value);
+                } else if (name == "--gc-no-gc-region") {
+                    options.NoGCRegionSize = (std::size_t)std::stoull(value);
+                } else if (name == "--no-ready-to-run") {
+                    options.ReadyToRun = false;
+                } else if (name == "--no-tiered-compilation") {
+                    options.TieredCompilation = false;
+                } else if (name == "--no-tiered-pgo") {
+                    options.TieredPGO = false;
+                } else if (name == "--no-warm-up") {
+                    options.WarmUpModules = false;
+                }
+            } catch (const std::exception&) {
+                SCHMIX_WARN("Invalid value for {}: {}", name.c_str(), value.c_str());
+            }
+        }
+
+        return options;
+    }
+
     Application::~Application() {
         if (m_Runtime.IsPresent()) {
             m_Runtime->GetType("Schmix.UI.Application").InvokeStaticMethod("Shutdown");
@@ -44,6 +133,8 @@ namespace schmix {
         SDL_Quit();
         MIDI::Shutdown();
 
+        SampleCache::Shutdown();
+
         if (m_OwnsLogger) {
             ResetLogger();
         }
@@ -63,16 +154,19 @@ namespace schmix {
         m_Executable = std::filesystem::absolute(arguments[0]).lexically_normal();
         auto executableDirectory = m_Executable.parent_path();
 
-        std::filesystem::path resourceDir;
+        std::filesystem::path resourceDir, cacheDir;
         std::optional<std::filesystem::path> logDir;
         if (executableDirectory.filename().string() == "bin") {
             resourceDir = executableDirectory / "../share/schmix";
+            cacheDir = GetUserCacheDirectory();
         } else {
             resourceDir = std::filesystem::current_path() / "assets";
             logDir = std::filesystem::current_path() / "logs";
+            cacheDir = std::filesystem::current_path() / "cache";
         }
 
         m_ResourceDirectory = resourceDir.lexically_normal();
+        m_CacheDirectory = cacheDir.lexically_normal();
         m_OwnsLogger = CreateLogger(logDir);
 
         // todo: dump build info
@@ -81,12 +175,23 @@ namespace schmix {
 
         SCHMIX_INFO("Executable path: {}", m_Executable.string().c_str());
         SCHMIX_INFO("Resource directory: {}", m_ResourceDirectory.string().c_str());
+        SCHMIX_INFO("Cache directory: {}", m_CacheDirectory.string().c_str());
+
+        std::error_code error;
+        std::filesystem::create_directories(m_CacheDirectory, error);
+        if (error) {
+            SCHMIX_WARN("Failed to create cache directory: {}", error.message().c_str());
+        }
+
+        m_RuntimeOptions = ParseRuntimeOptions(arguments);
 
         SCHMIX_INFO("Initializing...");
 
         MIDI::Init();
         IO::Init();
 
+        SampleCache::Init(m_CacheDirectory / "samples");
+
         if (!CreateWindow() || !InitImGui() || !InitRuntime()) {
             SCHMIX_ERROR("Initialization failed! Exiting 1...");
             Quit(1);
@@ -125,7 +230,7 @@ namespace schmix {
     }
 
     bool Application::InitRuntime() {
-        m_Runtime = new ScriptRuntime(m_ResourceDirectory / "runtime");
+        m_Runtime = new ScriptRuntime(m_ResourceDirectory / "runtime", m_RuntimeOptions);
         if (!m_Runtime->IsInitialized()) {
             SCHMIX_ERROR("Failed to initialize managed script runtime!");
             return false;
@@ -135,18 +240,24 @@ namespace schmix {
         Bindings::Get(bindings);
         m_Runtime->RegisterCoreBindings(bindings);
 
+        if (!m_Runtime->ConfigureGC()) {
+            SCHMIX_WARN("Failed to apply GC configuration; continuing with runtime defaults");
+        }
+
         if (!Plugin::Init(m_Runtime)) {
             SCHMIX_ERROR("Failed to initialize plugin interface!");
             return false;
         }
 
-        if (!Plugin::LoadPlugins(m_ResourceDirectory / "plugins")) {
+        if (!Plugin::LoadPlugins(m_ResourceDirectory / "plugins",
+                                 m_CacheDirectory / "plugins.index")) {
             SCHMIX_ERROR("Failed to load plugins!");
             return false;
         }
 
         auto& appType = m_Runtime->GetType("Schmix.UI.Application");
-        if (!appType.InvokeStaticMethod<bool>("Init")) {
+        if (!appType.InvokeStaticMethod<bool, Coral::Bool32>(
+                "Init", Coral::Bool32(m_RuntimeOptions.WarmUpModules))) {
             SCHMIX_ERROR("Failed to initialize Application in managed code!");
             return false;
         }
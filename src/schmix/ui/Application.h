@@ -22,6 +22,9 @@ namespace schmix {
 
         const Ref<Window>& GetWindow() const { return m_Window; }
         const Ref<ImGuiInstance>& GetImGuiInstance() const { return m_ImGui; }
+        const Ref<ScriptRuntime>& GetRuntime() const { return m_Runtime; }
+
+        const std::filesystem::path& GetCacheDirectory() const { return m_CacheDirectory; }
 
         bool IsRunning() const { return m_Running; }
 
@@ -45,12 +48,15 @@ namespace schmix {
 
         std::filesystem::path m_Executable;
         std::filesystem::path m_ResourceDirectory;
+        std::filesystem::path m_CacheDirectory;
 
         bool m_Running;
         int m_Status;
 
         bool m_OwnsLogger;
 
+        ScriptRuntimeOptions m_RuntimeOptions;
+
         Ref<Window> m_Window;
 
         Ref<ImGuiInstance> m_ImGui;
@@ -0,0 +1,169 @@
+#include "schmixpch.h"
+#include "schmix/ui/TranscodeCommand.h"
+
+#include "schmix/encoding/BatchTranscoder.h"
+#include "schmix/encoding/IO.h"
+
+namespace schmix {
+    static void PrintUsage() {
+        SCHMIX_INFO("Usage: schmix transcode <input glob> <output pattern> [options]");
+        SCHMIX_INFO("  The * in the output pattern stands for each input's path below the glob's "
+                    "first wildcard, without its extension");
+        SCHMIX_INFO("  --format=<extension>    replaces the output pattern's extension");
+        SCHMIX_INFO("  --rate=<hz>             output sample rate; defaults to each input's");
+        SCHMIX_INFO("  --channels=<n>          mono, stereo or a channel count; defaults to 2");
+        SCHMIX_INFO("  --jobs=<n>              files transcoded at once; defaults to one per "
+                    "hardware thread");
+        SCHMIX_INFO("  --codec-threads=<n>     threads per encoder; defaults to 1");
+        SCHMIX_INFO("  --quality=<quality>     resampling quality: fast, balanced or high");
+        SCHMIX_INFO("  --overwrite             replaces existing outputs instead of skipping them");
+    }
+
+    static std::optional<Resampler::Quality> ParseQuality(const std::string& value) {
+        static const std::unordered_map<std::string, Resampler::Quality> qualities = {
+            { "fast", Resampler::Quality::Fast },
+            { "balanced", Resampler::Quality::Balanced },
+            { "high", Resampler::Quality::High },
+        };
+
+        auto it = qualities.find(value);
+        if (it == qualities.end()) {
+            return {};
+        }
+
+        return it->second;
+    }
+
+    static std::optional<std::size_t> ParseChannels(const std::string& value) {
+        if (value == "mono") {
+            return 1;
+        } else if (value == "stereo") {
+            return 2;
+        }
+
+        auto channels = (std::size_t)std::stoull(value);
+        if (channels == 0) {
+            return {};
+        }
+
+        return channels;
+    }
+
+    static void ReportProgress(const BatchTranscoder::Progress& progress,
+                               std::size_t sampleRate) {
+        std::size_t done = progress.Completed + progress.Failed + progress.Skipped;
+        double seconds = std::max(progress.Elapsed.count(), 1e-3);
+
+        // every output shares a rate only if one was given
+        std::string speed;
+        if (sampleRate > 0) {
+            double audioSeconds = (double)progress.Frames / (double)sampleRate;
+            speed = fmt::format(", {:.1f}x realtime", audioSeconds / seconds);
+        }
+
+        SCHMIX_INFO("[{}/{}] {} failed, {} skipped - {:.1f} files/s, {:.0f} frames/s{}", done,
+                    progress.Total, progress.Failed, progress.Skipped, (double)done / seconds,
+                    (double)progress.Frames / seconds, speed.c_str());
+    }
+
+    static int RunTranscode(const std::vector<std::string>& arguments) {
+        std::vector<std::string> positional;
+        std::optional<std::string> format;
+        BatchTranscoder::Options options;
+
+        for (std::size_t i = 2; i < arguments.size(); i++) {
+            const auto& argument = arguments[i];
+            if (!argument.starts_with("--")) {
+                positional.push_back(argument);
+                continue;
+            }
+
+            std::size_t separator = argument.find('=');
+            std::string name = argument.substr(0, separator);
+            std::string value = separator != std::string::npos ? argument.substr(separator + 1) : "";
+
+            try {
+                if (name == "--help") {
+                    PrintUsage();
+                    return 0;
+                } else if (name == "--format") {
+                    format = value.starts_with('.') ? value : "." + value;
+                } else if (name == "--rate") {
+                    options.SampleRate = (std::size_t)std::stoull(value);
+                } else if (name == "--channels") {
+                    auto channels = ParseChannels(value);
+                    if (!channels.has_value()) {
+                        SCHMIX_ERROR("Invalid channel layout: {}", value.c_str());
+                        return 2;
+                    }
+
+                    options.Channels = channels.value();
+                } else if (name == "--jobs") {
+                    options.Jobs = (std::size_t)std::stoull(value);
+                } else if (name == "--codec-threads") {
+                    options.CodecThreads = (std::size_t)std::stoull(value);
+                } else if (name == "--quality") {
+                    auto quality = ParseQuality(value);
+                    if (!quality.has_value()) {
+                        SCHMIX_ERROR("Unknown resampling quality: {}", value.c_str());
+                        return 2;
+                    }
+
+                    options.Quality = quality.value();
+                } else if (name == "--overwrite") {
+                    options.Overwrite = true;
+                } else {
+                    SCHMIX_ERROR("Unknown option: {}", name.c_str());
+                    return 2;
+                }
+            } catch (const std::exception&) {
+                SCHMIX_ERROR("Invalid value for {}: {}", name.c_str(), value.c_str());
+                return 2;
+            }
+        }
+
+        if (positional.size() != 2) {
+            PrintUsage();
+            return 2;
+        }
+
+        std::string outputPattern = positional[1];
+        if (format.has_value()) {
+            outputPattern =
+                std::filesystem::path(outputPattern).replace_extension(format.value()).string();
+        }
+
+        auto jobs = BatchTranscoder::CollectJobs(positional[0], outputPattern);
+        if (!jobs.has_value()) {
+            return 2;
+        }
+
+        if (jobs->empty()) {
+            SCHMIX_WARN("Nothing matched {}", positional[0].c_str());
+            return 0;
+        }
+
+        BatchTranscoder transcoder(options);
+        bool success = transcoder.Run(
+            jobs.value(),
+            [&](const BatchTranscoder::Progress& progress) {
+                ReportProgress(progress, options.SampleRate);
+            },
+            std::chrono::seconds(1));
+
+        return success ? 0 : 1;
+    }
+
+    int TranscodeCommand::Run(const std::vector<std::string>& arguments) {
+        bool ownsLogger = CreateLogger({});
+        IO::Init();
+
+        int status = RunTranscode(arguments);
+
+        if (ownsLogger) {
+            ResetLogger();
+        }
+
+        return status;
+    }
+} // namespace schmix
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace schmix {
+    // "schmix transcode <input glob> <output pattern> [options]"
+    // runs headless: no window, audio device or script runtime is ever created
+    class TranscodeCommand {
+    public:
+        static constexpr const char* Name = "transcode";
+
+        TranscodeCommand() = delete;
+
+        // returns the process exit status
+        static int Run(const std::vector<std::string>& arguments);
+    };
+} // namespace schmix